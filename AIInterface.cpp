@@ -1,7 +1,27 @@
 #include "AIInterface.h"
+#include "BuiltinPredictors.h"
+#include "TreeEnsemblePredictor.h"
+#include "KnnPredictor.h"
+#include "ModelContainer.h"
 #include <iostream>
+#include <memory>
 
 AIInterface::AIInterface() : aiEnabled(false), useOpenAI(false), modelPath(""), openAIModel("gpt-3.5-turbo") {
+    FeatureCategories& categories = registry.getCategories();
+    auto remote = std::make_unique<RemotePredictor>(categories);
+    remotePredictor = remote.get();
+    auto tree = std::make_unique<TreeEnsemblePredictor>(categories);
+    treePredictor = tree.get();
+    auto knn = std::make_unique<KnnPredictor>(categories);
+    knnPredictor = knn.get();
+    registry.registerPredictor("heuristic", std::make_unique<HeuristicPredictor>(categories));
+    auto regression = std::make_unique<RegressionPredictor>(categories);
+    regressionPredictor = regression.get();
+    registry.registerPredictor("regression", std::move(regression));
+    registry.registerPredictor("tree", std::move(tree));
+    registry.registerPredictor("knn", std::move(knn));
+    registry.registerPredictor("remote", std::move(remote));
+    updateDefaultChain();
     std::cout << "AIInterface initialized (AI integration disabled by default)" << std::endl;
 }
 
@@ -20,6 +40,7 @@ bool AIInterface::isEnabled() const {
 
 void AIInterface::setUseOpenAI(bool enabled) {
     useOpenAI = enabled;
+    updateDefaultChain();
     std::cout << "OpenAI API usage " << (enabled ? "enabled" : "disabled") << std::endl;
 }
 
@@ -29,16 +50,19 @@ bool AIInterface::isUsingOpenAI() const {
 
 void AIInterface::setOpenAIApiKey(const std::string& apiKey) {
     openAIApiKey = apiKey;
+    remotePredictor->setApiKey(apiKey);
     std::cout << "OpenAI API key set" << std::endl;
 }
 
 void AIInterface::setOpenAIOrganization(const std::string& orgId) {
     openAIOrganization = orgId;
+    remotePredictor->setOrganization(orgId);
     std::cout << "OpenAI organization ID set" << std::endl;
 }
 
 void AIInterface::setOpenAIModel(const std::string& model) {
     openAIModel = model;
+    remotePredictor->setModel(model);
     std::cout << "OpenAI model set to: " << model << std::endl;
 }
 
@@ -49,72 +73,28 @@ double AIInterface::predictCuttingPower(const std::string& material,
                                       double depthOfCut,
                                       const std::string& operationType,
                                       const std::string& machineType) {
+    CutFeatures features = registry.makeFeatures(material, toolDiameter, spindleSpeed, feedRate,
+                                                 depthOfCut, operationType, machineType);
+    double predictedPower = 0.0;
+
     if (!aiEnabled) {
-        // If AI is disabled, return a default value or use a simple heuristic
+        // If AI is disabled, use a simple heuristic based on material and operation type
         std::cout << "AI disabled - using heuristic to estimate cutting power" << std::endl;
-        // Simple heuristic based on material and operation type
-        double basePower = 3.0; // Base power in kW
-
-        // Adjust based on material hardness (simplified)
-        if (material.find("Steel") != std::string::npos || material.find("steel") != std::string::npos) {
-            basePower *= 1.5;
-        } else if (material.find("Ti") != std::string::npos || material.find("titanium") != std::string::npos) {
-            basePower *= 1.8;
-        } else if (material.find("Al") != std::string::npos || material.find("aluminum") != std::string::npos) {
-            basePower *= 0.8;
-        }
-
-        // Adjust based on operation type
-        if (operationType.find("Milling") != std::string::npos || operationType.find("milling") != std::string::npos) {
-            basePower *= 1.1;
-        } else if (operationType.find("Drilling") != std::string::npos || operationType.find("drilling") != std::string::npos) {
-            basePower *= 0.9;
-        }
-
-        std::cout << "Heuristic estimated cutting power: " << basePower << " kW" << std::endl;
-        return basePower;
+        predictCuttingPowerBatch(Span<const CutFeatures>(&features, 1), Span<double>(&predictedPower, 1));
+        std::cout << "Heuristic estimated cutting power: " << predictedPower << " kW" << std::endl;
+        return predictedPower;
     }
 
-    if (useOpenAI && !openAIApiKey.empty()) {
-        // Use OpenAI API for prediction
-        return predictCuttingPowerWithOpenAI(material, toolDiameter, spindleSpeed,
-                                           feedRate, depthOfCut, operationType, machineType);
-    } else {
-        // In a real implementation, this would call an actual local ML model
-        // For this example, we'll simulate a prediction based on the input parameters
-        std::cout << "Local AI prediction for material: " << material
-                  << ", tool diameter: " << toolDiameter
-                  << "mm, spindle: " << spindleSpeed
-                  << "RPM, feed: " << feedRate
-                  << "mm/min" << std::endl;
-
-        // Simulate AI prediction (in a real implementation, this would use actual ML)
-        double predictedPower = 2.0; // Base power
-
-        // Factors based on input parameters
-        if (material.find("Steel") != std::string::npos) predictedPower += 2.0;
-        else if (material.find("Al") != std::string::npos) predictedPower += 0.5;
-        else predictedPower += 1.0; // default for other materials
-
-        // Tool diameter effect (larger tools generally need more power)
-        predictedPower += (toolDiameter / 10.0) * 0.2;
-
-        // Spindle speed effect (higher speeds may require more power)
-        predictedPower += (spindleSpeed / 10000.0) * 0.5;
+    std::cout << "AI prediction for material: " << material
+              << ", tool diameter: " << toolDiameter
+              << "mm, spindle: " << spindleSpeed
+              << "RPM, feed: " << feedRate
+              << "mm/min" << std::endl;
 
-        // Feed rate effect
-        predictedPower += (feedRate / 1000.0) * 0.3;
+    predictCuttingPowerBatch(Span<const CutFeatures>(&features, 1), Span<double>(&predictedPower, 1));
 
-        // Depth of cut effect
-        predictedPower += depthOfCut * 0.4;
-
-        // Operation type effect
-        if (operationType.find("Milling") != std::string::npos) predictedPower += 0.5;
-        else if (operationType.find("Drilling") != std::string::npos) predictedPower -= 0.2;
-
-        std::cout << "Local AI predicted cutting power: " << predictedPower << " kW" << std::endl;
-        return predictedPower;
-    }
+    std::cout << "AI predicted cutting power: " << predictedPower << " kW" << std::endl;
+    return predictedPower;
 }
 
 double AIInterface::predictCuttingPowerWithOpenAI(const std::string& material,
@@ -124,10 +104,6 @@ double AIInterface::predictCuttingPowerWithOpenAI(const std::string& material,
                                                  double depthOfCut,
                                                  const std::string& operationType,
                                                  const std::string& machineType) {
-    std::cout << "Calling OpenAI API for cutting power prediction..." << std::endl;
-
-    // In a real implementation, this would make an HTTP request to the OpenAI API
-    // For this example, we'll simulate the API call and response
     std::cout << "OpenAI request: material=" << material
               << ", tool_diameter=" << toolDiameter
               << "mm, spindle=" << spindleSpeed
@@ -136,75 +112,183 @@ double AIInterface::predictCuttingPowerWithOpenAI(const std::string& material,
               << "mm, operation=" << operationType
               << ", machine=" << machineType << std::endl;
 
-    // This is where the actual API call would happen in a real implementation:
-    /*
-    // Example of what would happen in a real implementation:
-    std::string apiUrl = "https://api.openai.com/v1/chat/completions";
-    std::string apiKey = openAIApiKey;
-
-    // Prepare the prompt for the API
-    std::string prompt = "Based on machining parameters, predict cutting power in kW. ";
-    prompt += "Material: " + material + ", ";
-    prompt += "Tool Diameter: " + std::to_string(toolDiameter) + "mm, ";
-    prompt += "Spindle Speed: " + std::to_string(spindleSpeed) + "RPM, ";
-    prompt += "Feed Rate: " + std::to_string(feedRate) + "mm/min, ";
-    prompt += "Depth of Cut: " + std::to_string(depthOfCut) + "mm, ";
-    prompt += "Operation Type: " + operationType + ", ";
-    prompt += "Machine Type: " + machineType + ". ";
-    prompt += "Provide only the numerical value in kW.";
-
-    // Create JSON payload
-    json request = {
-        {"model", openAIModel},
-        {"messages", json::array({
-            {{"role", "system"}, {"content", "You are an expert in CNC machining and energy consumption. Predict cutting power based on machining parameters."}},
-            {{"role", "user"}, {"content", prompt}}
-        })},
-        {"temperature", 0.2}
-    };
+    CutFeatures features = registry.makeFeatures(material, toolDiameter, spindleSpeed, feedRate,
+                                                 depthOfCut, operationType, machineType);
+    double predictedPower = 0.0;
+    if (!remotePredictor->predictBatch(Span<const CutFeatures>(&features, 1), Span<double>(&predictedPower, 1))) {
+        std::cout << "OpenAI API not available, falling back to local prediction" << std::endl;
+        registry.predictBatch(Span<const CutFeatures>(&features, 1), Span<double>(&predictedPower, 1));
+    }
 
-    // Make HTTP request to OpenAI API
-    // ... (HTTP request code would go here)
-    */
+    std::cout << "OpenAI predicted cutting power: " << predictedPower << " kW" << std::endl;
+    return predictedPower;
+}
 
-    // For this example, simulate a prediction based on the input parameters
-    // In reality, this would come from the OpenAI API response
-    double predictedPower = 2.0; // Base power
+void AIInterface::predictCuttingPowerBatch(Span<const CutFeatures> features, Span<double> out) {
+    if (!aiEnabled) {
+        registry.getPredictor("heuristic")->predictBatch(features, out);
+        return;
+    }
+    registry.predictBatch(features, out);
+}
 
-    // Factors based on input parameters (similar to local model but potentially more refined)
-    if (material.find("Steel") != std::string::npos) predictedPower += 2.2;
-    else if (material.find("Ti") != std::string::npos) predictedPower += 2.5;
-    else if (material.find("Al") != std::string::npos) predictedPower += 0.6;
-    else predictedPower += 1.1; // default for other materials
+PredictorRegistry& AIInterface::getPredictorRegistry() {
+    return registry;
+}
 
-    // Tool diameter effect (larger tools generally need more power)
-    predictedPower += (toolDiameter / 10.0) * 0.22;
+const RegressionPredictor& AIInterface::getRegressionPredictor() const {
+    return *regressionPredictor;
+}
 
-    // Spindle speed effect (higher speeds may require more power)
-    predictedPower += (spindleSpeed / 10000.0) * 0.55;
+std::uint64_t AIInterface::getModelVersion() {
+    std::uint64_t version = 0xcbf29ce484222325ULL;
+    auto combine = [&version](const void* data, std::size_t size) {
+        version = (version ^ ModelContainer::checksum(data, size)) * 0x100000001b3ULL;
+        version ^= version >> 32;
+    };
 
-    // Feed rate effect
-    predictedPower += (feedRate / 1000.0) * 0.33;
+    const unsigned char flags[2] = {static_cast<unsigned char>(aiEnabled), static_cast<unsigned char>(useOpenAI)};
+    combine(flags, sizeof(flags));
+    RegressionCoefficients coefficients = regressionPredictor->getCoefficients();
+    combine(&coefficients, sizeof(coefficients));
+    const std::vector<RegressionTerm>& terms = regressionPredictor->getTerms();
+    if (!terms.empty()) {
+        combine(&regressionPredictor->getNormalization(), sizeof(RegressionNormalization));
+        combine(terms.data(), terms.size() * sizeof(RegressionTerm));
+    }
+    std::vector<ModelSectionData> sections;
+    treePredictor->getSections(sections);
+    for (const ModelSectionData& section : sections) {
+        combine(section.data, static_cast<std::size_t>(section.size));
+    }
+    std::uint64_t measurements = knnPredictor->getChecksum();
+    combine(&measurements, sizeof(measurements));
+    return version;
+}
 
-    // Depth of cut effect
-    predictedPower += depthOfCut * 0.44;
+void AIInterface::updateDefaultChain() {
+    // Remote first when requested; it declines batches until an API key is set.
+    // Measured neighbours come before the models, but only for cuts close to a
+    // measurement; the tree backend is skipped until a model is loaded.
+    if (useOpenAI) {
+        registry.setDefaultChain({"remote", "knn", "tree", "regression", "heuristic"});
+    } else {
+        registry.setDefaultChain({"knn", "tree", "regression", "heuristic"});
+    }
+}
 
-    // Operation type effect
-    if (operationType.find("Milling") != std::string::npos) predictedPower += 0.55;
-    else if (operationType.find("Drilling") != std::string::npos) predictedPower -= 0.15;
+bool AIInterface::loadModel(const std::string& path) {
+    bool loaded = false;
+
+    if (ModelContainer::isContainerFile(path)) {
+        auto container = std::make_shared<ModelContainer>();
+        if (container->open(path)) {
+            // Validate the regression part before anything is replaced, so a failed load keeps
+            // the current model as a whole
+            std::size_t size = 0;
+            const void* coefficients = container->getSection(ModelSectionType::RegressionCoefficients, 0, size);
+            bool hasCoefficients = coefficients != nullptr && size == sizeof(RegressionCoefficients);
+            const RegressionNormalization* normalization = nullptr;
+            std::vector<RegressionTerm> polynomialTerms;
+            bool regressionValid = true;
+            if (hasCoefficients) {
+                const void* normalizationData =
+                    container->getSection(ModelSectionType::RegressionNormalization, 0, size);
+                if (normalizationData != nullptr && size == sizeof(RegressionNormalization)) {
+                    normalization = static_cast<const RegressionNormalization*>(normalizationData);
+                    const void* terms = container->getSection(ModelSectionType::RegressionTerms, 0, size);
+                    const RegressionTerm* first = static_cast<const RegressionTerm*>(terms);
+                    polynomialTerms.assign(first, first + size / sizeof(RegressionTerm));
+                    regressionValid = RegressionPredictor::validateTerms(*normalization, polynomialTerms);
+                }
+            }
+            bool hasTrees = container->getSection(ModelSectionType::TreeInfo, 0, size) != nullptr;
+
+            // attachContainer validates all tree data and changes nothing on failure, so it is
+            // the last step that can fail; the regression part is installed only after it
+            if (regressionValid && (hasCoefficients || hasTrees) &&
+                (!hasTrees || treePredictor->attachContainer(container))) {
+                if (hasCoefficients) {
+                    regressionPredictor->setCoefficients(*static_cast<const RegressionCoefficients*>(coefficients));
+                    if (normalization != nullptr) {
+                        regressionPredictor->setTerms(*normalization, polynomialTerms);
+                    }
+                }
+                loaded = true;
+            }
+        }
+    } else {
+        loaded = treePredictor->loadFromDump(path);
+    }
 
-    std::cout << "OpenAI predicted cutting power: " << predictedPower << " kW" << std::endl;
-    return predictedPower;
+    if (loaded) {
+        modelPath = path;
+        std::cout << "ML model loaded from: " << path << std::endl;
+    } else {
+        std::cout << "Warning: ML model could not be loaded from: " << path << std::endl;
+    }
+    return loaded;
 }
 
-void AIInterface::loadModel(const std::string& path) {
-    modelPath = path;
-    std::cout << "ML model loaded from: " << path << std::endl;
+bool AIInterface::saveModel(const std::string& path) {
+    std::vector<ModelSectionData> sections;
+    RegressionCoefficients coefficients = regressionPredictor->getCoefficients();
+    sections.push_back({ModelSectionType::RegressionCoefficients, 0, &coefficients, sizeof(coefficients)});
+    const std::vector<RegressionTerm>& terms = regressionPredictor->getTerms();
+    if (!terms.empty()) {
+        sections.push_back({ModelSectionType::RegressionNormalization, 0, &regressionPredictor->getNormalization(),
+                            sizeof(RegressionNormalization)});
+        sections.push_back({ModelSectionType::RegressionTerms, 0, terms.data(), terms.size() * sizeof(RegressionTerm)});
+    }
+    treePredictor->getSections(sections);
+
+    if (!ModelContainer::write(path, sections)) {
+        return false;
+    }
+    std::cout << "ML model saved to: " << path << std::endl;
+    return true;
 }
 
-void AIInterface::trainModel(const std::string& dataPath) {
+bool AIInterface::trainModel(const std::string& dataPath) {
     std::cout << "Training ML model with data from: " << dataPath << std::endl;
-    // In a real implementation, this would train the model with the provided data
+    TrainingSet data;
+    if (data.loadCsv(dataPath) < 0) {
+        return false;
+    }
+
+    // Retraining replaces the measurements; appending would count every point again
+    knnPredictor->clearMeasurements();
+    knnPredictor->loadMeasurementsCsv(dataPath);
+    ModelTrainer trainer(trainerOptions);
+    TrainingReport report;
+    if (!trainer.train(data, report)) {
+        std::cout << "Warning: regression model not retrained" << std::endl;
+        return false;
+    }
+    report.print();
+    regressionPredictor->setCoefficients(report.coefficients);
+    regressionPredictor->setTerms(report.normalization, report.terms);
+    trainingReport = report;
+    return true;
+}
+
+void AIInterface::setTrainerOptions(const TrainerOptions& options) {
+    trainerOptions = options;
+}
+
+const TrainingReport& AIInterface::getTrainingReport() const {
+    return trainingReport;
+}
+
+void AIInterface::recordMeasuredCut(const std::string& material,
+                                    double toolDiameter,
+                                    double spindleSpeed,
+                                    double feedRate,
+                                    double depthOfCut,
+                                    const std::string& machineType,
+                                    double actualPower) {
+    knnPredictor->addMeasurement(material, machineType, toolDiameter, spindleSpeed,
+                                 feedRate, depthOfCut, actualPower);
 }
 
 void AIInterface::calibrateModel(double actualPower, double predictedPower) {
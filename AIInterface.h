@@ -1,14 +1,25 @@
 #ifndef AI_INTERFACE_H
 #define AI_INTERFACE_H
 
+#include "PowerPredictor.h"
+#include "PredictorRegistry.h"
+#include "ModelTrainer.h"
+#include <cstdint>
 #include <string>
 
+class RemotePredictor;
+class TreeEnsemblePredictor;
+class KnnPredictor;
+class RegressionPredictor;
+
 /**
  * @brief Class to interface with AI/ML models for predicting cutting power
  *
  * This class provides an interface to AI models that can predict cutting power
  * based on machining parameters, potentially improving prediction accuracy.
  * Supports both local ML models and cloud-based models like OpenAI.
+ * Predictions are served by the backends of a PredictorRegistry; the flags below
+ * select the default fallback chain.
  */
 class AIInterface {
 private:
@@ -18,6 +29,15 @@ private:
     std::string openAIApiKey;    // OpenAI API key
     std::string openAIOrganization; // OpenAI organization ID (optional)
     std::string openAIModel;     // OpenAI model to use (e.g., "gpt-3.5-turbo", "gpt-4")
+    PredictorRegistry registry;  // Named prediction backends and fallback chains
+    RemotePredictor* remotePredictor; // Owned by the registry
+    TreeEnsemblePredictor* treePredictor; // Owned by the registry
+    KnnPredictor* knnPredictor;  // Owned by the registry
+    RegressionPredictor* regressionPredictor; // Owned by the registry
+    TrainerOptions trainerOptions; // Cross-validation settings used by trainModel
+    TrainingReport trainingReport; // Result of the last successful trainModel
+
+    void updateDefaultChain();
 
 public:
     AIInterface();
@@ -103,17 +123,102 @@ public:
                                         const std::string& operationType,
                                         const std::string& machineType);
 
+    /**
+     * @brief Predict cutting power for a batch of cuts
+     *
+     * Uses the heuristic backend when AI is disabled, otherwise the registry's fallback chains.
+     * Build the features with getPredictorRegistry().makeFeatures().
+     *
+     * @param features Input cuts
+     * @param out Predicted cutting power in kW, same size as features
+     */
+    void predictCuttingPowerBatch(Span<const CutFeatures> features, Span<double> out);
+
+    /**
+     * @brief Get the registry of prediction backends
+     * @return Registry used for all predictions
+     */
+    PredictorRegistry& getPredictorRegistry();
+
+    /**
+     * @brief Get the built-in regression backend, e.g. for sensitivity analysis
+     * @return Regression predictor owned by the registry
+     */
+    const RegressionPredictor& getRegressionPredictor() const;
+
+    /**
+     * @brief Get a digest of everything that determines the predictions
+     *
+     * Covers the enabled backends, the regression model, the tree ensemble and the
+     * measured cuts, so results cached under one version stay valid until it changes.
+     * Custom registry chains are not covered.
+     *
+     * @return 64-bit model version
+     */
+    std::uint64_t getModelVersion();
+
     /**
      * @brief Load an ML model from file
+     *
+     * Binary model containers are memory-mapped and used in place; tree-ensemble text
+     * dumps are parsed and compiled (docs/MODEL_FORMATS.md). A loaded tree ensemble takes
+     * precedence over the built-in regression model.
+     *
      * @param path Path to the model file
+     * @return False if the file could not be loaded (the current model is kept)
+     */
+    bool loadModel(const std::string& path);
+
+    /**
+     * @brief Save the current models as a binary model container for fast loading
+     * @param path Output path
+     * @return True on success
      */
-    void loadModel(const std::string& path);
+    bool saveModel(const std::string& path);
 
     /**
      * @brief Train the AI model with new data
+     *
+     * Measured cuts in the datasets/machining_power.csv layout replace the measurements
+     * of the "knn" backend (including cuts recorded since the last training), so training
+     * again on the same file gives the same model. The "regression" backend is
+     * refitted by a cross-validated search over polynomial degree and regularization
+     * (see ModelTrainer). Per-fold errors and timing are printed.
+     *
      * @param dataPath Path to training data file
+     * @return False if the regression model was not retrained
+     */
+    bool trainModel(const std::string& dataPath);
+
+    /**
+     * @brief Set the cross-validation and hyperparameter grid used by trainModel
+     * @param options Folds, degrees, regularization strengths, seed and thread count
+     */
+    void setTrainerOptions(const TrainerOptions& options);
+
+    /**
+     * @brief Get the report of the last successful training run
+     * @return Per-fold errors, timing and the fitted model
+     */
+    const TrainingReport& getTrainingReport() const;
+
+    /**
+     * @brief Add a single measured cut to the nearest-neighbour index
+     * @param material Type of material being machined
+     * @param toolDiameter Tool diameter in mm
+     * @param spindleSpeed Spindle speed in RPM
+     * @param feedRate Feed rate in mm/min
+     * @param depthOfCut Depth of cut in mm
+     * @param machineType Type of machine
+     * @param actualPower Measured cutting power in kW
      */
-    void trainModel(const std::string& dataPath);
+    void recordMeasuredCut(const std::string& material,
+                           double toolDiameter,
+                           double spindleSpeed,
+                           double feedRate,
+                           double depthOfCut,
+                           const std::string& machineType,
+                           double actualPower);
 
     /**
      * @brief Calibrate the model with actual measured data
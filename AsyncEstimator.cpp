@@ -0,0 +1,192 @@
+#include "AsyncEstimator.h"
+#include "AIInterface.h"
+#include "TimeModel.h"
+#include "EnergyModel.h"
+#include "CarbonModel.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include <utility>
+
+EstimationJob::EstimationJob(PartProgram program)
+    : part(std::move(program)),
+      cancelRequested(false),
+      state(static_cast<int>(EstimationState::Queued)),
+      completed(0),
+      result(promise.get_future().share()) {
+}
+
+void EstimationJob::cancel() {
+    cancelRequested = true;
+}
+
+std::size_t EstimationJob::poll(std::vector<OperationEstimate>& estimates) {
+    std::vector<OperationEstimate> ready;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ready.swap(published);
+    }
+    estimates.insert(estimates.end(), ready.begin(), ready.end());
+    return ready.size();
+}
+
+EstimationState EstimationJob::getState() const {
+    return static_cast<EstimationState>(state.load());
+}
+
+std::size_t EstimationJob::getCompleted() const {
+    return completed;
+}
+
+std::size_t EstimationJob::getTotal() const {
+    return part.operations.size();
+}
+
+bool EstimationJob::isDone() const {
+    return result.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+std::shared_future<PartEstimate> EstimationJob::getResult() const {
+    return result;
+}
+
+AsyncEstimator::AsyncEstimator(AIInterface& aiInterface, const TimeModel& timeModel, const EnergyModel& energyModel,
+                               double factor)
+    : ai(aiInterface),
+      parameters(timeModel, energyModel, factor),
+      setupTime(timeModel.getSetupTime()),
+      depthOfCut(2.0),
+      sliceSize(64),
+      executor(1) {
+}
+
+AsyncEstimator::~AsyncEstimator() {
+    cancelAll();
+}
+
+void AsyncEstimator::setDepthOfCut(double depth) {
+    depthOfCut = depth;
+}
+
+void AsyncEstimator::setSliceSize(std::size_t operations) {
+    sliceSize = std::max<std::size_t>(operations, 1);
+}
+
+std::shared_ptr<EstimationJob> AsyncEstimator::start(const PartProgram& part) {
+    return start(PartProgram(part));
+}
+
+std::shared_ptr<EstimationJob> AsyncEstimator::start(PartProgram&& part) {
+    std::shared_ptr<EstimationJob> job = std::make_shared<EstimationJob>(std::move(part));
+    {
+        std::lock_guard<std::mutex> lock(jobsMutex);
+        jobs.erase(std::remove_if(jobs.begin(), jobs.end(),
+                                  [](const std::weak_ptr<EstimationJob>& entry) {
+                                      std::shared_ptr<EstimationJob> live = entry.lock();
+                                      return !live || live->isDone();
+                                  }),
+                   jobs.end());
+        jobs.push_back(job);
+    }
+    double depth = depthOfCut;
+    std::size_t slice = sliceSize;
+    executor.submit([this, job, depth, slice]() {
+        try {
+            run(*job, depth, slice);
+        } catch (...) {
+            // Never leave a waiting UI hanging on the result
+            job->state = static_cast<int>(EstimationState::Cancelled);
+            job->promise.set_exception(std::current_exception());
+        }
+    });
+    return job;
+}
+
+void AsyncEstimator::cancelAll() {
+    std::lock_guard<std::mutex> lock(jobsMutex);
+    for (const std::weak_ptr<EstimationJob>& entry : jobs) {
+        if (std::shared_ptr<EstimationJob> job = entry.lock()) {
+            job->cancel();
+        }
+    }
+}
+
+void AsyncEstimator::run(EstimationJob& job, double depth, std::size_t slice) {
+    std::vector<OperationEstimate> estimates;
+    if (job.cancelRequested) {
+        finish(job, EstimationState::Cancelled, estimates);
+        return;
+    }
+    job.state = static_cast<int>(EstimationState::Running);
+
+    // Keyed like BatchEstimator; the version drops cached estimates when the models change
+    cache.setVersion(makeEstimateVersion(ai.getModelVersion(), parameters, false));
+
+    const PartProgram& part = job.part;
+    const std::vector<NXOperation>& operations = part.operations;
+    estimates.reserve(operations.size());
+    std::vector<OperationKey> keys;
+    std::vector<std::size_t> misses;
+    std::vector<CutFeatures> features;
+    std::vector<double> power;
+    for (std::size_t begin = 0; begin < operations.size(); begin += slice) {
+        if (job.cancelRequested) {
+            finish(job, EstimationState::Cancelled, estimates);
+            return;
+        }
+        std::size_t end = std::min(operations.size(), begin + slice);
+
+        keys.clear();
+        misses.clear();
+        features.clear();
+        for (std::size_t i = begin; i < end; ++i) {
+            const NXOperation& operation = operations[i];
+            keys.push_back(makeOperationKey(part.material, part.machineType, operation, depth));
+            const OperationEstimate* cached = cache.find(keys.back());
+            estimates.push_back(cached != nullptr ? *cached : OperationEstimate());
+            if (cached == nullptr) {
+                misses.push_back(i);
+                features.push_back(ai.getPredictorRegistry().makeFeatures(
+                    part.material, operation.getToolDiameter(), operation.getSpindleSpeed(), operation.getFeedRate(),
+                    depth, operation.getOperationType(), part.machineType));
+            }
+        }
+
+        power.resize(features.size());
+        if (!features.empty()) {
+            ai.predictCuttingPowerBatch(features, power);
+        }
+        for (std::size_t m = 0; m < misses.size(); ++m) {
+            std::size_t i = misses[m];
+            OperationEstimate& e = estimates[i];
+            e = evaluateOperation(operations[i].getCuttingTime(), power[m], parameters);
+            if (std::isfinite(e.cuttingPower)) {
+                cache.insert(keys[i - begin], e);
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(job.mutex);
+            job.published.insert(job.published.end(), estimates.begin() + begin, estimates.end());
+        }
+        job.completed = end;
+    }
+    finish(job, EstimationState::Completed, estimates);
+}
+
+void AsyncEstimator::finish(EstimationJob& job, EstimationState state, std::vector<OperationEstimate>& estimates) {
+    PartEstimate result;
+    result.name = job.part.name;
+    result.totalTime = setupTime;
+    result.energy = EnergyModel::computeEnergy(setupTime, parameters.idlePower);
+    result.carbon = CarbonModel::computeEmission(result.energy, parameters.emissionFactor);
+    for (const OperationEstimate& e : estimates) {
+        result.totalTime += e.totalTime;
+        result.energy += e.energy;
+        result.carbon += e.carbon;
+    }
+    result.operations.swap(estimates);
+    job.state = static_cast<int>(state);
+    job.promise.set_value(result);
+}
\ No newline at end of file
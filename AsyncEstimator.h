@@ -0,0 +1,191 @@
+#ifndef ASYNC_ESTIMATOR_H
+#define ASYNC_ESTIMATOR_H
+
+#include "BatchEstimator.h"
+#include "OperationCache.h"
+#include "ThreadPool.h"
+#include <atomic>
+#include <cstddef>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class AIInterface;
+class TimeModel;
+class EnergyModel;
+
+/**
+ * @brief State of an asynchronous estimation
+ */
+enum class EstimationState {
+    Queued,         // waiting for the background executor
+    Running,
+    Completed,
+    Cancelled       // stopped early; the result holds the operations finished until then
+};
+
+/**
+ * @brief One part being estimated in the background
+ *
+ * Shared between the thread that started it (typically the UI thread) and the executor.
+ * poll() and the state getters never wait for the computation: the worker only holds the
+ * job's lock to hand over a finished slice of operations, so a UI can drain new results
+ * once per frame.
+ */
+class EstimationJob {
+private:
+    friend class AsyncEstimator;
+
+    PartProgram part;
+    std::atomic<bool> cancelRequested;
+    std::atomic<int> state;
+    std::atomic<std::size_t> completed;
+    std::mutex mutex;
+    std::vector<OperationEstimate> published;   // finished but not yet polled, guarded by mutex
+    std::promise<PartEstimate> promise;
+    std::shared_future<PartEstimate> result;
+
+public:
+    explicit EstimationJob(PartProgram program);
+
+    EstimationJob(const EstimationJob&) = delete;
+    EstimationJob& operator=(const EstimationJob&) = delete;
+
+    /**
+     * @brief Ask the job to stop; it does so at the next slice boundary
+     */
+    void cancel();
+
+    /**
+     * @brief Move the operation estimates finished since the last call to the end of a vector
+     *
+     * Results arrive in program order, so after all calls `estimates[i]` belongs to
+     * operation i of the part. Reserve getTotal() entries up front so appending never
+     * reallocates on the polling thread.
+     *
+     * @param estimates Vector to append to
+     * @return Number of estimates appended
+     */
+    std::size_t poll(std::vector<OperationEstimate>& estimates);
+
+    /**
+     * @brief Get the state
+     * @return State
+     */
+    EstimationState getState() const;
+
+    /**
+     * @brief Get the number of operations estimated so far
+     * @return Completed operations
+     */
+    std::size_t getCompleted() const;
+
+    /**
+     * @brief Get the number of operations of the part
+     * @return Operation count
+     */
+    std::size_t getTotal() const;
+
+    /**
+     * @brief Check whether the job has finished (completed or cancelled)
+     * @return True once the result is available
+     */
+    bool isDone() const;
+
+    /**
+     * @brief Get the part estimate, ready when the job is done
+     *
+     * Totals include the setup. A cancelled job's estimate covers only the operations
+     * finished before it stopped.
+     *
+     * @return Future of the part estimate
+     */
+    std::shared_future<PartEstimate> getResult() const;
+};
+
+/**
+ * @brief Estimates parts on a background executor with progressive results and cancellation
+ *
+ * start() takes the program and returns at once; the operations are predicted and
+ * evaluated in slices on the executor, and each finished slice becomes visible through
+ * EstimationJob::poll(). Cancelling a job (e.g. because the user edited the program) stops
+ * it after the current slice. Operation estimates are cached by content, so restarting
+ * after an edit only computes the operations that changed.
+ *
+ * The executor has one thread, so jobs run in start order and the predictors, which are
+ * not thread-safe, are only used from that thread. Do not use the same AIInterface from
+ * other threads while jobs are queued or running.
+ */
+class AsyncEstimator {
+private:
+    AIInterface& ai;
+    OperationParameters parameters;
+    double setupTime;
+    double depthOfCut;
+    std::size_t sliceSize;
+    OperationCache cache;       // used on the executor thread only
+    std::mutex jobsMutex;
+    std::vector<std::weak_ptr<EstimationJob>> jobs;
+    ThreadPool executor;        // last member: joined before the others are destroyed
+
+    void run(EstimationJob& job, double depth, std::size_t slice);
+    void finish(EstimationJob& job, EstimationState state, std::vector<OperationEstimate>& estimates);
+
+public:
+    /**
+     * @brief Constructor
+     * @param aiInterface Prediction backends, used from the executor thread
+     * @param timeModel Time parameters (rapid factor, idle time per operation, setup time)
+     * @param energyModel Power levels (rapid and idle power)
+     * @param factor Emission factor in kg CO2/kWh
+     */
+    AsyncEstimator(AIInterface& aiInterface, const TimeModel& timeModel, const EnergyModel& energyModel,
+                   double factor);
+
+    /**
+     * @brief Cancel all jobs and wait for the executor to stop
+     */
+    ~AsyncEstimator();
+
+    AsyncEstimator(const AsyncEstimator&) = delete;
+    AsyncEstimator& operator=(const AsyncEstimator&) = delete;
+
+    /**
+     * @brief Set the depth of cut used for all operations of later jobs
+     * @param depth Depth of cut in mm
+     */
+    void setDepthOfCut(double depth);
+
+    /**
+     * @brief Set how many operations are estimated between publishing results and checking
+     *        for cancellation (smaller reacts faster, larger predicts in bigger batches)
+     * @param operations Operations per slice
+     */
+    void setSliceSize(std::size_t operations);
+
+    /**
+     * @brief Start estimating a part in the background
+     * @param part Part program (copied on the calling thread)
+     * @return Job handle
+     */
+    std::shared_ptr<EstimationJob> start(const PartProgram& part);
+
+    /**
+     * @brief Start estimating a part in the background, taking over the program
+     *
+     * Moving avoids copying the operations on the calling thread, which matters for
+     * programs with many thousands of operations.
+     *
+     * @param part Part program (moved)
+     * @return Job handle
+     */
+    std::shared_ptr<EstimationJob> start(PartProgram&& part);
+
+    /**
+     * @brief Cancel all queued and running jobs
+     */
+    void cancelAll();
+};
+
+#endif // ASYNC_ESTIMATOR_H
\ No newline at end of file
@@ -0,0 +1,294 @@
+#include "BatchEstimator.h"
+#include "AIInterface.h"
+#include "TimeModel.h"
+#include "EnergyModel.h"
+#include "CarbonModel.h"
+#include "ToolWearModel.h"
+#include "MachineClasses.h"
+#include "ReportWriter.h"
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <unordered_map>
+
+BatchEstimator::BatchEstimator(AIInterface& aiInterface, const TimeModel& timeModel, const EnergyModel& energyModel,
+                               double factor)
+    : ai(aiInterface),
+      parameters(timeModel, energyModel, factor),
+      setupTime(timeModel.getSetupTime()),
+      depthOfCut(2.0),
+      cache(memory.getResource(MemorySubsystem::PredictionCache)),
+      resultsCharged(0),
+      toolWear(nullptr),
+      machineClasses(false) {
+}
+
+void BatchEstimator::setDepthOfCut(double depth) {
+    depthOfCut = depth;
+}
+
+void BatchEstimator::setToolWearModel(const ToolWearModel* model) {
+    toolWear = model;
+}
+
+void BatchEstimator::setMachineClasses(bool enabled) {
+    machineClasses = enabled;
+}
+
+void BatchEstimator::setMemoryBudget(std::uint64_t bytes) {
+    memory.setBudget(bytes);
+}
+
+void BatchEstimator::setSpillPath(const std::string& path) {
+    spillPath = path;
+}
+
+MemoryAccount& BatchEstimator::getMemoryAccount() {
+    return memory;
+}
+
+void BatchEstimator::shedCache() {
+    // Keep what was computed in the cache file before dropping it from memory
+    if (!saveCache()) {
+        std::cout << "Warning: operation cache could not be saved before dropping it" << std::endl;
+    }
+    std::size_t dropped = cache.shed();
+    statistics.shedEntries += dropped;
+    std::cout << "Warning: memory budget exceeded, dropped " << dropped << " cached operation estimates"
+              << std::endl;
+}
+
+std::uint64_t BatchEstimator::computeConfigVersion() {
+    return makeEstimateVersion(ai.getModelVersion(), parameters, machineClasses);
+}
+
+bool BatchEstimator::openCache(const std::string& path) {
+    cachePath = path;
+    cache.setVersion(computeConfigVersion());
+    return cache.load(path);
+}
+
+bool BatchEstimator::saveCache() {
+    if (cachePath.empty() || !cache.isModified()) {
+        return true;
+    }
+    if (!cache.save(cachePath)) {
+        return false;
+    }
+    std::cout << "Operation cache saved to " << cachePath << " (" << cache.size() << " entries)" << std::endl;
+    return true;
+}
+
+OperationKey BatchEstimator::makeKey(const std::string& material, const std::string& machineType,
+                                     const NXOperation& operation) const {
+    return makeOperationKey(material, machineType, operation, depthOfCut);
+}
+
+void BatchEstimator::estimate(const std::vector<PartProgram>& parts, std::vector<PartEstimate>& results) {
+    auto start = std::chrono::steady_clock::now();
+    statistics = BatchStatistics();
+    statistics.parts = parts.size();
+    cache.setVersion(computeConfigVersion());
+    memory.release(MemorySubsystem::Results, resultsCharged);
+    resultsCharged = 0;
+    memory.resetPeaks();
+    std::pmr::memory_resource* operationMemory = memory.getResource(MemorySubsystem::Operations);
+    std::pmr::memory_resource* resultMemory = memory.getResource(MemorySubsystem::Results);
+
+    // Dispatch table of the job: the kernel of each part's machine class, resolved once per machine type
+    std::pmr::vector<const MachineKernel*> partKernels(parts.size(), nullptr, operationMemory);
+    if (machineClasses) {
+        std::unordered_map<std::string, const MachineKernel*> kernelsByType;
+        for (std::size_t p = 0; p < parts.size(); ++p) {
+            auto found = kernelsByType.find(parts[p].machineType);
+            if (found == kernelsByType.end()) {
+                found = kernelsByType.emplace(parts[p].machineType, findMachineKernel(parts[p].machineType)).first;
+            }
+            partKernels[p] = found->second;
+        }
+    }
+
+    // Reduce every occurrence to the index of its distinct operation
+    std::pmr::unordered_map<OperationKey, std::size_t, OperationKeyHash> uniqueIndex(operationMemory);
+    std::pmr::vector<std::size_t> occurrences(operationMemory);
+    std::pmr::vector<OperationKey> uniqueKeys(operationMemory);
+    std::pmr::vector<std::pair<const PartProgram*, const NXOperation*>> representatives(operationMemory);
+    std::pmr::vector<const MachineKernel*> uniqueKernels(operationMemory);
+    for (std::size_t p = 0; p < parts.size(); ++p) {
+        const PartProgram& part = parts[p];
+        for (const NXOperation& operation : part.operations) {
+            OperationKey key = makeKey(part.material, part.machineType, operation);
+            auto inserted = uniqueIndex.try_emplace(key, uniqueKeys.size());
+            if (inserted.second) {
+                uniqueKeys.push_back(key);
+                representatives.emplace_back(&part, &operation);
+                uniqueKernels.push_back(partKernels[p]);
+            }
+            occurrences.push_back(inserted.first->second);
+        }
+    }
+    statistics.operations = occurrences.size();
+    statistics.uniqueOperations = uniqueKeys.size();
+
+    // Cache lookups; the misses are predicted together
+    std::pmr::vector<OperationEstimate> uniqueEstimates(uniqueKeys.size(), resultMemory);
+    std::pmr::vector<std::size_t> misses(resultMemory);
+    std::pmr::vector<CutFeatures> features(resultMemory);
+    for (std::size_t u = 0; u < uniqueKeys.size(); ++u) {
+        const OperationEstimate* cached = cache.find(uniqueKeys[u]);
+        if (cached != nullptr) {
+            uniqueEstimates[u] = *cached;
+            continue;
+        }
+        const PartProgram& part = *representatives[u].first;
+        const NXOperation& operation = *representatives[u].second;
+        misses.push_back(u);
+        features.push_back(ai.getPredictorRegistry().makeFeatures(
+            part.material, operation.getToolDiameter(), operation.getSpindleSpeed(), operation.getFeedRate(),
+            depthOfCut, operation.getOperationType(), part.machineType));
+    }
+    statistics.cacheHits = uniqueKeys.size() - misses.size();
+    statistics.computed = misses.size();
+
+    std::pmr::vector<double> power(features.size(), resultMemory);
+    if (!features.empty()) {
+        ai.predictCuttingPowerBatch(features, power);
+    }
+
+    // Misses on a machine class are evaluated by its kernel in one call per class; the
+    // others with the generic time and energy parameters
+    std::pmr::vector<std::pmr::vector<std::size_t>> classMisses(static_cast<std::size_t>(MachineClass::Count),
+                                                               resultMemory);
+    for (std::size_t m = 0; m < misses.size(); ++m) {
+        std::size_t u = misses[m];
+        if (uniqueKernels[u] != nullptr) {
+            classMisses[static_cast<std::size_t>(uniqueKernels[u]->machineClass)].push_back(m);
+            continue;
+        }
+        uniqueEstimates[u] = evaluateOperation(representatives[u].second->getCuttingTime(), power[m], parameters);
+    }
+    std::pmr::vector<double> classTime(resultMemory);
+    std::pmr::vector<double> classPower(resultMemory);
+    std::pmr::vector<OperationEstimate> classEstimates(resultMemory);
+    for (std::size_t c = 0; c < classMisses.size(); ++c) {
+        const std::pmr::vector<std::size_t>& classMissIndices = classMisses[c];
+        if (classMissIndices.empty()) {
+            continue;
+        }
+        classTime.resize(classMissIndices.size());
+        classPower.resize(classMissIndices.size());
+        classEstimates.resize(classMissIndices.size());
+        for (std::size_t i = 0; i < classMissIndices.size(); ++i) {
+            std::size_t m = classMissIndices[i];
+            classTime[i] = representatives[misses[m]].second->getCuttingTime();
+            classPower[i] = power[m];
+        }
+        getMachineKernel(static_cast<MachineClass>(c))
+            .evaluate(classTime.data(), classPower.data(), classMissIndices.size(), parameters.emissionFactor,
+                      classEstimates.data());
+        for (std::size_t i = 0; i < classMissIndices.size(); ++i) {
+            uniqueEstimates[misses[classMissIndices[i]]] = classEstimates[i];
+        }
+    }
+    // Over budget the cache stops growing and gives its memory back
+    for (std::size_t u : misses) {
+        if (memory.isOverBudget()) {
+            break;
+        }
+        if (std::isfinite(uniqueEstimates[u].cuttingPower)) {
+            cache.insert(uniqueKeys[u], uniqueEstimates[u]);
+        }
+    }
+    if (memory.isOverBudget() && cache.size() > 0) {
+        shedCache();
+    }
+
+    // Wear factors of all occurrences in one scan; tools restart at every part
+    std::vector<double> wearFactors;
+    if (toolWear != nullptr) {
+        std::vector<double> cuttingTime;
+        std::vector<char> newTool;
+        cuttingTime.reserve(occurrences.size());
+        newTool.reserve(occurrences.size());
+        for (const PartProgram& part : parts) {
+            for (std::size_t i = 0; i < part.operations.size(); ++i) {
+                cuttingTime.push_back(part.operations[i].getCuttingTime());
+                newTool.push_back(i == 0 || ToolWearModel::isToolChange(part.operations[i - 1], part.operations[i]));
+            }
+        }
+        toolWear->computePowerFactors(cuttingTime, newTool, wearFactors);
+    }
+    std::uint64_t wearBytes = wearFactors.capacity() * sizeof(double);
+    memory.charge(MemorySubsystem::Results, wearBytes);
+
+    // Fan the distinct results back out; setup idle time belongs to the part. Over budget,
+    // the operations of each finished part go to the spill file and only its totals stay.
+    results.assign(parts.size(), PartEstimate());
+    std::unique_ptr<ReportWriter> spill;
+    bool spillFailed = false;
+    std::size_t next = 0;
+    for (std::size_t p = 0; p < parts.size(); ++p) {
+        PartEstimate& part = results[p];
+        const MachineKernel* kernel = partKernels[p];
+        part.name = parts[p].name;
+        part.totalTime = kernel != nullptr ? kernel->setupTime : setupTime;
+        part.energy = EnergyModel::computeEnergy(part.totalTime,
+                                                 kernel != nullptr ? kernel->idlePower : parameters.idlePower);
+        part.carbon = CarbonModel::computeEmission(part.energy, parameters.emissionFactor);
+        part.operations.reserve(parts[p].operations.size());
+        for (std::size_t i = 0; i < parts[p].operations.size(); ++i) {
+            part.operations.push_back(uniqueEstimates[occurrences[next]]);
+            OperationEstimate& e = part.operations.back();
+            if (!wearFactors.empty()) {
+                ToolWearModel::applyPowerFactor(e, wearFactors[next]);
+            }
+            ++next;
+            part.totalTime += e.totalTime;
+            part.energy += e.energy;
+            part.carbon += e.carbon;
+        }
+        std::uint64_t partBytes = part.operations.capacity() * sizeof(OperationEstimate);
+        memory.charge(MemorySubsystem::Results, partBytes);
+        resultsCharged += partBytes;
+        if (!memory.isOverBudget() || spillFailed) {
+            continue;
+        }
+        if (!spill) {
+            spill.reset(new ReportWriter(1 << 16));
+            if (spillPath.empty() || !spill->open(spillPath, ReportFormat::Csv)) {
+                std::cout << "Warning: memory budget exceeded and no spill file "
+                          << (spillPath.empty() ? "is set" : "could be created") << ", keeping results in memory"
+                          << std::endl;
+                spillFailed = true;
+                continue;
+            }
+        }
+        for (std::size_t i = 0; i < part.operations.size(); ++i) {
+            spill->writeOperation(part.name, i, parts[p].operations[i], part.operations[i]);
+        }
+        std::vector<OperationEstimate>().swap(part.operations);
+        part.operationsSpilled = true;
+        memory.release(MemorySubsystem::Results, partBytes);
+        resultsCharged -= partBytes;
+        ++statistics.spilledParts;
+    }
+    if (spill && !spillFailed) {
+        if (!spill->close()) {
+            std::cout << "Error: failed to write spill file " << spillPath << std::endl;
+        }
+        std::cout << "Memory budget exceeded, operations of " << statistics.spilledParts << " parts spilled to "
+                  << spillPath << std::endl;
+    }
+    memory.release(MemorySubsystem::Results, wearBytes);
+    statistics.memory = memory.getStatistics();
+    statistics.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+const BatchStatistics& BatchEstimator::getStatistics() const {
+    return statistics;
+}
+
+const OperationCache& BatchEstimator::getCache() const {
+    return cache;
+}
\ No newline at end of file
@@ -0,0 +1,202 @@
+#ifndef BATCH_ESTIMATOR_H
+#define BATCH_ESTIMATOR_H
+
+#include "NXCamDataExtractor.h"
+#include "OperationCache.h"
+#include "MemoryAccount.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class AIInterface;
+class TimeModel;
+class EnergyModel;
+class ToolWearModel;
+
+/**
+ * @brief One part (or program variant) to estimate
+ */
+struct PartProgram {
+    std::string name;
+    std::string material;
+    std::string machineType;
+    std::vector<NXOperation> operations;
+
+    PartProgram() {}
+    PartProgram(const std::string& partName, const std::string& partMaterial, const std::string& partMachineType,
+                const std::vector<NXOperation>& partOperations)
+        : name(partName), material(partMaterial), machineType(partMachineType), operations(partOperations) {}
+};
+
+/**
+ * @brief Estimate of one part: its operations plus the setup
+ */
+struct PartEstimate {
+    std::string name;
+    std::vector<OperationEstimate> operations;  // in program order
+    double totalTime;   // minutes, including setup
+    double energy;      // kWh, including setup idle energy
+    double carbon;      // kg CO2
+    bool operationsSpilled; // operations were written to the spill file instead of kept in memory
+
+    PartEstimate() : totalTime(0.0), energy(0.0), carbon(0.0), operationsSpilled(false) {}
+};
+
+/**
+ * @brief Work done by the last BatchEstimator::estimate call
+ */
+struct BatchStatistics {
+    std::size_t parts;
+    std::size_t operations;         // all occurrences
+    std::size_t uniqueOperations;   // distinct operation keys
+    std::size_t cacheHits;          // unique operations answered from the cache
+    std::size_t computed;           // unique operations predicted and evaluated
+    std::size_t shedEntries;        // cached estimates dropped to get under the memory budget
+    std::size_t spilledParts;       // parts whose operations were spilled to disk
+    double seconds;
+    MemoryStatistics memory;        // at the end of the call; peaks cover the call
+
+    BatchStatistics()
+        : parts(0), operations(0), uniqueOperations(0), cacheHits(0), computed(0), shedEntries(0), spilledParts(0),
+          seconds(0.0) {}
+};
+
+/**
+ * @brief Estimates many parts, evaluating each distinct operation only once
+ *
+ * Family-of-parts programs repeat identical operations across variants. Every operation
+ * is reduced to a content key over its model-relevant inputs (material, machine type,
+ * operation type, cutting time, feed, spindle speed, tool diameter, depth of cut).
+ * Distinct keys missing from the cache are predicted in one batch and evaluated through
+ * the time, energy and carbon formulas; the results are fanned back out to every
+ * occurrence. The cache can be persisted and is versioned by the models and parameters,
+ * so work scales with the number of new distinct operations.
+ */
+class BatchEstimator {
+private:
+    AIInterface& ai;
+    OperationParameters parameters;
+    double setupTime;
+    double depthOfCut;
+    MemoryAccount memory;       // before the cache, which allocates from it
+    OperationCache cache;
+    std::string cachePath;
+    std::string spillPath;
+    std::uint64_t resultsCharged;   // bytes of the last results, counted until the next call
+    const ToolWearModel* toolWear;
+    bool machineClasses;
+    BatchStatistics statistics;
+
+    void shedCache();
+
+    std::uint64_t computeConfigVersion();
+
+public:
+    /**
+     * @brief Estimator using the parameters of the given models
+     * @param aiInterface Cutting power prediction
+     * @param timeModel Rapid time factor, idle time per operation and setup time
+     * @param energyModel Rapid and idle power
+     * @param emissionFactor Emission factor in kg CO2/kWh
+     */
+    BatchEstimator(AIInterface& aiInterface, const TimeModel& timeModel, const EnergyModel& energyModel,
+                   double emissionFactor);
+
+    /**
+     * @brief Set the depth of cut, which NX operations do not carry
+     * @param depth Depth of cut in mm
+     */
+    void setDepthOfCut(double depth);
+
+    /**
+     * @brief Scale cutting power for tool wear along each part's program order
+     *
+     * Wear depends on an operation's position, not its content, so it is applied to every
+     * occurrence after the cached, wear-free estimates are fanned out. Each part starts
+     * with freshly loaded tools.
+     * @param model Wear model, or nullptr to ignore wear (the default); must outlive the estimator
+     */
+    void setToolWearModel(const ToolWearModel* model);
+
+    /**
+     * @brief Evaluate parts on known machine classes with their class kernels
+     *
+     * When enabled, parts whose machine type names a class in MachineClasses.h use that
+     * class's power levels, drive efficiency map and time constants instead of the generic
+     * model parameters; other parts keep the generic ones. The kernel of every machine type
+     * is looked up once per estimate() call.
+     * @param enabled True to use the machine class kernels (off by default)
+     */
+    void setMachineClasses(bool enabled);
+
+    /**
+     * @brief Set the memory budget of each estimate() call
+     *
+     * Over budget, the operation cache stops growing and is dropped from memory (after
+     * saving it to its file), and the operations of finished parts are spilled to the
+     * spill file, keeping only the part totals. The run carries on either way.
+     * @param bytes Budget in bytes, 0 for unlimited (the default)
+     */
+    void setMemoryBudget(std::uint64_t bytes);
+
+    /**
+     * @brief Set the file operation estimates are spilled to when over the memory budget
+     * @param path CSV file (ReportWriter layout), rewritten by every call that spills; empty
+     *        to keep all results in memory
+     */
+    void setSpillPath(const std::string& path);
+
+    /**
+     * @brief Get the memory account of the operation index, cache and result buffers
+     *
+     * Its extraction resource can be given to the ExtractionCache feeding the estimator, so
+     * the budget covers extraction as well.
+     * @return Memory account
+     */
+    MemoryAccount& getMemoryAccount();
+
+    /**
+     * @brief Use a persistent cache file, loading its entries if they match the current version
+     * @param path Cache file; saveCache() writes back to it
+     * @return True if cached entries were loaded
+     */
+    bool openCache(const std::string& path);
+
+    /**
+     * @brief Write the cache to the file given to openCache() if it changed
+     * @return True on success or if there was nothing to write
+     */
+    bool saveCache();
+
+    /**
+     * @brief Compute the content key of an operation
+     * @param material Workpiece material
+     * @param machineType Machine type
+     * @param operation Operation
+     * @return Key over the model-relevant inputs
+     */
+    OperationKey makeKey(const std::string& material, const std::string& machineType,
+                         const NXOperation& operation) const;
+
+    /**
+     * @brief Estimate all parts
+     * @param parts Parts to estimate
+     * @param results One estimate per part, in the same order
+     */
+    void estimate(const std::vector<PartProgram>& parts, std::vector<PartEstimate>& results);
+
+    /**
+     * @brief Get the statistics of the last estimate() call
+     * @return Occurrences, distinct operations, cache hits and computed operations
+     */
+    const BatchStatistics& getStatistics() const;
+
+    /**
+     * @brief Get the operation cache
+     * @return Cache of estimates by operation key
+     */
+    const OperationCache& getCache() const;
+};
+
+#endif // BATCH_ESTIMATOR_H
\ No newline at end of file
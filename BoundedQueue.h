@@ -0,0 +1,166 @@
+#ifndef BOUNDED_QUEUE_H
+#define BOUNDED_QUEUE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <thread>
+
+/**
+ * @brief Fixed-capacity lock-free multi-producer/multi-consumer FIFO queue
+ *
+ * A ring of cells, each carrying a sequence number that tells producers and consumers
+ * whether the cell is free for the current lap (Vyukov's bounded MPMC queue). tryPush and
+ * tryPop never block or allocate; push and pop wait with a spin, yield, sleep backoff, which
+ * is what bounds the memory of a pipeline: a producer that runs ahead of its consumers waits
+ * for a free cell instead of growing the queue. The capacity is rounded up to a power of two.
+ * Values should be cheap to move, typically pointers to recycled buffers.
+ */
+template <typename T>
+class BoundedQueue {
+private:
+    struct Cell {
+        std::atomic<std::size_t> sequence;
+        T value;
+    };
+
+    // Producers and consumers update different counters; keep them on separate cache lines
+    alignas(64) std::atomic<std::size_t> enqueuePosition;
+    alignas(64) std::atomic<std::size_t> dequeuePosition;
+    alignas(64) std::atomic<bool> closed;
+    std::unique_ptr<Cell[]> cells;
+    std::size_t mask;
+
+    static void backoff(unsigned& attempt) {
+        if (attempt < 64) {
+            // Short waits: the other side is usually mid-operation on another core
+        } else if (attempt < 128) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+        ++attempt;
+    }
+
+public:
+    /**
+     * @brief Create an empty queue
+     * @param capacity Maximum number of queued values (at least 2, rounded up to a power of two)
+     */
+    explicit BoundedQueue(std::size_t capacity)
+        : enqueuePosition(0), dequeuePosition(0), closed(false) {
+        std::size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        cells.reset(new Cell[size]);
+        mask = size - 1;
+        for (std::size_t i = 0; i < size; ++i) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    /**
+     * @brief Get the capacity
+     * @return Maximum number of queued values
+     */
+    std::size_t getCapacity() const {
+        return mask + 1;
+    }
+
+    /**
+     * @brief Append a value if there is room
+     * @param value Value, moved from on success
+     * @return False if the queue is full
+     */
+    bool tryPush(T& value) {
+        std::size_t position = enqueuePosition.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells[position & mask];
+            std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            std::ptrdiff_t difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+            if (difference == 0) {
+                if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    cell.value = std::move(value);
+                    cell.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (difference < 0) {
+                return false;
+            } else {
+                position = enqueuePosition.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * @brief Remove the oldest value if there is one
+     * @param value Receives the value
+     * @return False if the queue is empty
+     */
+    bool tryPop(T& value) {
+        std::size_t position = dequeuePosition.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells[position & mask];
+            std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            std::ptrdiff_t difference = static_cast<std::ptrdiff_t>(sequence)
+                                      - static_cast<std::ptrdiff_t>(position + 1);
+            if (difference == 0) {
+                if (dequeuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    value = std::move(cell.value);
+                    cell.sequence.store(position + mask + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (difference < 0) {
+                return false;
+            } else {
+                position = dequeuePosition.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * @brief Append a value, waiting while the queue is full
+     * @param value Value, moved from
+     * @return True if the call had to wait (backpressure)
+     */
+    bool push(T& value) {
+        unsigned attempt = 0;
+        while (!tryPush(value)) {
+            backoff(attempt);
+        }
+        return attempt > 0;
+    }
+
+    /**
+     * @brief Remove the oldest value, waiting while the queue is empty and not closed
+     * @param value Receives the value
+     * @return False once the queue is closed and drained
+     */
+    bool pop(T& value) {
+        unsigned attempt = 0;
+        for (;;) {
+            if (tryPop(value)) {
+                return true;
+            }
+            if (closed.load(std::memory_order_acquire)) {
+                // Values pushed before close() must still be delivered
+                return tryPop(value);
+            }
+            backoff(attempt);
+        }
+    }
+
+    /**
+     * @brief Mark the end of the input; pop() returns false once the queue is drained
+     */
+    void close() {
+        closed.store(true, std::memory_order_release);
+    }
+};
+
+#endif // BOUNDED_QUEUE_H
\ No newline at end of file
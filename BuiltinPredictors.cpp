@@ -0,0 +1,258 @@
+#include "BuiltinPredictors.h"
+#include <algorithm>
+#include <iostream>
+
+namespace {
+
+bool contains(const std::string& text, const char* pattern) {
+    return text.find(pattern) != std::string::npos;
+}
+
+// Category lookup used in the inner loops; ids outside the table get the fallback value
+inline double lookup(const std::vector<double>& table, int id, double fallback) {
+    return (id >= 0 && static_cast<std::size_t>(id) < table.size()) ? table[id] : fallback;
+}
+
+} // namespace
+
+// HeuristicPredictor implementation
+HeuristicPredictor::HeuristicPredictor(const FeatureCategories& cats)
+    : categories(cats), basePower(3.0) {
+}
+
+std::string HeuristicPredictor::getName() const {
+    return "heuristic";
+}
+
+void HeuristicPredictor::refreshFactors() {
+    // Categories only grow, so only factors for newly interned names are computed
+    for (std::size_t id = materialFactors.size(); id < categories.materials.size(); ++id) {
+        const std::string& material = categories.materials.getName(static_cast<int>(id));
+        double factor = 1.0;
+        // Adjust based on material hardness (simplified)
+        if (contains(material, "Steel") || contains(material, "steel")) {
+            factor = 1.5;
+        } else if (contains(material, "Ti") || contains(material, "titanium")) {
+            factor = 1.8;
+        } else if (contains(material, "Al") || contains(material, "aluminum")) {
+            factor = 0.8;
+        }
+        materialFactors.push_back(factor);
+    }
+    for (std::size_t id = operationFactors.size(); id < categories.operationTypes.size(); ++id) {
+        const std::string& operation = categories.operationTypes.getName(static_cast<int>(id));
+        double factor = 1.0;
+        if (contains(operation, "Milling") || contains(operation, "milling")) {
+            factor = 1.1;
+        } else if (contains(operation, "Drilling") || contains(operation, "drilling")) {
+            factor = 0.9;
+        }
+        operationFactors.push_back(factor);
+    }
+}
+
+bool HeuristicPredictor::predictBatch(Span<const CutFeatures> features, Span<double> out) {
+    refreshFactors();
+    for (std::size_t i = 0; i < features.size(); ++i) {
+        out[i] = basePower
+               * lookup(materialFactors, features[i].materialId, 1.0)
+               * lookup(operationFactors, features[i].operationTypeId, 1.0);
+    }
+    return true;
+}
+
+// RegressionPredictor implementation
+RegressionPredictor::RegressionPredictor(const FeatureCategories& cats)
+    : categories(cats), maxExponent(0) {
+    // Default coefficients of the built-in local model
+    coefficients.intercept = 2.0;
+    coefficients.toolDiameter = 0.02;
+    coefficients.spindleSpeed = 0.5 / 10000.0;
+    coefficients.feedRate = 0.3 / 1000.0;
+    coefficients.depthOfCut = 0.4;
+    coefficients.steelOffset = 2.0;
+    coefficients.titaniumOffset = 1.0;
+    coefficients.aluminumOffset = 0.5;
+    coefficients.otherMaterialOffset = 1.0;
+    coefficients.millingOffset = 0.5;
+    coefficients.drillingOffset = -0.2;
+    for (int j = 0; j < 4; ++j) {
+        normalization.mean[j] = 0.0;
+        normalization.scale[j] = 1.0;
+    }
+}
+
+std::string RegressionPredictor::getName() const {
+    return "regression";
+}
+
+RegressionPredictor::MaterialClass RegressionPredictor::classifyMaterial(const std::string& material) {
+    if (contains(material, "Steel")) return SteelClass;
+    if (contains(material, "Ti")) return TitaniumClass;
+    if (contains(material, "Al")) return AluminumClass;
+    return OtherMaterialClass;
+}
+
+RegressionPredictor::OperationClass RegressionPredictor::classifyOperation(const std::string& operationType) {
+    if (contains(operationType, "Milling")) return MillingClass;
+    if (contains(operationType, "Drilling")) return DrillingClass;
+    return OtherOperationClass;
+}
+
+void RegressionPredictor::refreshOffsets() {
+    const double byMaterial[MaterialClassCount] = {
+        coefficients.steelOffset, coefficients.titaniumOffset,
+        coefficients.aluminumOffset, coefficients.otherMaterialOffset
+    };
+    const double byOperation[OperationClassCount] = {
+        coefficients.millingOffset, coefficients.drillingOffset, 0.0
+    };
+    for (std::size_t id = materialOffsets.size(); id < categories.materials.size(); ++id) {
+        materialOffsets.push_back(byMaterial[classifyMaterial(categories.materials.getName(static_cast<int>(id)))]);
+    }
+    for (std::size_t id = operationOffsets.size(); id < categories.operationTypes.size(); ++id) {
+        operationOffsets.push_back(byOperation[classifyOperation(categories.operationTypes.getName(static_cast<int>(id)))]);
+    }
+}
+
+bool RegressionPredictor::predictBatch(Span<const CutFeatures> features, Span<double> out) {
+    refreshOffsets();
+    const RegressionCoefficients c = coefficients;
+    for (std::size_t i = 0; i < features.size(); ++i) {
+        const CutFeatures& f = features[i];
+        out[i] = linearPower(c,
+                             lookup(materialOffsets, f.materialId, c.otherMaterialOffset),
+                             lookup(operationOffsets, f.operationTypeId, 0.0),
+                             f.toolDiameter, f.spindleSpeed, f.feedRate, f.depthOfCut);
+    }
+    if (terms.empty()) {
+        return true;
+    }
+
+    // Polynomial terms in a second pass so the linear loop above stays simple
+    const RegressionNormalization n = normalization;
+    const RegressionTerm* termData = terms.data();
+    const std::size_t termCount = terms.size();
+    const int maxExp = maxExponent;
+    for (std::size_t i = 0; i < features.size(); ++i) {
+        const CutFeatures& f = features[i];
+        out[i] += termPower(n, termData, termCount, maxExp, f.toolDiameter, f.spindleSpeed, f.feedRate, f.depthOfCut);
+    }
+    return true;
+}
+
+void RegressionPredictor::setCoefficients(const RegressionCoefficients& coeffs) {
+    coefficients = coeffs;
+    terms.clear();
+    maxExponent = 0;
+    // Offsets depend on the coefficients, recompute them on the next batch
+    materialOffsets.clear();
+    operationOffsets.clear();
+}
+
+const RegressionCoefficients& RegressionPredictor::getCoefficients() const {
+    return coefficients;
+}
+
+bool RegressionPredictor::validateTerms(const RegressionNormalization& norm,
+                                        const std::vector<RegressionTerm>& polynomialTerms) {
+    for (const RegressionTerm& term : polynomialTerms) {
+        for (int j = 0; j < 4; ++j) {
+            if (term.exponents[j] > MaxTermExponent) {
+                std::cout << "Error: regression term exponent " << static_cast<int>(term.exponents[j])
+                          << " exceeds " << MaxTermExponent << std::endl;
+                return false;
+            }
+        }
+    }
+    for (int j = 0; j < 4; ++j) {
+        if (!(norm.scale[j] > 0.0)) {
+            std::cout << "Error: regression normalization scale must be positive" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool RegressionPredictor::setTerms(const RegressionNormalization& norm,
+                                   const std::vector<RegressionTerm>& polynomialTerms) {
+    if (!validateTerms(norm, polynomialTerms)) {
+        return false;
+    }
+    int highest = 0;
+    for (const RegressionTerm& term : polynomialTerms) {
+        for (int j = 0; j < 4; ++j) {
+            highest = std::max(highest, static_cast<int>(term.exponents[j]));
+        }
+    }
+    normalization = norm;
+    terms = polynomialTerms;
+    maxExponent = highest;
+    return true;
+}
+
+const std::vector<RegressionTerm>& RegressionPredictor::getTerms() const {
+    return terms;
+}
+
+const RegressionNormalization& RegressionPredictor::getNormalization() const {
+    return normalization;
+}
+
+// RemotePredictor implementation
+RemotePredictor::RemotePredictor(const FeatureCategories& cats)
+    : model("gpt-3.5-turbo"), simulatedModel(cats) {
+    // Simulated response: similar to the local model but slightly more refined
+    RegressionCoefficients c;
+    c.intercept = 2.0;
+    c.toolDiameter = 0.022;
+    c.spindleSpeed = 0.55 / 10000.0;
+    c.feedRate = 0.33 / 1000.0;
+    c.depthOfCut = 0.44;
+    c.steelOffset = 2.2;
+    c.titaniumOffset = 2.5;
+    c.aluminumOffset = 0.6;
+    c.otherMaterialOffset = 1.1;
+    c.millingOffset = 0.55;
+    c.drillingOffset = -0.15;
+    simulatedModel.setCoefficients(c);
+}
+
+std::string RemotePredictor::getName() const {
+    return "remote";
+}
+
+bool RemotePredictor::isReady() const {
+    return !apiKey.empty();
+}
+
+bool RemotePredictor::predictBatch(Span<const CutFeatures> features, Span<double> out) {
+    if (!isReady()) {
+        return false;
+    }
+
+    std::cout << "Calling OpenAI API (" << model << ") for " << features.size()
+              << " cutting power predictions..." << std::endl;
+
+    // In a real implementation, all cuts would be sent as one chat completion request
+    // (one line per cut, see OPENAI_INTEGRATION.md) and the values parsed from the response
+
+    // For this example, the response is simulated
+    return simulatedModel.predictBatch(features, out);
+}
+
+void RemotePredictor::setApiKey(const std::string& key) {
+    apiKey = key;
+}
+
+void RemotePredictor::setOrganization(const std::string& orgId) {
+    organization = orgId;
+}
+
+void RemotePredictor::setModel(const std::string& modelName) {
+    model = modelName;
+}
+
+const std::string& RemotePredictor::getModel() const {
+    return model;
+}
\ No newline at end of file
@@ -0,0 +1,259 @@
+#ifndef BUILTIN_PREDICTORS_H
+#define BUILTIN_PREDICTORS_H
+
+#include "PowerPredictor.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Rule-of-thumb cutting power from material and operation type only
+ *
+ * Always ready; used as the last element of every fallback chain.
+ */
+class HeuristicPredictor : public PowerPredictor {
+private:
+    const FeatureCategories& categories;
+    double basePower;                       // kW
+    std::vector<double> materialFactors;    // cached per material id
+    std::vector<double> operationFactors;   // cached per operation type id
+
+    void refreshFactors();
+
+public:
+    explicit HeuristicPredictor(const FeatureCategories& categories);
+
+    std::string getName() const override;
+    bool predictBatch(Span<const CutFeatures> features, Span<double> out) override;
+};
+
+/**
+ * @brief Coefficients of the linear cutting power model
+ */
+struct RegressionCoefficients {
+    double intercept;           // kW
+    double toolDiameter;        // kW per mm
+    double spindleSpeed;        // kW per RPM
+    double feedRate;            // kW per mm/min
+    double depthOfCut;          // kW per mm
+    double steelOffset;         // kW
+    double titaniumOffset;      // kW
+    double aluminumOffset;      // kW
+    double otherMaterialOffset; // kW
+    double millingOffset;       // kW
+    double drillingOffset;      // kW
+};
+static_assert(sizeof(RegressionCoefficients) == 11 * sizeof(double),
+              "RegressionCoefficients is stored as-is in model containers");
+
+/**
+ * @brief Standardization of the machining parameters used by higher-order regression terms
+ *
+ * Parameter order: tool diameter, spindle speed, feed rate, depth of cut.
+ */
+struct RegressionNormalization {
+    double mean[4];
+    double scale[4];
+};
+static_assert(sizeof(RegressionNormalization) == 8 * sizeof(double),
+              "RegressionNormalization is stored as-is in model containers");
+
+/**
+ * @brief Higher-order term of the regression model
+ *
+ * Contributes coefficient * z0^e0 * z1^e1 * z2^e2 * z3^e3, where z are the
+ * machining parameters standardized with RegressionNormalization.
+ */
+struct RegressionTerm {
+    std::uint8_t exponents[4];
+    std::uint32_t reserved;
+    double coefficient;     // kW
+};
+static_assert(sizeof(RegressionTerm) == 16, "RegressionTerm is stored as-is in model containers");
+
+/**
+ * @brief Linear regression over the machining parameters with per-material and per-operation offsets,
+ *        optionally extended with polynomial terms
+ */
+class RegressionPredictor : public PowerPredictor {
+public:
+    // Material and operation groups that carry their own offset
+    enum MaterialClass { SteelClass = 0, TitaniumClass, AluminumClass, OtherMaterialClass, MaterialClassCount };
+    enum OperationClass { MillingClass = 0, DrillingClass, OtherOperationClass, OperationClassCount };
+
+    // Highest exponent of a single parameter in a polynomial term
+    static const int MaxTermExponent = 8;
+
+private:
+    const FeatureCategories& categories;
+    RegressionCoefficients coefficients;
+    RegressionNormalization normalization;
+    std::vector<RegressionTerm> terms;
+    int maxExponent;                        // highest exponent used by the terms
+    std::vector<double> materialOffsets;    // cached per material id
+    std::vector<double> operationOffsets;   // cached per operation type id
+
+    void refreshOffsets();
+
+    static double offsetFor(const std::vector<double>& offsets, int id, double fallback) {
+        return (id >= 0 && static_cast<std::size_t>(id) < offsets.size()) ? offsets[id] : fallback;
+    }
+
+    // Linear part of the model, shared by predictBatch and predict
+    template <typename T>
+    static T linearPower(const RegressionCoefficients& c, double materialOffset, double operationOffset,
+                         const T& toolDiameter, const T& spindleSpeed, const T& feedRate, const T& depthOfCut) {
+        return c.intercept
+             + materialOffset
+             + toolDiameter * c.toolDiameter
+             + spindleSpeed * c.spindleSpeed
+             + feedRate * c.feedRate
+             + depthOfCut * c.depthOfCut
+             + operationOffset;
+    }
+
+    // Sum of the polynomial terms; powers of the standardized parameters are tabulated once
+    template <typename T>
+    static T termPower(const RegressionNormalization& n, const RegressionTerm* termData, std::size_t termCount,
+                       int maxExponent, const T& toolDiameter, const T& spindleSpeed, const T& feedRate,
+                       const T& depthOfCut) {
+        const T z[4] = {
+            (toolDiameter - n.mean[0]) / n.scale[0],
+            (spindleSpeed - n.mean[1]) / n.scale[1],
+            (feedRate - n.mean[2]) / n.scale[2],
+            (depthOfCut - n.mean[3]) / n.scale[3]
+        };
+        T powers[4][MaxTermExponent + 1];
+        for (int j = 0; j < 4; ++j) {
+            powers[j][0] = 1.0;
+            for (int e = 1; e <= maxExponent; ++e) {
+                powers[j][e] = powers[j][e - 1] * z[j];
+            }
+        }
+        T sum = 0.0;
+        for (std::size_t t = 0; t < termCount; ++t) {
+            const RegressionTerm& term = termData[t];
+            sum += term.coefficient
+                 * powers[0][term.exponents[0]] * powers[1][term.exponents[1]]
+                 * powers[2][term.exponents[2]] * powers[3][term.exponents[3]];
+        }
+        return sum;
+    }
+
+public:
+    explicit RegressionPredictor(const FeatureCategories& categories);
+
+    /**
+     * @brief Classify a material name the way the regression offsets do
+     * @param material Material name
+     * @return Material class
+     */
+    static MaterialClass classifyMaterial(const std::string& material);
+
+    /**
+     * @brief Classify an operation type name the way the regression offsets do
+     * @param operationType Operation type name
+     * @return Operation class
+     */
+    static OperationClass classifyOperation(const std::string& operationType);
+
+    std::string getName() const override;
+    bool predictBatch(Span<const CutFeatures> features, Span<double> out) override;
+
+    /**
+     * @brief Evaluate one cut, templated on the numeric type
+     *
+     * Same formula as predictBatch. Instantiated with Dual, it also yields the partial
+     * derivatives of the cutting power with respect to the machining parameters.
+     *
+     * @param materialId Material id in the registry categories
+     * @param operationTypeId Operation type id in the registry categories
+     * @param toolDiameter Tool diameter in mm
+     * @param spindleSpeed Spindle speed in RPM
+     * @param feedRate Feed rate in mm/min
+     * @param depthOfCut Depth of cut in mm
+     * @return Cutting power in kW
+     */
+    template <typename T>
+    T predict(int materialId, int operationTypeId, const T& toolDiameter, const T& spindleSpeed,
+              const T& feedRate, const T& depthOfCut) {
+        refreshOffsets();
+        T power = linearPower(coefficients,
+                              offsetFor(materialOffsets, materialId, coefficients.otherMaterialOffset),
+                              offsetFor(operationOffsets, operationTypeId, 0.0),
+                              toolDiameter, spindleSpeed, feedRate, depthOfCut);
+        if (!terms.empty()) {
+            power += termPower(normalization, terms.data(), terms.size(), maxExponent,
+                               toolDiameter, spindleSpeed, feedRate, depthOfCut);
+        }
+        return power;
+    }
+
+    /**
+     * @brief Replace the model coefficients and drop any polynomial terms
+     * @param coeffs New coefficients
+     */
+    void setCoefficients(const RegressionCoefficients& coeffs);
+
+    /**
+     * @brief Get the model coefficients
+     * @return Current coefficients
+     */
+    const RegressionCoefficients& getCoefficients() const;
+
+    /**
+     * @brief Check polynomial terms without installing them
+     * @param norm Standardization applied to the parameters before evaluating the terms
+     * @param polynomialTerms Terms to check
+     * @return False if a term uses an exponent above MaxTermExponent or a scale is not positive
+     */
+    static bool validateTerms(const RegressionNormalization& norm, const std::vector<RegressionTerm>& polynomialTerms);
+
+    /**
+     * @brief Replace the polynomial terms added to the linear model
+     * @param norm Standardization applied to the parameters before evaluating the terms
+     * @param polynomialTerms New terms (empty for a purely linear model)
+     * @return False if a term uses an exponent above MaxTermExponent or a scale is not positive
+     */
+    bool setTerms(const RegressionNormalization& norm, const std::vector<RegressionTerm>& polynomialTerms);
+
+    /**
+     * @brief Get the polynomial terms
+     * @return Current terms
+     */
+    const std::vector<RegressionTerm>& getTerms() const;
+
+    /**
+     * @brief Get the standardization used by the polynomial terms
+     * @return Current normalization
+     */
+    const RegressionNormalization& getNormalization() const;
+};
+
+/**
+ * @brief Cloud-based prediction through the OpenAI API
+ *
+ * The request is simulated; the whole batch would be sent in a single API call.
+ * Not ready until an API key is configured.
+ */
+class RemotePredictor : public PowerPredictor {
+private:
+    std::string apiKey;
+    std::string organization;
+    std::string model;
+    RegressionPredictor simulatedModel;     // stands in for the API response
+
+public:
+    explicit RemotePredictor(const FeatureCategories& categories);
+
+    std::string getName() const override;
+    bool isReady() const override;
+    bool predictBatch(Span<const CutFeatures> features, Span<double> out) override;
+
+    void setApiKey(const std::string& key);
+    void setOrganization(const std::string& orgId);
+    void setModel(const std::string& modelName);
+    const std::string& getModel() const;
+};
+
+#endif // BUILTIN_PREDICTORS_H
\ No newline at end of file
@@ -0,0 +1,127 @@
+#include "CalendarQueue.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const std::size_t minimumBuckets = 2;
+const std::size_t widthSampleSize = 25;
+
+bool earlier(const SimulationEvent& a, const SimulationEvent& b) {
+    return a.time < b.time || (a.time == b.time && a.sequence < b.sequence);
+}
+
+bool later(const SimulationEvent& a, const SimulationEvent& b) {
+    return earlier(b, a);
+}
+
+} // namespace
+
+CalendarQueue::CalendarQueue() {
+    clear();
+}
+
+void CalendarQueue::clear() {
+    buckets.assign(minimumBuckets, std::vector<SimulationEvent>());
+    width = 1.0;
+    mask = minimumBuckets - 1;
+    day = 0;
+    count = 0;
+    nextSequence = 0;
+    lastTime = 0.0;
+}
+
+std::uint64_t CalendarQueue::dayOf(double time) const {
+    return static_cast<std::uint64_t>(std::max(time, 0.0) / width);
+}
+
+void CalendarQueue::insert(const SimulationEvent& event) {
+    std::vector<SimulationEvent>& bucket = buckets[static_cast<std::size_t>(dayOf(event.time)) & mask];
+    bucket.insert(std::upper_bound(bucket.begin(), bucket.end(), event, later), event);
+}
+
+void CalendarQueue::push(SimulationEvent event) {
+    event.sequence = nextSequence++;
+    insert(event);
+    ++count;
+    if (count > 2 * buckets.size()) {
+        resize(2 * buckets.size());
+    }
+}
+
+bool CalendarQueue::pop(SimulationEvent& event) {
+    if (count == 0) {
+        return false;
+    }
+
+    // Walk the days of the current year; a bucket's earliest event is due if it falls on that day
+    std::vector<SimulationEvent>* found = nullptr;
+    for (std::size_t i = 0; i < buckets.size(); ++i, ++day) {
+        std::vector<SimulationEvent>& bucket = buckets[static_cast<std::size_t>(day) & mask];
+        if (!bucket.empty() && dayOf(bucket.back().time) <= day) {
+            found = &bucket;
+            break;
+        }
+    }
+    if (found == nullptr) {
+        // Sparse calendar: jump straight to the earliest event
+        for (std::vector<SimulationEvent>& bucket : buckets) {
+            if (!bucket.empty() && (found == nullptr || earlier(bucket.back(), found->back()))) {
+                found = &bucket;
+            }
+        }
+        day = dayOf(found->back().time);
+    }
+
+    event = found->back();
+    found->pop_back();
+    --count;
+    lastTime = event.time;
+    if (buckets.size() > minimumBuckets && count < buckets.size() / 2) {
+        resize(buckets.size() / 2);
+    }
+    return true;
+}
+
+void CalendarQueue::resize(std::size_t bucketCount) {
+    std::vector<SimulationEvent> events;
+    events.reserve(count);
+    for (std::vector<SimulationEvent>& bucket : buckets) {
+        events.insert(events.end(), bucket.begin(), bucket.end());
+    }
+    std::sort(events.begin(), events.end(), earlier);
+
+    // Day width: three times the average spacing of the earliest events, ignoring outlying gaps
+    std::size_t samples = std::min(events.size(), widthSampleSize);
+    if (samples >= 2) {
+        double average = (events[samples - 1].time - events[0].time) / (samples - 1);
+        double total = 0.0;
+        std::size_t gaps = 0;
+        for (std::size_t i = 1; i < samples; ++i) {
+            double gap = events[i].time - events[i - 1].time;
+            if (gap <= 2.0 * average) {
+                total += gap;
+                ++gaps;
+            }
+        }
+        if (gaps > 0 && total > 0.0) {
+            width = 3.0 * total / gaps;
+        }
+    }
+
+    buckets.assign(bucketCount, std::vector<SimulationEvent>());
+    mask = bucketCount - 1;
+    for (std::vector<SimulationEvent>::reverse_iterator it = events.rbegin(); it != events.rend(); ++it) {
+        buckets[static_cast<std::size_t>(dayOf(it->time)) & mask].push_back(*it);
+    }
+    // Resume at the last dequeued time: later pushes may still fall before the pending events
+    day = dayOf(lastTime);
+}
+
+std::size_t CalendarQueue::size() const {
+    return count;
+}
+
+bool CalendarQueue::empty() const {
+    return count == 0;
+}
\ No newline at end of file
@@ -0,0 +1,83 @@
+#ifndef CALENDAR_QUEUE_H
+#define CALENDAR_QUEUE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Pending event of a discrete-event simulation
+ */
+struct SimulationEvent {
+    double time;                // minutes
+    std::uint64_t sequence;     // insertion order, breaks ties between equal times
+    std::uint32_t target;       // e.g. machine index
+    std::uint32_t type;
+    std::uint64_t generation;   // lets the owner ignore events that were superseded
+
+    SimulationEvent() : time(0.0), sequence(0), target(0), type(0), generation(0) {}
+    SimulationEvent(double eventTime, std::uint32_t eventTarget, std::uint32_t eventType,
+                    std::uint64_t eventGeneration = 0)
+        : time(eventTime), sequence(0), target(eventTarget), type(eventType), generation(eventGeneration) {}
+};
+
+/**
+ * @brief Calendar queue (Brown, 1988): priority queue of events with O(1) average operations
+ *
+ * Events are hashed by time into a ring of buckets, each one day wide, like appointments
+ * in a desk calendar whose pages are reused every year. Dequeuing walks the days of the
+ * current year and takes the earliest event of the first day that has one due; only when
+ * a whole year is empty does it search all buckets directly. The number of buckets follows
+ * the number of pending events and the day width is re-estimated from the spacing of the
+ * earliest events on every resize, so each bucket holds a few events. Events with equal
+ * times come out in insertion order. Event times must not precede the last dequeued event.
+ */
+class CalendarQueue {
+private:
+    std::vector<std::vector<SimulationEvent>> buckets;  // each sorted latest first
+    double width;                   // minutes per bucket
+    std::size_t mask;
+    std::uint64_t day;              // absolute bucket number of the current position
+    std::size_t count;
+    std::uint64_t nextSequence;
+    double lastTime;
+
+    std::uint64_t dayOf(double time) const;
+    void insert(const SimulationEvent& event);
+    void resize(std::size_t bucketCount);
+
+public:
+    CalendarQueue();
+
+    /**
+     * @brief Add an event
+     * @param event Event; its sequence number is assigned here
+     */
+    void push(SimulationEvent event);
+
+    /**
+     * @brief Remove the earliest event
+     * @param event Receives the event
+     * @return False if the queue is empty
+     */
+    bool pop(SimulationEvent& event);
+
+    /**
+     * @brief Get the number of pending events
+     * @return Number of events
+     */
+    std::size_t size() const;
+
+    /**
+     * @brief Check whether no events are pending
+     * @return True if empty
+     */
+    bool empty() const;
+
+    /**
+     * @brief Drop all events and start again at time 0
+     */
+    void clear();
+};
+
+#endif // CALENDAR_QUEUE_H
\ No newline at end of file
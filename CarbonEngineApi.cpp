@@ -0,0 +1,323 @@
+#include "CarbonEngineApi.h"
+#include "AIInterface.h"
+#include "OperationCache.h"
+#include "TimeModel.h"
+#include "EnergyModel.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <exception>
+#include <limits>
+#include <mutex>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Rows predicted per call into the predictors; scratch buffers are sized for this once
+const std::size_t blockRows = 4096;
+
+// Struct sizes of interface version 1. Later versions append fields, so callers may pass any
+// size from these up; fields beyond their struct_size take defaults
+const std::size_t configSizeV1 = offsetof(nxc_config, default_machine_type_id) + sizeof(int32_t);
+const std::size_t batchInputSizeV1 = offsetof(nxc_batch_input, emission_factor) + sizeof(const double*);
+const std::size_t batchOutputSizeV1 = offsetof(nxc_batch_output, status) + sizeof(uint8_t*);
+
+} // namespace
+
+struct nxc_engine {
+    AIInterface ai;
+    nxc_config config;
+    std::mutex mutex;
+    std::string lastError;
+    std::vector<CutFeatures> features;  // valid rows of the current block
+    std::vector<std::size_t> rows;      // their row index in the batch
+    std::vector<double> power;
+
+    nxc_engine() : features(blockRows), rows(blockRows), power(blockRows) {
+        ai.setEnabled(true);
+        TimeModel timeModel;
+        EnergyModel energyModel;
+        FeatureCategories& categories = ai.getPredictorRegistry().getCategories();
+        config.struct_size = sizeof(nxc_config);
+        config.emission_factor = 0.475;     // kg CO2/kWh (US average)
+        config.rapid_power = energyModel.getRapidPower();
+        config.idle_power = energyModel.getIdlePower();
+        config.rapid_time_factor = timeModel.getRapidTimeFactor();
+        config.idle_time_per_op = timeModel.getIdleTimePerOp();
+        config.depth_of_cut = 2.0;
+        config.default_operation_type_id = categories.operationTypes.intern("Milling");
+        config.default_machine_type_id = categories.machineTypes.intern("3axis_VMC");
+    }
+
+    nxc_status fail(nxc_status status, const char* message) {
+        lastError = message;
+        return status;
+    }
+};
+
+namespace {
+
+bool validId(int32_t id, const CategoryTable& table) {
+    return id >= 0 && static_cast<std::size_t>(id) < table.size();
+}
+
+CategoryTable* categoryTable(nxc_engine* engine, nxc_category category) {
+    FeatureCategories& categories = engine->ai.getPredictorRegistry().getCategories();
+    switch (category) {
+        case NXC_CATEGORY_MATERIAL:
+            return &categories.materials;
+        case NXC_CATEGORY_OPERATION_TYPE:
+            return &categories.operationTypes;
+        case NXC_CATEGORY_MACHINE_TYPE:
+            return &categories.machineTypes;
+    }
+    return nullptr;
+}
+
+// Run an entry point body under the engine lock; no exception leaves the library
+template <typename Body>
+nxc_status guarded(nxc_engine* engine, Body body) {
+    if (engine == nullptr) {
+        return NXC_INVALID_ARGUMENT;
+    }
+    try {
+        std::lock_guard<std::mutex> lock(engine->mutex);
+        engine->lastError.clear();
+        return body();
+    } catch (const std::bad_alloc&) {
+        return engine->fail(NXC_OUT_OF_MEMORY, "out of memory");
+    } catch (const std::exception& error) {
+        return engine->fail(NXC_INTERNAL_ERROR, error.what());
+    } catch (...) {
+        return engine->fail(NXC_INTERNAL_ERROR, "unknown error");
+    }
+}
+
+void writeRow(const nxc_batch_output& output, std::size_t row, double power, double totalTime, double energy,
+              double carbon, nxc_status status) {
+    if (output.cutting_power != nullptr) output.cutting_power[row] = power;
+    if (output.total_time != nullptr) output.total_time[row] = totalTime;
+    if (output.energy != nullptr) output.energy[row] = energy;
+    if (output.carbon != nullptr) output.carbon[row] = carbon;
+    if (output.status != nullptr) output.status[row] = static_cast<uint8_t>(status);
+}
+
+void writeFailedRow(const nxc_batch_output& output, std::size_t row, nxc_status status) {
+    double nan = std::numeric_limits<double>::quiet_NaN();
+    writeRow(output, row, nan, nan, nan, nan, status);
+}
+
+} // namespace
+
+extern "C" {
+
+NXC_API uint32_t nxc_api_version(void) {
+    return NXC_API_VERSION;
+}
+
+NXC_API const char* nxc_status_string(nxc_status status) {
+    switch (status) {
+        case NXC_OK:
+            return "ok";
+        case NXC_INVALID_ARGUMENT:
+            return "invalid argument";
+        case NXC_IO_ERROR:
+            return "file could not be read";
+        case NXC_NO_PREDICTION:
+            return "no prediction";
+        case NXC_OUT_OF_MEMORY:
+            return "out of memory";
+        case NXC_INTERNAL_ERROR:
+            return "internal error";
+    }
+    return "unknown status";
+}
+
+NXC_API nxc_status nxc_engine_create(nxc_engine** engine) {
+    if (engine == nullptr) {
+        return NXC_INVALID_ARGUMENT;
+    }
+    *engine = nullptr;
+    try {
+        *engine = new nxc_engine();
+        return NXC_OK;
+    } catch (const std::bad_alloc&) {
+        return NXC_OUT_OF_MEMORY;
+    } catch (...) {
+        return NXC_INTERNAL_ERROR;
+    }
+}
+
+NXC_API void nxc_engine_destroy(nxc_engine* engine) {
+    try {
+        delete engine;
+    } catch (...) {
+    }
+}
+
+NXC_API nxc_status nxc_engine_load_model(nxc_engine* engine, const char* path) {
+    return guarded(engine, [&]() {
+        if (path == nullptr) {
+            return engine->fail(NXC_INVALID_ARGUMENT, "no model path");
+        }
+        if (!engine->ai.loadModel(path)) {
+            return engine->fail(NXC_IO_ERROR, "model could not be loaded");
+        }
+        return NXC_OK;
+    });
+}
+
+NXC_API nxc_status nxc_engine_train(nxc_engine* engine, const char* path) {
+    return guarded(engine, [&]() {
+        if (path == nullptr) {
+            return engine->fail(NXC_INVALID_ARGUMENT, "no training data path");
+        }
+        if (!engine->ai.trainModel(path)) {
+            return engine->fail(NXC_IO_ERROR, "model was not retrained");
+        }
+        return NXC_OK;
+    });
+}
+
+NXC_API nxc_status nxc_engine_get_config(nxc_engine* engine, nxc_config* config) {
+    return guarded(engine, [&]() {
+        if (config == nullptr || config->struct_size < configSizeV1) {
+            return engine->fail(NXC_INVALID_ARGUMENT, "config is null or struct_size is too small");
+        }
+        uint32_t size = config->struct_size;
+        std::memcpy(config, &engine->config, std::min<std::size_t>(size, sizeof(nxc_config)));
+        config->struct_size = size;
+        return NXC_OK;
+    });
+}
+
+NXC_API nxc_status nxc_engine_set_config(nxc_engine* engine, const nxc_config* config) {
+    return guarded(engine, [&]() {
+        if (config == nullptr || config->struct_size < configSizeV1) {
+            return engine->fail(NXC_INVALID_ARGUMENT, "config is null or struct_size is too small");
+        }
+        // Fields the caller does not know about keep their current values
+        nxc_config updated = engine->config;
+        std::memcpy(&updated, config, std::min<std::size_t>(config->struct_size, sizeof(nxc_config)));
+        updated.struct_size = sizeof(nxc_config);
+        const FeatureCategories& categories = engine->ai.getPredictorRegistry().getCategories();
+        if (!validId(updated.default_operation_type_id, categories.operationTypes) ||
+            !validId(updated.default_machine_type_id, categories.machineTypes)) {
+            return engine->fail(NXC_INVALID_ARGUMENT, "unknown default operation or machine type id");
+        }
+        engine->config = updated;
+        return NXC_OK;
+    });
+}
+
+NXC_API nxc_status nxc_engine_category_id(nxc_engine* engine, nxc_category category, const char* name, int32_t* id) {
+    return guarded(engine, [&]() {
+        CategoryTable* table = categoryTable(engine, category);
+        if (table == nullptr || name == nullptr || id == nullptr) {
+            return engine->fail(NXC_INVALID_ARGUMENT, "unknown category, or null name or id");
+        }
+        *id = table->intern(name);
+        return NXC_OK;
+    });
+}
+
+NXC_API nxc_status nxc_engine_model_version(nxc_engine* engine, uint64_t* version) {
+    return guarded(engine, [&]() {
+        if (version == nullptr) {
+            return engine->fail(NXC_INVALID_ARGUMENT, "null version");
+        }
+        *version = engine->ai.getModelVersion();
+        return NXC_OK;
+    });
+}
+
+NXC_API nxc_status nxc_engine_estimate(nxc_engine* engine, const nxc_batch_input* input,
+                                       const nxc_batch_output* output, size_t count, size_t* failed) {
+    if (failed != nullptr) {
+        *failed = 0;
+    }
+    return guarded(engine, [&]() {
+        if (input == nullptr || output == nullptr || input->struct_size < batchInputSizeV1 ||
+            output->struct_size < batchOutputSizeV1) {
+            return engine->fail(NXC_INVALID_ARGUMENT, "input or output is null or struct_size is too small");
+        }
+        // Columns beyond the caller's struct_size are absent
+        nxc_batch_input in = {};
+        nxc_batch_output out = {};
+        std::memcpy(&in, input, std::min<std::size_t>(input->struct_size, sizeof(nxc_batch_input)));
+        std::memcpy(&out, output, std::min<std::size_t>(output->struct_size, sizeof(nxc_batch_output)));
+        if (count > 0 && (in.cutting_time == nullptr || in.tool_diameter == nullptr ||
+                          in.spindle_speed == nullptr || in.feed_rate == nullptr ||
+                          in.material_id == nullptr)) {
+            return engine->fail(NXC_INVALID_ARGUMENT, "a required input column is null");
+        }
+
+        const nxc_config& config = engine->config;
+        OperationParameters parameters;
+        parameters.rapidTimeFactor = config.rapid_time_factor;
+        parameters.idleTimePerOp = config.idle_time_per_op;
+        parameters.rapidPower = config.rapid_power;
+        parameters.idlePower = config.idle_power;
+        const FeatureCategories& categories = engine->ai.getPredictorRegistry().getCategories();
+        std::size_t failures = 0;
+        for (std::size_t begin = 0; begin < count; begin += blockRows) {
+            std::size_t end = std::min(count, begin + blockRows);
+
+            // Gather the valid rows of the block into the predictors' feature layout
+            std::size_t valid = 0;
+            for (std::size_t row = begin; row < end; ++row) {
+                CutFeatures& features = engine->features[valid];
+                features.toolDiameter = in.tool_diameter[row];
+                features.spindleSpeed = in.spindle_speed[row];
+                features.feedRate = in.feed_rate[row];
+                features.depthOfCut = in.depth_of_cut != nullptr ? in.depth_of_cut[row] : config.depth_of_cut;
+                features.materialId = in.material_id[row];
+                features.operationTypeId = in.operation_type_id != nullptr ? in.operation_type_id[row]
+                                                                               : config.default_operation_type_id;
+                features.machineTypeId = in.machine_type_id != nullptr ? in.machine_type_id[row]
+                                                                           : config.default_machine_type_id;
+                if (!validId(features.materialId, categories.materials) ||
+                    !validId(features.operationTypeId, categories.operationTypes) ||
+                    !validId(features.machineTypeId, categories.machineTypes)) {
+                    writeFailedRow(out, row, NXC_INVALID_ARGUMENT);
+                    ++failures;
+                    continue;
+                }
+                engine->rows[valid++] = row;
+            }
+            engine->ai.predictCuttingPowerBatch(Span<const CutFeatures>(engine->features.data(), valid),
+                                                Span<double>(engine->power.data(), valid));
+
+            for (std::size_t i = 0; i < valid; ++i) {
+                std::size_t row = engine->rows[i];
+                double power = engine->power[i];
+                if (!std::isfinite(power)) {
+                    writeFailedRow(out, row, NXC_NO_PREDICTION);
+                    ++failures;
+                    continue;
+                }
+                parameters.emissionFactor = (in.emission_factor != nullptr && in.emission_factor[row] > 0.0)
+                                                ? in.emission_factor[row]
+                                                : config.emission_factor;
+                OperationEstimate e = evaluateOperation(in.cutting_time[row], power, parameters);
+                writeRow(out, row, power, e.totalTime, e.energy, e.carbon, NXC_OK);
+            }
+        }
+        if (failed != nullptr) {
+            *failed = failures;
+        }
+        if (failures > 0) {
+            engine->lastError = std::to_string(failures) + " rows failed";
+        }
+        return NXC_OK;
+    });
+}
+
+NXC_API const char* nxc_engine_last_error(const nxc_engine* engine) {
+    return engine != nullptr ? engine->lastError.c_str() : "null engine";
+}
+
+} // extern "C"
\ No newline at end of file
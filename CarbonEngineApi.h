@@ -0,0 +1,209 @@
+/* CarbonEngineApi.h
+ * Stable C interface of the estimation engine, exported by the nxcarbon shared library
+ * so the MES, Python (ctypes/cffi) and other non-C++ callers can use the models without NX.
+ */
+
+#ifndef CARBON_ENGINE_API_H
+#define CARBON_ENGINE_API_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#  if defined(NXC_BUILDING_LIBRARY)
+#    define NXC_API __declspec(dllexport)
+#  else
+#    define NXC_API __declspec(dllimport)
+#  endif
+#else
+#  define NXC_API __attribute__((visibility("default")))
+#endif
+
+/** Version of this interface; incremented only by incompatible changes */
+#define NXC_API_VERSION 1
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Opaque engine: models, category tables, configuration and scratch buffers */
+typedef struct nxc_engine nxc_engine;
+
+/** @brief Result of a call, and per-row status of a batch */
+typedef enum nxc_status {
+    NXC_OK = 0,
+    NXC_INVALID_ARGUMENT = 1,   /* null pointer, unknown category id or too small struct_size */
+    NXC_IO_ERROR = 2,           /* model or training file could not be read */
+    NXC_NO_PREDICTION = 3,      /* no backend could predict the cutting power of a row */
+    NXC_OUT_OF_MEMORY = 4,
+    NXC_INTERNAL_ERROR = 5
+} nxc_status;
+
+/** @brief Category tables mapping names to the ids used in batch columns */
+typedef enum nxc_category {
+    NXC_CATEGORY_MATERIAL = 0,
+    NXC_CATEGORY_OPERATION_TYPE = 1,
+    NXC_CATEGORY_MACHINE_TYPE = 2
+} nxc_category;
+
+/**
+ * @brief Engine configuration
+ *
+ * Set struct_size to sizeof(nxc_config); later versions only append fields, so older
+ * callers keep working: fields beyond their struct_size keep the engine's values.
+ * Ids come from nxc_engine_category_id.
+ */
+typedef struct nxc_config {
+    uint32_t struct_size;
+    double emission_factor;             /* kg CO2/kWh, used for rows without their own factor */
+    double rapid_power;                 /* kW */
+    double idle_power;                  /* kW */
+    double rapid_time_factor;           /* rapid time as a fraction of cutting time */
+    double idle_time_per_op;            /* minutes per operation */
+    double depth_of_cut;                /* mm, used when the batch has no depth column */
+    int32_t default_operation_type_id;  /* used when the batch has no operation type column */
+    int32_t default_machine_type_id;    /* used when the batch has no machine type column */
+} nxc_config;
+
+/**
+ * @brief Input columns of a batch, each an array of `count` values owned by the caller
+ *
+ * Optional columns may be NULL and fall back to the configuration; so do columns beyond
+ * struct_size, for callers built against an older version.
+ */
+typedef struct nxc_batch_input {
+    uint32_t struct_size;
+    const double* cutting_time;         /* minutes, required */
+    const double* tool_diameter;        /* mm, required */
+    const double* spindle_speed;        /* RPM, required */
+    const double* feed_rate;            /* mm/min, required */
+    const double* depth_of_cut;         /* mm, optional */
+    const int32_t* material_id;         /* required */
+    const int32_t* operation_type_id;   /* optional */
+    const int32_t* machine_type_id;     /* optional */
+    const double* emission_factor;      /* kg CO2/kWh, optional; values <= 0 use the configuration */
+} nxc_batch_input;
+
+/**
+ * @brief Output columns of a batch, each an array of `count` values owned by the caller
+ *
+ * Any column may be NULL if the caller does not need it; columns beyond struct_size are
+ * not written. Rows that fail are NaN.
+ */
+typedef struct nxc_batch_output {
+    uint32_t struct_size;
+    double* cutting_power;              /* kW */
+    double* total_time;                 /* minutes: cutting, rapid and per-operation idle time */
+    double* energy;                     /* kWh */
+    double* carbon;                     /* kg CO2 */
+    uint8_t* status;                    /* nxc_status of each row */
+} nxc_batch_output;
+
+/**
+ * @brief Get the interface version the library was built with
+ * @return NXC_API_VERSION of the library
+ */
+NXC_API uint32_t nxc_api_version(void);
+
+/**
+ * @brief Get a short description of a status
+ * @param status Status
+ * @return Static string
+ */
+NXC_API const char* nxc_status_string(nxc_status status);
+
+/**
+ * @brief Create an engine with the built-in models and default configuration
+ * @param engine Receives the engine
+ * @return NXC_OK, or an error with *engine set to NULL
+ */
+NXC_API nxc_status nxc_engine_create(nxc_engine** engine);
+
+/**
+ * @brief Destroy an engine (NULL is ignored)
+ * @param engine Engine
+ */
+NXC_API void nxc_engine_destroy(nxc_engine* engine);
+
+/**
+ * @brief Load a model container or tree-ensemble dump (docs/MODEL_FORMATS.md)
+ * @param engine Engine
+ * @param path File path, UTF-8
+ * @return NXC_OK, or NXC_IO_ERROR if the file could not be loaded (the current model is kept)
+ */
+NXC_API nxc_status nxc_engine_load_model(nxc_engine* engine, const char* path);
+
+/**
+ * @brief Train on measured cuts in the datasets/machining_power.csv layout
+ * @param engine Engine
+ * @param path File path, UTF-8
+ * @return NXC_OK, or NXC_IO_ERROR if the model was not retrained
+ */
+NXC_API nxc_status nxc_engine_train(nxc_engine* engine, const char* path);
+
+/**
+ * @brief Get the current configuration
+ * @param engine Engine
+ * @param config Receives the configuration; its struct_size must be set by the caller
+ * @return NXC_OK or NXC_INVALID_ARGUMENT
+ */
+NXC_API nxc_status nxc_engine_get_config(nxc_engine* engine, nxc_config* config);
+
+/**
+ * @brief Replace the configuration
+ * @param engine Engine
+ * @param config Configuration (start from nxc_engine_get_config)
+ * @return NXC_OK, or NXC_INVALID_ARGUMENT for unknown default ids
+ */
+NXC_API nxc_status nxc_engine_set_config(nxc_engine* engine, const nxc_config* config);
+
+/**
+ * @brief Get the id of a category name, adding the name if it is new
+ *
+ * Resolve names once and pass the ids in the batch columns, so batches carry no strings.
+ *
+ * @param engine Engine
+ * @param category Category table
+ * @param name Name, UTF-8
+ * @param id Receives the id
+ * @return NXC_OK or NXC_INVALID_ARGUMENT
+ */
+NXC_API nxc_status nxc_engine_category_id(nxc_engine* engine, nxc_category category, const char* name, int32_t* id);
+
+/**
+ * @brief Get the model version, which changes whenever a model is loaded or retrained
+ * @param engine Engine
+ * @param version Receives the version
+ * @return NXC_OK or NXC_INVALID_ARGUMENT
+ */
+NXC_API nxc_status nxc_engine_model_version(nxc_engine* engine, uint64_t* version);
+
+/**
+ * @brief Estimate cutting power, time, energy and emissions of a batch of operations
+ *
+ * Reads the input columns and writes the output columns in place; nothing is copied out
+ * of or allocated for the caller. Calls on one engine are serialized; use one engine per
+ * thread for parallel batches.
+ *
+ * @param engine Engine
+ * @param input Input columns
+ * @param output Output columns
+ * @param count Number of rows
+ * @param failed Receives the number of rows that failed (may be NULL)
+ * @return NXC_OK if the batch ran (individual rows may still have failed), or an error
+ */
+NXC_API nxc_status nxc_engine_estimate(nxc_engine* engine, const nxc_batch_input* input,
+                                       const nxc_batch_output* output, size_t count, size_t* failed);
+
+/**
+ * @brief Get a description of the last error on an engine
+ * @param engine Engine
+ * @return Text owned by the engine, valid until its next call; empty if there was none
+ */
+NXC_API const char* nxc_engine_last_error(const nxc_engine* engine);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CARBON_ENGINE_API_H */
\ No newline at end of file
@@ -13,7 +13,7 @@ CarbonModel::~CarbonModel() {
 }
 
 double CarbonModel::calculateCarbonEmission(double energy, double emissionFactor) {
-    double carbonEmission = energy * emissionFactor;
+    double carbonEmission = computeEmission(energy, emissionFactor);
     std::cout << "Calculated carbon emission: " << carbonEmission << " kg CO2 (energy: " 
               << energy << " kWh, factor: " << emissionFactor << " kg CO2/kWh)" << std::endl;
     return carbonEmission;
@@ -81,13 +81,13 @@ double CarbonModel::getEmissionFactorForGridType(const std::string& gridType) {
 }
 
 double CarbonModel::calculateCarbonPerOperation(double operationEnergy, double emissionFactor) {
-    double carbon = operationEnergy * emissionFactor;
+    double carbon = computeEmission(operationEnergy, emissionFactor);
     std::cout << "Calculated carbon per operation: " << carbon << " kg CO2" << std::endl;
     return carbon;
 }
 
 double CarbonModel::calculateCarbonPerPart(double totalEnergy, double emissionFactor) {
-    double carbon = totalEnergy * emissionFactor;
+    double carbon = computeEmission(totalEnergy, emissionFactor);
     std::cout << "Calculated carbon per part: " << carbon << " kg CO2" << std::endl;
     return carbon;
 }
\ No newline at end of file
@@ -50,6 +50,18 @@ public:
      * @return Carbon emissions for the part in kg CO2
      */
     double calculateCarbonPerPart(double totalEnergy, double emissionFactor);
+
+    /**
+     * @brief Emission formula, templated on the numeric type so that Dual numbers can
+     *        flow through it for sensitivity analysis; the methods above use the double version
+     * @param energy Energy in kWh
+     * @param emissionFactor Emission factor in kg CO2/kWh
+     * @return Carbon emissions in kg CO2
+     */
+    template <typename T>
+    static T computeEmission(const T& energy, const T& emissionFactor) {
+        return energy * emissionFactor;
+    }
 };
 
 #endif // CARBON_MODEL_H
\ No newline at end of file
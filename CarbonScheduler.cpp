@@ -0,0 +1,532 @@
+#include "CarbonScheduler.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <random>
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+// Moves must improve the cost by more than this (kg CO2) to be accepted
+const double improvementTolerance = 1e-9;
+
+// Start times tried per job and machine during list scheduling
+const double maxStartCandidates = 48.0;
+
+double millisecondsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+} // namespace
+
+// ScheduleMachine implementation
+ScheduleMachine::ScheduleMachine()
+    : idlePower(1.0), speedFactor(1.0), energyFactor(1.0), availableFrom(0.0), powerOffGap(60.0) {
+}
+
+ScheduleMachine::ScheduleMachine(const std::string& machineName, const EnergyModel& energyModel)
+    : name(machineName), idlePower(energyModel.getIdlePower()), speedFactor(1.0), energyFactor(1.0),
+      availableFrom(0.0), powerOffGap(60.0) {
+}
+
+// ScheduleJob implementation
+ScheduleJob::ScheduleJob()
+    : duration(0.0), energy(0.0), releaseTime(0.0), dueDate(std::numeric_limits<double>::infinity()),
+      tardinessWeight(0.1) {
+}
+
+ScheduleJob::ScheduleJob(const std::string& jobName, double durationMinutes, double energyKWh, double due)
+    : name(jobName), duration(durationMinutes), energy(energyKWh), releaseTime(0.0), dueDate(due),
+      tardinessWeight(0.1) {
+}
+
+// SchedulerOptions implementation
+SchedulerOptions::SchedulerOptions()
+    : lookAhead(720.0), maxIterations(2000000), stallLimit(200000), timeLimit(5.0), seed(1) {
+}
+
+// CarbonScheduler implementation
+CarbonScheduler::CarbonScheduler() : summary(), scheduled(false) {
+    std::cout << "CarbonScheduler initialized" << std::endl;
+}
+
+CarbonScheduler::~CarbonScheduler() {
+    std::cout << "CarbonScheduler destroyed" << std::endl;
+}
+
+void CarbonScheduler::setGridIntensity(const GridIntensity& intensity) {
+    grid = intensity;
+    scheduled = false;
+}
+
+void CarbonScheduler::setOptions(const SchedulerOptions& schedulerOptions) {
+    options = schedulerOptions;
+}
+
+int CarbonScheduler::addMachine(const ScheduleMachine& machine) {
+    machines.push_back(machine);
+    scheduled = false;
+    return static_cast<int>(machines.size() - 1);
+}
+
+int CarbonScheduler::addJob(const ScheduleJob& job) {
+    jobs.push_back(job);
+    scheduled = false;
+    return static_cast<int>(jobs.size() - 1);
+}
+
+void CarbonScheduler::clear() {
+    machines.clear();
+    jobs.clear();
+    jobStates.clear();
+    machineStates.clear();
+    scheduled = false;
+}
+
+bool CarbonScheduler::prepare() {
+    const std::size_t machineCount = machines.size();
+    if (machineCount == 0) {
+        std::cout << "Error: no machines to schedule on" << std::endl;
+        return false;
+    }
+
+    runTimes.assign(jobs.size() * machineCount, 0.0);
+    runPowers.assign(jobs.size() * machineCount, 0.0);
+    eligible.assign(jobs.size() * machineCount, 0);
+    candidateMachines.assign(jobs.size(), std::vector<int>());
+    for (std::size_t j = 0; j < jobs.size(); ++j) {
+        const ScheduleJob& job = jobs[j];
+        if (!(job.duration > 0.0) || job.energy < 0.0) {
+            std::cout << "Error: job " << job.name << " needs a positive duration and non-negative energy" << std::endl;
+            return false;
+        }
+        for (int m : job.machines) {
+            if (m < 0 || static_cast<std::size_t>(m) >= machineCount) {
+                std::cout << "Error: job " << job.name << " refers to unknown machine " << m << std::endl;
+                return false;
+            }
+            eligible[j * machineCount + m] = 1;
+        }
+        for (std::size_t m = 0; m < machineCount; ++m) {
+            std::size_t cell = j * machineCount + m;
+            if (job.machines.empty()) {
+                eligible[cell] = 1;
+            }
+            if (eligible[cell]) {
+                candidateMachines[j].push_back(static_cast<int>(m));
+            }
+            runTimes[cell] = job.duration * machines[m].speedFactor;
+            runPowers[cell] = job.energy * machines[m].energyFactor / runTimes[cell] * 60.0;
+        }
+        if (candidateMachines[j].empty()) {
+            std::cout << "Error: job " << job.name << " has no eligible machine" << std::endl;
+            return false;
+        }
+    }
+
+    jobStates.assign(jobs.size(), JobState());
+    machineStates.assign(machineCount, MachineState());
+    for (MachineState& state : machineStates) {
+        state.prefix.push_back(0.0);
+    }
+    return true;
+}
+
+double CarbonScheduler::jobCost(int job, int machine, double start, double gapStart) const {
+    const std::size_t cell = static_cast<std::size_t>(job) * machines.size() + machine;
+    const double end = start + runTimes[cell];
+    double cost = grid.emissions(runPowers[cell], start, end);
+    const ScheduleMachine& m = machines[machine];
+    if (start > gapStart && start - gapStart < m.powerOffGap) {
+        cost += grid.emissions(m.idlePower, gapStart, start);
+    }
+    const double late = end - jobs[job].dueDate;
+    if (late > 0.0) {
+        cost += jobs[job].tardinessWeight * late;
+    }
+    return cost;
+}
+
+double CarbonScheduler::machineTotal(int machine) const {
+    return machineStates[machine].prefix.back();
+}
+
+double CarbonScheduler::evaluateMachine(int machine, std::size_t fromPosition, std::size_t convergeFrom) {
+    // The sequence is already modified; positions before fromPosition and the committed
+    // prefix sums are unchanged, so only the jobs whose timing changes are re-costed
+    const MachineState& state = machineStates[machine];
+    const std::vector<int>& sequence = state.sequence;
+    double total = state.prefix[fromPosition];
+    double previousEnd = fromPosition == 0 ? machines[machine].availableFrom
+                                           : jobStates[sequence[fromPosition - 1]].end;
+
+    for (std::size_t position = fromPosition; position < sequence.size(); ++position) {
+        const int job = sequence[position];
+        const JobState& committed = jobStates[job];
+        const double start = std::max(std::max(previousEnd, jobs[job].releaseTime), committed.requestedStart);
+        const double gapStart = position == 0 ? start : previousEnd;
+
+        if (position >= convergeFrom && committed.machine == machine &&
+            committed.start == start && committed.gapStart == gapStart) {
+            // Timing matches the committed schedule again: the rest is unchanged
+            return total + (machineTotal(machine) - state.prefix[committed.position]);
+        }
+
+        TrialJob entry;
+        entry.job = job;
+        entry.machine = machine;
+        entry.position = position;
+        entry.start = start;
+        entry.gapStart = gapStart;
+        entry.end = start + runTimes[static_cast<std::size_t>(job) * machines.size() + machine];
+        entry.cost = jobCost(job, machine, start, gapStart);
+        trial.push_back(entry);
+        total += entry.cost;
+        previousEnd = entry.end;
+    }
+    return total;
+}
+
+void CarbonScheduler::applyTrial() {
+    for (const TrialJob& entry : trial) {
+        JobState& state = jobStates[entry.job];
+        state.machine = entry.machine;
+        state.start = entry.start;
+        state.gapStart = entry.gapStart;
+        state.end = entry.end;
+        state.cost = entry.cost;
+    }
+    trial.clear();
+}
+
+void CarbonScheduler::rebuildMachine(int machine, std::size_t fromPosition) {
+    MachineState& state = machineStates[machine];
+    state.prefix.resize(state.sequence.size() + 1);
+    for (std::size_t position = fromPosition; position < state.sequence.size(); ++position) {
+        JobState& job = jobStates[state.sequence[position]];
+        job.position = position;
+        state.prefix[position + 1] = state.prefix[position] + job.cost;
+    }
+}
+
+void CarbonScheduler::listSchedule() {
+    // Earliest due date first. Each job goes to the machine where it can finish first,
+    // which keeps the load balanced, then to the cheapest start within its window there
+    std::vector<int> order(jobs.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [this](int a, int b) {
+        return jobs[a].dueDate < jobs[b].dueDate;
+    });
+
+    const double step = std::max(grid.getInterval(), options.lookAhead / maxStartCandidates);
+    for (int job : order) {
+        int machine = -1;
+        double earliest = 0.0;
+        double bestFinish = std::numeric_limits<double>::infinity();
+        for (int candidate : candidateMachines[job]) {
+            const MachineState& state = machineStates[candidate];
+            const double previousEnd = state.sequence.empty() ? machines[candidate].availableFrom
+                                                              : jobStates[state.sequence.back()].end;
+            const double start = std::max(previousEnd, jobs[job].releaseTime);
+            const double finish = start + runTimes[static_cast<std::size_t>(job) * machines.size() + candidate];
+            if (finish < bestFinish) {
+                bestFinish = finish;
+                machine = candidate;
+                earliest = start;
+            }
+        }
+
+        MachineState& state = machineStates[machine];
+        const double runTime = runTimes[static_cast<std::size_t>(job) * machines.size() + machine];
+        const bool first = state.sequence.empty();
+        const double previousEnd = first ? earliest : jobStates[state.sequence.back()].end;
+        // Delays only pay off if the job still finishes on time; later jobs need the capacity
+        const double latest = std::max(earliest, std::min(earliest + options.lookAhead,
+                                                          jobs[job].dueDate - runTime));
+        double bestCost = std::numeric_limits<double>::infinity();
+        double bestStart = earliest;
+        // Candidate starts: as early as possible, then interval boundaries within the window
+        for (double start = earliest; start <= latest;
+             start = (start == earliest ? grid.nextBoundary(earliest) : start + step)) {
+            const double cost = jobCost(job, machine, start, first ? start : previousEnd);
+            if (cost < bestCost) {
+                bestCost = cost;
+                bestStart = start;
+            }
+        }
+
+        JobState& placed = jobStates[job];
+        placed.machine = machine;
+        placed.position = state.sequence.size();
+        placed.requestedStart = bestStart > earliest ? bestStart : 0.0;
+        placed.start = bestStart;
+        placed.gapStart = first ? bestStart : previousEnd;
+        placed.end = bestStart + runTime;
+        placed.cost = bestCost;
+        state.sequence.push_back(job);
+        state.prefix.push_back(state.prefix.back() + bestCost);
+    }
+}
+
+bool CarbonScheduler::tryRelocate(int job, int machine, std::size_t position) {
+    const int source = jobStates[job].machine;
+    const std::size_t sourcePosition = jobStates[job].position;
+    std::vector<int>& from = machineStates[source].sequence;
+    std::vector<int>& to = machineStates[machine].sequence;
+    trial.clear();
+
+    if (source == machine) {
+        if (position == sourcePosition) {
+            return false;
+        }
+        const double before = machineTotal(machine);
+        from.erase(from.begin() + sourcePosition);
+        from.insert(from.begin() + position, job);
+        const std::size_t first = std::min(sourcePosition, position);
+        const double after = evaluateMachine(machine, first, std::max(sourcePosition, position) + 1);
+        if (after - before < -improvementTolerance) {
+            applyTrial();
+            rebuildMachine(machine, first);
+            return true;
+        }
+        from.erase(from.begin() + position);
+        from.insert(from.begin() + sourcePosition, job);
+        return false;
+    }
+
+    const double before = machineTotal(source) + machineTotal(machine);
+    from.erase(from.begin() + sourcePosition);
+    to.insert(to.begin() + position, job);
+    const double after = evaluateMachine(source, sourcePosition, sourcePosition)
+                       + evaluateMachine(machine, position, position + 1);
+    if (after - before < -improvementTolerance) {
+        applyTrial();
+        rebuildMachine(source, sourcePosition);
+        rebuildMachine(machine, position);
+        return true;
+    }
+    to.erase(to.begin() + position);
+    from.insert(from.begin() + sourcePosition, job);
+    return false;
+}
+
+bool CarbonScheduler::trySwap(int first, int second) {
+    const int firstMachine = jobStates[first].machine;
+    const int secondMachine = jobStates[second].machine;
+    const std::size_t machineCount = machines.size();
+    if (!eligible[static_cast<std::size_t>(first) * machineCount + secondMachine] ||
+        !eligible[static_cast<std::size_t>(second) * machineCount + firstMachine]) {
+        return false;
+    }
+    const std::size_t firstPosition = jobStates[first].position;
+    const std::size_t secondPosition = jobStates[second].position;
+    std::vector<int>& firstSequence = machineStates[firstMachine].sequence;
+    std::vector<int>& secondSequence = machineStates[secondMachine].sequence;
+    trial.clear();
+
+    double before = 0.0;
+    double after = 0.0;
+    firstSequence[firstPosition] = second;
+    secondSequence[secondPosition] = first;
+    if (firstMachine == secondMachine) {
+        before = machineTotal(firstMachine);
+        after = evaluateMachine(firstMachine, std::min(firstPosition, secondPosition),
+                                std::max(firstPosition, secondPosition) + 1);
+    } else {
+        before = machineTotal(firstMachine) + machineTotal(secondMachine);
+        after = evaluateMachine(firstMachine, firstPosition, firstPosition + 1)
+              + evaluateMachine(secondMachine, secondPosition, secondPosition + 1);
+    }
+
+    if (after - before < -improvementTolerance) {
+        applyTrial();
+        if (firstMachine == secondMachine) {
+            rebuildMachine(firstMachine, std::min(firstPosition, secondPosition));
+        } else {
+            rebuildMachine(firstMachine, firstPosition);
+            rebuildMachine(secondMachine, secondPosition);
+        }
+        return true;
+    }
+    firstSequence[firstPosition] = first;
+    secondSequence[secondPosition] = second;
+    return false;
+}
+
+bool CarbonScheduler::tryRetime(int job, double requestedStart) {
+    JobState& state = jobStates[job];
+    const double previous = state.requestedStart;
+    if (requestedStart == previous) {
+        return false;
+    }
+    trial.clear();
+    state.requestedStart = requestedStart;
+    const double before = machineTotal(state.machine);
+    const double after = evaluateMachine(state.machine, state.position, state.position + 1);
+    if (after - before < -improvementTolerance) {
+        const int machine = state.machine;
+        const std::size_t position = state.position;
+        applyTrial();
+        rebuildMachine(machine, position);
+        return true;
+    }
+    state.requestedStart = previous;
+    return false;
+}
+
+void CarbonScheduler::localSearch() {
+    std::mt19937_64 generator(options.seed);
+    const Clock::time_point start = Clock::now();
+    const std::size_t jobCount = jobs.size();
+    const double step = std::max(grid.getInterval(), options.lookAhead / maxStartCandidates);
+    const std::uint64_t retimeSlots = static_cast<std::uint64_t>(options.lookAhead / step) + 1;
+
+    std::size_t sinceImprovement = 0;
+    for (std::size_t iteration = 0; iteration < options.maxIterations; ++iteration) {
+        if ((iteration & 1023) == 0 && millisecondsSince(start) > options.timeLimit * 1000.0) {
+            break;
+        }
+        if (options.stallLimit > 0 && sinceImprovement >= options.stallLimit) {
+            break;
+        }
+        ++summary.iterations;
+        const int job = static_cast<int>(generator() % jobCount);
+        const std::uint64_t move = generator() % 10;
+        bool improved = false;
+
+        if (move < 4) {
+            // Relocate to a random position on a random eligible machine
+            const std::vector<int>& candidates = candidateMachines[job];
+            const int machine = candidates[generator() % candidates.size()];
+            std::size_t slots = machineStates[machine].sequence.size();
+            if (machine != jobStates[job].machine) {
+                ++slots;
+            }
+            improved = tryRelocate(job, machine, static_cast<std::size_t>(generator() % slots));
+        } else if (move < 7) {
+            const int other = static_cast<int>(generator() % jobCount);
+            improved = other != job && trySwap(job, other);
+        } else {
+            // Retime: as early as possible, or an interval boundary within the look-ahead
+            const JobState& state = jobStates[job];
+            const std::vector<int>& sequence = machineStates[state.machine].sequence;
+            const double previousEnd = state.position == 0 ? machines[state.machine].availableFrom
+                                                           : jobStates[sequence[state.position - 1]].end;
+            const double earliest = std::max(previousEnd, jobs[job].releaseTime);
+            const std::uint64_t slot = generator() % (retimeSlots + 1);
+            const double requested = slot == 0 ? 0.0
+                                   : grid.nextBoundary(earliest) + static_cast<double>(slot - 1) * step;
+            improved = tryRetime(job, requested);
+        }
+        if (improved) {
+            ++summary.improvements;
+            sinceImprovement = 0;
+        } else {
+            ++sinceImprovement;
+        }
+    }
+}
+
+bool CarbonScheduler::schedule() {
+    scheduled = false;
+    summary = ScheduleSummary();
+    if (!prepare()) {
+        return false;
+    }
+
+    Clock::time_point phase = Clock::now();
+    listSchedule();
+    summary.listMilliseconds = millisecondsSince(phase);
+    for (std::size_t m = 0; m < machines.size(); ++m) {
+        summary.initialCost += machineTotal(static_cast<int>(m));
+    }
+
+    phase = Clock::now();
+    if (!jobs.empty()) {
+        localSearch();
+    }
+    summary.searchMilliseconds = millisecondsSince(phase);
+
+    updateSummary();
+    scheduled = true;
+    return true;
+}
+
+void CarbonScheduler::updateSummary() {
+    summary.processingEmissions = 0.0;
+    summary.idleEmissions = 0.0;
+    summary.tardinessPenalty = 0.0;
+    summary.totalTardiness = 0.0;
+    summary.lateJobs = 0;
+    summary.makespan = 0.0;
+    for (std::size_t j = 0; j < jobs.size(); ++j) {
+        const JobState& state = jobStates[j];
+        const ScheduleMachine& machine = machines[state.machine];
+        summary.processingEmissions += grid.emissions(runPowers[j * machines.size() + state.machine],
+                                                      state.start, state.end);
+        if (state.start > state.gapStart && state.start - state.gapStart < machine.powerOffGap) {
+            summary.idleEmissions += grid.emissions(machine.idlePower, state.gapStart, state.start);
+        }
+        const double late = state.end - jobs[j].dueDate;
+        if (late > 0.0) {
+            summary.totalTardiness += late;
+            summary.tardinessPenalty += jobs[j].tardinessWeight * late;
+            ++summary.lateJobs;
+        }
+        summary.makespan = std::max(summary.makespan, state.end);
+    }
+    summary.totalCost = summary.processingEmissions + summary.idleEmissions + summary.tardinessPenalty;
+}
+
+ScheduledJob CarbonScheduler::getAssignment(int job) const {
+    ScheduledJob assignment;
+    assignment.machine = -1;
+    assignment.start = 0.0;
+    assignment.end = 0.0;
+    if (scheduled && job >= 0 && static_cast<std::size_t>(job) < jobStates.size()) {
+        assignment.machine = jobStates[job].machine;
+        assignment.start = jobStates[job].start;
+        assignment.end = jobStates[job].end;
+    }
+    return assignment;
+}
+
+const std::vector<int>& CarbonScheduler::getMachineSequence(int machine) const {
+    return machineStates[machine].sequence;
+}
+
+const ScheduleSummary& CarbonScheduler::getSummary() const {
+    return summary;
+}
+
+double CarbonScheduler::recomputeCost() const {
+    double total = 0.0;
+    for (std::size_t m = 0; m < machineStates.size(); ++m) {
+        const std::vector<int>& sequence = machineStates[m].sequence;
+        double previousEnd = machines[m].availableFrom;
+        for (std::size_t position = 0; position < sequence.size(); ++position) {
+            const int job = sequence[position];
+            const double start = std::max(std::max(previousEnd, jobs[job].releaseTime),
+                                          jobStates[job].requestedStart);
+            total += jobCost(job, static_cast<int>(m), start, position == 0 ? start : previousEnd);
+            previousEnd = start + runTimes[static_cast<std::size_t>(job) * machines.size() + m];
+        }
+    }
+    return total;
+}
+
+void CarbonScheduler::printSummary() const {
+    std::cout << "Schedule: " << jobs.size() << " jobs on " << machines.size() << " machines" << std::endl;
+    std::cout << "Processing emissions: " << summary.processingEmissions << " kg CO2" << std::endl;
+    std::cout << "Idle emissions: " << summary.idleEmissions << " kg CO2" << std::endl;
+    std::cout << "Tardiness: " << summary.totalTardiness << " min over " << summary.lateJobs
+              << " late jobs (penalty " << summary.tardinessPenalty << ")" << std::endl;
+    std::cout << "Total cost: " << summary.totalCost << " (list scheduling: " << summary.initialCost << ")" << std::endl;
+    std::cout << "Makespan: " << summary.makespan << " min" << std::endl;
+    std::cout << "Local search: " << summary.improvements << " of " << summary.iterations
+              << " moves accepted, " << summary.searchMilliseconds << " ms (list scheduling "
+              << summary.listMilliseconds << " ms)" << std::endl;
+}
\ No newline at end of file
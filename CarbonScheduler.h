@@ -0,0 +1,243 @@
+#ifndef CARBON_SCHEDULER_H
+#define CARBON_SCHEDULER_H
+
+#include "GridIntensity.h"
+#include "EnergyModel.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Machine available to the scheduler
+ */
+struct ScheduleMachine {
+    std::string name;
+    double idlePower;       // kW while powered on between jobs
+    double speedFactor;     // processing time multiplier (1 = nominal)
+    double energyFactor;    // processing energy multiplier (1 = nominal)
+    double availableFrom;   // minutes
+    double powerOffGap;     // gaps at least this long (minutes) are spent switched off
+
+    ScheduleMachine();
+
+    /**
+     * @brief Machine using the idle power of an energy model
+     * @param machineName Machine name
+     * @param energyModel Power values of the machine
+     */
+    ScheduleMachine(const std::string& machineName, const EnergyModel& energyModel);
+};
+
+/**
+ * @brief Queued part program
+ */
+struct ScheduleJob {
+    std::string name;
+    double duration;            // minutes on a machine with speed factor 1
+    double energy;              // kWh on a machine with energy factor 1 (average power = energy / duration)
+    double releaseTime;         // earliest start in minutes
+    double dueDate;             // minutes
+    double tardinessWeight;     // kg CO2 equivalent per minute late
+    std::vector<int> machines;  // eligible machine indices (empty = any machine)
+
+    ScheduleJob();
+
+    /**
+     * @brief Job eligible for any machine, released at time 0
+     * @param jobName Job name
+     * @param durationMinutes Processing time in minutes
+     * @param energyKWh Processing energy in kWh
+     * @param due Due date in minutes
+     */
+    ScheduleJob(const std::string& jobName, double durationMinutes, double energyKWh, double due);
+};
+
+/**
+ * @brief Scheduler settings
+ */
+struct SchedulerOptions {
+    double lookAhead;           // how far a job may be delayed past its earliest start, in minutes
+    std::size_t maxIterations;  // local search moves to try
+    std::size_t stallLimit;     // stop after this many moves without improvement (0 = never)
+    double timeLimit;           // local search wall clock limit in seconds
+    std::uint64_t seed;         // seed of the local search
+
+    SchedulerOptions();
+};
+
+/**
+ * @brief Placement of one job
+ */
+struct ScheduledJob {
+    int machine;
+    double start;   // minutes
+    double end;     // minutes
+};
+
+/**
+ * @brief Cost breakdown and statistics of a schedule
+ */
+struct ScheduleSummary {
+    double processingEmissions; // kg CO2
+    double idleEmissions;       // kg CO2
+    double tardinessPenalty;    // kg CO2 equivalent
+    double totalCost;           // sum of the above
+    double initialCost;         // after list scheduling, before local search
+    double totalTardiness;      // minutes
+    std::size_t lateJobs;
+    double makespan;            // minutes
+    std::size_t iterations;     // local search moves evaluated
+    std::size_t improvements;   // local search moves accepted
+    double listMilliseconds;
+    double searchMilliseconds;
+};
+
+/**
+ * @brief Carbon-aware assignment of queued jobs to machines and start times
+ *
+ * Minimizes processing emissions under a time-varying grid intensity, plus the
+ * emissions of machines idling between jobs and a tardiness penalty. An initial
+ * schedule is built by list scheduling in due date order, each job going to the
+ * machine and start time (within the look-ahead window) with the lowest added
+ * cost; seeded local search then relocates, swaps and retimes jobs.
+ *
+ * Each job stores a requested start; its actual start is the latest of that, its
+ * release time and the end of its predecessor. A move is evaluated by re-timing
+ * only the affected machines from the first changed position until the start
+ * times match the committed schedule again; the untouched prefix and suffix of
+ * each machine's cost come from stored prefix sums. This keeps a move at a few
+ * jobs' worth of work, so thousands of jobs on dozens of machines are scheduled
+ * in seconds.
+ */
+class CarbonScheduler {
+private:
+    struct JobState {
+        int machine;
+        std::size_t position;
+        double requestedStart;  // 0 = as early as possible
+        double start;
+        double gapStart;        // end of the predecessor (= start for the first job on a machine)
+        double end;
+        double cost;
+    };
+
+    struct MachineState {
+        std::vector<int> sequence;
+        std::vector<double> prefix;     // prefix[k] = cost of the first k jobs
+    };
+
+    struct TrialJob {
+        int job;
+        int machine;
+        std::size_t position;
+        double start;
+        double gapStart;
+        double end;
+        double cost;
+    };
+
+    GridIntensity grid;
+    SchedulerOptions options;
+    std::vector<ScheduleMachine> machines;
+    std::vector<ScheduleJob> jobs;
+    std::vector<JobState> jobStates;
+    std::vector<MachineState> machineStates;
+    std::vector<double> runTimes;       // job x machine
+    std::vector<double> runPowers;      // job x machine, kW
+    std::vector<char> eligible;         // job x machine
+    std::vector<std::vector<int>> candidateMachines;    // eligible machines per job
+    std::vector<TrialJob> trial;
+    ScheduleSummary summary;
+    bool scheduled;
+
+    bool prepare();
+    double jobCost(int job, int machine, double start, double gapStart) const;
+    double machineTotal(int machine) const;
+    double evaluateMachine(int machine, std::size_t fromPosition, std::size_t convergeFrom);
+    void applyTrial();
+    void rebuildMachine(int machine, std::size_t fromPosition);
+    void listSchedule();
+    void localSearch();
+    bool tryRelocate(int job, int machine, std::size_t position);
+    bool trySwap(int first, int second);
+    bool tryRetime(int job, double requestedStart);
+    void updateSummary();
+
+public:
+    CarbonScheduler();
+    ~CarbonScheduler();
+
+    /**
+     * @brief Set the grid carbon intensity
+     * @param intensity Intensity over the scheduling horizon
+     */
+    void setGridIntensity(const GridIntensity& intensity);
+
+    /**
+     * @brief Set the scheduler options
+     * @param schedulerOptions New options
+     */
+    void setOptions(const SchedulerOptions& schedulerOptions);
+
+    /**
+     * @brief Add a machine
+     * @param machine Machine parameters
+     * @return Machine index
+     */
+    int addMachine(const ScheduleMachine& machine);
+
+    /**
+     * @brief Add a job to the queue
+     * @param job Job parameters
+     * @return Job index
+     */
+    int addJob(const ScheduleJob& job);
+
+    /**
+     * @brief Remove all jobs and machines
+     */
+    void clear();
+
+    /**
+     * @brief Build the schedule
+     * @return True on success; false if a job cannot run on any machine or has invalid parameters
+     */
+    bool schedule();
+
+    /**
+     * @brief Get the placement of a job
+     * @param job Job index
+     * @return Machine and time window of the job
+     */
+    ScheduledJob getAssignment(int job) const;
+
+    /**
+     * @brief Get the jobs of a machine in processing order
+     * @param machine Machine index
+     * @return Job indices
+     */
+    const std::vector<int>& getMachineSequence(int machine) const;
+
+    /**
+     * @brief Get the cost breakdown of the current schedule
+     * @return Summary
+     */
+    const ScheduleSummary& getSummary() const;
+
+    /**
+     * @brief Recompute the cost of the current schedule from scratch
+     *
+     * Used to validate the incremental bookkeeping.
+     *
+     * @return Total cost
+     */
+    double recomputeCost() const;
+
+    /**
+     * @brief Print the cost breakdown and search statistics
+     */
+    void printSummary() const;
+};
+
+#endif // CARBON_SCHEDULER_H
\ No newline at end of file
@@ -0,0 +1,151 @@
+#ifndef DUAL_H
+#define DUAL_H
+
+#include <cmath>
+#include <cstddef>
+
+/**
+ * @brief Dual number for forward-mode automatic differentiation
+ *
+ * Carries a value and its partial derivatives with respect to N seeded input
+ * variables. Model formulas templated on the numeric type evaluate to the value
+ * and the full gradient in a single pass when instantiated with Dual<N>.
+ */
+template <std::size_t N>
+class Dual {
+public:
+    double value;
+    double gradient[N];
+
+    Dual() : value(0.0), gradient() {
+    }
+
+    /**
+     * @brief Constant (all derivatives zero)
+     * @param constant Value
+     */
+    Dual(double constant) : value(constant), gradient() {
+    }
+
+    /**
+     * @brief Input variable with a unit derivative with respect to itself
+     * @param v Value of the variable
+     * @param index Index of the variable in the gradient
+     * @return Seeded dual number
+     */
+    static Dual variable(double v, std::size_t index) {
+        Dual result(v);
+        result.gradient[index] = 1.0;
+        return result;
+    }
+
+    Dual& operator+=(const Dual& other) {
+        value += other.value;
+        for (std::size_t i = 0; i < N; ++i) gradient[i] += other.gradient[i];
+        return *this;
+    }
+
+    Dual& operator-=(const Dual& other) {
+        value -= other.value;
+        for (std::size_t i = 0; i < N; ++i) gradient[i] -= other.gradient[i];
+        return *this;
+    }
+
+    Dual& operator*=(const Dual& other) {
+        for (std::size_t i = 0; i < N; ++i) gradient[i] = gradient[i] * other.value + value * other.gradient[i];
+        value *= other.value;
+        return *this;
+    }
+
+    Dual& operator/=(const Dual& other) {
+        const double inverse = 1.0 / other.value;
+        for (std::size_t i = 0; i < N; ++i) {
+            gradient[i] = (gradient[i] - value * inverse * other.gradient[i]) * inverse;
+        }
+        value /= other.value;
+        return *this;
+    }
+
+    Dual& operator+=(double constant) {
+        value += constant;
+        return *this;
+    }
+
+    Dual& operator-=(double constant) {
+        value -= constant;
+        return *this;
+    }
+
+    Dual& operator*=(double constant) {
+        value *= constant;
+        for (std::size_t i = 0; i < N; ++i) gradient[i] *= constant;
+        return *this;
+    }
+
+    Dual& operator/=(double constant) {
+        value /= constant;
+        for (std::size_t i = 0; i < N; ++i) gradient[i] /= constant;
+        return *this;
+    }
+};
+
+template <std::size_t N>
+Dual<N> operator-(const Dual<N>& a) {
+    Dual<N> result(a);
+    result *= -1.0;
+    return result;
+}
+
+template <std::size_t N>
+Dual<N> operator+(Dual<N> a, const Dual<N>& b) { return a += b; }
+template <std::size_t N>
+Dual<N> operator-(Dual<N> a, const Dual<N>& b) { return a -= b; }
+template <std::size_t N>
+Dual<N> operator*(Dual<N> a, const Dual<N>& b) { return a *= b; }
+template <std::size_t N>
+Dual<N> operator/(Dual<N> a, const Dual<N>& b) { return a /= b; }
+
+template <std::size_t N>
+Dual<N> operator+(Dual<N> a, double b) { return a += b; }
+template <std::size_t N>
+Dual<N> operator-(Dual<N> a, double b) { return a -= b; }
+template <std::size_t N>
+Dual<N> operator*(Dual<N> a, double b) { return a *= b; }
+template <std::size_t N>
+Dual<N> operator/(Dual<N> a, double b) { return a /= b; }
+
+template <std::size_t N>
+Dual<N> operator+(double a, Dual<N> b) { return b += a; }
+template <std::size_t N>
+Dual<N> operator-(double a, const Dual<N>& b) { return Dual<N>(a) -= b; }
+template <std::size_t N>
+Dual<N> operator*(double a, Dual<N> b) { return b *= a; }
+template <std::size_t N>
+Dual<N> operator/(double a, const Dual<N>& b) { return Dual<N>(a) /= b; }
+
+template <std::size_t N>
+bool operator<(const Dual<N>& a, const Dual<N>& b) { return a.value < b.value; }
+template <std::size_t N>
+bool operator>(const Dual<N>& a, const Dual<N>& b) { return a.value > b.value; }
+
+template <std::size_t N>
+Dual<N> sqrt(const Dual<N>& a) {
+    Dual<N> result(std::sqrt(a.value));
+    const double scale = 0.5 / result.value;
+    for (std::size_t i = 0; i < N; ++i) result.gradient[i] = a.gradient[i] * scale;
+    return result;
+}
+
+/**
+ * @brief Get the value of a plain or dual number
+ */
+inline double valueOf(double x) {
+    return x;
+}
+
+template <std::size_t N>
+double valueOf(const Dual<N>& x) {
+    return x.value;
+}
+
+#endif // DUAL_H
\ No newline at end of file
@@ -15,7 +15,7 @@ EnergyModel::~EnergyModel() {
 
 double EnergyModel::calculateCuttingEnergy(double cuttingTime, double power) {
     double p = (power >= 0) ? power : cuttingPower;
-    double energy = (cuttingTime / 60.0) * p;  // Convert minutes to hours
+    double energy = computeEnergy(cuttingTime, p);
     std::cout << "Calculated cutting energy: " << energy << " kWh (time: " << cuttingTime 
               << " min, power: " << p << " kW)" << std::endl;
     return energy;
@@ -23,7 +23,7 @@ double EnergyModel::calculateCuttingEnergy(double cuttingTime, double power) {
 
 double EnergyModel::calculateRapidEnergy(double rapidTime, double power) {
     double p = (power >= 0) ? power : rapidPower;
-    double energy = (rapidTime / 60.0) * p;  // Convert minutes to hours
+    double energy = computeEnergy(rapidTime, p);
     std::cout << "Calculated rapid energy: " << energy << " kWh (time: " << rapidTime 
               << " min, power: " << p << " kW)" << std::endl;
     return energy;
@@ -31,14 +31,14 @@ double EnergyModel::calculateRapidEnergy(double rapidTime, double power) {
 
 double EnergyModel::calculateIdleEnergy(double idleTime, double power) {
     double p = (power >= 0) ? power : idlePower;
-    double energy = (idleTime / 60.0) * p;  // Convert minutes to hours
+    double energy = computeEnergy(idleTime, p);
     std::cout << "Calculated idle energy: " << energy << " kWh (time: " << idleTime 
               << " min, power: " << p << " kW)" << std::endl;
     return energy;
 }
 
 double EnergyModel::calculateTotalEnergy(double cuttingEnergy, double rapidEnergy, double idleEnergy) {
-    double totalEnergy = cuttingEnergy + rapidEnergy + idleEnergy;
+    double totalEnergy = computeTotalEnergy(cuttingEnergy, rapidEnergy, idleEnergy);
     std::cout << "Total energy calculated: " << totalEnergy << " kWh" << std::endl;
     return totalEnergy;
 }
@@ -84,6 +84,32 @@ public:
      * @return Idle power in kW
      */
     double getIdlePower() const;
+
+    // Model formulas, templated on the numeric type so that Dual numbers can flow
+    // through them for sensitivity analysis; the methods above use the double versions
+
+    /**
+     * @brief Energy of a phase at constant power
+     * @param time Phase time in minutes
+     * @param power Power in kW
+     * @return Energy in kWh
+     */
+    template <typename T>
+    static T computeEnergy(const T& time, const T& power) {
+        return (time / 60.0) * power;  // Convert minutes to hours
+    }
+
+    /**
+     * @brief Total energy formula
+     * @param cuttingEnergy Cutting energy in kWh
+     * @param rapidEnergy Rapid energy in kWh
+     * @param idleEnergy Idle energy in kWh
+     * @return Total energy in kWh
+     */
+    template <typename T>
+    static T computeTotalEnergy(const T& cuttingEnergy, const T& rapidEnergy, const T& idleEnergy) {
+        return cuttingEnergy + rapidEnergy + idleEnergy;
+    }
 };
 
 #endif // ENERGY_MODEL_H
\ No newline at end of file
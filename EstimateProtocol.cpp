@@ -0,0 +1,80 @@
+#include "EstimateProtocol.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+static_assert(sizeof(EstimateFrameHeader) == 12, "EstimateFrameHeader must match the wire layout");
+static_assert(sizeof(EstimateRequestFields) == 48, "EstimateRequestFields must match the wire layout");
+static_assert(sizeof(EstimateResult) == 32, "EstimateResult must match the wire layout");
+
+namespace {
+
+void appendName(std::vector<char>& out, const std::string& name) {
+    std::size_t length = std::min(name.size(), EstimateMaxNameLength);
+    out.push_back(static_cast<char>(static_cast<unsigned char>(length)));
+    out.insert(out.end(), name.data(), name.data() + length);
+}
+
+bool readName(const char*& cursor, const char* end, std::string& name) {
+    if (cursor >= end) {
+        return false;
+    }
+    std::size_t length = static_cast<unsigned char>(*cursor++);
+    if (static_cast<std::size_t>(end - cursor) < length) {
+        return false;
+    }
+    name.assign(cursor, length);
+    cursor += length;
+    return true;
+}
+
+} // namespace
+
+void EstimateCodec::appendRequest(std::vector<char>& out, std::uint32_t requestId, const EstimateQuery& query) {
+    std::size_t start = out.size();
+    EstimateFrameHeader header = {0, static_cast<std::uint16_t>(EstimateMessageType::EstimateRequest), 0, requestId};
+    out.resize(start + EstimateHeaderSize + sizeof(EstimateRequestFields));
+    std::memcpy(&out[start + EstimateHeaderSize], &query.fields, sizeof(EstimateRequestFields));
+    appendName(out, query.material);
+    appendName(out, query.operationType);
+    appendName(out, query.machineType);
+    header.length = static_cast<std::uint32_t>(out.size() - start - EstimateHeaderSize);
+    std::memcpy(&out[start], &header, EstimateHeaderSize);
+}
+
+void EstimateCodec::appendFrame(std::vector<char>& out, EstimateMessageType type, EstimateStatus status,
+                                std::uint32_t requestId, const void* payload, std::size_t length) {
+    EstimateFrameHeader header = {static_cast<std::uint32_t>(length), static_cast<std::uint16_t>(type),
+                                  static_cast<std::uint16_t>(status), requestId};
+    std::size_t start = out.size();
+    out.resize(start + EstimateHeaderSize + length);
+    std::memcpy(&out[start], &header, EstimateHeaderSize);
+    if (length > 0) {
+        std::memcpy(&out[start + EstimateHeaderSize], payload, length);
+    }
+}
+
+bool EstimateCodec::decodeRequest(const char* payload, std::size_t length, EstimateQuery& query) {
+    if (length < sizeof(EstimateRequestFields)) {
+        return false;
+    }
+    std::memcpy(&query.fields, payload, sizeof(EstimateRequestFields));
+    const EstimateRequestFields& f = query.fields;
+    if (!std::isfinite(f.toolDiameter) || !std::isfinite(f.spindleSpeed) || !std::isfinite(f.feedRate)
+        || !std::isfinite(f.depthOfCut) || !std::isfinite(f.cuttingTime) || !std::isfinite(f.emissionFactor)
+        || f.cuttingTime < 0.0) {
+        return false;
+    }
+    const char* cursor = payload + sizeof(EstimateRequestFields);
+    const char* end = payload + length;
+    return readName(cursor, end, query.material)
+        && readName(cursor, end, query.operationType)
+        && readName(cursor, end, query.machineType)
+        && cursor == end;
+}
+
+EstimateFrameHeader EstimateCodec::readHeader(const char* data) {
+    EstimateFrameHeader header;
+    std::memcpy(&header, data, EstimateHeaderSize);
+    return header;
+}
\ No newline at end of file
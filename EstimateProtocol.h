@@ -0,0 +1,129 @@
+#ifndef ESTIMATE_PROTOCOL_H
+#define ESTIMATE_PROTOCOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Wire protocol of the nxcarbond estimation daemon (native endianness, the socket is local).
+// Every message is a frame: EstimateFrameHeader followed by `length` payload bytes.
+//   EstimateRequest   payload: EstimateRequestFields, then material, operation type and
+//                              machine type, each as [uint8 length][characters]
+//   EstimateResponse  payload: EstimateResult (omitted when the status is not Ok)
+//   MetricsRequest    payload: none
+//   MetricsResponse   payload: metrics text, one "name value" line per metric
+// Responses carry the request id of their request and may arrive out of order.
+
+/**
+ * @brief Message types of the estimation protocol
+ */
+enum class EstimateMessageType : std::uint16_t {
+    EstimateRequest = 1,
+    EstimateResponse = 2,
+    MetricsRequest = 3,
+    MetricsResponse = 4
+};
+
+/**
+ * @brief Status of a response
+ */
+enum class EstimateStatus : std::uint16_t {
+    Ok = 0,
+    Malformed = 1,          // request could not be decoded, or names a category the server will not add
+    UnknownMessage = 2,     // unsupported message type
+    NoPrediction = 3        // no backend could predict the cutting power
+};
+
+/**
+ * @brief Header of every frame
+ */
+struct EstimateFrameHeader {
+    std::uint32_t length;       // payload bytes following the header
+    std::uint16_t type;         // EstimateMessageType
+    std::uint16_t status;       // EstimateStatus, 0 in requests
+    std::uint32_t requestId;    // chosen by the client, echoed in the response
+};
+
+/**
+ * @brief Numeric fields of an estimate request
+ */
+struct EstimateRequestFields {
+    double toolDiameter;    // mm
+    double spindleSpeed;    // RPM
+    double feedRate;        // mm/min
+    double depthOfCut;      // mm
+    double cuttingTime;     // minutes
+    double emissionFactor;  // kg CO2/kWh, 0 or less uses the daemon's factor
+};
+
+/**
+ * @brief Estimate of one operation
+ */
+struct EstimateResult {
+    double cuttingPower;    // kW
+    double totalTime;       // minutes, cutting + rapid + idle time of the operation
+    double energy;          // kWh
+    double carbon;          // kg CO2
+};
+
+const std::size_t EstimateHeaderSize = sizeof(EstimateFrameHeader);
+const std::size_t EstimateMaxPayload = 64 * 1024;
+const std::size_t EstimateMaxNameLength = 255;
+const char* const EstimateDefaultSocketPath = "/tmp/nxcarbond.sock";
+
+/**
+ * @brief Operation to estimate, as sent by a client
+ */
+struct EstimateQuery {
+    std::string material;
+    std::string operationType;
+    std::string machineType;
+    EstimateRequestFields fields;
+
+    EstimateQuery() : fields() {}
+};
+
+/**
+ * @brief Encoding and decoding of protocol frames
+ */
+class EstimateCodec {
+public:
+    /**
+     * @brief Append an estimate request frame
+     * @param out Buffer to append to
+     * @param requestId Request id
+     * @param query Operation to estimate (names longer than EstimateMaxNameLength are truncated)
+     */
+    static void appendRequest(std::vector<char>& out, std::uint32_t requestId, const EstimateQuery& query);
+
+    /**
+     * @brief Append a frame with a raw payload
+     * @param out Buffer to append to
+     * @param type Message type
+     * @param status Status
+     * @param requestId Request id
+     * @param payload Payload bytes (may be nullptr if length is 0)
+     * @param length Payload length
+     */
+    static void appendFrame(std::vector<char>& out, EstimateMessageType type, EstimateStatus status,
+                            std::uint32_t requestId, const void* payload, std::size_t length);
+
+    /**
+     * @brief Decode the payload of an estimate request
+     * @param payload Payload bytes
+     * @param length Payload length
+     * @param query Decoded operation; the strings are reused to avoid allocations
+     * @return False if the payload is malformed
+     */
+    static bool decodeRequest(const char* payload, std::size_t length, EstimateQuery& query);
+
+    /**
+     * @brief Read a frame header
+     * @param data At least EstimateHeaderSize bytes
+     * @return Header
+     */
+    static EstimateFrameHeader readHeader(const char* data);
+};
+
+#endif // ESTIMATE_PROTOCOL_H
\ No newline at end of file
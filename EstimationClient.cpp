@@ -0,0 +1,189 @@
+#include "EstimationClient.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+namespace {
+
+// Requests in flight per round trip; bounded so that neither side's buffers fill up
+const std::size_t PipelineWindow = 256;
+
+} // namespace
+
+EstimationClient::EstimationClient() : fd(-1), nextRequestId(1), receiveStart(0) {
+}
+
+EstimationClient::~EstimationClient() {
+    close();
+}
+
+bool EstimationClient::connect(const std::string& socketPath) {
+    close();
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (socketPath.empty() || socketPath.size() >= sizeof(address.sun_path)) {
+        std::cout << "Error: invalid socket path " << socketPath << std::endl;
+        return false;
+    }
+    std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size());
+
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        std::cout << "Error: cannot connect to " << socketPath << ": " << std::strerror(errno) << std::endl;
+        close();
+        return false;
+    }
+    return true;
+}
+
+void EstimationClient::close() {
+    if (fd >= 0) {
+        ::close(fd);
+    }
+    fd = -1;
+    receiveBuffer.clear();
+    receiveStart = 0;
+}
+
+bool EstimationClient::isConnected() const {
+    return fd >= 0;
+}
+
+bool EstimationClient::sendAll(const std::vector<char>& data) {
+    std::size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            close();
+            return false;
+        }
+        sent += static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+bool EstimationClient::receiveFrame(EstimateFrameHeader& header, std::vector<char>& payload) {
+    for (;;) {
+        std::size_t available = receiveBuffer.size() - receiveStart;
+        if (available >= EstimateHeaderSize) {
+            header = EstimateCodec::readHeader(&receiveBuffer[receiveStart]);
+            if (header.length > EstimateMaxPayload) {
+                close();
+                return false;
+            }
+            if (available >= EstimateHeaderSize + header.length) {
+                const char* data = &receiveBuffer[receiveStart + EstimateHeaderSize];
+                payload.assign(data, data + header.length);
+                receiveStart += EstimateHeaderSize + header.length;
+                if (receiveStart == receiveBuffer.size()) {
+                    receiveBuffer.clear();
+                    receiveStart = 0;
+                }
+                return true;
+            }
+        }
+
+        std::size_t used = receiveBuffer.size();
+        receiveBuffer.resize(used + 64 * 1024);
+        ssize_t n = recv(fd, &receiveBuffer[used], 64 * 1024, 0);
+        receiveBuffer.resize(used + static_cast<std::size_t>(std::max<ssize_t>(n, 0)));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            close();
+            return false;
+        }
+    }
+}
+
+EstimateStatus EstimationClient::estimate(const EstimateQuery& query, EstimateResult& result) {
+    std::vector<EstimateResult> results;
+    std::vector<EstimateStatus> statuses;
+    if (!estimateBatch(std::vector<EstimateQuery>(1, query), results, statuses)) {
+        result = EstimateResult();
+        return EstimateStatus::Malformed;
+    }
+    result = results[0];
+    return statuses[0];
+}
+
+bool EstimationClient::estimateBatch(const std::vector<EstimateQuery>& queries, std::vector<EstimateResult>& results,
+                                     std::vector<EstimateStatus>& statuses) {
+    results.assign(queries.size(), EstimateResult());
+    statuses.assign(queries.size(), EstimateStatus::Malformed);
+    if (fd < 0) {
+        return false;
+    }
+
+    std::vector<char> payload;
+    for (std::size_t begin = 0; begin < queries.size(); begin += PipelineWindow) {
+        std::size_t end = std::min(queries.size(), begin + PipelineWindow);
+        std::uint32_t firstId = nextRequestId;
+        sendBuffer.clear();
+        for (std::size_t i = begin; i < end; ++i) {
+            EstimateCodec::appendRequest(sendBuffer, nextRequestId++, queries[i]);
+        }
+        if (!sendAll(sendBuffer)) {
+            return false;
+        }
+
+        // Responses may arrive in any order; the request id gives the position
+        for (std::size_t received = begin; received < end;) {
+            EstimateFrameHeader header;
+            if (!receiveFrame(header, payload)) {
+                return false;
+            }
+            if (header.type != static_cast<std::uint16_t>(EstimateMessageType::EstimateResponse)) {
+                continue;
+            }
+            std::uint32_t offset = header.requestId - firstId;
+            if (offset >= end - begin) {
+                continue;
+            }
+            std::size_t index = begin + offset;
+            statuses[index] = static_cast<EstimateStatus>(header.status);
+            if (statuses[index] == EstimateStatus::Ok && payload.size() == sizeof(EstimateResult)) {
+                std::memcpy(&results[index], payload.data(), sizeof(EstimateResult));
+            }
+            ++received;
+        }
+    }
+    return true;
+}
+
+bool EstimationClient::fetchMetrics(std::string& text) {
+    if (fd < 0) {
+        return false;
+    }
+    std::uint32_t requestId = nextRequestId++;
+    sendBuffer.clear();
+    EstimateCodec::appendFrame(sendBuffer, EstimateMessageType::MetricsRequest, EstimateStatus::Ok, requestId,
+                               nullptr, 0);
+    if (!sendAll(sendBuffer)) {
+        return false;
+    }
+    std::vector<char> payload;
+    EstimateFrameHeader header;
+    do {
+        if (!receiveFrame(header, payload)) {
+            return false;
+        }
+    } while (header.type != static_cast<std::uint16_t>(EstimateMessageType::MetricsResponse)
+             || header.requestId != requestId);
+    text.assign(payload.begin(), payload.end());
+    return true;
+}
\ No newline at end of file
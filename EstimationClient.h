@@ -0,0 +1,79 @@
+#ifndef ESTIMATION_CLIENT_H
+#define ESTIMATION_CLIENT_H
+
+#include "EstimateProtocol.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Blocking client of the nxcarbond estimation daemon
+ *
+ * Lets NX sessions, the MES or a dashboard backend share one daemon instead of loading
+ * the models themselves. estimateBatch() pipelines all requests on the connection so
+ * they are predicted together by the daemon.
+ */
+class EstimationClient {
+private:
+    int fd;
+    std::uint32_t nextRequestId;
+    std::vector<char> sendBuffer;
+    std::vector<char> receiveBuffer;
+    std::size_t receiveStart;
+
+    bool sendAll(const std::vector<char>& data);
+    bool receiveFrame(EstimateFrameHeader& header, std::vector<char>& payload);
+
+public:
+    EstimationClient();
+    ~EstimationClient();
+
+    EstimationClient(const EstimationClient&) = delete;
+    EstimationClient& operator=(const EstimationClient&) = delete;
+
+    /**
+     * @brief Connect to the daemon
+     * @param socketPath Unix domain socket path of the daemon
+     * @return True on success
+     */
+    bool connect(const std::string& socketPath = EstimateDefaultSocketPath);
+
+    /**
+     * @brief Close the connection
+     */
+    void close();
+
+    /**
+     * @brief Check whether the client is connected
+     * @return True if connected
+     */
+    bool isConnected() const;
+
+    /**
+     * @brief Estimate one operation
+     * @param query Operation to estimate
+     * @param result Estimate
+     * @return Status of the response; Malformed if the connection failed
+     */
+    EstimateStatus estimate(const EstimateQuery& query, EstimateResult& result);
+
+    /**
+     * @brief Estimate several operations with one round trip
+     * @param queries Operations to estimate
+     * @param results Estimates in query order (zero where the status is not Ok)
+     * @param statuses Status of each estimate
+     * @return False if the connection failed
+     */
+    bool estimateBatch(const std::vector<EstimateQuery>& queries, std::vector<EstimateResult>& results,
+                       std::vector<EstimateStatus>& statuses);
+
+    /**
+     * @brief Fetch the daemon metrics
+     * @param text Metrics text, one "name value" line per metric
+     * @return False if the connection failed
+     */
+    bool fetchMetrics(std::string& text);
+};
+
+#endif // ESTIMATION_CLIENT_H
\ No newline at end of file
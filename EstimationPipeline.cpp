@@ -0,0 +1,195 @@
+#include "EstimationPipeline.h"
+#include "AIInterface.h"
+#include "BoundedQueue.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+// Unit of hand-over between the stages; allocated once per run and recycled
+struct OperationChunk {
+    std::size_t first;                  // index of the first operation in extraction order
+    std::vector<CutFeatures> features;
+    std::vector<double> cuttingTime;
+    std::vector<double> power;
+};
+
+// Estimates of one worker, as runs of consecutive operations
+struct WorkerOutput {
+    std::vector<OperationEstimate> estimates;
+    std::vector<std::pair<std::size_t, std::size_t>> segments;  // (first operation, count)
+    double busySeconds;
+
+    WorkerOutput() : busySeconds(0.0) {}
+};
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+} // namespace
+
+EstimationPipeline::EstimationPipeline(AIInterface& aiInterface, const TimeModel& timeModel,
+                                       const EnergyModel& energyModel, double factor)
+    : ai(aiInterface),
+      parameters(timeModel, energyModel, factor),
+      depthOfCut(2.0),
+      material("Al6061"),
+      machineType("3axis_VMC") {
+}
+
+void EstimationPipeline::setPart(const std::string& partMaterial, const std::string& partMachineType) {
+    material = partMaterial;
+    machineType = partMachineType;
+}
+
+void EstimationPipeline::setDepthOfCut(double depth) {
+    depthOfCut = depth;
+}
+
+void EstimationPipeline::setOptions(const PipelineOptions& pipelineOptions) {
+    options = pipelineOptions;
+    options.chunkSize = std::max<std::size_t>(options.chunkSize, 1);
+    options.queuedChunks = std::max<std::size_t>(options.queuedChunks, 1);
+}
+
+void EstimationPipeline::run(NXCamDataExtractor& extractor, std::vector<OperationEstimate>& results) {
+    run([&extractor](const OperationSink& sink) { return extractor.extractOperations(sink); }, results);
+}
+
+void EstimationPipeline::run(const OperationSource& source, std::vector<OperationEstimate>& results) {
+    Clock::time_point start = Clock::now();
+    statistics = PipelineStatistics();
+
+    std::size_t workerCount = options.workers;
+    if (workerCount == 0) {
+        workerCount = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+    }
+    const std::size_t chunkSize = options.chunkSize;
+
+    // Every chunk is queued, being filled or held by a worker, so both queues can hold all of them
+    // and the free list alone throttles extraction
+    const std::size_t chunkCount = options.queuedChunks + workerCount + 1;
+    std::vector<OperationChunk> chunks(chunkCount);
+    BoundedQueue<OperationChunk*> filled(chunkCount);
+    BoundedQueue<OperationChunk*> available(chunkCount);
+    for (OperationChunk& chunk : chunks) {
+        chunk.features.reserve(chunkSize);
+        chunk.cuttingTime.reserve(chunkSize);
+        chunk.power.reserve(chunkSize);
+        OperationChunk* pointer = &chunk;
+        available.tryPush(pointer);
+    }
+    statistics.workers = workerCount;
+    statistics.bufferedOperations = chunkCount * chunkSize;
+
+    std::mutex predictMutex;
+    std::vector<WorkerOutput> outputs(workerCount);
+    ThreadPool pool(workerCount);
+    std::vector<std::future<void>> done;
+    for (std::size_t w = 0; w < workerCount; ++w) {
+        WorkerOutput& output = outputs[w];
+        done.push_back(pool.submit([this, &filled, &available, &predictMutex, &output]() {
+            OperationChunk* chunk = nullptr;
+            while (filled.pop(chunk)) {
+                Clock::time_point busy = Clock::now();
+                std::size_t count = chunk->features.size();
+                chunk->power.resize(count);
+                {
+                    std::lock_guard<std::mutex> lock(predictMutex);
+                    ai.predictCuttingPowerBatch(chunk->features, chunk->power);
+                }
+                output.segments.emplace_back(chunk->first, count);
+                for (std::size_t i = 0; i < count; ++i) {
+                    output.estimates.push_back(evaluateOperation(chunk->cuttingTime[i], chunk->power[i], parameters));
+                }
+                output.busySeconds += secondsSince(busy);
+                available.push(chunk);
+            }
+        }));
+    }
+
+    // Extraction: features of each operation type are interned once, under the prediction lock
+    std::unordered_map<std::string, CutFeatures> featuresByType;
+    OperationChunk* current = nullptr;
+    std::size_t extracted = 0;
+    double waitSeconds = 0.0;
+    auto handOver = [&filled, &current, this]() {
+        filled.push(current);
+        current = nullptr;
+        ++statistics.chunks;
+    };
+    OperationSink sink = [&](const NXOperation& operation) {
+        if (current == nullptr) {
+            if (!available.tryPop(current)) {
+                Clock::time_point wait = Clock::now();
+                ++statistics.extractionWaits;
+                available.pop(current);
+                waitSeconds += secondsSince(wait);
+            }
+            current->first = extracted;
+            current->features.clear();
+            current->cuttingTime.clear();
+        }
+        std::string operationType = operation.getOperationType();
+        auto known = featuresByType.find(operationType);
+        if (known == featuresByType.end()) {
+            std::lock_guard<std::mutex> lock(predictMutex);
+            known = featuresByType.emplace(operationType, ai.getPredictorRegistry().makeFeatures(
+                material, 0.0, 0.0, 0.0, depthOfCut, operationType, machineType)).first;
+        }
+        CutFeatures features = known->second;
+        features.toolDiameter = operation.getToolDiameter();
+        features.spindleSpeed = operation.getSpindleSpeed();
+        features.feedRate = operation.getFeedRate();
+        current->features.push_back(features);
+        current->cuttingTime.push_back(operation.getCuttingTime());
+        ++extracted;
+        if (current->features.size() == chunkSize) {
+            handOver();
+        }
+        return true;
+    };
+
+    try {
+        source(sink);
+        if (current != nullptr) {
+            handOver();
+        }
+    } catch (...) {
+        filled.close();
+        throw;      // the pool finishes the queued chunks and joins its workers
+    }
+    statistics.extractSeconds = secondsSince(start) - waitSeconds;
+    filled.close();
+    for (std::future<void>& worker : done) {
+        worker.get();
+    }
+
+    // Put the estimates back into extraction order
+    results.assign(extracted, OperationEstimate());
+    for (const WorkerOutput& output : outputs) {
+        std::size_t offset = 0;
+        for (const auto& segment : output.segments) {
+            std::copy(output.estimates.begin() + offset, output.estimates.begin() + offset + segment.second,
+                      results.begin() + segment.first);
+            offset += segment.second;
+        }
+        statistics.computeSeconds += output.busySeconds;
+    }
+    statistics.operations = extracted;
+    statistics.wallSeconds = secondsSince(start);
+}
+
+const PipelineStatistics& EstimationPipeline::getStatistics() const {
+    return statistics;
+}
\ No newline at end of file
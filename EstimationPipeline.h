@@ -0,0 +1,128 @@
+#ifndef ESTIMATION_PIPELINE_H
+#define ESTIMATION_PIPELINE_H
+
+#include "NXCamDataExtractor.h"
+#include "OperationCache.h"
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+class AIInterface;
+class TimeModel;
+class EnergyModel;
+
+/**
+ * @brief Sizing of an EstimationPipeline
+ */
+struct PipelineOptions {
+    std::size_t workers;        // compute threads (0 uses the hardware concurrency)
+    std::size_t chunkSize;      // operations handed over at a time
+    std::size_t queuedChunks;   // chunks that may wait for a worker before extraction pauses
+
+    PipelineOptions() : workers(0), chunkSize(256), queuedChunks(8) {}
+};
+
+/**
+ * @brief Work done by the last EstimationPipeline::run call
+ */
+struct PipelineStatistics {
+    std::size_t operations;
+    std::size_t chunks;
+    std::size_t workers;
+    std::size_t bufferedOperations;     // upper bound of operations held between the stages
+    std::size_t extractionWaits;        // times extraction paused for a free chunk (backpressure)
+    double extractSeconds;              // extraction, excluding the pauses
+    double computeSeconds;              // summed over the workers
+    double wallSeconds;
+
+    PipelineStatistics()
+        : operations(0), chunks(0), workers(0), bufferedOperations(0), extractionWaits(0), extractSeconds(0.0),
+          computeSeconds(0.0), wallSeconds(0.0) {}
+};
+
+/**
+ * @brief Source of operations for EstimationPipeline::run
+ *
+ * Passes every operation to the sink and returns their number, like
+ * NXCamDataExtractor::extractOperations(const OperationSink&).
+ */
+typedef std::function<std::size_t(const OperationSink&)> OperationSource;
+
+/**
+ * @brief Overlaps operation extraction with the time, energy and carbon evaluation
+ *
+ * Extraction runs on the calling thread (NX Open API calls belong there) and fills
+ * fixed-size chunks of prediction features, which go to the compute workers through a
+ * lock-free bounded queue (BoundedQueue.h). Workers predict the cutting power of a whole
+ * chunk in one batch, evaluate the time, energy and carbon formulas, and return the chunk
+ * to a free list for reuse. Only a fixed number of chunks exists, so a slow consumer pauses
+ * extraction instead of buffering the whole assembly, and nothing is allocated per chunk.
+ * Wall time approaches the slower of the two stages instead of their sum.
+ *
+ * Predictors are not assumed to be thread-safe: the batch predictions of the workers (and
+ * the category interning of new operation types) are serialized, the rest runs in parallel.
+ * The AIInterface must not be used by other threads during run().
+ */
+class EstimationPipeline {
+private:
+    AIInterface& ai;
+    OperationParameters parameters;
+    double depthOfCut;
+    std::string material;
+    std::string machineType;
+    PipelineOptions options;
+    PipelineStatistics statistics;
+
+public:
+    /**
+     * @brief Pipeline using the parameters of the given models
+     * @param aiInterface Cutting power prediction
+     * @param timeModel Rapid time factor and idle time per operation
+     * @param energyModel Rapid and idle power
+     * @param emissionFactor Emission factor in kg CO2/kWh
+     */
+    EstimationPipeline(AIInterface& aiInterface, const TimeModel& timeModel, const EnergyModel& energyModel,
+                       double emissionFactor);
+
+    /**
+     * @brief Set the workpiece and machine the operations belong to
+     * @param partMaterial Workpiece material
+     * @param partMachineType Machine type
+     */
+    void setPart(const std::string& partMaterial, const std::string& partMachineType);
+
+    /**
+     * @brief Set the depth of cut, which NX operations do not carry
+     * @param depth Depth of cut in mm
+     */
+    void setDepthOfCut(double depth);
+
+    /**
+     * @brief Set the number of workers and the chunk and queue sizes
+     * @param pipelineOptions Options
+     */
+    void setOptions(const PipelineOptions& pipelineOptions);
+
+    /**
+     * @brief Extract and estimate all operations of a source
+     * @param source Operation source, called once on the calling thread
+     * @param results One estimate per operation, in extraction order (setup time not included)
+     */
+    void run(const OperationSource& source, std::vector<OperationEstimate>& results);
+
+    /**
+     * @brief Extract and estimate all operations of the current NX CAM setup
+     * @param extractor Extractor
+     * @param results One estimate per operation, in extraction order (setup time not included)
+     */
+    void run(NXCamDataExtractor& extractor, std::vector<OperationEstimate>& results);
+
+    /**
+     * @brief Get the statistics of the last run() call
+     * @return Operation counts, backpressure and stage timings
+     */
+    const PipelineStatistics& getStatistics() const;
+};
+
+#endif // ESTIMATION_PIPELINE_H
\ No newline at end of file
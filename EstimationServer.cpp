@@ -0,0 +1,554 @@
+#include "EstimationServer.h"
+#include "AIInterface.h"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0     // SIGPIPE must then be ignored by the process
+#endif
+
+namespace {
+
+const std::size_t ReadChunk = 64 * 1024;
+const int ReadsPerWakeup = 4;       // bounds the time one busy client can hold the loop
+
+bool setNonBlocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+// Wait for events; a negative timeout waits indefinitely
+int waitForEvents(std::vector<pollfd>& fds, long long timeoutMicros) {
+#ifdef __linux__
+    // Batch delays are typically tens of microseconds, below poll()'s millisecond resolution
+    timespec timeout;
+    timeout.tv_sec = static_cast<time_t>(timeoutMicros / 1000000);
+    timeout.tv_nsec = static_cast<long>(timeoutMicros % 1000000) * 1000;
+    return ppoll(fds.data(), static_cast<nfds_t>(fds.size()), timeoutMicros < 0 ? nullptr : &timeout, nullptr);
+#else
+    int timeoutMillis = timeoutMicros < 0 ? -1 : static_cast<int>((timeoutMicros + 999) / 1000);
+    return poll(fds.data(), static_cast<nfds_t>(fds.size()), timeoutMillis);
+#endif
+}
+
+} // namespace
+
+LatencyHistogram::LatencyHistogram() : counts(62 * SubBuckets, 0), total(0), maximum(0) {
+}
+
+std::size_t LatencyHistogram::bucketOf(std::uint64_t nanoseconds) {
+    if (nanoseconds < static_cast<std::uint64_t>(SubBuckets)) {
+        return static_cast<std::size_t>(nanoseconds);
+    }
+    int shift = 0;
+    while ((nanoseconds >> shift) >= static_cast<std::uint64_t>(2 * SubBuckets)) {
+        ++shift;
+    }
+    std::uint64_t mantissa = (nanoseconds >> shift) - SubBuckets;
+    return static_cast<std::size_t>(shift + 1) * SubBuckets + static_cast<std::size_t>(mantissa);
+}
+
+std::uint64_t LatencyHistogram::bucketMidpoint(std::size_t bucket) {
+    if (bucket < static_cast<std::size_t>(2 * SubBuckets)) {
+        return bucket;
+    }
+    int shift = static_cast<int>(bucket / SubBuckets) - 1;
+    std::uint64_t low = static_cast<std::uint64_t>(SubBuckets + bucket % SubBuckets) << shift;
+    return low + ((static_cast<std::uint64_t>(1) << shift) >> 1);
+}
+
+void LatencyHistogram::record(std::uint64_t nanoseconds) {
+    ++counts[bucketOf(nanoseconds)];
+    ++total;
+    maximum = std::max(maximum, nanoseconds);
+}
+
+std::uint64_t LatencyHistogram::quantile(double q) const {
+    if (total == 0) {
+        return 0;
+    }
+    std::uint64_t target = static_cast<std::uint64_t>(std::ceil(q * static_cast<double>(total)));
+    target = std::max<std::uint64_t>(1, std::min(target, total));
+    std::uint64_t seen = 0;
+    for (std::size_t b = 0; b < counts.size(); ++b) {
+        seen += counts[b];
+        if (seen >= target) {
+            return std::min(bucketMidpoint(b), maximum);
+        }
+    }
+    return maximum;
+}
+
+std::uint64_t LatencyHistogram::getMaximum() const {
+    return maximum;
+}
+
+std::uint64_t LatencyHistogram::getCount() const {
+    return total;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    for (std::size_t b = 0; b < counts.size(); ++b) {
+        counts[b] += other.counts[b];
+    }
+    total += other.total;
+    maximum = std::max(maximum, other.maximum);
+}
+
+EstimationServer::EstimationServer(AIInterface& aiInterface, const TimeModel& timeModel,
+                                   const EnergyModel& energyModel, double factor)
+    : ai(aiInterface),
+      parameters(timeModel, energyModel, factor),
+      listenFd(-1),
+      stopRequested(false),
+      nextSerial(1),
+      pending(memory.getResource(MemorySubsystem::Operations)),
+      batchFeatures(memory.getResource(MemorySubsystem::Results)),
+      batchPower(memory.getResource(MemorySubsystem::Results)),
+      startTime(Clock::now()) {
+    wakeFds[0] = -1;
+    wakeFds[1] = -1;
+    std::cout << "EstimationServer initialized" << std::endl;
+}
+
+EstimationServer::~EstimationServer() {
+    closeAll();
+    if (listenFd >= 0) {
+        ::close(listenFd);
+        ::unlink(options.socketPath.c_str());
+    }
+    for (int fd : wakeFds) {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+    std::cout << "EstimationServer destroyed" << std::endl;
+}
+
+void EstimationServer::setOptions(const ServerOptions& serverOptions) {
+    options = serverOptions;
+    options.maxBatchSize = std::max<std::size_t>(1, options.maxBatchSize);
+    options.maxQueueDepth = std::max(options.maxQueueDepth, options.maxBatchSize);
+}
+
+bool EstimationServer::start() {
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (options.socketPath.empty() || options.socketPath.size() >= sizeof(address.sun_path)) {
+        std::cout << "Error: invalid socket path " << options.socketPath << std::endl;
+        return false;
+    }
+    std::memcpy(address.sun_path, options.socketPath.c_str(), options.socketPath.size());
+
+    if (pipe(wakeFds) != 0 || !setNonBlocking(wakeFds[0]) || !setNonBlocking(wakeFds[1])) {
+        std::cout << "Error: cannot create wakeup pipe: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        std::cout << "Error: cannot create socket: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    // A socket file left by a crashed daemon is replaced; a live daemon is not
+    struct stat info;
+    if (stat(options.socketPath.c_str(), &info) == 0 && S_ISSOCK(info.st_mode)) {
+        if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0) {
+            std::cout << "Error: another daemon is listening on " << options.socketPath << std::endl;
+            ::close(fd);
+            return false;
+        }
+        ::close(fd);
+        ::unlink(options.socketPath.c_str());
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0) {
+            std::cout << "Error: cannot create socket: " << std::strerror(errno) << std::endl;
+            return false;
+        }
+    }
+
+    if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0
+        || listen(fd, SOMAXCONN) != 0 || !setNonBlocking(fd)) {
+        std::cout << "Error: cannot listen on " << options.socketPath << ": " << std::strerror(errno) << std::endl;
+        ::close(fd);
+        return false;
+    }
+    listenFd = fd;
+    startTime = Clock::now();
+    std::cout << "Listening on " << options.socketPath << std::endl;
+    return true;
+}
+
+void EstimationServer::run() {
+    if (listenFd < 0) {
+        std::cout << "Error: EstimationServer::run() called before start()" << std::endl;
+        return;
+    }
+
+    std::vector<pollfd> fds;
+    std::vector<std::size_t> fdSlots;
+    while (!stopRequested) {
+        fds.clear();
+        fdSlots.clear();
+        fds.push_back({wakeFds[0], POLLIN, 0});
+        fds.push_back({listenFd, static_cast<short>(metrics.connections < options.maxConnections ? POLLIN : 0), 0});
+
+        // Backpressure: stop reading while the queue is full or a client does not read its responses
+        bool queueFull = pending.size() >= options.maxQueueDepth;
+        for (std::size_t slot = 0; slot < connections.size(); ++slot) {
+            const Connection& c = connections[slot];
+            if (c.fd < 0) {
+                continue;
+            }
+            std::size_t unsent = c.output.size() - c.outputStart;
+            short events = 0;
+            if (!queueFull && !c.closing && unsent < options.maxOutputBuffer) {
+                events |= POLLIN;
+            }
+            if (unsent > 0) {
+                events |= POLLOUT;
+            }
+            fds.push_back({c.fd, events, 0});
+            fdSlots.push_back(slot);
+        }
+
+        long long timeout = -1;
+        if (!pending.empty()) {
+            auto waited = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - pending.front().received);
+            timeout = std::max<long long>(0, options.batchDelayMicros - waited.count());
+        }
+
+        int ready = waitForEvents(fds, timeout);
+        if (ready < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            std::cout << "Error: poll failed: " << std::strerror(errno) << std::endl;
+            break;
+        }
+
+        if (fds[0].revents & POLLIN) {
+            char drain[64];
+            while (read(wakeFds[0], drain, sizeof(drain)) > 0) {
+            }
+        }
+        for (std::size_t i = 2; i < fds.size(); ++i) {
+            std::size_t slot = fdSlots[i - 2];
+            if (fds[i].revents & POLLOUT) {
+                flushConnection(slot);
+            }
+            if (connections[slot].fd >= 0 && (fds[i].revents & (POLLIN | POLLHUP | POLLERR))) {
+                readConnection(slot);
+            }
+        }
+        if (fds[1].revents & POLLIN) {
+            acceptConnections();
+        }
+
+        if (!pending.empty()) {
+            auto waited = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - pending.front().received);
+            if (pending.size() >= options.maxBatchSize || waited.count() >= options.batchDelayMicros) {
+                processPending();
+                for (std::size_t slot = 0; slot < connections.size(); ++slot) {
+                    if (connections[slot].fd >= 0 && hasFrame(connections[slot])) {
+                        parseFrames(slot, Clock::now());
+                    }
+                }
+            }
+        }
+
+        // Write responses right away; POLLOUT is only needed when the socket buffer is full
+        for (std::size_t slot = 0; slot < connections.size(); ++slot) {
+            Connection& c = connections[slot];
+            if (c.fd >= 0 && (c.output.size() > c.outputStart || (c.closing && c.queued == 0))) {
+                flushConnection(slot);
+            }
+        }
+    }
+    closeAll();
+}
+
+void EstimationServer::stop() {
+    stopRequested = true;
+    if (wakeFds[1] >= 0) {
+        char byte = 1;
+        ssize_t written = write(wakeFds[1], &byte, 1);
+        (void)written;
+    }
+}
+
+void EstimationServer::acceptConnections() {
+    while (metrics.connections < options.maxConnections) {
+        int fd = accept(listenFd, nullptr, nullptr);
+        if (fd < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;  // EAGAIN, or a client that went away before accept
+        }
+        if (!setNonBlocking(fd)) {
+            ::close(fd);
+            continue;
+        }
+
+        std::size_t slot;
+        if (!freeSlots.empty()) {
+            slot = freeSlots.back();
+            freeSlots.pop_back();
+        } else {
+            slot = connections.size();
+            connections.push_back(Connection());
+        }
+        Connection& c = connections[slot];
+        c.fd = fd;
+        c.serial = nextSerial++;
+        c.inputStart = 0;
+        c.outputStart = 0;
+        c.queued = 0;
+        c.closing = false;
+        ++metrics.connections;
+        ++metrics.connectionsAccepted;
+    }
+}
+
+void EstimationServer::readConnection(std::size_t slot) {
+    Connection& c = connections[slot];
+    for (int r = 0; r < ReadsPerWakeup; ++r) {
+        if (c.inputStart > 0 && c.inputStart == c.input.size()) {
+            c.input.clear();
+            c.inputStart = 0;
+        }
+        std::size_t used = c.input.size();
+        c.input.resize(used + ReadChunk);
+        ssize_t n = read(c.fd, &c.input[used], ReadChunk);
+        c.input.resize(used + static_cast<std::size_t>(std::max<ssize_t>(n, 0)));
+        if (n > 0) {
+            parseFrames(slot, Clock::now());
+            if (c.closing || static_cast<std::size_t>(n) < ReadChunk) {
+                return;
+            }
+            continue;
+        }
+        if (n == 0) {
+            c.closing = true;   // client finished sending; answer what is queued, then close
+            return;
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            closeConnection(slot);
+        }
+        return;
+    }
+}
+
+void EstimationServer::parseFrames(std::size_t slot, Clock::time_point received) {
+    Connection& c = connections[slot];
+    // Frames beyond the queue bound stay buffered until the queue has been answered
+    while (c.input.size() - c.inputStart >= EstimateHeaderSize && pending.size() < options.maxQueueDepth) {
+        const char* frame = &c.input[c.inputStart];
+        EstimateFrameHeader header = EstimateCodec::readHeader(frame);
+        if (header.length > EstimateMaxPayload) {
+            // The stream cannot be resynchronized after a bad length
+            ++metrics.errors;
+            EstimateCodec::appendFrame(c.output, EstimateMessageType::EstimateResponse, EstimateStatus::Malformed,
+                                       header.requestId, nullptr, 0);
+            c.input.clear();
+            c.inputStart = 0;
+            c.closing = true;
+            return;
+        }
+        if (c.input.size() - c.inputStart < EstimateHeaderSize + header.length) {
+            break;
+        }
+        const char* payload = frame + EstimateHeaderSize;
+
+        switch (static_cast<EstimateMessageType>(header.type)) {
+            case EstimateMessageType::EstimateRequest:
+                if (EstimateCodec::decodeRequest(payload, header.length, scratchQuery) &&
+                    ai.getPredictorRegistry().makeBoundedFeatures(
+                        scratchQuery.material, scratchQuery.fields.toolDiameter, scratchQuery.fields.spindleSpeed,
+                        scratchQuery.fields.feedRate, scratchQuery.fields.depthOfCut, scratchQuery.operationType,
+                        scratchQuery.machineType, options.maxCategoryNames, scratchFeatures)) {
+                    const EstimateRequestFields& f = scratchQuery.fields;
+                    batchFeatures.push_back(scratchFeatures);
+                    pending.push_back({slot, c.serial, header.requestId, f.cuttingTime, f.emissionFactor, received});
+                    ++c.queued;
+                    metrics.maxQueueDepth = std::max(metrics.maxQueueDepth, pending.size());
+                } else {
+                    ++metrics.errors;
+                    EstimateCodec::appendFrame(c.output, EstimateMessageType::EstimateResponse,
+                                               EstimateStatus::Malformed, header.requestId, nullptr, 0);
+                }
+                break;
+            case EstimateMessageType::MetricsRequest: {
+                std::string text = formatMetrics(getMetrics());
+                EstimateCodec::appendFrame(c.output, EstimateMessageType::MetricsResponse, EstimateStatus::Ok,
+                                           header.requestId, text.data(), text.size());
+                break;
+            }
+            default:
+                ++metrics.errors;
+                EstimateCodec::appendFrame(c.output, EstimateMessageType::EstimateResponse,
+                                           EstimateStatus::UnknownMessage, header.requestId, nullptr, 0);
+                break;
+        }
+        c.inputStart += EstimateHeaderSize + header.length;
+    }
+}
+
+bool EstimationServer::hasFrame(const Connection& c) const {
+    std::size_t buffered = c.input.size() - c.inputStart;
+    return buffered >= EstimateHeaderSize &&
+           buffered >= EstimateHeaderSize + EstimateCodec::readHeader(&c.input[c.inputStart]).length;
+}
+
+void EstimationServer::processPending() {
+    for (std::size_t begin = 0; begin < pending.size(); begin += options.maxBatchSize) {
+        processBatch(begin, std::min(pending.size(), begin + options.maxBatchSize));
+    }
+    pending.clear();
+    batchFeatures.clear();
+}
+
+void EstimationServer::processBatch(std::size_t begin, std::size_t end) {
+    std::size_t count = end - begin;
+    batchPower.resize(count);
+    ai.predictCuttingPowerBatch(Span<const CutFeatures>(&batchFeatures[begin], count),
+                                Span<double>(batchPower.data(), count));
+    ++metrics.batches;
+
+    Clock::time_point now = Clock::now();
+    for (std::size_t i = begin; i < end; ++i) {
+        const PendingRequest& request = pending[i];
+        if (!isOpen(request.slot, request.serial)) {
+            continue;   // client disconnected while the request was queued
+        }
+        Connection& c = connections[request.slot];
+        --c.queued;
+        double power = batchPower[i - begin];
+        if (!std::isfinite(power)) {
+            EstimateCodec::appendFrame(c.output, EstimateMessageType::EstimateResponse, EstimateStatus::NoPrediction,
+                                       request.requestId, nullptr, 0);
+        } else {
+            // One operation: its cutting, rapid and per-operation idle time (setup is per part)
+            OperationParameters requestParameters = parameters;
+            if (request.emissionFactor > 0.0) {
+                requestParameters.emissionFactor = request.emissionFactor;
+            }
+            OperationEstimate e = evaluateOperation(request.cuttingTime, power, requestParameters);
+            EstimateResult result;
+            result.cuttingPower = power;
+            result.totalTime = e.totalTime;
+            result.energy = e.energy;
+            result.carbon = e.carbon;
+            EstimateCodec::appendFrame(c.output, EstimateMessageType::EstimateResponse, EstimateStatus::Ok,
+                                       request.requestId, &result, sizeof(result));
+        }
+        ++metrics.requests;
+        latency.record(static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(now - request.received).count()));
+    }
+}
+
+bool EstimationServer::flushConnection(std::size_t slot) {
+    Connection& c = connections[slot];
+    while (c.outputStart < c.output.size()) {
+        ssize_t n = send(c.fd, &c.output[c.outputStart], c.output.size() - c.outputStart, MSG_NOSIGNAL);
+        if (n > 0) {
+            c.outputStart += static_cast<std::size_t>(n);
+            continue;
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return true;
+        }
+        closeConnection(slot);
+        return false;
+    }
+    c.output.clear();
+    c.outputStart = 0;
+    if (c.closing && c.queued == 0 && !hasFrame(c)) {
+        closeConnection(slot);
+        return false;
+    }
+    return true;
+}
+
+void EstimationServer::closeConnection(std::size_t slot) {
+    Connection& c = connections[slot];
+    if (c.fd < 0) {
+        return;
+    }
+    ::close(c.fd);
+    c.fd = -1;
+    std::vector<char>().swap(c.input);
+    std::vector<char>().swap(c.output);
+    c.inputStart = 0;
+    c.outputStart = 0;
+    c.queued = 0;
+    c.closing = false;
+    freeSlots.push_back(slot);
+    --metrics.connections;
+}
+
+bool EstimationServer::isOpen(std::size_t slot, std::uint64_t serial) const {
+    return connections[slot].fd >= 0 && connections[slot].serial == serial;
+}
+
+void EstimationServer::closeAll() {
+    for (std::size_t slot = 0; slot < connections.size(); ++slot) {
+        closeConnection(slot);
+    }
+    pending.clear();
+    batchFeatures.clear();
+}
+
+ServerMetrics EstimationServer::getMetrics() const {
+    ServerMetrics snapshot = metrics;
+    snapshot.queueDepth = pending.size();
+    snapshot.meanBatchSize = metrics.batches > 0
+        ? static_cast<double>(metrics.requests) / static_cast<double>(metrics.batches) : 0.0;
+    snapshot.latencyP50 = latency.quantile(0.50) / 1000.0;
+    snapshot.latencyP90 = latency.quantile(0.90) / 1000.0;
+    snapshot.latencyP99 = latency.quantile(0.99) / 1000.0;
+    snapshot.latencyMax = latency.getMaximum() / 1000.0;
+    snapshot.uptime = std::chrono::duration<double>(Clock::now() - startTime).count();
+    snapshot.memory = memory.getStatistics();
+    return snapshot;
+}
+
+std::string EstimationServer::formatMetrics(const ServerMetrics& snapshot) {
+    std::ostringstream text;
+    text << "nxcarbond_requests_total " << snapshot.requests << "\n"
+         << "nxcarbond_batches_total " << snapshot.batches << "\n"
+         << "nxcarbond_batch_size_mean " << snapshot.meanBatchSize << "\n"
+         << "nxcarbond_errors_total " << snapshot.errors << "\n"
+         << "nxcarbond_connections_accepted_total " << snapshot.connectionsAccepted << "\n"
+         << "nxcarbond_connections " << snapshot.connections << "\n"
+         << "nxcarbond_queue_depth " << snapshot.queueDepth << "\n"
+         << "nxcarbond_queue_depth_max " << snapshot.maxQueueDepth << "\n"
+         << "nxcarbond_latency_p50_us " << snapshot.latencyP50 << "\n"
+         << "nxcarbond_latency_p90_us " << snapshot.latencyP90 << "\n"
+         << "nxcarbond_latency_p99_us " << snapshot.latencyP99 << "\n"
+         << "nxcarbond_latency_max_us " << snapshot.latencyMax << "\n"
+         << "nxcarbond_uptime_seconds " << snapshot.uptime << "\n"
+         << MemoryAccount::formatMetrics("nxcarbond", snapshot.memory);
+    return text.str();
+}
\ No newline at end of file
@@ -0,0 +1,232 @@
+#ifndef ESTIMATION_SERVER_H
+#define ESTIMATION_SERVER_H
+
+#include "EstimateProtocol.h"
+#include "PowerPredictor.h"
+#include "MemoryAccount.h"
+#include "OperationCache.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class AIInterface;
+class TimeModel;
+class EnergyModel;
+
+/**
+ * @brief Histogram of latencies with logarithmic buckets (about 6% resolution)
+ */
+class LatencyHistogram {
+private:
+    static const int SubBuckets = 16;   // per power of two
+    std::vector<std::uint64_t> counts;
+    std::uint64_t total;
+    std::uint64_t maximum;
+
+    static std::size_t bucketOf(std::uint64_t nanoseconds);
+    static std::uint64_t bucketMidpoint(std::size_t bucket);
+
+public:
+    LatencyHistogram();
+
+    /**
+     * @brief Record one latency
+     * @param nanoseconds Latency in nanoseconds
+     */
+    void record(std::uint64_t nanoseconds);
+
+    /**
+     * @brief Get a quantile
+     * @param q Quantile between 0 and 1
+     * @return Latency in nanoseconds, 0 if nothing was recorded
+     */
+    std::uint64_t quantile(double q) const;
+
+    /**
+     * @brief Get the largest recorded latency
+     * @return Latency in nanoseconds
+     */
+    std::uint64_t getMaximum() const;
+
+    /**
+     * @brief Get the number of recorded latencies
+     * @return Count
+     */
+    std::uint64_t getCount() const;
+
+    /**
+     * @brief Add the counts of another histogram
+     * @param other Histogram to merge
+     */
+    void merge(const LatencyHistogram& other);
+};
+
+/**
+ * @brief Settings of the estimation server
+ */
+struct ServerOptions {
+    std::string socketPath;         // Unix domain socket path
+    std::size_t maxBatchSize;       // requests per batch prediction
+    int batchDelayMicros;           // wait for more requests after the first one (0 = batch what has arrived)
+    std::size_t maxQueueDepth;      // reading and parsing pause while this many requests are pending
+    std::size_t maxConnections;
+    std::size_t maxOutputBuffer;    // reading from a client pauses while its unsent responses exceed this
+    std::size_t maxCategoryNames;   // names per category table clients may add; later unknown names are malformed
+
+    ServerOptions()
+        : socketPath(EstimateDefaultSocketPath),
+          maxBatchSize(512),
+          batchDelayMicros(0),
+          maxQueueDepth(8192),
+          maxConnections(1024),
+          maxOutputBuffer(1 << 20),
+          maxCategoryNames(256) {}
+};
+
+/**
+ * @brief Counters and latency distribution of the estimation server
+ */
+struct ServerMetrics {
+    std::uint64_t requests;         // estimate requests answered
+    std::uint64_t batches;          // batch predictions run
+    std::uint64_t errors;           // malformed or unknown requests
+    std::uint64_t connectionsAccepted;
+    std::size_t connections;        // currently open
+    std::size_t queueDepth;         // requests pending now
+    std::size_t maxQueueDepth;      // largest number of pending requests seen
+    double meanBatchSize;
+    double latencyP50;              // microseconds, from receipt to response
+    double latencyP90;
+    double latencyP99;
+    double latencyMax;
+    double uptime;                  // seconds
+    MemoryStatistics memory;        // request queue and batch buffers
+
+    ServerMetrics()
+        : requests(0), batches(0), errors(0), connectionsAccepted(0), connections(0), queueDepth(0),
+          maxQueueDepth(0), meanBatchSize(0.0), latencyP50(0.0), latencyP90(0.0), latencyP99(0.0),
+          latencyMax(0.0), uptime(0.0) {}
+};
+
+/**
+ * @brief Serves operation estimates over a Unix domain socket
+ *
+ * A single-threaded poll() event loop reads request frames (EstimateProtocol.h) from all
+ * clients, queues them, and answers everything that has arrived with one call into the
+ * batch prediction path of AIInterface, followed by the time/energy/carbon formulas.
+ * Under load the batches grow by themselves; batchDelayMicros trades latency for larger
+ * batches when clients send one request at a time. The models are loaded once and must
+ * not be used by other threads while the server runs.
+ */
+class EstimationServer {
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Connection {
+        int fd;
+        std::uint64_t serial;           // distinguishes reuses of the slot
+        std::vector<char> input;
+        std::size_t inputStart;
+        std::vector<char> output;
+        std::size_t outputStart;
+        std::size_t queued;             // requests waiting for the next batch
+        bool closing;                   // close once queued requests are answered and flushed
+    };
+
+    struct PendingRequest {
+        std::size_t slot;
+        std::uint64_t serial;
+        std::uint32_t requestId;
+        double cuttingTime;
+        double emissionFactor;
+        Clock::time_point received;
+    };
+
+    AIInterface& ai;
+    ServerOptions options;
+    OperationParameters parameters;
+
+    int listenFd;
+    int wakeFds[2];                     // self-pipe, written by stop()
+    std::atomic<bool> stopRequested;
+    std::vector<Connection> connections;
+    std::vector<std::size_t> freeSlots;
+    std::uint64_t nextSerial;
+
+    MemoryAccount memory;               // before the buffers allocating from it
+    std::pmr::vector<PendingRequest> pending;
+    std::pmr::vector<CutFeatures> batchFeatures;
+    std::pmr::vector<double> batchPower;
+    EstimateQuery scratchQuery;
+    CutFeatures scratchFeatures;
+
+    ServerMetrics metrics;
+    LatencyHistogram latency;
+    Clock::time_point startTime;
+
+    void acceptConnections();
+    void readConnection(std::size_t slot);
+    void parseFrames(std::size_t slot, Clock::time_point received);
+    bool hasFrame(const Connection& c) const;
+    void processPending();
+    void processBatch(std::size_t begin, std::size_t end);
+    bool flushConnection(std::size_t slot);
+    void closeConnection(std::size_t slot);
+    bool isOpen(std::size_t slot, std::uint64_t serial) const;
+    void closeAll();
+
+public:
+    /**
+     * @brief Server using the given models
+     * @param aiInterface Cutting power prediction (registry and loaded models)
+     * @param timeModel Rapid time factor and idle time per operation
+     * @param energyModel Rapid and idle power
+     * @param emissionFactor Default emission factor in kg CO2/kWh
+     */
+    EstimationServer(AIInterface& aiInterface, const TimeModel& timeModel, const EnergyModel& energyModel,
+                     double emissionFactor);
+    ~EstimationServer();
+
+    EstimationServer(const EstimationServer&) = delete;
+    EstimationServer& operator=(const EstimationServer&) = delete;
+
+    /**
+     * @brief Set the server options (before start())
+     * @param serverOptions Socket path, batching and backpressure limits
+     */
+    void setOptions(const ServerOptions& serverOptions);
+
+    /**
+     * @brief Bind and listen on the socket, replacing a stale socket file
+     * @return True on success
+     */
+    bool start();
+
+    /**
+     * @brief Run the event loop until stop() is called
+     */
+    void run();
+
+    /**
+     * @brief Ask the event loop to exit; safe to call from a signal handler or another thread
+     */
+    void stop();
+
+    /**
+     * @brief Get a snapshot of the metrics (from the event loop thread or after run() returned)
+     * @return Counters, queue depth and latency quantiles
+     */
+    ServerMetrics getMetrics() const;
+
+    /**
+     * @brief Format metrics as "name value" lines, as served to MetricsRequest messages
+     * @param snapshot Metrics to format
+     * @return Metrics text
+     */
+    static std::string formatMetrics(const ServerMetrics& snapshot);
+};
+
+#endif // ESTIMATION_SERVER_H
\ No newline at end of file
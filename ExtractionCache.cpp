@@ -0,0 +1,330 @@
+#include "ExtractionCache.h"
+#include "ModelContainer.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+namespace {
+
+const char cacheMagic[8] = {'N', 'X', 'E', 'X', 'T', 'R', 'A', 'C'};
+const std::uint32_t cacheFormatVersion = 2;     // 2: part fingerprints include the part identity
+
+const std::uint32_t kindOperation = 0;
+const std::uint32_t kindText = 1;
+
+const std::uint64_t defaultMaxBytes = 64ULL << 20;
+
+struct CacheFileHeader {
+    char magic[8];
+    std::uint32_t formatVersion;
+    std::uint32_t recordSize;
+    std::uint64_t clock;
+    std::uint64_t count;
+    std::uint64_t poolBytes;
+    std::uint64_t checksum;         // over all records and the string pool
+};
+
+struct CacheRecord {
+    std::uint64_t keyHigh;
+    std::uint64_t keyLow;
+    std::uint64_t stamp;
+    std::uint64_t lastUsed;
+    double cuttingTime;
+    double feedRate;
+    double spindleSpeed;
+    double toolDiameter;
+    std::uint64_t textOffset;       // into the string pool: operation type or text
+    std::uint32_t textLength;
+    std::uint32_t kind;
+};
+
+static_assert(sizeof(CacheRecord) == 80, "CacheRecord is stored as-is in cache files");
+
+OperationKey makeKey(std::uint32_t kind, std::uint64_t part, const std::string& name) {
+    OperationKeyBuilder builder;
+    builder.add(static_cast<std::uint64_t>(kind));
+    builder.add(part);
+    builder.add(name);
+    return builder.getKey();
+}
+
+std::uint64_t checksumFile(const std::vector<CacheRecord>& records, const std::string& pool) {
+    // Mix the pool's checksum so that swapping bytes between records and pool is detected
+    std::uint64_t sum = ModelContainer::checksum(records.data(), records.size() * sizeof(CacheRecord));
+    return sum ^ (ModelContainer::checksum(pool.data(), pool.size()) * 0x9e3779b97f4a7c15ULL);
+}
+
+} // namespace
+
+ExtractionCache::Entry::Entry() : stamp(0), lastUsed(0), kind(kindOperation), operation("", 0.0, 0.0, 0.0, 0.0) {
+}
+
+ExtractionCache::ExtractionCache(std::pmr::memory_resource* resource)
+    : entries(resource), clock(0), maxBytes(defaultMaxBytes), bytes(sizeof(CacheFileHeader)), hits(0), misses(0),
+      modified(false) {
+}
+
+std::uint64_t ExtractionCache::fingerprintPart(const std::string& path, const std::string& identity) {
+    std::error_code error;
+    std::filesystem::path absolute = std::filesystem::weakly_canonical(std::filesystem::path(path), error);
+    OperationKeyBuilder builder;
+    builder.add(error ? path : absolute.string());
+    builder.add(identity);
+    return builder.getKey().low;
+}
+
+std::uint64_t ExtractionCache::entryBytes(const Entry& entry) {
+    const std::string& text = entry.kind == kindOperation ? entry.operation.getOperationType() : entry.text;
+    return sizeof(CacheRecord) + text.size();
+}
+
+void ExtractionCache::store(const OperationKey& key, Entry& entry) {
+    entry.lastUsed = ++clock;
+    auto it = entries.find(key);
+    if (it != entries.end()) {
+        bytes -= entryBytes(it->second);
+        it->second = std::move(entry);
+    } else {
+        it = entries.emplace(key, std::move(entry)).first;
+    }
+    bytes += entryBytes(it->second);
+    modified = true;
+}
+
+ExtractionCache::Entry* ExtractionCache::lookup(const OperationKey& key, std::uint64_t stamp) {
+    auto it = entries.find(key);
+    if (it == entries.end() || it->second.stamp != stamp) {
+        ++misses;
+        return nullptr;
+    }
+    ++hits;
+    it->second.lastUsed = ++clock;
+    return &it->second;
+}
+
+const NXOperation* ExtractionCache::findOperation(std::uint64_t part, const std::string& id, std::uint64_t stamp) {
+    Entry* entry = lookup(makeKey(kindOperation, part, id), stamp);
+    return entry != nullptr ? &entry->operation : nullptr;
+}
+
+void ExtractionCache::insertOperation(std::uint64_t part, const std::string& id, std::uint64_t stamp,
+                                      const NXOperation& operation) {
+    Entry entry;
+    entry.stamp = stamp;
+    entry.kind = kindOperation;
+    entry.operation = operation;
+    store(makeKey(kindOperation, part, id), entry);
+}
+
+const std::string* ExtractionCache::findText(std::uint64_t part, const std::string& name, std::uint64_t stamp) {
+    Entry* entry = lookup(makeKey(kindText, part, name), stamp);
+    return entry != nullptr ? &entry->text : nullptr;
+}
+
+void ExtractionCache::insertText(std::uint64_t part, const std::string& name, std::uint64_t stamp,
+                                 const std::string& text) {
+    Entry entry;
+    entry.stamp = stamp;
+    entry.kind = kindText;
+    entry.text = text;
+    store(makeKey(kindText, part, name), entry);
+}
+
+void ExtractionCache::setMaxBytes(std::uint64_t limit) {
+    maxBytes = limit;
+}
+
+std::uint64_t ExtractionCache::getMaxBytes() const {
+    return maxBytes;
+}
+
+std::size_t ExtractionCache::trim() {
+    if (bytes <= maxBytes) {
+        return 0;
+    }
+    std::vector<std::pair<std::uint64_t, OperationKey>> ages;
+    ages.reserve(entries.size());
+    for (const auto& entry : entries) {
+        ages.emplace_back(entry.second.lastUsed, entry.first);
+    }
+    std::sort(ages.begin(), ages.end(),
+              [](const std::pair<std::uint64_t, OperationKey>& a, const std::pair<std::uint64_t, OperationKey>& b) {
+                  return a.first < b.first;
+              });
+    std::size_t evicted = 0;
+    for (const auto& age : ages) {
+        if (bytes <= maxBytes) {
+            break;
+        }
+        auto it = entries.find(age.second);
+        bytes -= entryBytes(it->second);
+        entries.erase(it);
+        ++evicted;
+    }
+    modified = true;
+    return evicted;
+}
+
+std::size_t ExtractionCache::size() const {
+    return entries.size();
+}
+
+std::size_t ExtractionCache::getHits() const {
+    return hits;
+}
+
+std::size_t ExtractionCache::getMisses() const {
+    return misses;
+}
+
+void ExtractionCache::clear() {
+    modified = modified || !entries.empty();
+    entries.clear();
+    bytes = sizeof(CacheFileHeader);
+}
+
+bool ExtractionCache::isModified() const {
+    return modified;
+}
+
+bool ExtractionCache::load(const std::string& path) {
+    entries.clear();
+    bytes = sizeof(CacheFileHeader);
+    modified = false;
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    CacheFileHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))
+        || std::memcmp(header.magic, cacheMagic, sizeof(cacheMagic)) != 0
+        || header.formatVersion != cacheFormatVersion || header.recordSize != sizeof(CacheRecord)) {
+        std::cout << "Warning: " << path << " is not a valid extraction cache, ignoring it" << std::endl;
+        return false;
+    }
+
+    file.seekg(0, std::ios::end);
+    std::uint64_t bodyBytes = static_cast<std::uint64_t>(file.tellg()) - sizeof(header);
+    file.seekg(sizeof(header), std::ios::beg);
+    if (header.count > bodyBytes / sizeof(CacheRecord)
+        || header.count * sizeof(CacheRecord) + header.poolBytes != bodyBytes) {
+        std::cout << "Warning: extraction cache " << path << " is truncated or corrupt, ignoring it" << std::endl;
+        return false;
+    }
+
+    std::vector<CacheRecord> records(static_cast<std::size_t>(header.count));
+    std::string pool(static_cast<std::size_t>(header.poolBytes), '\0');
+    if (!file.read(reinterpret_cast<char*>(records.data()), records.size() * sizeof(CacheRecord))
+        || !file.read(&pool[0], pool.size())
+        || checksumFile(records, pool) != header.checksum) {
+        std::cout << "Warning: extraction cache " << path << " is truncated or corrupt, ignoring it" << std::endl;
+        return false;
+    }
+    for (const CacheRecord& record : records) {
+        if (record.textOffset > pool.size() || record.textLength > pool.size() - record.textOffset
+            || (record.kind != kindOperation && record.kind != kindText)) {
+            std::cout << "Warning: extraction cache " << path << " is corrupt, ignoring it" << std::endl;
+            entries.clear();
+            bytes = sizeof(CacheFileHeader);
+            return false;
+        }
+    }
+
+    entries.reserve(records.size());
+    for (const CacheRecord& record : records) {
+        Entry entry;
+        entry.stamp = record.stamp;
+        entry.lastUsed = record.lastUsed;
+        entry.kind = record.kind;
+        std::string text = pool.substr(static_cast<std::size_t>(record.textOffset), record.textLength);
+        if (record.kind == kindOperation) {
+            entry.operation = NXOperation(text, record.cuttingTime, record.feedRate, record.spindleSpeed,
+                                          record.toolDiameter);
+        } else {
+            entry.text = std::move(text);
+        }
+        bytes += entryBytes(entry);
+        entries.emplace(OperationKey{record.keyHigh, record.keyLow}, std::move(entry));
+    }
+    clock = std::max(clock, header.clock);
+    std::cout << "Extraction cache loaded from " << path << " (" << entries.size() << " entries)" << std::endl;
+    return true;
+}
+
+bool ExtractionCache::save(const std::string& path) {
+    std::size_t evicted = trim();
+    if (evicted > 0) {
+        std::cout << "Extraction cache over " << maxBytes << " bytes, evicted " << evicted
+                  << " least recently used entries" << std::endl;
+    }
+
+    // Operation types and texts repeat across operations and parts; store each once
+    std::vector<CacheRecord> records;
+    records.reserve(entries.size());
+    std::string pool;
+    std::unordered_map<std::string, std::uint64_t> pooled;
+    for (const auto& entry : entries) {
+        const Entry& value = entry.second;
+        const std::string& text = value.kind == kindOperation ? value.operation.getOperationType() : value.text;
+        auto offset = pooled.emplace(text, pool.size());
+        if (offset.second) {
+            pool += text;
+        }
+
+        CacheRecord record;
+        record.keyHigh = entry.first.high;
+        record.keyLow = entry.first.low;
+        record.stamp = value.stamp;
+        record.lastUsed = value.lastUsed;
+        record.cuttingTime = value.operation.getCuttingTime();
+        record.feedRate = value.operation.getFeedRate();
+        record.spindleSpeed = value.operation.getSpindleSpeed();
+        record.toolDiameter = value.operation.getToolDiameter();
+        record.textOffset = offset.first->second;
+        record.textLength = static_cast<std::uint32_t>(text.size());
+        record.kind = value.kind;
+        records.push_back(record);
+    }
+
+    CacheFileHeader header;
+    std::memcpy(header.magic, cacheMagic, sizeof(cacheMagic));
+    header.formatVersion = cacheFormatVersion;
+    header.recordSize = sizeof(CacheRecord);
+    header.clock = clock;
+    header.count = records.size();
+    header.poolBytes = pool.size();
+    header.checksum = checksumFile(records, pool);
+
+    // Write next to the target and rename, so readers never see a partial file
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            std::cout << "Error: cannot write extraction cache " << temporary << std::endl;
+            return false;
+        }
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(CacheRecord));
+        file.write(pool.data(), pool.size());
+        if (!file) {
+            std::cout << "Error: failed to write extraction cache " << temporary << std::endl;
+            return false;
+        }
+    }
+    if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+        std::remove(path.c_str());     // rename does not replace existing files on Windows
+        if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+            std::cout << "Error: cannot replace extraction cache " << path << std::endl;
+            return false;
+        }
+    }
+    modified = false;
+    return true;
+}
\ No newline at end of file
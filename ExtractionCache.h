@@ -0,0 +1,168 @@
+#ifndef EXTRACTION_CACHE_H
+#define EXTRACTION_CACHE_H
+
+#include "NXCamDataExtractor.h"
+#include "OperationCache.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <unordered_map>
+
+/**
+ * @brief Persistent cache of data extracted from NX parts
+ *
+ * Entries are keyed by the part fingerprint and the operation id (or the name of a
+ * part-level text such as the tool information), and carry the modification stamp the data
+ * was read at. A lookup with a different stamp misses, so changed operations are read again
+ * while unchanged ones come from the cache.
+ *
+ * The file is a header, fixed-size records and a pool of the strings they refer to, in
+ * native endianness and protected by a checksum. Saving first evicts the least recently used
+ * entries until the file fits the size cap, so entries of parts that are no longer opened,
+ * and of deleted operations, age out.
+ */
+class ExtractionCache {
+private:
+    struct Entry {
+        std::uint64_t stamp;
+        std::uint64_t lastUsed;     // value of the use clock at the last lookup or insert
+        std::uint32_t kind;         // operation or text
+        NXOperation operation;
+        std::string text;           // text entries only
+
+        Entry();
+    };
+
+    std::pmr::unordered_map<OperationKey, Entry, OperationKeyHash> entries;
+    std::uint64_t clock;
+    std::uint64_t maxBytes;
+    std::uint64_t bytes;            // file size of the current entries, before string pooling
+    std::size_t hits;
+    std::size_t misses;
+    bool modified;
+
+    static std::uint64_t entryBytes(const Entry& entry);
+    void store(const OperationKey& key, Entry& entry);
+    Entry* lookup(const OperationKey& key, std::uint64_t stamp);
+
+public:
+    /**
+     * @brief Empty cache
+     * @param resource Memory resource of the entries (e.g. from a MemoryAccount)
+     */
+    explicit ExtractionCache(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+    /**
+     * @brief Fingerprint a part by its absolute path and its identity within NX
+     *
+     * The identity (e.g. the part's UUID) stays the same across saves of the part, so changes
+     * within it are detected by the operation stamps alone; a different part copied over the
+     * same path gets a different fingerprint instead of being served the old part's operations.
+     * @param path Part file path
+     * @param identity Persistent identity of the part, stable across saves
+     * @return Fingerprint
+     */
+    static std::uint64_t fingerprintPart(const std::string& path, const std::string& identity);
+
+    /**
+     * @brief Look up an operation
+     * @param part Part fingerprint
+     * @param id Operation id
+     * @param stamp Current modification stamp of the operation
+     * @return Cached operation, or nullptr if it is not cached or was cached at another stamp
+     */
+    const NXOperation* findOperation(std::uint64_t part, const std::string& id, std::uint64_t stamp);
+
+    /**
+     * @brief Add or replace an operation
+     * @param part Part fingerprint
+     * @param id Operation id
+     * @param stamp Modification stamp the operation was read at
+     * @param operation Operation
+     */
+    void insertOperation(std::uint64_t part, const std::string& id, std::uint64_t stamp,
+                         const NXOperation& operation);
+
+    /**
+     * @brief Look up a part-level text
+     * @param part Part fingerprint
+     * @param name Name of the text (e.g. "tool-info")
+     * @param stamp Current stamp of the data the text was extracted from
+     * @return Cached text, or nullptr if it is not cached or was cached at another stamp
+     */
+    const std::string* findText(std::uint64_t part, const std::string& name, std::uint64_t stamp);
+
+    /**
+     * @brief Add or replace a part-level text
+     * @param part Part fingerprint
+     * @param name Name of the text
+     * @param stamp Stamp of the data the text was extracted from
+     * @param text Text
+     */
+    void insertText(std::uint64_t part, const std::string& name, std::uint64_t stamp, const std::string& text);
+
+    /**
+     * @brief Set the size cap of the cache file (default 64 MiB)
+     * @param limit Maximum file size in bytes
+     */
+    void setMaxBytes(std::uint64_t limit);
+
+    /**
+     * @brief Get the size cap of the cache file
+     * @return Maximum file size in bytes
+     */
+    std::uint64_t getMaxBytes() const;
+
+    /**
+     * @brief Evict the least recently used entries until the cache fits the size cap
+     * @return Number of entries evicted
+     */
+    std::size_t trim();
+
+    /**
+     * @brief Get the number of cached entries
+     * @return Number of entries
+     */
+    std::size_t size() const;
+
+    /**
+     * @brief Get the number of lookups that were served from the cache
+     * @return Hits since construction
+     */
+    std::size_t getHits() const;
+
+    /**
+     * @brief Get the number of lookups that had to extract again
+     * @return Misses since construction
+     */
+    std::size_t getMisses() const;
+
+    /**
+     * @brief Drop all entries
+     */
+    void clear();
+
+    /**
+     * @brief Check whether entries were added or evicted since the last load or save
+     * @return True if the cache should be saved
+     */
+    bool isModified() const;
+
+    /**
+     * @brief Load a cache file
+     * @param path Cache file
+     * @return True if entries were loaded; false if the file is missing or corrupt (the cache
+     *         is then left empty)
+     */
+    bool load(const std::string& path);
+
+    /**
+     * @brief Trim the cache to the size cap and write it to a cache file
+     * @param path Cache file (written to a temporary file and renamed)
+     * @return True on success
+     */
+    bool save(const std::string& path);
+};
+
+#endif // EXTRACTION_CACHE_H
\ No newline at end of file
@@ -0,0 +1,110 @@
+#include "GridIntensity.h"
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+GridIntensity::GridIntensity() : GridIntensity(0.475) {
+}
+
+GridIntensity::GridIntensity(double emissionFactor)
+    : GridIntensity(0.0, 60.0, std::vector<double>(1, emissionFactor)) {
+}
+
+GridIntensity::GridIntensity(double start, double intervalMinutes, const std::vector<double>& intensities)
+    : startTime(start), interval(intervalMinutes > 0.0 ? intervalMinutes : 60.0), values(intensities) {
+    if (values.empty()) {
+        values.push_back(0.475);
+    }
+    cumulative.resize(values.size() + 1);
+    cumulative[0] = 0.0;
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        cumulative[i + 1] = cumulative[i] + values[i] * interval;
+    }
+}
+
+bool GridIntensity::loadCsv(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cout << "Error: cannot open grid intensity file " << path << std::endl;
+        return false;
+    }
+
+    std::string line;
+    std::getline(file, line);
+    std::vector<double> times;
+    std::vector<double> intensities;
+    while (std::getline(file, line)) {
+        std::size_t comma = line.find(',');
+        if (comma == std::string::npos) {
+            continue;
+        }
+        char* end = nullptr;
+        double time = std::strtod(line.c_str(), &end);
+        if (end == line.c_str()) {
+            continue;
+        }
+        const char* valueText = line.c_str() + comma + 1;
+        double intensity = std::strtod(valueText, &end);
+        if (end == valueText) {
+            continue;
+        }
+        times.push_back(time);
+        intensities.push_back(intensity);
+    }
+
+    if (intensities.empty()) {
+        std::cout << "Error: no grid intensity values in " << path << std::endl;
+        return false;
+    }
+    double spacing = times.size() > 1 ? times[1] - times[0] : 60.0;
+    for (std::size_t i = 1; i < times.size(); ++i) {
+        if (!(spacing > 0.0) || std::fabs((times[i] - times[i - 1]) - spacing) > 1e-6 * spacing) {
+            std::cout << "Error: grid intensity rows in " << path << " are not equally spaced" << std::endl;
+            return false;
+        }
+    }
+
+    *this = GridIntensity(times[0], spacing, intensities);
+    return true;
+}
+
+double GridIntensity::integralTo(double time) const {
+    double offset = time - startTime;
+    if (offset <= 0.0) {
+        return offset * values.front();
+    }
+    std::size_t index = static_cast<std::size_t>(offset / interval);
+    if (index >= values.size()) {
+        double end = static_cast<double>(values.size()) * interval;
+        return cumulative.back() + (offset - end) * values.back();
+    }
+    return cumulative[index] + (offset - static_cast<double>(index) * interval) * values[index];
+}
+
+double GridIntensity::at(double time) const {
+    double offset = time - startTime;
+    if (offset <= 0.0) {
+        return values.front();
+    }
+    std::size_t index = static_cast<std::size_t>(offset / interval);
+    return index < values.size() ? values[index] : values.back();
+}
+
+double GridIntensity::emissions(double power, double from, double to) const {
+    // Integral is in (kg CO2/kWh) * min, power in kW
+    return power * (integralTo(to) - integralTo(from)) / 60.0;
+}
+
+double GridIntensity::nextBoundary(double time) const {
+    double steps = std::floor((time - startTime) / interval) + 1.0;
+    return startTime + steps * interval;
+}
+
+double GridIntensity::getInterval() const {
+    return interval;
+}
+
+std::size_t GridIntensity::getIntervalCount() const {
+    return values.size();
+}
\ No newline at end of file
@@ -0,0 +1,91 @@
+#ifndef GRID_INTENSITY_H
+#define GRID_INTENSITY_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Time-varying carbon intensity of the electricity grid
+ *
+ * Piecewise constant over equal intervals (e.g. hourly forecasts). Before the first
+ * interval the first value applies, after the last interval the last value. Emissions
+ * of a constant load over any time span are answered in O(1) from a cumulative integral.
+ * Times are in minutes, intensities in kg CO2/kWh.
+ */
+class GridIntensity {
+private:
+    double startTime;               // minutes
+    double interval;                // minutes
+    std::vector<double> values;     // kg CO2/kWh per interval
+    std::vector<double> cumulative; // integral of the intensity up to each interval start
+
+    double integralTo(double time) const;
+
+public:
+    /**
+     * @brief Constant intensity of 0.475 kg CO2/kWh (US average)
+     */
+    GridIntensity();
+
+    /**
+     * @brief Constant intensity
+     * @param emissionFactor Emission factor in kg CO2/kWh, e.g. from CarbonModel
+     */
+    explicit GridIntensity(double emissionFactor);
+
+    /**
+     * @brief Intensity series
+     * @param start Start of the first interval in minutes
+     * @param intervalMinutes Length of each interval in minutes (must be positive)
+     * @param intensities Intensity per interval in kg CO2/kWh (must not be empty)
+     */
+    GridIntensity(double start, double intervalMinutes, const std::vector<double>& intensities);
+
+    /**
+     * @brief Load an intensity series from a CSV file with columns time_min,kg_co2_per_kwh
+     *
+     * Rows must be equally spaced in time; the first row is a header.
+     *
+     * @param path Path to the CSV file
+     * @return True on success; on failure the current series is kept
+     */
+    bool loadCsv(const std::string& path);
+
+    /**
+     * @brief Get the intensity at a point in time
+     * @param time Time in minutes
+     * @return Intensity in kg CO2/kWh
+     */
+    double at(double time) const;
+
+    /**
+     * @brief Calculate the emissions of a constant load
+     * @param power Load in kW
+     * @param from Start in minutes
+     * @param to End in minutes
+     * @return Emissions in kg CO2
+     */
+    double emissions(double power, double from, double to) const;
+
+    /**
+     * @brief Get the first interval boundary strictly after a point in time
+     * @param time Time in minutes
+     * @return Boundary in minutes (boundaries continue with the same spacing outside the series)
+     */
+    double nextBoundary(double time) const;
+
+    /**
+     * @brief Get the interval length
+     * @return Interval length in minutes
+     */
+    double getInterval() const;
+
+    /**
+     * @brief Get the number of intervals
+     * @return Number of intervals in the series
+     */
+    std::size_t getIntervalCount() const;
+};
+
+#endif // GRID_INTENSITY_H
\ No newline at end of file
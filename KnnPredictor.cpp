@@ -0,0 +1,631 @@
+#include "KnnPredictor.h"
+#include "ModelContainer.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <tuple>
+
+namespace {
+
+// Scales used when a dimension has no spread (e.g. a single measurement)
+const double defaultScales[KdIndex::Dimensions] = {4.0, 2000.0, 400.0, 1.0};
+
+// Ranges at or below this size are scanned linearly
+const std::size_t leafSize = 8;
+
+// Measurements that may sit in the tail before it is merged into the tree
+const std::size_t minTailSize = 64;
+
+const char indexMagic[8] = {'N', 'X', 'K', 'N', 'N', 'I', 'D', 'X'};
+const std::uint32_t indexVersion = 1;
+
+// File layout (native endianness, every section 8-byte aligned):
+//   FileHeader, then per index: IndexHeader, material name, machine type name,
+//   coords[count * Dimensions], values[count], splitDims[count]
+struct FileHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t indexCount;
+    std::uint64_t fileSize;
+};
+
+struct IndexHeader {
+    std::uint64_t count;
+    std::uint32_t materialLength;
+    std::uint32_t machineLength;
+    double mean[KdIndex::Dimensions];
+    double scale[KdIndex::Dimensions];
+};
+
+std::size_t alignUp(std::size_t offset) {
+    return (offset + 7) & ~static_cast<std::size_t>(7);
+}
+
+// Bounded sorted list of the best candidates found so far
+struct NeighbourSearch {
+    const double* query;
+    std::size_t k;
+    std::size_t found;
+    double distances[64];   // squared distances, ascending
+    double values[64];
+
+    double worst() const {
+        return (found < k) ? std::numeric_limits<double>::infinity() : distances[found - 1];
+    }
+
+    void consider(const double* point, double value) {
+        double d2 = 0.0;
+        for (int d = 0; d < KdIndex::Dimensions; ++d) {
+            double diff = query[d] - point[d];
+            d2 += diff * diff;
+        }
+        if (d2 >= worst()) {
+            return;
+        }
+        std::size_t i = (found < k) ? found++ : found - 1;
+        while (i > 0 && distances[i - 1] > d2) {
+            distances[i] = distances[i - 1];
+            values[i] = values[i - 1];
+            --i;
+        }
+        distances[i] = d2;
+        values[i] = value;
+    }
+
+    void searchRange(const double* coords, const double* pointValues, const std::uint8_t* splitDims,
+                     std::size_t lo, std::size_t hi) {
+        if (hi - lo <= leafSize) {
+            for (std::size_t i = lo; i < hi; ++i) {
+                consider(coords + i * KdIndex::Dimensions, pointValues[i]);
+            }
+            return;
+        }
+        std::size_t mid = lo + (hi - lo) / 2;
+        consider(coords + mid * KdIndex::Dimensions, pointValues[mid]);
+        int dim = splitDims[mid];
+        double diff = query[dim] - coords[mid * KdIndex::Dimensions + dim];
+        if (diff < 0.0) {
+            searchRange(coords, pointValues, splitDims, lo, mid);
+            if (diff * diff < worst()) {
+                searchRange(coords, pointValues, splitDims, mid + 1, hi);
+            }
+        } else {
+            searchRange(coords, pointValues, splitDims, mid + 1, hi);
+            if (diff * diff < worst()) {
+                searchRange(coords, pointValues, splitDims, lo, mid);
+            }
+        }
+    }
+};
+
+} // namespace
+
+// KdIndex implementation
+KdIndex::KdIndex() : coords(nullptr), values(nullptr), splitDims(nullptr), count(0) {
+    for (int d = 0; d < Dimensions; ++d) {
+        mean[d] = 0.0;
+        scale[d] = defaultScales[d];
+    }
+}
+
+void KdIndex::insert(const double point[Dimensions], double value) {
+    tailCoords.insert(tailCoords.end(), point, point + Dimensions);
+    tailValues.push_back(value);
+}
+
+bool KdIndex::needsRebuild() const {
+    // Keeps the linear tail scan within O(sqrt(n)) while bulk inserts cost a single rebuild
+    std::size_t limit = std::max(minTailSize, static_cast<std::size_t>(std::sqrt(static_cast<double>(count))));
+    return tailValues.size() > limit;
+}
+
+void KdIndex::rebuild() {
+    std::size_t total = count + tailValues.size();
+    std::vector<double> raw(total * Dimensions);
+    std::vector<double> allValues(total);
+
+    // Indexed points are stored normalized; bring them back to raw units
+    for (std::size_t i = 0; i < count; ++i) {
+        for (int d = 0; d < Dimensions; ++d) {
+            raw[i * Dimensions + d] = coords[i * Dimensions + d] * scale[d] + mean[d];
+        }
+        allValues[i] = values[i];
+    }
+    std::copy(tailCoords.begin(), tailCoords.end(), raw.begin() + count * Dimensions);
+    std::copy(tailValues.begin(), tailValues.end(), allValues.begin() + count);
+
+    for (int d = 0; d < Dimensions; ++d) {
+        double sum = 0.0;
+        double sumSquares = 0.0;
+        for (std::size_t i = 0; i < total; ++i) {
+            double v = raw[i * Dimensions + d];
+            sum += v;
+            sumSquares += v * v;
+        }
+        double m = (total > 0) ? sum / total : 0.0;
+        double variance = (total > 0) ? sumSquares / total - m * m : 0.0;
+        double stddev = (variance > 0.0) ? std::sqrt(variance) : 0.0;
+        mean[d] = m;
+        scale[d] = (stddev > 1e-9 * std::max(1.0, std::fabs(m))) ? stddev : defaultScales[d];
+    }
+
+    std::vector<double> normalized(total * Dimensions);
+    for (std::size_t i = 0; i < total; ++i) {
+        for (int d = 0; d < Dimensions; ++d) {
+            normalized[i * Dimensions + d] = (raw[i * Dimensions + d] - mean[d]) / scale[d];
+        }
+    }
+
+    std::vector<std::size_t> order(total);
+    std::iota(order.begin(), order.end(), 0);
+    ownedSplitDims.assign(total, 0);
+    buildRange(0, total, order, normalized);
+
+    ownedCoords.resize(total * Dimensions);
+    ownedValues.resize(total);
+    for (std::size_t i = 0; i < total; ++i) {
+        std::copy(normalized.begin() + order[i] * Dimensions,
+                  normalized.begin() + (order[i] + 1) * Dimensions,
+                  ownedCoords.begin() + i * Dimensions);
+        ownedValues[i] = allValues[order[i]];
+    }
+
+    coords = ownedCoords.data();
+    values = ownedValues.data();
+    splitDims = ownedSplitDims.data();
+    count = total;
+    tailCoords.clear();
+    tailValues.clear();
+}
+
+void KdIndex::buildRange(std::size_t lo, std::size_t hi, std::vector<std::size_t>& order,
+                         const std::vector<double>& normalized) {
+    if (hi - lo <= leafSize) {
+        return;
+    }
+
+    // Split on the dimension with the widest spread
+    int dim = 0;
+    double widest = -1.0;
+    for (int d = 0; d < Dimensions; ++d) {
+        double lowest = std::numeric_limits<double>::infinity();
+        double highest = -lowest;
+        for (std::size_t i = lo; i < hi; ++i) {
+            double v = normalized[order[i] * Dimensions + d];
+            lowest = std::min(lowest, v);
+            highest = std::max(highest, v);
+        }
+        if (highest - lowest > widest) {
+            widest = highest - lowest;
+            dim = d;
+        }
+    }
+
+    std::size_t mid = lo + (hi - lo) / 2;
+    std::nth_element(order.begin() + lo, order.begin() + mid, order.begin() + hi,
+                     [&](std::size_t a, std::size_t b) {
+                         return normalized[a * Dimensions + dim] < normalized[b * Dimensions + dim];
+                     });
+    ownedSplitDims[mid] = static_cast<std::uint8_t>(dim);
+    buildRange(lo, mid, order, normalized);
+    buildRange(mid + 1, hi, order, normalized);
+}
+
+void KdIndex::query(const double point[Dimensions], std::size_t k,
+                    std::vector<double>& distances, std::vector<double>& neighbourValues) const {
+    double normalized[Dimensions];
+    for (int d = 0; d < Dimensions; ++d) {
+        normalized[d] = (point[d] - mean[d]) / scale[d];
+    }
+
+    NeighbourSearch search;
+    search.query = normalized;
+    search.k = std::min<std::size_t>(std::max<std::size_t>(k, 1), 64);
+    search.found = 0;
+
+    if (count > 0) {
+        search.searchRange(coords, values, splitDims, 0, count);
+    }
+    for (std::size_t i = 0; i < tailValues.size(); ++i) {
+        double tailPoint[Dimensions];
+        for (int d = 0; d < Dimensions; ++d) {
+            tailPoint[d] = (tailCoords[i * Dimensions + d] - mean[d]) / scale[d];
+        }
+        search.consider(tailPoint, tailValues[i]);
+    }
+
+    distances.resize(search.found);
+    neighbourValues.resize(search.found);
+    for (std::size_t i = 0; i < search.found; ++i) {
+        distances[i] = std::sqrt(search.distances[i]);
+        neighbourValues[i] = search.values[i];
+    }
+}
+
+std::size_t KdIndex::size() const {
+    return count + tailValues.size();
+}
+
+// KnnPredictor implementation
+KnnPredictor::KnnPredictor(const FeatureCategories& cats)
+    : categories(cats), neighbours(5), maxDistance(2.0), weightPower(2.0) {
+}
+
+KnnPredictor::~KnnPredictor() {
+    // Indexes may point into the mapping, release them first
+    indexes.clear();
+    mappedFile.reset();
+}
+
+std::string KnnPredictor::getName() const {
+    return "knn";
+}
+
+bool KnnPredictor::isReady() const {
+    return !indexes.empty();
+}
+
+KdIndex* KnnPredictor::findIndex(int materialId, int machineTypeId) {
+    std::pair<int, int> ids(materialId, machineTypeId);
+    auto cached = resolvedIndexes.find(ids);
+    if (cached != resolvedIndexes.end()) {
+        return cached->second;
+    }
+    auto it = indexes.find(IndexKey(categories.materials.getName(materialId),
+                                    categories.machineTypes.getName(machineTypeId)));
+    KdIndex* index = (it != indexes.end()) ? &it->second : nullptr;
+    resolvedIndexes[ids] = index;
+    return index;
+}
+
+bool KnnPredictor::predictBatch(Span<const CutFeatures> features, Span<double> out) {
+    if (!isReady()) {
+        return false;
+    }
+
+    const double missing = std::numeric_limits<double>::quiet_NaN();
+    std::vector<double> distances;
+    std::vector<double> neighbourValues;
+    distances.reserve(neighbours);
+    neighbourValues.reserve(neighbours);
+
+    int lastMaterial = -2;
+    int lastMachine = -2;
+    KdIndex* index = nullptr;
+
+    for (std::size_t i = 0; i < features.size(); ++i) {
+        const CutFeatures& f = features[i];
+        if (f.materialId != lastMaterial || f.machineTypeId != lastMachine) {
+            index = findIndex(f.materialId, f.machineTypeId);
+            lastMaterial = f.materialId;
+            lastMachine = f.machineTypeId;
+            if (index != nullptr && index->needsRebuild()) {
+                index->rebuild();
+            }
+        }
+        if (index == nullptr) {
+            out[i] = missing;
+            continue;
+        }
+
+        double point[KdIndex::Dimensions] = {f.toolDiameter, f.spindleSpeed, f.feedRate, f.depthOfCut};
+        index->query(point, neighbours, distances, neighbourValues);
+        if (distances.empty() || distances[0] > maxDistance) {
+            out[i] = missing;
+            continue;
+        }
+
+        // Inverse-distance weighting; exact matches are averaged directly
+        if (distances[0] < 1e-12) {
+            double sum = 0.0;
+            std::size_t exact = 0;
+            while (exact < distances.size() && distances[exact] < 1e-12) {
+                sum += neighbourValues[exact++];
+            }
+            out[i] = sum / exact;
+            continue;
+        }
+        double weightedSum = 0.0;
+        double weightTotal = 0.0;
+        for (std::size_t j = 0; j < distances.size(); ++j) {
+            double weight = 1.0 / std::pow(distances[j], weightPower);
+            weightedSum += weight * neighbourValues[j];
+            weightTotal += weight;
+        }
+        out[i] = weightedSum / weightTotal;
+    }
+    return true;
+}
+
+void KnnPredictor::addMeasurement(const std::string& material, const std::string& machineType,
+                                  double toolDiameter, double spindleSpeed, double feedRate,
+                                  double depthOfCut, double cuttingPower) {
+    IndexKey key(material, machineType);
+    auto it = indexes.find(key);
+    if (it == indexes.end()) {
+        it = indexes.emplace(std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple()).first;
+        resolvedIndexes.clear();
+    }
+    double point[KdIndex::Dimensions] = {toolDiameter, spindleSpeed, feedRate, depthOfCut};
+    it->second.insert(point, cuttingPower);
+}
+
+void KnnPredictor::clearMeasurements() {
+    // Indexes may point into the mapping, release them first
+    indexes.clear();
+    resolvedIndexes.clear();
+    mappedFile.reset();
+}
+
+int KnnPredictor::loadMeasurementsCsv(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cout << "Error: cannot open measurement file " << path << std::endl;
+        return -1;
+    }
+
+    // Columns: material, tool_diameter_mm, spindle_rpm, feed_mm_min, depth_of_cut_mm,
+    //          operation_type, machine_type, cutting_power_kW
+    std::string line;
+    std::getline(file, line);
+    int added = 0;
+    int skipped = 0;
+    while (std::getline(file, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (line.empty()) {
+            continue;
+        }
+        std::vector<std::string> fields;
+        std::stringstream stream(line);
+        std::string field;
+        while (std::getline(stream, field, ',')) {
+            fields.push_back(field);
+        }
+        if (fields.size() < 8) {
+            ++skipped;
+            continue;
+        }
+        char* end = nullptr;
+        double values[5];
+        const int columns[5] = {1, 2, 3, 4, 7};
+        bool valid = true;
+        for (int c = 0; c < 5; ++c) {
+            values[c] = std::strtod(fields[columns[c]].c_str(), &end);
+            valid = valid && end != fields[columns[c]].c_str();
+        }
+        if (!valid) {
+            ++skipped;
+            continue;
+        }
+        addMeasurement(fields[0], fields[6], values[0], values[1], values[2], values[3], values[4]);
+        ++added;
+    }
+
+    std::cout << "Loaded " << added << " measured cuts from " << path;
+    if (skipped > 0) {
+        std::cout << " (" << skipped << " malformed rows skipped)";
+    }
+    std::cout << std::endl;
+    return added;
+}
+
+bool KnnPredictor::save(const std::string& path) {
+    // Write next to the target and rename: after load() the indexes point into the mapping of
+    // the target, which must not change under them
+    std::string temporary = path + ".tmp";
+    std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cout << "Error: cannot write kNN index file " << temporary << std::endl;
+        return false;
+    }
+
+    const char padding[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    auto writeAligned = [&](const void* bytes, std::size_t length) {
+        file.write(static_cast<const char*>(bytes), static_cast<std::streamsize>(length));
+        file.write(padding, static_cast<std::streamsize>(alignUp(length) - length));
+        return alignUp(length);
+    };
+
+    FileHeader header;
+    std::memcpy(header.magic, indexMagic, sizeof(indexMagic));
+    header.version = indexVersion;
+    header.indexCount = static_cast<std::uint32_t>(indexes.size());
+    header.fileSize = 0;
+    std::size_t offset = writeAligned(&header, sizeof(header));
+
+    for (auto& entry : indexes) {
+        KdIndex& index = entry.second;
+        if (!index.tailValues.empty()) {
+            index.rebuild();
+        }
+        IndexHeader indexHeader;
+        indexHeader.count = index.count;
+        indexHeader.materialLength = static_cast<std::uint32_t>(entry.first.first.size());
+        indexHeader.machineLength = static_cast<std::uint32_t>(entry.first.second.size());
+        std::copy(index.mean, index.mean + KdIndex::Dimensions, indexHeader.mean);
+        std::copy(index.scale, index.scale + KdIndex::Dimensions, indexHeader.scale);
+
+        offset += writeAligned(&indexHeader, sizeof(indexHeader));
+        offset += writeAligned(entry.first.first.data(), entry.first.first.size());
+        offset += writeAligned(entry.first.second.data(), entry.first.second.size());
+        offset += writeAligned(index.coords, index.count * KdIndex::Dimensions * sizeof(double));
+        offset += writeAligned(index.values, index.count * sizeof(double));
+        offset += writeAligned(index.splitDims, index.count);
+    }
+
+    // Patch the total size so truncated files are detected on load
+    header.fileSize = offset;
+    file.seekp(0);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.close();
+    if (!file.good()) {
+        std::cout << "Error: failed to write kNN index file " << temporary << std::endl;
+        std::remove(temporary.c_str());
+        return false;
+    }
+    if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+        std::remove(path.c_str());     // rename does not replace existing files on Windows
+        if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+            std::cout << "Error: cannot replace kNN index file " << path << std::endl;
+            return false;
+        }
+    }
+
+    std::cout << "kNN index saved to " << path << " (" << indexes.size() << " indexes, "
+              << getMeasurementCount() << " measurements)" << std::endl;
+    return true;
+}
+
+bool KnnPredictor::load(const std::string& path) {
+    auto mapping = std::make_unique<MappedFile>();
+    if (!mapping->open(path)) {
+        std::cout << "Error: cannot map kNN index file " << path << std::endl;
+        return false;
+    }
+
+    const unsigned char* base = mapping->getData();
+    std::size_t size = mapping->getSize();
+    FileHeader header;
+    if (size < sizeof(header)) {
+        std::cout << "Error: kNN index file " << path << " is truncated" << std::endl;
+        return false;
+    }
+    std::memcpy(&header, base, sizeof(header));
+    if (std::memcmp(header.magic, indexMagic, sizeof(indexMagic)) != 0 ||
+        header.version != indexVersion || header.fileSize != size) {
+        std::cout << "Error: " << path << " is not a valid kNN index file (version " << indexVersion << ")" << std::endl;
+        return false;
+    }
+
+    std::map<IndexKey, KdIndex> loaded;
+    std::size_t offset = alignUp(sizeof(header));
+    for (std::uint32_t n = 0; n < header.indexCount; ++n) {
+        IndexHeader indexHeader;
+        if (offset + sizeof(indexHeader) > size) {
+            std::cout << "Error: kNN index file " << path << " is truncated" << std::endl;
+            return false;
+        }
+        std::memcpy(&indexHeader, base + offset, sizeof(indexHeader));
+        offset += alignUp(sizeof(indexHeader));
+
+        if (indexHeader.count > size || indexHeader.materialLength > size || indexHeader.machineLength > size) {
+            std::cout << "Error: kNN index file " << path << " is truncated" << std::endl;
+            return false;
+        }
+        std::size_t count = static_cast<std::size_t>(indexHeader.count);
+        std::size_t materialOffset = offset;
+        offset += alignUp(indexHeader.materialLength);
+        std::size_t machineOffset = offset;
+        offset += alignUp(indexHeader.machineLength);
+        std::size_t coordsOffset = offset;
+        offset += count * KdIndex::Dimensions * sizeof(double);
+        std::size_t valuesOffset = offset;
+        offset += count * sizeof(double);
+        std::size_t splitOffset = offset;
+        offset += alignUp(count);
+        if (offset > size) {
+            std::cout << "Error: kNN index file " << path << " is truncated" << std::endl;
+            return false;
+        }
+
+        // Queries index the point with the split dimensions without checks
+        const std::uint8_t* splitDims = base + splitOffset;
+        if (std::any_of(splitDims, splitDims + count, [](std::uint8_t dim) { return dim >= KdIndex::Dimensions; })) {
+            std::cout << "Error: kNN index file " << path << " is corrupt" << std::endl;
+            return false;
+        }
+
+        IndexKey key(std::string(reinterpret_cast<const char*>(base + materialOffset), indexHeader.materialLength),
+                     std::string(reinterpret_cast<const char*>(base + machineOffset), indexHeader.machineLength));
+        KdIndex& index = loaded[key];
+        std::copy(indexHeader.mean, indexHeader.mean + KdIndex::Dimensions, index.mean);
+        std::copy(indexHeader.scale, indexHeader.scale + KdIndex::Dimensions, index.scale);
+        index.coords = reinterpret_cast<const double*>(base + coordsOffset);
+        index.values = reinterpret_cast<const double*>(base + valuesOffset);
+        index.splitDims = splitDims;
+        index.count = count;
+    }
+
+    indexes.swap(loaded);
+    resolvedIndexes.clear();
+    loaded.clear();     // previous indexes may still point into the previous mapping
+    mappedFile = std::move(mapping);
+
+    std::cout << "kNN index loaded from " << path << " (" << indexes.size() << " indexes, "
+              << getMeasurementCount() << " measurements)" << std::endl;
+    return true;
+}
+
+void KnnPredictor::setNeighbours(std::size_t k) {
+    neighbours = std::min<std::size_t>(std::max<std::size_t>(k, 1), 64);
+}
+
+void KnnPredictor::setMaxDistance(double distance) {
+    maxDistance = distance;
+}
+
+std::size_t KnnPredictor::getMeasurementCount() const {
+    std::size_t total = 0;
+    for (const auto& entry : indexes) {
+        total += entry.second.size();
+    }
+    return total;
+}
+
+std::uint64_t KnnPredictor::getChecksum() const {
+    // Measured points are summed after mixing, so the order of points (insertion order,
+    // tree layout, tail) does not matter
+    auto mix = [](std::uint64_t x) {
+        x ^= x >> 33;
+        x *= 0xff51afd7ed558ccdULL;
+        x ^= x >> 33;
+        x *= 0xc4ceb9fe1a85ec53ULL;
+        return x ^ (x >> 33);
+    };
+    auto bitsOf = [](double value) {
+        std::uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    };
+    // Coordinates in raw units, rounded to float: the tree stores them normalized with a
+    // normalization that is recomputed on every rebuild, and the round trip is not exact
+    auto pointHash = [&mix, &bitsOf](const double raw[KdIndex::Dimensions], double value) {
+        std::uint64_t hash = mix(bitsOf(value));
+        for (int d = 0; d < KdIndex::Dimensions; ++d) {
+            float rounded = static_cast<float>(raw[d]);
+            std::uint32_t bits;
+            std::memcpy(&bits, &rounded, sizeof(bits));
+            hash = mix(hash ^ (static_cast<std::uint64_t>(d + 1) << 32 | bits));
+        }
+        return hash;
+    };
+
+    std::uint64_t digest = mix(neighbours) ^ mix(bitsOf(maxDistance) + 1) ^ mix(bitsOf(weightPower) + 2);
+    for (const auto& entry : indexes) {
+        const KdIndex& index = entry.second;
+        std::uint64_t pointSum = 0;
+        double raw[KdIndex::Dimensions];
+        for (std::size_t i = 0; i < index.count; ++i) {
+            for (int d = 0; d < KdIndex::Dimensions; ++d) {
+                raw[d] = index.coords[i * KdIndex::Dimensions + d] * index.scale[d] + index.mean[d];
+            }
+            pointSum += pointHash(raw, index.values[i]);
+        }
+        for (std::size_t i = 0; i < index.tailValues.size(); ++i) {
+            pointSum += pointHash(&index.tailCoords[i * KdIndex::Dimensions], index.tailValues[i]);
+        }
+        std::string name = entry.first.first + '\0' + entry.first.second;
+        digest = mix(digest ^ ModelContainer::checksum(name.data(), name.size()));
+        digest = mix(digest ^ pointSum ^ index.size());
+    }
+    return digest;
+}
\ No newline at end of file
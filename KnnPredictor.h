@@ -0,0 +1,188 @@
+#ifndef KNN_PREDICTOR_H
+#define KNN_PREDICTOR_H
+
+#include "PowerPredictor.h"
+#include "MappedFile.h"
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief KD-tree over the measured cuts of one (material, machine type) pair
+ *
+ * Points are stored normalized (per-dimension mean and scale) in an implicit
+ * median-split tree: the node of range [lo, hi) is the point at (lo + hi) / 2.
+ * The arrays either live in owned vectors or point into a mapped index file.
+ * New measurements go to an unindexed tail that is scanned linearly; the owner
+ * merges it into the tree before querying once it outgrows sqrt(n) points.
+ */
+class KdIndex {
+public:
+    static const int Dimensions = 4;    // tool diameter, spindle speed, feed rate, depth of cut
+
+private:
+    double mean[Dimensions];
+    double scale[Dimensions];
+
+    // Indexed points, owned or mapped
+    const double* coords;               // count * Dimensions, normalized
+    const double* values;               // measured cutting power in kW
+    const std::uint8_t* splitDims;      // split dimension of the node at each position
+    std::size_t count;
+
+    std::vector<double> ownedCoords;
+    std::vector<double> ownedValues;
+    std::vector<std::uint8_t> ownedSplitDims;
+
+    // Raw (unnormalized) measurements not yet in the tree
+    std::vector<double> tailCoords;
+    std::vector<double> tailValues;
+
+    void buildRange(std::size_t lo, std::size_t hi, std::vector<std::size_t>& order,
+                    const std::vector<double>& normalized);
+
+    friend class KnnPredictor;
+
+public:
+    KdIndex();
+
+    // The point arrays may refer to the owned vectors, so copies would dangle
+    KdIndex(const KdIndex&) = delete;
+    KdIndex& operator=(const KdIndex&) = delete;
+
+    /**
+     * @brief Add a measurement
+     * @param point Tool diameter (mm), spindle speed (RPM), feed rate (mm/min), depth of cut (mm)
+     * @param value Measured cutting power in kW
+     */
+    void insert(const double point[Dimensions], double value);
+
+    /**
+     * @brief Check whether the tail has grown enough to be merged into the tree
+     * @return True if rebuild() should be called before the next query
+     */
+    bool needsRebuild() const;
+
+    /**
+     * @brief Merge the tail into the tree and recompute the normalization
+     */
+    void rebuild();
+
+    /**
+     * @brief Find the k nearest measurements of a point
+     * @param point Query point in raw units
+     * @param k Number of neighbours
+     * @param distances Output normalized distances, ascending
+     * @param neighbourValues Output measured cutting power of each neighbour
+     */
+    void query(const double point[Dimensions], std::size_t k,
+               std::vector<double>& distances, std::vector<double>& neighbourValues) const;
+
+    /**
+     * @brief Get the number of measurements (indexed and tail)
+     * @return Number of measurements
+     */
+    std::size_t size() const;
+};
+
+/**
+ * @brief Data-driven cutting power lookup over historical measured cuts
+ *
+ * Keeps one KdIndex per (material, machine type) and predicts by inverse-distance
+ * weighting of the k nearest measurements. Cuts without an index, or whose nearest
+ * measurement is farther than the maximum distance, are left as NaN for the next backend.
+ */
+class KnnPredictor : public PowerPredictor {
+private:
+    typedef std::pair<std::string, std::string> IndexKey;   // (material, machine type)
+
+    const FeatureCategories& categories;
+    std::map<IndexKey, KdIndex> indexes;
+    std::map<std::pair<int, int>, KdIndex*> resolvedIndexes;  // (material id, machine type id) cache
+    std::unique_ptr<MappedFile> mappedFile;
+    std::size_t neighbours;
+    double maxDistance;         // in normalized units
+    double weightPower;
+
+    KdIndex* findIndex(int materialId, int machineTypeId);
+
+public:
+    explicit KnnPredictor(const FeatureCategories& categories);
+    ~KnnPredictor();
+
+    std::string getName() const override;
+    bool isReady() const override;
+    bool predictBatch(Span<const CutFeatures> features, Span<double> out) override;
+
+    /**
+     * @brief Add a measured cut
+     * @param material Type of material being machined
+     * @param machineType Type of machine
+     * @param toolDiameter Tool diameter in mm
+     * @param spindleSpeed Spindle speed in RPM
+     * @param feedRate Feed rate in mm/min
+     * @param depthOfCut Depth of cut in mm
+     * @param cuttingPower Measured cutting power in kW
+     */
+    void addMeasurement(const std::string& material, const std::string& machineType,
+                        double toolDiameter, double spindleSpeed, double feedRate,
+                        double depthOfCut, double cuttingPower);
+
+    /**
+     * @brief Drop all measurements, including those of a loaded index file
+     */
+    void clearMeasurements();
+
+    /**
+     * @brief Add all measurements of a CSV file in the datasets/machining_power.csv layout
+     * @param path Path to the CSV file
+     * @return Number of measurements added, or -1 if the file cannot be read
+     */
+    int loadMeasurementsCsv(const std::string& path);
+
+    /**
+     * @brief Write all indexes to a memory-mappable file
+     * @param path Output path
+     * @return True on success
+     */
+    bool save(const std::string& path);
+
+    /**
+     * @brief Replace all indexes with those of a file, used in place from a memory mapping
+     * @param path Index file written by save()
+     * @return True on success; on failure the current indexes are kept
+     */
+    bool load(const std::string& path);
+
+    /**
+     * @brief Set the number of neighbours used per prediction
+     * @param k Number of neighbours (at least 1)
+     */
+    void setNeighbours(std::size_t k);
+
+    /**
+     * @brief Set the distance beyond which no prediction is made
+     * @param distance Maximum normalized distance to the nearest measurement
+     */
+    void setMaxDistance(double distance);
+
+    /**
+     * @brief Get the total number of measurements
+     * @return Number of measurements over all indexes
+     */
+    std::size_t getMeasurementCount() const;
+
+    /**
+     * @brief Get a digest of the measurements and settings, e.g. to version cached predictions
+     *
+     * Independent of insertion order and of whether the indexes were rebuilt or mapped.
+     *
+     * @return 64-bit digest
+     */
+    std::uint64_t getChecksum() const;
+};
+
+#endif // KNN_PREDICTOR_H
\ No newline at end of file
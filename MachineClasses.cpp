@@ -0,0 +1,60 @@
+#include "MachineClasses.h"
+#include <cstring>
+
+namespace {
+
+// Everything the kernel of a class computes with, so that changing a constant invalidates
+// cached estimates made with the old value
+template <typename Machine>
+std::uint64_t fingerprintMachine() {
+    OperationKeyBuilder builder;
+    builder.add(std::string(Machine::name));
+    builder.add(Machine::ratedSpindlePower);
+    builder.add(Machine::rapidPower);
+    builder.add(Machine::idlePower);
+    builder.add(Machine::rapidTimeFactor);
+    builder.add(Machine::idleTimePerOp);
+    builder.add(Machine::setupTime);
+    for (double load : Machine::efficiencyLoad) {
+        builder.add(load);
+    }
+    for (double efficiency : Machine::efficiency) {
+        builder.add(efficiency);
+    }
+    return builder.getKey().low;
+}
+
+template <typename Machine>
+MachineKernel makeKernel(MachineClass machineClass) {
+    return MachineKernel{machineClass, Machine::name, Machine::setupTime, Machine::idlePower,
+                         &evaluateMachineOperations<Machine>, fingerprintMachine<Machine>()};
+}
+
+// Indexed by MachineClass
+const MachineKernel machineKernels[] = {
+    makeKernel<ThreeAxisVmc>(MachineClass::ThreeAxisVmc),
+    makeKernel<FiveAxis>(MachineClass::FiveAxis),
+    makeKernel<Hmc>(MachineClass::Hmc),
+    makeKernel<Lathe>(MachineClass::Lathe),
+    makeKernel<MillTurn>(MachineClass::MillTurn)
+};
+
+static_assert(sizeof(machineKernels) / sizeof(machineKernels[0]) == static_cast<std::size_t>(MachineClass::Count),
+              "one kernel per machine class");
+static_assert(spindleEfficiency<ThreeAxisVmc>(1.0) == 0.90 && spindleEfficiency<ThreeAxisVmc>(0.0) == 0.55,
+              "efficiency maps are evaluated at compile time");
+
+} // namespace
+
+const MachineKernel& getMachineKernel(MachineClass machineClass) {
+    return machineKernels[static_cast<std::size_t>(machineClass)];
+}
+
+const MachineKernel* findMachineKernel(const std::string& machineType) {
+    for (const MachineKernel& kernel : machineKernels) {
+        if (std::strcmp(kernel.name, machineType.c_str()) == 0) {
+            return &kernel;
+        }
+    }
+    return nullptr;
+}
\ No newline at end of file
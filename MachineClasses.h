@@ -0,0 +1,182 @@
+#ifndef MACHINE_CLASSES_H
+#define MACHINE_CLASSES_H
+
+#include "OperationCache.h"
+#include "TimeModel.h"
+#include "EnergyModel.h"
+#include "CarbonModel.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Machine classes with their own power levels, drive efficiency and time constants
+ */
+enum class MachineClass {
+    ThreeAxisVmc,
+    FiveAxis,
+    Hmc,
+    Lathe,
+    MillTurn,
+    Count
+};
+
+// Machine class policies. Each one provides, as compile-time constants:
+//   name                     machine type name used in parts and predictor chains
+//   ratedSpindlePower        kW at full spindle load
+//   rapidPower, idlePower    kW while positioning and between operations
+//   rapidTimeFactor          rapid time as a fraction of cutting time
+//   idleTimePerOp, setupTime minutes per operation and per job
+//   efficiencyLoad[]         spindle load fractions (ascending) of the drive efficiency map
+//   efficiency[]             drive efficiency at those loads
+
+struct ThreeAxisVmc {
+    static constexpr const char* name = "3axis_VMC";
+    static constexpr double ratedSpindlePower = 15.0;
+    static constexpr double rapidPower = 3.0;
+    static constexpr double idlePower = 1.0;
+    static constexpr double rapidTimeFactor = 0.3;
+    static constexpr double idleTimePerOp = 2.0;
+    static constexpr double setupTime = 10.0;
+    static constexpr double efficiencyLoad[] = {0.05, 0.25, 0.5, 0.75, 1.0};
+    static constexpr double efficiency[] = {0.55, 0.78, 0.86, 0.89, 0.90};
+};
+
+struct FiveAxis {
+    static constexpr const char* name = "5axis_VMC";
+    static constexpr double ratedSpindlePower = 20.0;
+    static constexpr double rapidPower = 4.5;       // two rotary axes on top of the linear axes
+    static constexpr double idlePower = 1.6;
+    static constexpr double rapidTimeFactor = 0.35;
+    static constexpr double idleTimePerOp = 2.5;
+    static constexpr double setupTime = 20.0;
+    static constexpr double efficiencyLoad[] = {0.05, 0.25, 0.5, 0.75, 1.0};
+    static constexpr double efficiency[] = {0.50, 0.75, 0.84, 0.88, 0.89};
+};
+
+struct Hmc {
+    static constexpr const char* name = "HMC";
+    static constexpr double ratedSpindlePower = 30.0;
+    static constexpr double rapidPower = 5.5;
+    static constexpr double idlePower = 2.2;
+    static constexpr double rapidTimeFactor = 0.25;
+    static constexpr double idleTimePerOp = 1.5;
+    static constexpr double setupTime = 8.0;         // parts are fixtured on pallets outside the machine
+    static constexpr double efficiencyLoad[] = {0.05, 0.25, 0.5, 0.75, 1.0};
+    static constexpr double efficiency[] = {0.52, 0.80, 0.88, 0.91, 0.92};
+};
+
+struct Lathe {
+    static constexpr const char* name = "Lathe";
+    static constexpr double ratedSpindlePower = 18.0;
+    static constexpr double rapidPower = 2.0;
+    static constexpr double idlePower = 0.8;
+    static constexpr double rapidTimeFactor = 0.15;
+    static constexpr double idleTimePerOp = 1.0;    // turret index instead of a tool change
+    static constexpr double setupTime = 12.0;
+    static constexpr double efficiencyLoad[] = {0.05, 0.25, 0.5, 0.75, 1.0};
+    static constexpr double efficiency[] = {0.60, 0.80, 0.87, 0.90, 0.91};
+};
+
+struct MillTurn {
+    static constexpr const char* name = "MillTurn";
+    static constexpr double ratedSpindlePower = 22.0;
+    static constexpr double rapidPower = 4.0;
+    static constexpr double idlePower = 1.8;
+    static constexpr double rapidTimeFactor = 0.25;
+    static constexpr double idleTimePerOp = 1.5;
+    static constexpr double setupTime = 30.0;
+    static constexpr double efficiencyLoad[] = {0.05, 0.25, 0.5, 0.75, 1.0};
+    static constexpr double efficiency[] = {0.52, 0.76, 0.85, 0.88, 0.89};
+};
+
+/**
+ * @brief Drive efficiency of a machine class at a spindle load, interpolated in its efficiency map
+ * @param load Spindle power as a fraction of the rated power (clamped to the map)
+ * @return Efficiency
+ */
+template <typename Machine>
+constexpr double spindleEfficiency(double load) {
+    constexpr std::size_t points = sizeof(Machine::efficiency) / sizeof(Machine::efficiency[0]);
+    static_assert(points == sizeof(Machine::efficiencyLoad) / sizeof(Machine::efficiencyLoad[0]),
+                  "efficiency map needs one efficiency per load");
+    if (!(load > Machine::efficiencyLoad[0])) {
+        return Machine::efficiency[0];
+    }
+    for (std::size_t i = 1; i < points; ++i) {
+        if (load <= Machine::efficiencyLoad[i]) {
+            double t = (load - Machine::efficiencyLoad[i - 1]) /
+                       (Machine::efficiencyLoad[i] - Machine::efficiencyLoad[i - 1]);
+            return Machine::efficiency[i - 1] + t * (Machine::efficiency[i] - Machine::efficiency[i - 1]);
+        }
+    }
+    return Machine::efficiency[points - 1];
+}
+
+/**
+ * @brief Electrical power a machine class draws for a predicted spindle cutting power
+ * @param cuttingPower Predicted cutting power at the spindle in kW
+ * @return Power drawn in kW
+ */
+template <typename Machine>
+constexpr double drawnCuttingPower(double cuttingPower) {
+    return cuttingPower / spindleEfficiency<Machine>(cuttingPower / Machine::ratedSpindlePower);
+}
+
+/**
+ * @brief Time, energy and emission kernel of a machine class
+ *
+ * Instantiated once per class, so the constants are folded into the loop and nothing in
+ * it depends on the machine type at run time.
+ * @param cuttingTime Cutting time of each operation in minutes
+ * @param cuttingPower Predicted spindle cutting power of each operation in kW
+ * @param count Number of operations
+ * @param emissionFactor Emission factor in kg CO2/kWh
+ * @param estimates Receives one estimate per operation; cuttingPower is the power drawn
+ */
+template <typename Machine>
+void evaluateMachineOperations(const double* cuttingTime, const double* cuttingPower, std::size_t count,
+                               double emissionFactor, OperationEstimate* estimates) {
+    const double idleEnergy = EnergyModel::computeEnergy(Machine::idleTimePerOp, Machine::idlePower);
+    for (std::size_t i = 0; i < count; ++i) {
+        OperationEstimate& e = estimates[i];
+        e.cuttingTime = cuttingTime[i];
+        e.cuttingPower = drawnCuttingPower<Machine>(cuttingPower[i]);
+        e.rapidTime = TimeModel::computeRapidTime(e.cuttingTime, Machine::rapidTimeFactor);
+        e.idleTime = Machine::idleTimePerOp;
+        e.totalTime = TimeModel::computeTotalTime(e.cuttingTime, e.rapidTime, e.idleTime);
+        e.energy = EnergyModel::computeTotalEnergy(EnergyModel::computeEnergy(e.cuttingTime, e.cuttingPower),
+                                                   EnergyModel::computeEnergy(e.rapidTime, Machine::rapidPower),
+                                                   idleEnergy);
+        e.carbon = CarbonModel::computeEmission(e.energy, emissionFactor);
+    }
+}
+
+/**
+ * @brief Entry of the machine class dispatch table
+ */
+struct MachineKernel {
+    MachineClass machineClass;
+    const char* name;
+    double setupTime;       // minutes per job
+    double idlePower;       // kW, also drawn during setup
+    void (*evaluate)(const double* cuttingTime, const double* cuttingPower, std::size_t count,
+                     double emissionFactor, OperationEstimate* estimates);
+    std::uint64_t fingerprint;  // hash of all class constants, part of the estimate version
+};
+
+/**
+ * @brief Get the kernel of a machine class
+ * @param machineClass Machine class
+ * @return Dispatch table entry
+ */
+const MachineKernel& getMachineKernel(MachineClass machineClass);
+
+/**
+ * @brief Find the kernel of a machine type name
+ * @param machineType Machine type name (e.g. "5axis_VMC")
+ * @return Dispatch table entry, or nullptr if the name is not a known machine class
+ */
+const MachineKernel* findMachineKernel(const std::string& machineType);
+
+#endif // MACHINE_CLASSES_H
\ No newline at end of file
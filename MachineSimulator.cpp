@@ -0,0 +1,400 @@
+#include "MachineSimulator.h"
+#include "TimeModel.h"
+#include "EnergyModel.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+namespace {
+
+enum EventType : std::uint32_t {
+    PhaseEnd,
+    JobRelease,
+    StandbyTimeout,
+    ConveyorOff
+};
+
+const double pi = 3.14159265358979323846;
+const double joulesPerKWh = 3.6e6;
+
+// Rotational kinetic energy of the spindle in kWh
+double kineticEnergy(double inertia, double rpm) {
+    double omega = rpm * 2.0 * pi / 60.0;
+    return 0.5 * inertia * omega * omega / joulesPerKWh;
+}
+
+} // namespace
+
+MachineProfile::MachineProfile()
+    : name("Machine"), basePower(1.0), standbyPower(0.3), standbyDelay(15.0), wakeUpTime(2.0), axisRapidPower(2.0),
+      axisFeedPower(0.5), cuttingPower(5.0), spindleDragPower(0.4), spindleInertia(0.05), spindleAcceleration(2000.0),
+      spindleEfficiency(0.85), brakingRecovery(0.0), toolChangeTime(0.15), toolChangePower(0.8), coolantPower(0.75),
+      chipConveyorPower(0.25), chipConveyorRunOn(2.0) {
+}
+
+MachineProfile::MachineProfile(const std::string& machineName, const EnergyModel& energyModel)
+    : MachineProfile() {
+    name = machineName;
+    basePower = energyModel.getIdlePower();
+    axisRapidPower = std::max(energyModel.getRapidPower() - energyModel.getIdlePower(), 0.0);
+    cuttingPower = energyModel.getCuttingPower();
+}
+
+SimulationJob::SimulationJob() : releaseTime(0.0), setupTime(-1.0) {
+}
+
+SimulationJob::SimulationJob(const std::string& jobName, const std::vector<NXOperation>& jobOperations)
+    : name(jobName), operations(jobOperations), releaseTime(0.0), setupTime(-1.0) {
+}
+
+MachineResult::MachineResult() : jobsCompleted(0), operationsCompleted(0), toolChanges(0), spindleStarts(0) {
+    energy.fill(0.0);
+    time.fill(0.0);
+}
+
+double MachineResult::getTotalEnergy() const {
+    double total = 0.0;
+    for (double value : energy) {
+        total += value;
+    }
+    return total;
+}
+
+MachineSimulator::MachineSimulator(const TimeModel& timeModel)
+    : rapidTimeFactor(timeModel.getRapidTimeFactor()),
+      defaultSetupTime(timeModel.getSetupTime()),
+      now(0.0),
+      processedEvents(0),
+      wallSeconds(0.0) {
+}
+
+std::size_t MachineSimulator::addMachine(const MachineProfile& profile) {
+    Machine machine;
+    machine.profile = profile;
+    machine.result.name = profile.name;
+    machines.push_back(machine);
+    return machines.size() - 1;
+}
+
+bool MachineSimulator::addJob(std::size_t machine, const SimulationJob& job) {
+    if (machine >= machines.size()) {
+        std::cout << "Error: no machine " << machine << " for job " << job.name << std::endl;
+        return false;
+    }
+    machines[machine].jobs.push_back(job);
+    return true;
+}
+
+void MachineSimulator::integrate(Machine& machine, double time) {
+    double elapsed = time - machine.lastUpdate;
+    if (elapsed <= 0.0) {
+        return;
+    }
+    for (std::size_t s = 0; s < SubsystemCount; ++s) {
+        machine.result.energy[s] += EnergyModel::computeEnergy(elapsed, machine.power[s]);
+    }
+    machine.result.time[static_cast<std::size_t>(machine.state)] += elapsed;
+    machine.lastUpdate = time;
+}
+
+void MachineSimulator::enterState(std::uint32_t index, MachineState state, double duration) {
+    Machine& machine = machines[index];
+    const MachineProfile& profile = machine.profile;
+    integrate(machine, now);
+    machine.state = state;
+
+    double spindle = 0.0;
+    double axes = 0.0;
+    if (state == MachineState::SpindleRunUp || state == MachineState::SpindleBraking) {
+        // Kinetic energy change, spread over the transient; instantaneous transients are booked at once
+        double change = kineticEnergy(profile.spindleInertia, machine.targetSpeed)
+                      - kineticEnergy(profile.spindleInertia, machine.spindleSpeed);
+        double grid = change > 0.0 ? change / std::max(profile.spindleEfficiency, 1e-6)
+                                   : change * profile.spindleEfficiency * profile.brakingRecovery;
+        if (duration > 0.0) {
+            spindle = grid / (duration / 60.0);
+        } else {
+            machine.result.energy[static_cast<std::size_t>(Subsystem::Spindle)] += grid;
+        }
+    } else if (state == MachineState::Rapid) {
+        spindle = machine.spindleSpeed > 0.0 ? profile.spindleDragPower : 0.0;
+        axes = profile.axisRapidPower;
+    } else if (state == MachineState::Cutting) {
+        const SimulationJob& job = machine.jobs[machine.job];
+        double cutting = profile.cuttingPower;
+        if (job.cuttingPowers.size() == job.operations.size() && std::isfinite(job.cuttingPowers[machine.operation])) {
+            cutting = job.cuttingPowers[machine.operation];
+        }
+        axes = profile.axisFeedPower;
+        spindle = std::max(cutting - profile.basePower - axes, 0.0);
+    }
+
+    machine.power[static_cast<std::size_t>(Subsystem::Base)] =
+        state == MachineState::Standby ? profile.standbyPower : profile.basePower;
+    machine.power[static_cast<std::size_t>(Subsystem::Spindle)] = spindle;
+    machine.power[static_cast<std::size_t>(Subsystem::Axes)] = axes;
+    machine.power[static_cast<std::size_t>(Subsystem::Coolant)] =
+        state == MachineState::Cutting ? profile.coolantPower : 0.0;
+    machine.power[static_cast<std::size_t>(Subsystem::ToolChanger)] =
+        state == MachineState::ToolChange ? profile.toolChangePower : 0.0;
+
+    if (state == MachineState::Cutting) {
+        ++machine.conveyorGeneration;   // cancels a pending run-on stop
+        setConveyor(index, true);
+    }
+    if (duration >= 0.0) {
+        events.push(SimulationEvent(now + duration, index, PhaseEnd));
+    }
+}
+
+void MachineSimulator::setConveyor(std::uint32_t index, bool running) {
+    Machine& machine = machines[index];
+    integrate(machine, now);
+    machine.conveyorRunning = running;
+    machine.power[static_cast<std::size_t>(Subsystem::ChipConveyor)] =
+        running ? machine.profile.chipConveyorPower : 0.0;
+}
+
+void MachineSimulator::startNextJob(std::uint32_t index) {
+    Machine& machine = machines[index];
+    ++machine.idleGeneration;
+    if (machine.job < machine.jobs.size() && machine.jobs[machine.job].releaseTime <= now) {
+        const SimulationJob& job = machine.jobs[machine.job];
+        double setup = job.setupTime >= 0.0 ? job.setupTime : defaultSetupTime;
+        if (machine.state == MachineState::Standby) {
+            setup += machine.profile.wakeUpTime;
+        }
+        machine.busy = true;
+        machine.operation = 0;
+        enterState(index, MachineState::Setup, setup);
+        return;
+    }
+
+    // Nothing to do yet: wait for the next release, dropping to standby if that takes long
+    if (machine.state != MachineState::Standby) {
+        enterState(index, MachineState::Ready, -1.0);
+        if (machine.profile.standbyDelay >= 0.0) {
+            events.push(SimulationEvent(now + machine.profile.standbyDelay, index, StandbyTimeout,
+                                        machine.idleGeneration));
+        }
+    }
+    if (machine.job < machine.jobs.size()) {
+        events.push(SimulationEvent(machine.jobs[machine.job].releaseTime, index, JobRelease));
+    }
+}
+
+void MachineSimulator::advance(std::uint32_t index) {
+    Machine& machine = machines[index];
+    const MachineProfile& profile = machine.profile;
+    MachineState ended = machine.state;
+    const SimulationJob& job = machine.jobs[machine.job];
+
+    // Complete the phase that just ended
+    if (ended == MachineState::SpindleRunUp || ended == MachineState::SpindleBraking) {
+        machine.spindleSpeed = machine.targetSpeed;
+    } else if (ended == MachineState::ToolChange) {
+        machine.toolDiameter = job.operations[machine.operation].getToolDiameter();
+    } else if (ended == MachineState::Cutting) {
+        ++machine.result.operationsCompleted;
+        ++machine.operation;
+        std::uint64_t generation = ++machine.conveyorGeneration;
+        if (profile.chipConveyorRunOn > 0.0) {
+            events.push(SimulationEvent(now + profile.chipConveyorRunOn, index, ConveyorOff, generation));
+        } else {
+            setConveyor(index, false);
+        }
+    }
+
+    // Choose the next one
+    if (machine.operation >= job.operations.size()) {
+        if (machine.spindleSpeed > 0.0) {
+            machine.targetSpeed = 0.0;
+            enterState(index, MachineState::SpindleBraking,
+                       machine.spindleSpeed / std::max(profile.spindleAcceleration, 1e-6) / 60.0);
+            return;
+        }
+        ++machine.result.jobsCompleted;
+        ++machine.job;
+        machine.busy = false;
+        startNextJob(index);
+        return;
+    }
+
+    const NXOperation& operation = job.operations[machine.operation];
+    if (machine.toolDiameter != operation.getToolDiameter()) {
+        if (machine.spindleSpeed > 0.0) {
+            machine.targetSpeed = 0.0;
+            enterState(index, MachineState::SpindleBraking,
+                       machine.spindleSpeed / std::max(profile.spindleAcceleration, 1e-6) / 60.0);
+            return;
+        }
+        ++machine.result.toolChanges;
+        enterState(index, MachineState::ToolChange, profile.toolChangeTime);
+        return;
+    }
+    if (machine.spindleSpeed != operation.getSpindleSpeed()) {
+        machine.targetSpeed = operation.getSpindleSpeed();
+        double duration = std::fabs(machine.targetSpeed - machine.spindleSpeed)
+                        / std::max(profile.spindleAcceleration, 1e-6) / 60.0;
+        if (machine.targetSpeed > machine.spindleSpeed) {
+            if (machine.spindleSpeed == 0.0) {
+                ++machine.result.spindleStarts;
+            }
+            enterState(index, MachineState::SpindleRunUp, duration);
+        } else {
+            enterState(index, MachineState::SpindleBraking, duration);
+        }
+        return;
+    }
+    if (ended == MachineState::Rapid) {
+        enterState(index, MachineState::Cutting, operation.getCuttingTime());
+    } else {
+        enterState(index, MachineState::Rapid, TimeModel::computeRapidTime(operation.getCuttingTime(), rapidTimeFactor));
+    }
+}
+
+void MachineSimulator::handle(const SimulationEvent& event) {
+    Machine& machine = machines[event.target];
+    switch (event.type) {
+    case PhaseEnd:
+        advance(event.target);
+        break;
+    case JobRelease:
+        if (!machine.busy) {
+            startNextJob(event.target);
+        }
+        break;
+    case StandbyTimeout:
+        if (event.generation == machine.idleGeneration && !machine.busy) {
+            enterState(event.target, MachineState::Standby, -1.0);
+        }
+        break;
+    case ConveyorOff:
+        if (event.generation == machine.conveyorGeneration) {
+            setConveyor(event.target, false);
+        }
+        break;
+    }
+}
+
+bool MachineSimulator::run(double shiftMinutes) {
+    if (machines.empty()) {
+        std::cout << "Error: no machines to simulate" << std::endl;
+        return false;
+    }
+    auto start = std::chrono::steady_clock::now();
+    events.clear();
+    now = 0.0;
+    processedEvents = 0;
+
+    for (std::uint32_t i = 0; i < machines.size(); ++i) {
+        Machine& machine = machines[i];
+        machine.state = MachineState::Ready;
+        machine.job = 0;
+        machine.operation = 0;
+        machine.busy = false;
+        machine.toolDiameter = 0.0;
+        machine.spindleSpeed = 0.0;
+        machine.targetSpeed = 0.0;
+        machine.power.fill(0.0);
+        machine.lastUpdate = 0.0;
+        machine.idleGeneration = 0;
+        machine.conveyorGeneration = 0;
+        machine.conveyorRunning = false;
+        machine.result = MachineResult();
+        machine.result.name = machine.profile.name;
+        startNextJob(i);
+    }
+
+    SimulationEvent event;
+    while (events.pop(event) && event.time <= shiftMinutes) {
+        now = event.time;
+        handle(event);
+        ++processedEvents;
+    }
+    now = shiftMinutes;
+    for (Machine& machine : machines) {
+        integrate(machine, shiftMinutes);
+    }
+    wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return true;
+}
+
+std::vector<MachineResult> MachineSimulator::getResults() const {
+    std::vector<MachineResult> results;
+    results.reserve(machines.size());
+    for (const Machine& machine : machines) {
+        results.push_back(machine.result);
+    }
+    return results;
+}
+
+double MachineSimulator::getTotalEnergy() const {
+    double total = 0.0;
+    for (const Machine& machine : machines) {
+        total += machine.result.getTotalEnergy();
+    }
+    return total;
+}
+
+std::size_t MachineSimulator::getEventCount() const {
+    return processedEvents;
+}
+
+void MachineSimulator::printSummary() const {
+    std::array<double, SubsystemCount> energy;
+    std::array<double, MachineStateCount> time;
+    energy.fill(0.0);
+    time.fill(0.0);
+    std::size_t jobs = 0;
+    std::size_t toolChanges = 0;
+    for (const Machine& machine : machines) {
+        for (std::size_t s = 0; s < SubsystemCount; ++s) {
+            energy[s] += machine.result.energy[s];
+        }
+        for (std::size_t s = 0; s < MachineStateCount; ++s) {
+            time[s] += machine.result.time[s];
+        }
+        jobs += machine.result.jobsCompleted;
+        toolChanges += machine.result.toolChanges;
+    }
+
+    std::cout << "Simulated " << machines.size() << " machines: " << processedEvents << " events in "
+              << wallSeconds * 1000.0 << " ms" << std::endl;
+    std::cout << "Jobs completed: " << jobs << ", tool changes: " << toolChanges << std::endl;
+    std::cout << "Total energy: " << getTotalEnergy() << " kWh" << std::endl;
+    for (std::size_t s = 0; s < SubsystemCount; ++s) {
+        std::cout << "  " << getSubsystemName(static_cast<Subsystem>(s)) << ": " << energy[s] << " kWh" << std::endl;
+    }
+    for (std::size_t s = 0; s < MachineStateCount; ++s) {
+        std::cout << "  " << getStateName(static_cast<MachineState>(s)) << ": " << time[s] << " machine-min"
+                  << std::endl;
+    }
+}
+
+const char* MachineSimulator::getStateName(MachineState state) {
+    switch (state) {
+    case MachineState::Standby: return "Standby";
+    case MachineState::Ready: return "Ready";
+    case MachineState::Setup: return "Setup";
+    case MachineState::ToolChange: return "Tool change";
+    case MachineState::SpindleRunUp: return "Spindle run-up";
+    case MachineState::SpindleBraking: return "Spindle braking";
+    case MachineState::Rapid: return "Rapid";
+    case MachineState::Cutting: return "Cutting";
+    default: return "Unknown";
+    }
+}
+
+const char* MachineSimulator::getSubsystemName(Subsystem subsystem) {
+    switch (subsystem) {
+    case Subsystem::Base: return "Base load";
+    case Subsystem::Spindle: return "Spindle";
+    case Subsystem::Axes: return "Axes";
+    case Subsystem::Coolant: return "Coolant";
+    case Subsystem::ChipConveyor: return "Chip conveyor";
+    case Subsystem::ToolChanger: return "Tool changer";
+    default: return "Unknown";
+    }
+}
\ No newline at end of file
@@ -0,0 +1,242 @@
+#ifndef MACHINE_SIMULATOR_H
+#define MACHINE_SIMULATOR_H
+
+#include "CalendarQueue.h"
+#include "NXCamDataExtractor.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class TimeModel;
+class EnergyModel;
+
+/**
+ * @brief State of a simulated machine
+ */
+enum class MachineState {
+    Standby,        // drives and auxiliaries switched off after a long idle period
+    Ready,          // powered up, waiting for work
+    Setup,          // part loading and unloading
+    ToolChange,
+    SpindleRunUp,   // accelerating the spindle to the operation's speed
+    SpindleBraking,
+    Rapid,
+    Cutting,
+    Count
+};
+
+/**
+ * @brief Power consumer of a simulated machine
+ */
+enum class Subsystem {
+    Base,           // controls, hydraulics, cabinet cooling
+    Spindle,
+    Axes,
+    Coolant,
+    ChipConveyor,
+    ToolChanger,
+    Count
+};
+
+const std::size_t MachineStateCount = static_cast<std::size_t>(MachineState::Count);
+const std::size_t SubsystemCount = static_cast<std::size_t>(Subsystem::Count);
+
+/**
+ * @brief Power characteristics of one machine
+ */
+struct MachineProfile {
+    std::string name;
+    double basePower;           // kW while powered up
+    double standbyPower;        // kW in standby
+    double standbyDelay;        // minutes of idling before entering standby (negative = never)
+    double wakeUpTime;          // minutes to leave standby
+    double axisRapidPower;      // kW of the axis drives during rapid moves
+    double axisFeedPower;       // kW of the axis drives while cutting
+    double cuttingPower;        // kW of the machine while cutting, used when the job has no prediction
+    double spindleDragPower;    // kW to keep the spindle turning without load
+    double spindleInertia;      // kg m^2 of spindle and tool
+    double spindleAcceleration; // RPM per second, run-up and braking
+    double spindleEfficiency;   // drive efficiency during run-up
+    double brakingRecovery;     // fraction of the kinetic energy fed back to the grid when braking
+    double toolChangeTime;      // minutes per tool change
+    double toolChangePower;     // kW of the tool changer
+    double coolantPower;        // kW of the coolant pump while cutting
+    double chipConveyorPower;   // kW of the chip conveyor
+    double chipConveyorRunOn;   // minutes the conveyor keeps running after a cut
+
+    MachineProfile();
+
+    /**
+     * @brief Profile using the power levels of an energy model
+     *
+     * The idle power becomes the base load, the rapid power minus the idle power the
+     * axis power of rapid moves, and the cutting power the default cutting power.
+     * @param machineName Machine name
+     * @param energyModel Power values of the machine
+     */
+    MachineProfile(const std::string& machineName, const EnergyModel& energyModel);
+};
+
+/**
+ * @brief Part program queued on a simulated machine
+ */
+struct SimulationJob {
+    std::string name;
+    std::vector<NXOperation> operations;
+    std::vector<double> cuttingPowers;  // kW per operation (empty = the profile's cutting power)
+    double releaseTime;                 // earliest start in minutes
+    double setupTime;                   // minutes (negative = the time model's setup time)
+
+    SimulationJob();
+
+    /**
+     * @brief Job released at time 0 with the default setup time
+     * @param jobName Job name
+     * @param jobOperations Operations in program order
+     */
+    SimulationJob(const std::string& jobName, const std::vector<NXOperation>& jobOperations);
+};
+
+/**
+ * @brief Simulated energy and time of one machine
+ */
+struct MachineResult {
+    std::string name;
+    std::array<double, SubsystemCount> energy;      // kWh per subsystem
+    std::array<double, MachineStateCount> time;     // minutes per state
+    std::size_t jobsCompleted;
+    std::size_t operationsCompleted;
+    std::size_t toolChanges;
+    std::size_t spindleStarts;
+
+    MachineResult();
+
+    /**
+     * @brief Get the energy over all subsystems
+     * @return Energy in kWh
+     */
+    double getTotalEnergy() const;
+};
+
+/**
+ * @brief Discrete-event simulation of a machining cell
+ *
+ * Each machine runs its queued jobs in order through a state machine: setup, then per
+ * operation a tool change when the tool diameter differs from the loaded one (braking the
+ * spindle first), a spindle run-up or slow-down to the operation's speed, the rapid moves
+ * and the cut. The spindle brakes at the end of each part. A machine without work drops
+ * to standby after a delay, and the chip conveyor keeps running for a while after each cut.
+ * Power is piecewise constant between events and integrated exactly per subsystem.
+ *
+ * Spindle transients follow from the rotational kinetic energy 1/2 J w^2: run-up draws it
+ * (divided by the drive efficiency) over the acceleration time, braking returns the
+ * recovered fraction. Rapid time comes from the time model's rapid factor; the lumped idle
+ * time per operation is replaced by the explicit tool changes, run-ups and braking.
+ *
+ * Events are kept in a calendar queue, so a shift of a large cell takes milliseconds.
+ */
+class MachineSimulator {
+private:
+    struct Machine {
+        MachineProfile profile;
+        std::vector<SimulationJob> jobs;
+        MachineState state;
+        std::size_t job;                // index of the current or next job
+        std::size_t operation;          // index of the current or next operation of the job
+        bool busy;                      // working on a job
+        double toolDiameter;            // loaded tool, 0 = none
+        double spindleSpeed;            // RPM
+        double targetSpeed;             // RPM at the end of the current transient
+        std::array<double, SubsystemCount> power;
+        double lastUpdate;              // minutes
+        std::uint64_t idleGeneration;   // invalidates pending standby timeouts
+        std::uint64_t conveyorGeneration;
+        bool conveyorRunning;
+        MachineResult result;
+    };
+
+    std::vector<Machine> machines;
+    CalendarQueue events;
+    double rapidTimeFactor;
+    double defaultSetupTime;
+    double now;
+    std::size_t processedEvents;
+    double wallSeconds;
+
+    void integrate(Machine& machine, double time);
+    void enterState(std::uint32_t index, MachineState state, double duration);
+    void setConveyor(std::uint32_t index, bool running);
+    void advance(std::uint32_t index);
+    void startNextJob(std::uint32_t index);
+    void handle(const SimulationEvent& event);
+
+public:
+    /**
+     * @brief Simulator taking the rapid time factor and setup time of a time model
+     * @param timeModel Time model
+     */
+    explicit MachineSimulator(const TimeModel& timeModel);
+
+    /**
+     * @brief Add a machine
+     * @param profile Power characteristics
+     * @return Machine index
+     */
+    std::size_t addMachine(const MachineProfile& profile);
+
+    /**
+     * @brief Queue a job on a machine; jobs run in the order they were added
+     * @param machine Machine index
+     * @param job Job
+     * @return False if the machine index is invalid
+     */
+    bool addJob(std::size_t machine, const SimulationJob& job);
+
+    /**
+     * @brief Simulate from time 0 until the end of the shift
+     * @param shiftMinutes Shift length in minutes
+     * @return False if there are no machines
+     */
+    bool run(double shiftMinutes);
+
+    /**
+     * @brief Get the results of the last run
+     * @return One result per machine
+     */
+    std::vector<MachineResult> getResults() const;
+
+    /**
+     * @brief Get the energy of the whole cell in the last run
+     * @return Energy in kWh
+     */
+    double getTotalEnergy() const;
+
+    /**
+     * @brief Get the number of events processed in the last run
+     * @return Number of events
+     */
+    std::size_t getEventCount() const;
+
+    /**
+     * @brief Print cell totals, energy per subsystem and time per state
+     */
+    void printSummary() const;
+
+    /**
+     * @brief Get the display name of a state
+     * @param state State
+     * @return Name
+     */
+    static const char* getStateName(MachineState state);
+
+    /**
+     * @brief Get the display name of a subsystem
+     * @param subsystem Subsystem
+     * @return Name
+     */
+    static const char* getSubsystemName(Subsystem subsystem);
+};
+
+#endif // MACHINE_SIMULATOR_H
\ No newline at end of file
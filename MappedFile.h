@@ -0,0 +1,62 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+
+/**
+ * @brief Read-only memory mapping of a file
+ *
+ * Model and index files are used in place from the mapping, so loading does not
+ * depend on file size and several NX processes on a host share the same pages.
+ */
+class MappedFile {
+private:
+    const unsigned char* data;
+    std::size_t size;
+#ifdef _WIN32
+    void* fileHandle;
+    void* mappingHandle;
+#else
+    int fileDescriptor;
+#endif
+
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * @brief Map a file, closing any previous mapping
+     * @param path Path to the file
+     * @return True on success
+     */
+    bool open(const std::string& path);
+
+    /**
+     * @brief Unmap the file
+     */
+    void close();
+
+    /**
+     * @brief Check whether a file is mapped
+     * @return True if a file is mapped
+     */
+    bool isOpen() const;
+
+    /**
+     * @brief Get the start of the mapping
+     * @return Pointer to the first byte (page aligned), or nullptr if nothing is mapped
+     */
+    const unsigned char* getData() const;
+
+    /**
+     * @brief Get the size of the mapping
+     * @return Size in bytes
+     */
+    std::size_t getSize() const;
+};
+
+#endif // MAPPED_FILE_H
\ No newline at end of file
@@ -0,0 +1,149 @@
+#include "MemoryAccount.h"
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+const char* const subsystemNames[] = {"extraction", "operations", "prediction_cache", "results"};
+
+static_assert(sizeof(subsystemNames) / sizeof(subsystemNames[0]) == static_cast<std::size_t>(MemorySubsystem::Count),
+              "one name per memory subsystem");
+
+void raisePeak(std::atomic<std::uint64_t>& peak, std::uint64_t value) {
+    std::uint64_t current = peak.load(std::memory_order_relaxed);
+    while (value > current && !peak.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+} // namespace
+
+const char* getMemorySubsystemName(MemorySubsystem subsystem) {
+    std::size_t index = static_cast<std::size_t>(subsystem);
+    return index < static_cast<std::size_t>(MemorySubsystem::Count) ? subsystemNames[index] : "unknown";
+}
+
+TrackingResource::TrackingResource()
+    : account(nullptr), subsystem(MemorySubsystem::Results), upstream(std::pmr::new_delete_resource()) {
+}
+
+void* TrackingResource::do_allocate(std::size_t bytes, std::size_t alignment) {
+    void* pointer = upstream->allocate(bytes, alignment);
+    account->record(subsystem, bytes, true);
+    return pointer;
+}
+
+void TrackingResource::do_deallocate(void* pointer, std::size_t bytes, std::size_t alignment) {
+    upstream->deallocate(pointer, bytes, alignment);
+    account->record(subsystem, bytes, false);
+}
+
+bool TrackingResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
+
+MemoryAccount::MemoryAccount(std::pmr::memory_resource* upstream) : budget(0) {
+    for (std::size_t s = 0; s < static_cast<std::size_t>(MemorySubsystem::Count); ++s) {
+        resources[s].account = this;
+        resources[s].subsystem = static_cast<MemorySubsystem>(s);
+        resources[s].upstream = upstream;
+    }
+}
+
+void MemoryAccount::record(MemorySubsystem subsystem, std::uint64_t bytes, bool allocated) {
+    Counters& counter = counters[static_cast<std::size_t>(subsystem)];
+    if (allocated) {
+        counter.allocations.fetch_add(1, std::memory_order_relaxed);
+        total.allocations.fetch_add(1, std::memory_order_relaxed);
+        raisePeak(counter.peakBytes, counter.bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes);
+        raisePeak(total.peakBytes, total.bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes);
+    } else {
+        counter.deallocations.fetch_add(1, std::memory_order_relaxed);
+        total.deallocations.fetch_add(1, std::memory_order_relaxed);
+        counter.bytes.fetch_sub(bytes, std::memory_order_relaxed);
+        total.bytes.fetch_sub(bytes, std::memory_order_relaxed);
+    }
+}
+
+std::pmr::memory_resource* MemoryAccount::getResource(MemorySubsystem subsystem) {
+    return &resources[static_cast<std::size_t>(subsystem)];
+}
+
+void MemoryAccount::charge(MemorySubsystem subsystem, std::uint64_t bytes) {
+    record(subsystem, bytes, true);
+}
+
+void MemoryAccount::release(MemorySubsystem subsystem, std::uint64_t bytes) {
+    record(subsystem, bytes, false);
+}
+
+void MemoryAccount::setBudget(std::uint64_t bytes) {
+    budget = bytes;
+}
+
+std::uint64_t MemoryAccount::getBudget() const {
+    return budget;
+}
+
+std::uint64_t MemoryAccount::getBytes() const {
+    return total.bytes.load(std::memory_order_relaxed);
+}
+
+bool MemoryAccount::isOverBudget() const {
+    std::uint64_t limit = budget;
+    return limit != 0 && getBytes() > limit;
+}
+
+void MemoryAccount::resetPeaks() {
+    for (Counters& counter : counters) {
+        counter.peakBytes = counter.bytes.load(std::memory_order_relaxed);
+    }
+    total.peakBytes = total.bytes.load(std::memory_order_relaxed);
+}
+
+MemoryStatistics MemoryAccount::getStatistics() const {
+    auto load = [](const Counters& counter) {
+        MemoryUsage usage;
+        usage.bytes = counter.bytes.load(std::memory_order_relaxed);
+        usage.peakBytes = counter.peakBytes.load(std::memory_order_relaxed);
+        usage.allocations = counter.allocations.load(std::memory_order_relaxed);
+        usage.deallocations = counter.deallocations.load(std::memory_order_relaxed);
+        return usage;
+    };
+    MemoryStatistics statistics;
+    for (std::size_t s = 0; s < static_cast<std::size_t>(MemorySubsystem::Count); ++s) {
+        statistics.subsystems[s] = load(counters[s]);
+    }
+    MemoryUsage all = load(total);
+    statistics.bytes = all.bytes;
+    statistics.peakBytes = all.peakBytes;
+    statistics.budget = budget;
+    return statistics;
+}
+
+void MemoryAccount::print(const MemoryStatistics& statistics) {
+    for (std::size_t s = 0; s < static_cast<std::size_t>(MemorySubsystem::Count); ++s) {
+        const MemoryUsage& usage = statistics.subsystems[s];
+        std::cout << "  " << subsystemNames[s] << ": " << usage.bytes << " bytes (peak " << usage.peakBytes
+                  << "), " << usage.allocations << " allocations, " << usage.deallocations << " deallocations"
+                  << std::endl;
+    }
+    std::cout << "  total: " << statistics.bytes << " bytes (peak " << statistics.peakBytes << "), budget "
+              << (statistics.budget != 0 ? std::to_string(statistics.budget) + " bytes" : std::string("unlimited"))
+              << std::endl;
+}
+
+std::string MemoryAccount::formatMetrics(const std::string& prefix, const MemoryStatistics& statistics) {
+    std::ostringstream text;
+    for (std::size_t s = 0; s < static_cast<std::size_t>(MemorySubsystem::Count); ++s) {
+        const MemoryUsage& usage = statistics.subsystems[s];
+        std::string name = prefix + "_memory_" + subsystemNames[s];
+        text << name << "_bytes " << usage.bytes << "\n"
+             << name << "_peak_bytes " << usage.peakBytes << "\n"
+             << name << "_allocations_total " << usage.allocations << "\n"
+             << name << "_deallocations_total " << usage.deallocations << "\n";
+    }
+    text << prefix << "_memory_bytes " << statistics.bytes << "\n"
+         << prefix << "_memory_peak_bytes " << statistics.peakBytes << "\n"
+         << prefix << "_memory_budget_bytes " << statistics.budget << "\n";
+    return text.str();
+}
\ No newline at end of file
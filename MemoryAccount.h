@@ -0,0 +1,185 @@
+#ifndef MEMORY_ACCOUNT_H
+#define MEMORY_ACCOUNT_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+
+/**
+ * @brief Parts of an estimate run whose memory is accounted separately
+ */
+enum class MemorySubsystem {
+    Extraction,         // extracted operations and the extraction cache
+    Operations,         // per-job operation index (keys, occurrences, representatives)
+    PredictionCache,    // cached operation estimates
+    Results,            // prediction inputs and outputs, estimates handed back
+    Count
+};
+
+/**
+ * @brief Get the name of a subsystem as used in metrics
+ * @param subsystem Subsystem
+ * @return Lower-case name, e.g. "prediction_cache"
+ */
+const char* getMemorySubsystemName(MemorySubsystem subsystem);
+
+/**
+ * @brief Memory counters of one subsystem
+ */
+struct MemoryUsage {
+    std::uint64_t bytes;            // currently allocated
+    std::uint64_t peakBytes;        // largest allocation total since the last reset
+    std::uint64_t allocations;
+    std::uint64_t deallocations;
+
+    MemoryUsage() : bytes(0), peakBytes(0), allocations(0), deallocations(0) {}
+};
+
+/**
+ * @brief Snapshot of a MemoryAccount
+ */
+struct MemoryStatistics {
+    MemoryUsage subsystems[static_cast<std::size_t>(MemorySubsystem::Count)];
+    std::uint64_t bytes;            // all subsystems
+    std::uint64_t peakBytes;
+    std::uint64_t budget;           // 0 if unlimited
+
+    MemoryStatistics() : bytes(0), peakBytes(0), budget(0) {}
+};
+
+class MemoryAccount;
+
+/**
+ * @brief Memory resource that forwards to an upstream resource and counts into a MemoryAccount
+ */
+class TrackingResource : public std::pmr::memory_resource {
+private:
+    friend class MemoryAccount;
+
+    MemoryAccount* account;
+    MemorySubsystem subsystem;
+    std::pmr::memory_resource* upstream;
+
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+    void do_deallocate(void* pointer, std::size_t bytes, std::size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+public:
+    TrackingResource();
+};
+
+/**
+ * @brief Bytes and allocation counts per subsystem, with an optional budget
+ *
+ * Containers opt in by allocating from getResource() (std::pmr containers); memory held in
+ * ordinary containers can be counted with charge() and release(). Counters are atomic, so
+ * resources may be used from several threads.
+ *
+ * Allocations never fail because of the budget. Components check isOverBudget() at points
+ * where they can give memory back (dropping caches, spilling results to disk), so a run
+ * over budget degrades instead of being killed.
+ */
+class MemoryAccount {
+private:
+    friend class TrackingResource;
+
+    struct Counters {
+        std::atomic<std::uint64_t> bytes;
+        std::atomic<std::uint64_t> peakBytes;
+        std::atomic<std::uint64_t> allocations;
+        std::atomic<std::uint64_t> deallocations;
+
+        Counters() : bytes(0), peakBytes(0), allocations(0), deallocations(0) {}
+    };
+
+    Counters counters[static_cast<std::size_t>(MemorySubsystem::Count)];
+    Counters total;
+    std::atomic<std::uint64_t> budget;
+    TrackingResource resources[static_cast<std::size_t>(MemorySubsystem::Count)];
+
+    void record(MemorySubsystem subsystem, std::uint64_t bytes, bool allocated);
+
+public:
+    /**
+     * @brief Account whose resources allocate from an upstream resource
+     * @param upstream Resource doing the allocations (default: operator new/delete)
+     */
+    explicit MemoryAccount(std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+
+    MemoryAccount(const MemoryAccount&) = delete;
+    MemoryAccount& operator=(const MemoryAccount&) = delete;
+
+    /**
+     * @brief Get the resource of a subsystem, for its std::pmr containers
+     * @param subsystem Subsystem
+     * @return Resource, valid as long as the account
+     */
+    std::pmr::memory_resource* getResource(MemorySubsystem subsystem);
+
+    /**
+     * @brief Count memory held outside the account's resources
+     * @param subsystem Subsystem
+     * @param bytes Bytes now held
+     */
+    void charge(MemorySubsystem subsystem, std::uint64_t bytes);
+
+    /**
+     * @brief Stop counting memory added with charge()
+     * @param subsystem Subsystem
+     * @param bytes Bytes given back
+     */
+    void release(MemorySubsystem subsystem, std::uint64_t bytes);
+
+    /**
+     * @brief Set the budget
+     * @param bytes Budget in bytes, 0 for unlimited
+     */
+    void setBudget(std::uint64_t bytes);
+
+    /**
+     * @brief Get the budget
+     * @return Budget in bytes, 0 if unlimited
+     */
+    std::uint64_t getBudget() const;
+
+    /**
+     * @brief Get the bytes currently counted in all subsystems
+     * @return Bytes
+     */
+    std::uint64_t getBytes() const;
+
+    /**
+     * @brief Check whether the counted bytes exceed the budget
+     * @return True if a budget is set and exceeded
+     */
+    bool isOverBudget() const;
+
+    /**
+     * @brief Restart the peaks at the current usage, e.g. at the start of a job
+     */
+    void resetPeaks();
+
+    /**
+     * @brief Get a snapshot of all counters
+     * @return Statistics
+     */
+    MemoryStatistics getStatistics() const;
+
+    /**
+     * @brief Print statistics, one line per subsystem
+     * @param statistics Statistics
+     */
+    static void print(const MemoryStatistics& statistics);
+
+    /**
+     * @brief Format statistics as "name value" metric lines
+     * @param prefix Metric name prefix, e.g. "nxcarbond"
+     * @param statistics Statistics
+     * @return Metrics text
+     */
+    static std::string formatMetrics(const std::string& prefix, const MemoryStatistics& statistics);
+};
+
+#endif // MEMORY_ACCOUNT_H
\ No newline at end of file
@@ -0,0 +1,262 @@
+#include "ModelContainer.h"
+#include <iostream>
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+const char containerMagic[8] = {'N', 'X', 'C', 'M', 'O', 'D', 'E', 'L'};
+
+// Sections start on a cache line boundary
+const std::uint64_t sectionAlignment = 64;
+
+struct ContainerHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t sectionCount;
+    std::uint64_t fileSize;
+    std::uint64_t headerChecksum;   // over this header (with this field zero) and the section table
+};
+
+std::uint64_t alignSection(std::uint64_t offset) {
+    return (offset + sectionAlignment - 1) & ~(sectionAlignment - 1);
+}
+
+std::uint64_t headerChecksum(const ContainerHeader& header, const void* table, std::size_t tableSize) {
+    ContainerHeader copy = header;
+    copy.headerChecksum = 0;
+    // Chain the table hash onto the header hash
+    std::uint64_t hash = ModelContainer::checksum(&copy, sizeof(copy));
+    return hash ^ (ModelContainer::checksum(table, tableSize) * 0x100000001b3ULL);
+}
+
+} // namespace
+
+// NameTableView implementation
+NameTableView::NameTableView() : offsets(nullptr), characters(nullptr), count(0) {
+}
+
+bool NameTableView::attach(const void* data, std::size_t size) {
+    offsets = nullptr;
+    characters = nullptr;
+    count = 0;
+    if (data == nullptr || size < sizeof(std::uint32_t)) {
+        return false;
+    }
+    const std::uint32_t* words = static_cast<const std::uint32_t*>(data);
+    std::uint32_t n = words[0];
+    std::size_t tableBytes = (static_cast<std::size_t>(n) + 2) * sizeof(std::uint32_t);
+    if (tableBytes > size) {
+        return false;
+    }
+    const std::uint32_t* offs = words + 1;
+    std::size_t characterBytes = size - tableBytes;
+    for (std::uint32_t i = 0; i < n; ++i) {
+        if (offs[i] > offs[i + 1]) {
+            return false;
+        }
+    }
+    if (offs[0] != 0 || offs[n] > characterBytes) {
+        return false;
+    }
+    offsets = offs;
+    characters = reinterpret_cast<const char*>(words + n + 2);
+    count = n;
+    return true;
+}
+
+int NameTableView::find(const std::string& name) const {
+    for (std::uint32_t i = 0; i < count; ++i) {
+        std::size_t length = offsets[i + 1] - offsets[i];
+        if (length == name.size() && std::memcmp(characters + offsets[i], name.data(), length) == 0) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+std::size_t NameTableView::size() const {
+    return count;
+}
+
+std::vector<std::uint32_t> NameTableView::encode(const std::vector<std::string>& names) {
+    std::string characters;
+    std::vector<std::uint32_t> words;
+    words.push_back(static_cast<std::uint32_t>(names.size()));
+    words.push_back(0);
+    for (const std::string& name : names) {
+        characters += name;
+        words.push_back(static_cast<std::uint32_t>(characters.size()));
+    }
+    std::size_t start = words.size();
+    words.resize(start + (characters.size() + 3) / 4, 0);
+    if (!characters.empty()) {
+        std::memcpy(&words[start], characters.data(), characters.size());
+    }
+    return words;
+}
+
+// ModelContainer implementation
+ModelContainer::ModelContainer() : sections(nullptr), sectionCount(0) {
+}
+
+bool ModelContainer::isContainerFile(const std::string& path) {
+    std::ifstream stream(path, std::ios::binary);
+    char magic[sizeof(containerMagic)];
+    if (!stream.read(magic, sizeof(magic))) {
+        return false;
+    }
+    return std::memcmp(magic, containerMagic, sizeof(magic)) == 0;
+}
+
+bool ModelContainer::open(const std::string& path, bool verifySections) {
+    sections = nullptr;
+    sectionCount = 0;
+    if (!file.open(path)) {
+        std::cout << "Error: cannot map model container " << path << std::endl;
+        return false;
+    }
+
+    const unsigned char* base = file.getData();
+    std::size_t size = file.getSize();
+    ContainerHeader header;
+    if (size < sizeof(header)) {
+        std::cout << "Error: model container " << path << " is truncated" << std::endl;
+        file.close();
+        return false;
+    }
+    std::memcpy(&header, base, sizeof(header));
+    if (std::memcmp(header.magic, containerMagic, sizeof(containerMagic)) != 0) {
+        std::cout << "Error: " << path << " is not a model container" << std::endl;
+        file.close();
+        return false;
+    }
+    if (header.version != FormatVersion) {
+        std::cout << "Error: model container " << path << " has version " << header.version
+                  << ", expected " << FormatVersion << std::endl;
+        file.close();
+        return false;
+    }
+
+    std::size_t tableSize = static_cast<std::size_t>(header.sectionCount) * sizeof(SectionEntry);
+    if (header.fileSize != size || sizeof(header) + tableSize > size ||
+        headerChecksum(header, base + sizeof(header), tableSize) != header.headerChecksum) {
+        std::cout << "Error: model container " << path << " is corrupt or truncated" << std::endl;
+        file.close();
+        return false;
+    }
+
+    const SectionEntry* table = reinterpret_cast<const SectionEntry*>(base + sizeof(header));
+    for (std::uint32_t i = 0; i < header.sectionCount; ++i) {
+        if (table[i].offset % sectionAlignment != 0 || table[i].offset > size ||
+            table[i].size > size - table[i].offset) {
+            std::cout << "Error: model container " << path << " has an invalid section table" << std::endl;
+            file.close();
+            return false;
+        }
+    }
+
+    sections = table;
+    sectionCount = header.sectionCount;
+    if (verifySections && !verifyPayload()) {
+        std::cout << "Error: model container " << path << " failed checksum verification" << std::endl;
+        sections = nullptr;
+        sectionCount = 0;
+        file.close();
+        return false;
+    }
+    return true;
+}
+
+const void* ModelContainer::getSection(ModelSectionType type, std::uint32_t index, std::size_t& size) const {
+    for (std::uint32_t i = 0; i < sectionCount; ++i) {
+        if (sections[i].type == static_cast<std::uint32_t>(type) && sections[i].index == index) {
+            size = static_cast<std::size_t>(sections[i].size);
+            return file.getData() + sections[i].offset;
+        }
+    }
+    size = 0;
+    return nullptr;
+}
+
+bool ModelContainer::verifyPayload() const {
+    for (std::uint32_t i = 0; i < sectionCount; ++i) {
+        const unsigned char* data = file.getData() + sections[i].offset;
+        if (checksum(data, static_cast<std::size_t>(sections[i].size)) != sections[i].checksum) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ModelContainer::write(const std::string& path, const std::vector<ModelSectionData>& sectionData) {
+    ContainerHeader header;
+    std::memcpy(header.magic, containerMagic, sizeof(containerMagic));
+    header.version = FormatVersion;
+    header.sectionCount = static_cast<std::uint32_t>(sectionData.size());
+
+    std::vector<SectionEntry> table(sectionData.size());
+    std::uint64_t offset = alignSection(sizeof(header) + table.size() * sizeof(SectionEntry));
+    for (std::size_t i = 0; i < sectionData.size(); ++i) {
+        table[i].type = static_cast<std::uint32_t>(sectionData[i].type);
+        table[i].index = sectionData[i].index;
+        table[i].offset = offset;
+        table[i].size = sectionData[i].size;
+        table[i].checksum = checksum(sectionData[i].data, static_cast<std::size_t>(sectionData[i].size));
+        offset = alignSection(offset + sectionData[i].size);
+    }
+    header.fileSize = offset;
+    header.headerChecksum = 0;
+    header.headerChecksum = headerChecksum(header, table.data(), table.size() * sizeof(SectionEntry));
+
+    // Write next to the target and rename: the target may be mapped (by this process when a
+    // loaded model is saved back, or by other processes sharing its pages) and must not change
+    // under its readers
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream stream(temporary, std::ios::binary | std::ios::trunc);
+        if (!stream.is_open()) {
+            std::cout << "Error: cannot write model container " << temporary << std::endl;
+            return false;
+        }
+        stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        stream.write(reinterpret_cast<const char*>(table.data()),
+                     static_cast<std::streamsize>(table.size() * sizeof(SectionEntry)));
+
+        const char padding[sectionAlignment] = {};
+        std::uint64_t written = sizeof(header) + table.size() * sizeof(SectionEntry);
+        for (std::size_t i = 0; i < sectionData.size(); ++i) {
+            stream.write(padding, static_cast<std::streamsize>(table[i].offset - written));
+            stream.write(static_cast<const char*>(sectionData[i].data),
+                         static_cast<std::streamsize>(sectionData[i].size));
+            written = table[i].offset + sectionData[i].size;
+        }
+        stream.write(padding, static_cast<std::streamsize>(header.fileSize - written));
+
+        if (!stream.good()) {
+            std::cout << "Error: failed to write model container " << temporary << std::endl;
+            stream.close();
+            std::remove(temporary.c_str());
+            return false;
+        }
+    }
+    if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+        std::remove(path.c_str());     // rename does not replace existing files on Windows
+        if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+            std::cout << "Error: cannot replace model container " << path << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+std::uint64_t ModelContainer::checksum(const void* data, std::size_t size, std::uint64_t previous) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    std::uint64_t hash = previous;
+    for (std::size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
\ No newline at end of file
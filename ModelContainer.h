@@ -0,0 +1,164 @@
+#ifndef MODEL_CONTAINER_H
+#define MODEL_CONTAINER_H
+
+#include "MappedFile.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Section types of a binary model container
+ */
+enum class ModelSectionType : std::uint32_t {
+    RegressionCoefficients = 1,     // one RegressionCoefficients struct
+    TreeInfo = 2,                   // one TreeEnsembleInfo struct
+    TreeNodes = 3,                  // TreeEnsemblePredictor::FlatNode array
+    TreeLeafValues = 4,             // double array, parallel to the nodes
+    TreeRoots = 5,                  // int32 array, root node of each tree
+    TreeDepths = 6,                 // int32 array, depth of each tree
+    CategoryNames = 7,              // name table; the section index is the categorical feature
+    RegressionNormalization = 8,    // one RegressionNormalization struct
+    RegressionTerms = 9             // RegressionTerm array
+};
+
+/**
+ * @brief Scalar parameters of a tree ensemble stored in a container
+ */
+struct TreeEnsembleInfo {
+    double baseScore;
+    std::uint32_t treeCount;
+    std::uint32_t nodeCount;
+};
+
+/**
+ * @brief Read-only view of an interned name table stored as
+ *        [count][offsets 0..count][characters], all offsets relative to the characters
+ */
+class NameTableView {
+private:
+    const std::uint32_t* offsets;
+    const char* characters;
+    std::uint32_t count;
+
+public:
+    NameTableView();
+
+    /**
+     * @brief Attach to an encoded table, validating its bounds
+     * @param data Start of the table (4-byte aligned)
+     * @param size Size of the table in bytes
+     * @return True if the table is well formed
+     */
+    bool attach(const void* data, std::size_t size);
+
+    /**
+     * @brief Find a name
+     * @param name Name to look up
+     * @return Index of the name, or -1 if it is not in the table
+     */
+    int find(const std::string& name) const;
+
+    /**
+     * @brief Get the number of names
+     * @return Number of names
+     */
+    std::size_t size() const;
+
+    /**
+     * @brief Encode names into the table layout
+     * @param names Names in index order
+     * @return Encoded table as 32-bit words
+     */
+    static std::vector<std::uint32_t> encode(const std::vector<std::string>& names);
+};
+
+/**
+ * @brief Section to be written into a container
+ */
+struct ModelSectionData {
+    ModelSectionType type;
+    std::uint32_t index;    // distinguishes several sections of the same type
+    const void* data;
+    std::uint64_t size;     // bytes
+};
+
+/**
+ * @brief Versioned, checksummed binary model file used in place from a memory mapping
+ *
+ * Layout: a fixed header, a section table, then the sections, each starting on a
+ * 64-byte boundary so arrays can be used directly from the mapping. The header and
+ * section table are always checksummed on open; each section also carries its own
+ * checksum, checked on open only when full verification is requested. Loading is then
+ * one linear validation pass by the predictors attaching the sections (node links,
+ * roots, depths), with no parsing and no copies of the nodes. See docs/MODEL_FORMATS.md.
+ */
+class ModelContainer {
+public:
+    struct SectionEntry {
+        std::uint32_t type;
+        std::uint32_t index;
+        std::uint64_t offset;
+        std::uint64_t size;
+        std::uint64_t checksum;
+    };
+
+private:
+    MappedFile file;
+    const SectionEntry* sections;
+    std::uint32_t sectionCount;
+
+public:
+    static const std::uint32_t FormatVersion = 1;
+
+    ModelContainer();
+
+    /**
+     * @brief Check whether a file starts with the container magic
+     * @param path Path to the file
+     * @return True if the file looks like a binary model container
+     */
+    static bool isContainerFile(const std::string& path);
+
+    /**
+     * @brief Map and validate a container
+     * @param path Path to the container
+     * @param verifySections Also verify the checksum of every section (reads the whole file)
+     * @return True on success
+     */
+    bool open(const std::string& path, bool verifySections = false);
+
+    /**
+     * @brief Get a section
+     * @param type Section type
+     * @param index Section index
+     * @param size Output size of the section in bytes
+     * @return Start of the section in the mapping, or nullptr if absent
+     */
+    const void* getSection(ModelSectionType type, std::uint32_t index, std::size_t& size) const;
+
+    /**
+     * @brief Verify the checksums of all sections
+     * @return True if every section matches its checksum
+     */
+    bool verifyPayload() const;
+
+    /**
+     * @brief Write a container
+     * @param path Output path
+     * @param sectionData Sections to store
+     * @return True on success
+     */
+    static bool write(const std::string& path, const std::vector<ModelSectionData>& sectionData);
+
+    /**
+     * @brief 64-bit FNV-1a checksum
+     * @param data Bytes to hash
+     * @param size Number of bytes
+     * @param previous Checksum of the bytes before these, to hash data in pieces
+     * @return Checksum
+     */
+    static std::uint64_t checksum(const void* data, std::size_t size,
+                                  std::uint64_t previous = 0xcbf29ce484222325ULL);
+};
+
+#endif // MODEL_CONTAINER_H
\ No newline at end of file
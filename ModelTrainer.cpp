@@ -0,0 +1,532 @@
+#include "ModelTrainer.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <sstream>
+
+namespace {
+
+typedef std::array<std::uint8_t, 4> Exponents;
+typedef std::chrono::steady_clock Clock;
+
+// Design matrix columns: one-hot material class, milling and drilling indicators, then the monomials
+const std::size_t categoricalColumns = RegressionPredictor::MaterialClassCount + 2;
+
+double millisecondsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// All exponent vectors of total degree 1..degree, lowest degree first
+std::vector<Exponents> enumerateMonomials(int degree) {
+    std::vector<Exponents> monomials;
+    for (int total = 1; total <= degree; ++total) {
+        for (int a = total; a >= 0; --a) {
+            for (int b = total - a; b >= 0; --b) {
+                for (int c = total - a - b; c >= 0; --c) {
+                    int d = total - a - b - c;
+                    monomials.push_back({static_cast<std::uint8_t>(a), static_cast<std::uint8_t>(b),
+                                         static_cast<std::uint8_t>(c), static_cast<std::uint8_t>(d)});
+                }
+            }
+        }
+    }
+    return monomials;
+}
+
+/**
+ * Expanded feature space of one polynomial degree; rows are expanded on the fly
+ * from the shared training set instead of materializing a design matrix
+ */
+struct DesignSpace {
+    int degree;
+    std::vector<Exponents> monomials;
+    std::size_t columns;
+
+    void expand(const TrainingSet& data, const RegressionNormalization& norm, std::size_t row, double* x) const {
+        std::fill(x, x + categoricalColumns, 0.0);
+        x[data.materialClasses[row]] = 1.0;
+        if (data.operationClasses[row] == RegressionPredictor::MillingClass) {
+            x[RegressionPredictor::MaterialClassCount] = 1.0;
+        } else if (data.operationClasses[row] == RegressionPredictor::DrillingClass) {
+            x[RegressionPredictor::MaterialClassCount + 1] = 1.0;
+        }
+
+        double powers[4][RegressionPredictor::MaxTermExponent + 1];
+        const double* p = &data.parameters[row * 4];
+        for (int j = 0; j < 4; ++j) {
+            double z = (p[j] - norm.mean[j]) / norm.scale[j];
+            powers[j][0] = 1.0;
+            for (int e = 1; e <= degree; ++e) {
+                powers[j][e] = powers[j][e - 1] * z;
+            }
+        }
+        double* out = x + categoricalColumns;
+        for (const Exponents& m : monomials) {
+            *out++ = powers[0][m[0]] * powers[1][m[1]] * powers[2][m[2]] * powers[3][m[3]];
+        }
+    }
+};
+
+// X'X (upper triangle, row-major p x p) and X'y over a set of rows
+struct NormalEquations {
+    std::vector<double> gram;
+    std::vector<double> rhs;
+    std::size_t rows;
+};
+
+NormalEquations accumulate(const TrainingSet& data, const RegressionNormalization& norm,
+                           const DesignSpace& space, const std::vector<std::size_t>& rows) {
+    const std::size_t p = space.columns;
+    NormalEquations eq;
+    eq.gram.assign(p * p, 0.0);
+    eq.rhs.assign(p, 0.0);
+    eq.rows = rows.size();
+    std::vector<double> x(p);
+    for (std::size_t row : rows) {
+        space.expand(data, norm, row, x.data());
+        const double y = data.power[row];
+        for (std::size_t a = 0; a < p; ++a) {
+            const double xa = x[a];
+            if (xa == 0.0) {
+                continue;   // one-hot columns are mostly zero
+            }
+            double* gramRow = &eq.gram[a * p];
+            for (std::size_t b = a; b < p; ++b) {
+                gramRow[b] += xa * x[b];
+            }
+            eq.rhs[a] += xa * y;
+        }
+    }
+    return eq;
+}
+
+/**
+ * Ridge solve of (G + penalty) w = r by Cholesky; G is given by its upper triangle.
+ * The categorical columns only get a tiny stabilizing ridge, so a material class
+ * missing from the training rows simply receives a zero offset.
+ */
+bool solveRidge(const std::vector<double>& gram, const std::vector<double>& rhs, std::size_t p,
+                double penalty, std::vector<double>& weights) {
+    std::vector<double> a(p * p);
+    double maxDiagonal = 0.0;
+    for (std::size_t i = 0; i < p; ++i) {
+        maxDiagonal = std::max(maxDiagonal, gram[i * p + i]);
+    }
+    const double jitter = 1e-10 * (1.0 + maxDiagonal);
+    for (std::size_t i = 0; i < p; ++i) {
+        for (std::size_t j = i; j < p; ++j) {
+            a[i * p + j] = a[j * p + i] = gram[i * p + j];
+        }
+        a[i * p + i] += jitter + (i >= categoricalColumns ? penalty : 0.0);
+    }
+
+    // In-place Cholesky factorization, lower triangle
+    for (std::size_t j = 0; j < p; ++j) {
+        double diagonal = a[j * p + j];
+        for (std::size_t k = 0; k < j; ++k) {
+            diagonal -= a[j * p + k] * a[j * p + k];
+        }
+        if (!(diagonal > 0.0)) {
+            return false;
+        }
+        diagonal = std::sqrt(diagonal);
+        a[j * p + j] = diagonal;
+        for (std::size_t i = j + 1; i < p; ++i) {
+            double value = a[i * p + j];
+            for (std::size_t k = 0; k < j; ++k) {
+                value -= a[i * p + k] * a[j * p + k];
+            }
+            a[i * p + j] = value / diagonal;
+        }
+    }
+
+    weights.assign(p, 0.0);
+    for (std::size_t i = 0; i < p; ++i) {
+        double value = rhs[i];
+        for (std::size_t k = 0; k < i; ++k) {
+            value -= a[i * p + k] * weights[k];
+        }
+        weights[i] = value / a[i * p + i];
+    }
+    for (std::size_t i = p; i-- > 0;) {
+        double value = weights[i];
+        for (std::size_t k = i + 1; k < p; ++k) {
+            value -= a[k * p + i] * weights[k];
+        }
+        weights[i] = value / a[i * p + i];
+    }
+    return true;
+}
+
+// Squared and absolute error sums of a weight vector over a set of rows
+void evaluate(const TrainingSet& data, const RegressionNormalization& norm, const DesignSpace& space,
+              const std::vector<double>& weights, const std::vector<std::size_t>& rows,
+              double& squaredError, double& absoluteError) {
+    std::vector<double> x(space.columns);
+    squaredError = 0.0;
+    absoluteError = 0.0;
+    for (std::size_t row : rows) {
+        space.expand(data, norm, row, x.data());
+        double predicted = std::inner_product(x.begin(), x.end(), weights.begin(), 0.0);
+        double error = predicted - data.power[row];
+        squaredError += error * error;
+        absoluteError += std::fabs(error);
+    }
+}
+
+} // namespace
+
+// TrainingSet implementation
+TrainingSet::TrainingSet() : rows(0) {
+}
+
+void TrainingSet::addRow(const std::string& material, const std::string& operationType,
+                         double toolDiameter, double spindleSpeed, double feedRate, double depthOfCut,
+                         double cuttingPower) {
+    parameters.push_back(toolDiameter);
+    parameters.push_back(spindleSpeed);
+    parameters.push_back(feedRate);
+    parameters.push_back(depthOfCut);
+    materialClasses.push_back(static_cast<std::uint8_t>(RegressionPredictor::classifyMaterial(material)));
+    operationClasses.push_back(static_cast<std::uint8_t>(RegressionPredictor::classifyOperation(operationType)));
+    power.push_back(cuttingPower);
+    ++rows;
+}
+
+int TrainingSet::loadCsv(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cout << "Error: cannot open training data " << path << std::endl;
+        return -1;
+    }
+
+    // Columns: material, tool_diameter_mm, spindle_rpm, feed_mm_min, depth_of_cut_mm,
+    //          operation_type, machine_type, cutting_power_kW
+    std::string line;
+    std::getline(file, line);
+    int added = 0;
+    while (std::getline(file, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (line.empty()) {
+            continue;
+        }
+        std::vector<std::string> fields;
+        std::stringstream stream(line);
+        std::string field;
+        while (std::getline(stream, field, ',')) {
+            fields.push_back(field);
+        }
+        if (fields.size() < 8) {
+            continue;
+        }
+        char* end = nullptr;
+        double values[5];
+        const int columns[5] = {1, 2, 3, 4, 7};
+        bool valid = true;
+        for (int c = 0; c < 5; ++c) {
+            values[c] = std::strtod(fields[columns[c]].c_str(), &end);
+            valid = valid && end != fields[columns[c]].c_str() && std::isfinite(values[c]);
+        }
+        if (!valid) {
+            continue;
+        }
+        addRow(fields[0], fields[5], values[0], values[1], values[2], values[3], values[4]);
+        ++added;
+    }
+    return added;
+}
+
+// TrainerOptions implementation
+TrainerOptions::TrainerOptions()
+    : folds(5), degrees({1, 2, 3}), lambdas({1e-4, 1e-3, 1e-2, 1e-1, 1.0, 10.0}), seed(42), threads(0) {
+}
+
+// TrainingReport implementation
+TrainingReport::TrainingReport()
+    : bestCandidate(0), rows(0), folds(0), threads(0), seed(0), trainingRmse(0.0),
+      statisticsMilliseconds(0.0), searchMilliseconds(0.0), totalMilliseconds(0.0),
+      coefficients(), normalization() {
+}
+
+void TrainingReport::print() const {
+    std::cout << "Cross-validation: " << rows << " rows, " << folds << " folds, "
+              << candidates.size() << " grid points, " << threads << " threads, seed " << seed << std::endl;
+    for (const CandidateReport& candidate : candidates) {
+        std::cout << "  degree " << candidate.degree << ", lambda " << candidate.lambda
+                  << ": RMSE " << candidate.meanRmse << " +/- " << candidate.rmseStdDev << " kW (folds:";
+        for (const FoldReport& fold : candidate.folds) {
+            std::cout << " " << fold.rmse;
+        }
+        std::cout << "), " << candidate.milliseconds << " ms" << std::endl;
+    }
+    if (candidates.empty()) {
+        return;
+    }
+
+    const CandidateReport& best = candidates[bestCandidate];
+    std::cout << "Selected degree " << best.degree << ", lambda " << best.lambda << std::endl;
+    for (const FoldReport& fold : best.folds) {
+        std::cout << "  fold " << fold.fold << ": train " << fold.trainingRows
+                  << ", validate " << fold.validationRows
+                  << ", RMSE " << fold.rmse << " kW, MAE " << fold.meanAbsError
+                  << " kW, " << fold.milliseconds << " ms" << std::endl;
+    }
+    std::cout << "CV RMSE " << best.meanRmse << " kW, training RMSE " << trainingRmse << " kW" << std::endl;
+    std::cout << "Timing: normal equations " << statisticsMilliseconds << " ms, search "
+              << searchMilliseconds << " ms, total " << totalMilliseconds << " ms" << std::endl;
+}
+
+// ModelTrainer implementation
+ModelTrainer::ModelTrainer(const TrainerOptions& trainerOptions) : options(trainerOptions) {
+}
+
+const TrainerOptions& ModelTrainer::getOptions() const {
+    return options;
+}
+
+bool ModelTrainer::train(const TrainingSet& data, TrainingReport& report) const {
+    const Clock::time_point start = Clock::now();
+    report = TrainingReport();
+
+    const std::size_t n = data.rows;
+    const std::size_t folds = std::min(options.folds, n);
+    if (folds < 2) {
+        std::cout << "Error: cross-validation needs at least 2 folds and 2 rows (have " << n << " rows)" << std::endl;
+        return false;
+    }
+    if (options.degrees.empty() || options.lambdas.empty()) {
+        std::cout << "Error: empty hyperparameter grid" << std::endl;
+        return false;
+    }
+    for (int degree : options.degrees) {
+        if (degree < 1 || degree > RegressionPredictor::MaxTermExponent) {
+            std::cout << "Error: polynomial degree " << degree << " out of range" << std::endl;
+            return false;
+        }
+    }
+    for (double lambda : options.lambdas) {
+        if (!(lambda >= 0.0)) {
+            std::cout << "Error: regularization strength must be non-negative" << std::endl;
+            return false;
+        }
+    }
+
+    // Standardize on all rows so every fold and the final model share one feature space
+    RegressionNormalization norm;
+    for (int j = 0; j < 4; ++j) {
+        double mean = 0.0;
+        for (std::size_t row = 0; row < n; ++row) {
+            mean += data.parameters[row * 4 + j];
+        }
+        mean /= static_cast<double>(n);
+        double variance = 0.0;
+        for (std::size_t row = 0; row < n; ++row) {
+            double d = data.parameters[row * 4 + j] - mean;
+            variance += d * d;
+        }
+        double scale = std::sqrt(variance / static_cast<double>(n));
+        norm.mean[j] = mean;
+        norm.scale[j] = scale > 0.0 ? scale : 1.0;
+    }
+
+    // Seeded fold assignment; folds hold row indices into the shared data
+    std::vector<std::size_t> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::mt19937_64 generator(options.seed);
+    for (std::size_t i = n - 1; i > 0; --i) {
+        // Explicit Fisher-Yates: std::shuffle's draws are not specified across standard libraries
+        std::size_t j = static_cast<std::size_t>(generator() % (i + 1));
+        std::swap(order[i], order[j]);
+    }
+    std::vector<std::vector<std::size_t>> foldRows(folds);
+    for (std::size_t i = 0; i < n; ++i) {
+        foldRows[i % folds].push_back(order[i]);
+    }
+
+    std::vector<DesignSpace> spaces;
+    for (int degree : options.degrees) {
+        DesignSpace space;
+        space.degree = degree;
+        space.monomials = enumerateMonomials(degree);
+        space.columns = categoricalColumns + space.monomials.size();
+        spaces.push_back(space);
+    }
+
+    ThreadPool pool(options.threads);
+    report.rows = n;
+    report.folds = folds;
+    report.threads = pool.getThreadCount();
+    report.seed = options.seed;
+
+    // Normal equations per (degree, fold), in parallel
+    Clock::time_point phase = Clock::now();
+    std::vector<std::vector<NormalEquations>> foldEquations(spaces.size(), std::vector<NormalEquations>(folds));
+    {
+        std::vector<std::future<void>> pending;
+        for (std::size_t s = 0; s < spaces.size(); ++s) {
+            for (std::size_t k = 0; k < folds; ++k) {
+                pending.push_back(pool.submit([&, s, k]() {
+                    foldEquations[s][k] = accumulate(data, norm, spaces[s], foldRows[k]);
+                }));
+            }
+        }
+        for (std::future<void>& task : pending) {
+            task.get();
+        }
+    }
+    // Totals are summed in fold order so they do not depend on scheduling
+    std::vector<NormalEquations> totals(spaces.size());
+    for (std::size_t s = 0; s < spaces.size(); ++s) {
+        totals[s] = foldEquations[s][0];
+        for (std::size_t k = 1; k < folds; ++k) {
+            for (std::size_t i = 0; i < totals[s].gram.size(); ++i) {
+                totals[s].gram[i] += foldEquations[s][k].gram[i];
+            }
+            for (std::size_t i = 0; i < totals[s].rhs.size(); ++i) {
+                totals[s].rhs[i] += foldEquations[s][k].rhs[i];
+            }
+            totals[s].rows += foldEquations[s][k].rows;
+        }
+    }
+    report.statisticsMilliseconds = millisecondsSince(phase);
+
+    // Every (degree, lambda, fold) is an independent task writing its own FoldReport
+    phase = Clock::now();
+    for (std::size_t s = 0; s < spaces.size(); ++s) {
+        for (double lambda : options.lambdas) {
+            CandidateReport candidate;
+            candidate.degree = spaces[s].degree;
+            candidate.lambda = lambda;
+            candidate.folds.resize(folds);
+            report.candidates.push_back(candidate);
+        }
+    }
+    {
+        std::vector<std::future<bool>> pending;
+        for (std::size_t c = 0; c < report.candidates.size(); ++c) {
+            for (std::size_t k = 0; k < folds; ++k) {
+                pending.push_back(pool.submit([&, c, k]() {
+                    const Clock::time_point taskStart = Clock::now();
+                    const std::size_t s = c / options.lambdas.size();
+                    const DesignSpace& space = spaces[s];
+                    const NormalEquations& total = totals[s];
+                    const NormalEquations& held = foldEquations[s][k];
+
+                    std::vector<double> gram(total.gram.size());
+                    std::vector<double> rhs(total.rhs.size());
+                    for (std::size_t i = 0; i < gram.size(); ++i) {
+                        gram[i] = total.gram[i] - held.gram[i];
+                    }
+                    for (std::size_t i = 0; i < rhs.size(); ++i) {
+                        rhs[i] = total.rhs[i] - held.rhs[i];
+                    }
+                    const std::size_t trainingRows = total.rows - held.rows;
+                    std::vector<double> weights;
+                    if (!solveRidge(gram, rhs, space.columns,
+                                    report.candidates[c].lambda * static_cast<double>(trainingRows), weights)) {
+                        return false;
+                    }
+
+                    double squaredError = 0.0;
+                    double absoluteError = 0.0;
+                    evaluate(data, norm, space, weights, foldRows[k], squaredError, absoluteError);
+                    FoldReport& fold = report.candidates[c].folds[k];
+                    fold.fold = k;
+                    fold.trainingRows = trainingRows;
+                    fold.validationRows = held.rows;
+                    fold.rmse = std::sqrt(squaredError / static_cast<double>(held.rows));
+                    fold.meanAbsError = absoluteError / static_cast<double>(held.rows);
+                    fold.milliseconds = millisecondsSince(taskStart);
+                    return true;
+                }));
+            }
+        }
+        bool solved = true;
+        for (std::future<bool>& task : pending) {
+            solved = task.get() && solved;
+        }
+        if (!solved) {
+            std::cout << "Error: cross-validation system is singular, increase the regularization" << std::endl;
+            return false;
+        }
+    }
+    report.searchMilliseconds = millisecondsSince(phase);
+
+    for (std::size_t c = 0; c < report.candidates.size(); ++c) {
+        CandidateReport& candidate = report.candidates[c];
+        double sum = 0.0;
+        double squares = 0.0;
+        candidate.milliseconds = 0.0;
+        for (const FoldReport& fold : candidate.folds) {
+            sum += fold.rmse;
+            squares += fold.rmse * fold.rmse;
+            candidate.milliseconds += fold.milliseconds;
+        }
+        candidate.meanRmse = sum / static_cast<double>(folds);
+        candidate.rmseStdDev = std::sqrt(std::max(0.0, squares / static_cast<double>(folds)
+                                                       - candidate.meanRmse * candidate.meanRmse));
+        // Strict comparison keeps the first (lowest degree) grid point on ties
+        if (candidate.meanRmse < report.candidates[report.bestCandidate].meanRmse) {
+            report.bestCandidate = c;
+        }
+    }
+
+    // Refit the selected grid point on all rows
+    const CandidateReport& best = report.candidates[report.bestCandidate];
+    const std::size_t s = report.bestCandidate / options.lambdas.size();
+    const DesignSpace& space = spaces[s];
+    std::vector<double> weights;
+    if (!solveRidge(totals[s].gram, totals[s].rhs, space.columns, best.lambda * static_cast<double>(n), weights)) {
+        std::cout << "Error: training system is singular, increase the regularization" << std::endl;
+        return false;
+    }
+    std::vector<std::size_t> allRows(n);
+    std::iota(allRows.begin(), allRows.end(), 0);
+    double squaredError = 0.0;
+    double absoluteError = 0.0;
+    evaluate(data, norm, space, weights, allRows, squaredError, absoluteError);
+    report.trainingRmse = std::sqrt(squaredError / static_cast<double>(n));
+
+    // Map the weights onto the regression backend: offsets, raw-unit linear coefficients, higher terms
+    RegressionCoefficients& c = report.coefficients;
+    c.steelOffset = weights[RegressionPredictor::SteelClass];
+    c.titaniumOffset = weights[RegressionPredictor::TitaniumClass];
+    c.aluminumOffset = weights[RegressionPredictor::AluminumClass];
+    c.otherMaterialOffset = weights[RegressionPredictor::OtherMaterialClass];
+    c.millingOffset = weights[RegressionPredictor::MaterialClassCount];
+    c.drillingOffset = weights[RegressionPredictor::MaterialClassCount + 1];
+    c.intercept = 0.0;
+    double* linear[4] = {&c.toolDiameter, &c.spindleSpeed, &c.feedRate, &c.depthOfCut};
+    for (int j = 0; j < 4; ++j) {
+        *linear[j] = 0.0;
+    }
+    report.normalization = norm;
+    for (std::size_t m = 0; m < space.monomials.size(); ++m) {
+        const Exponents& e = space.monomials[m];
+        const double w = weights[categoricalColumns + m];
+        if (e[0] + e[1] + e[2] + e[3] == 1) {
+            int j = e[0] ? 0 : e[1] ? 1 : e[2] ? 2 : 3;
+            *linear[j] = w / norm.scale[j];
+            c.intercept -= w * norm.mean[j] / norm.scale[j];
+        } else {
+            RegressionTerm term;
+            std::copy(e.begin(), e.end(), term.exponents);
+            term.reserved = 0;
+            term.coefficient = w;
+            report.terms.push_back(term);
+        }
+    }
+
+    report.totalMilliseconds = millisecondsSince(start);
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,136 @@
+#ifndef MODEL_TRAINER_H
+#define MODEL_TRAINER_H
+
+#include "BuiltinPredictors.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Measured cuts used to fit the regression model
+ *
+ * Loaded once and shared read-only by all folds and grid points.
+ */
+struct TrainingSet {
+    std::size_t rows;
+    std::vector<double> parameters;                 // rows x 4: tool diameter, spindle speed, feed rate, depth of cut
+    std::vector<std::uint8_t> materialClasses;      // RegressionPredictor::MaterialClass per row
+    std::vector<std::uint8_t> operationClasses;     // RegressionPredictor::OperationClass per row
+    std::vector<double> power;                      // measured cutting power in kW
+
+    TrainingSet();
+
+    /**
+     * @brief Append one measured cut
+     */
+    void addRow(const std::string& material, const std::string& operationType,
+                double toolDiameter, double spindleSpeed, double feedRate, double depthOfCut,
+                double cuttingPower);
+
+    /**
+     * @brief Load measured cuts in the datasets/machining_power.csv layout
+     * @param path Path to the CSV file
+     * @return Number of rows loaded, or -1 if the file cannot be read
+     */
+    int loadCsv(const std::string& path);
+};
+
+/**
+ * @brief Cross-validation and hyperparameter grid settings
+ */
+struct TrainerOptions {
+    std::size_t folds;              // k of the k-fold split (limited to the number of rows)
+    std::vector<int> degrees;       // polynomial degrees of the machining parameters to try
+    std::vector<double> lambdas;    // ridge regularization strengths to try
+    std::uint64_t seed;             // seed of the fold assignment
+    std::size_t threads;            // worker threads (0 uses the hardware concurrency)
+
+    TrainerOptions();
+};
+
+/**
+ * @brief Validation error of one fold for one grid point
+ */
+struct FoldReport {
+    std::size_t fold;
+    std::size_t trainingRows;
+    std::size_t validationRows;
+    double rmse;            // kW
+    double meanAbsError;    // kW
+    double milliseconds;    // solve and validation time
+};
+
+/**
+ * @brief Cross-validation result of one grid point
+ */
+struct CandidateReport {
+    int degree;
+    double lambda;
+    std::vector<FoldReport> folds;
+    double meanRmse;        // kW, mean over the folds
+    double rmseStdDev;      // kW, spread over the folds
+    double milliseconds;    // sum of the fold times
+};
+
+/**
+ * @brief Outcome of a training run
+ */
+struct TrainingReport {
+    std::vector<CandidateReport> candidates;    // in grid order (degree-major)
+    std::size_t bestCandidate;
+    std::size_t rows;
+    std::size_t folds;
+    std::size_t threads;
+    std::uint64_t seed;
+    double trainingRmse;                        // kW, best model on all rows
+    double statisticsMilliseconds;              // per-fold normal equations
+    double searchMilliseconds;                  // all grid points, wall clock
+    double totalMilliseconds;
+
+    // Fitted model, ready for RegressionPredictor
+    RegressionCoefficients coefficients;
+    RegressionNormalization normalization;
+    std::vector<RegressionTerm> terms;
+
+    TrainingReport();
+
+    /**
+     * @brief Print the per-fold errors, timing and the selected hyperparameters
+     */
+    void print() const;
+};
+
+/**
+ * @brief Fits the regression backend with k-fold cross-validated ridge regression
+ *
+ * The grid over polynomial degree and regularization strength runs on a thread pool.
+ * Each fold's normal equations (X'X and X'y) are accumulated once per degree, in
+ * parallel, straight from the shared TrainingSet; the training system of a fold is
+ * then the total minus the fold, so each grid point costs one small solve plus one
+ * pass over the validation rows. Results are identical for any thread count: folds
+ * come from a seeded shuffle and every task writes to its own slot.
+ */
+class ModelTrainer {
+private:
+    TrainerOptions options;
+
+public:
+    explicit ModelTrainer(const TrainerOptions& trainerOptions = TrainerOptions());
+
+    /**
+     * @brief Run the cross-validated search and fit the best grid point on all rows
+     * @param data Measured cuts
+     * @param report Receives the per-fold results and the fitted model
+     * @return True on success
+     */
+    bool train(const TrainingSet& data, TrainingReport& report) const;
+
+    /**
+     * @brief Get the options
+     * @return Current options
+     */
+    const TrainerOptions& getOptions() const;
+};
+
+#endif // MODEL_TRAINER_H
\ No newline at end of file
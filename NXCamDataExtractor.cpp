@@ -1,12 +1,38 @@
 #include "NXCamDataExtractor.h"
+#include "ExtractionCache.h"
 #include <iostream>
 
+namespace {
+
+// Sample operations with the ids and stamps the operation navigator would report
+struct SampleOperation {
+    const char* id;
+    std::uint64_t stamp;
+    const char* type;
+    double time;
+    double feed;
+    double spindle;
+    double diameter;
+};
+
+const SampleOperation sampleOperations[] = {
+    {"OP010", 1, "Rough Milling", 15.2, 1000, 7500, 12.0},
+    {"OP020", 1, "Finish Milling", 8.7, 800, 8000, 8.0},
+    {"OP030", 1, "Drilling", 3.4, 500, 4500, 6.0}
+};
+
+const char samplePartIdentity[] = "3f2a9c1e-5b7d-4e08-9a61-c4d2e8f0b135";
+const char toolInfoName[] = "tool-info";
+const char processParametersName[] = "process-parameters";
+
+} // namespace
+
 // NXOperation implementation
 NXOperation::NXOperation(const std::string& type, double time, double feed, double spindle, double diameter)
     : operationType(type), cuttingTime(time), feedRate(feed), spindleSpeed(spindle), toolDiameter(diameter) {
 }
 
-std::string NXOperation::getOperationType() const {
+const std::string& NXOperation::getOperationType() const {
     return operationType;
 }
 
@@ -35,30 +61,131 @@ NXCamDataExtractor::~NXCamDataExtractor() {
     std::cout << "NXCamDataExtractor destroyed" << std::endl;
 }
 
+void NXCamDataExtractor::setPartPath(const std::string& path) {
+    partPath = path;
+}
+
+void NXCamDataExtractor::setPartIdentity(const std::string& identity) {
+    partIdentity = identity;
+}
+
+std::uint64_t NXCamDataExtractor::getPartFingerprint() const {
+    // In a real implementation, the path and the UUID would come from the work part via NX Open API
+    return ExtractionCache::fingerprintPart(partPath.empty() ? std::string("sample_part.prt") : partPath,
+                                            partIdentity.empty() ? std::string(samplePartIdentity) : partIdentity);
+}
+
+std::size_t NXCamDataExtractor::listOperationStamps(std::vector<OperationStamp>& stamps) {
+    // In a real implementation, this would walk the operation navigator and read each
+    // operation's id and modification time without touching its tool or parameters
+    stamps.clear();
+    for (const SampleOperation& sample : sampleOperations) {
+        stamps.push_back(OperationStamp{sample.id, sample.stamp});
+    }
+    return stamps.size();
+}
+
+NXOperation NXCamDataExtractor::readOperation(std::size_t index) {
+    // In a real implementation, this would read the operation, its tool and its cutting
+    // parameters via NX Open API, which is the expensive part of an extraction
+    const SampleOperation& sample = sampleOperations[index];
+    return NXOperation(sample.type, sample.time, sample.feed, sample.spindle, sample.diameter);
+}
+
+std::uint64_t NXCamDataExtractor::getTreeStamp(const std::vector<OperationStamp>& stamps) const {
+    // Changes whenever an operation is added, removed, reordered or modified
+    OperationKeyBuilder builder;
+    for (const OperationStamp& operation : stamps) {
+        builder.add(operation.id);
+        builder.add(operation.stamp);
+    }
+    return builder.getKey().low;
+}
+
 std::vector<NXOperation> NXCamDataExtractor::extractOperations() {
-    // In a real implementation, this would connect to NX CAM via NX Open API
-    // For this example, we'll return a sample set of operations
     std::vector<NXOperation> operations;
-    
-    // Simulate extraction of operations from NX CAM
-    operations.emplace_back("Rough Milling", 15.2, 1000, 7500, 12.0);
-    operations.emplace_back("Finish Milling", 8.7, 800, 8000, 8.0);
-    operations.emplace_back("Drilling", 3.4, 500, 4500, 6.0);
+    extractOperations([&operations](const NXOperation& operation) {
+        operations.push_back(operation);
+        return true;
+    });
     
     std::cout << "Extracted " << operations.size() << " operations from NX CAM" << std::endl;
     return operations;
 }
 
+std::size_t NXCamDataExtractor::extractOperations(const OperationSink& sink) {
+    // In a real implementation, this would walk the NX CAM operation navigator via NX Open API
+    // For this example, we'll hand over a sample set of operations
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < sizeof(sampleOperations) / sizeof(sampleOperations[0]); ++i) {
+        ++count;
+        if (!sink(readOperation(i))) {
+            break;
+        }
+    }
+    return count;
+}
+
+std::size_t NXCamDataExtractor::extractOperations(const OperationSink& sink, ExtractionCache& cache) {
+    std::uint64_t part = getPartFingerprint();
+    std::vector<OperationStamp> stamps;
+    listOperationStamps(stamps);
+
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < stamps.size(); ++i) {
+        ++count;
+        const NXOperation* cached = cache.findOperation(part, stamps[i].id, stamps[i].stamp);
+        bool more;
+        if (cached != nullptr) {
+            more = sink(*cached);
+        } else {
+            NXOperation operation = readOperation(i);
+            cache.insertOperation(part, stamps[i].id, stamps[i].stamp, operation);
+            more = sink(operation);
+        }
+        if (!more) {
+            break;
+        }
+    }
+    return count;
+}
+
 std::string NXCamDataExtractor::extractToolInfo() {
     // In a real implementation, this would extract tool information from NX CAM
     return "Tool information extracted from NX CAM";
 }
 
+std::string NXCamDataExtractor::extractToolInfo(ExtractionCache& cache) {
+    std::vector<OperationStamp> stamps;
+    listOperationStamps(stamps);
+    std::uint64_t part = getPartFingerprint();
+    std::uint64_t stamp = getTreeStamp(stamps);
+    if (const std::string* cached = cache.findText(part, toolInfoName, stamp)) {
+        return *cached;
+    }
+    std::string info = extractToolInfo();
+    cache.insertText(part, toolInfoName, stamp, info);
+    return info;
+}
+
 std::string NXCamDataExtractor::extractProcessParameters() {
     // In a real implementation, this would extract process parameters from NX CAM
     return "Process parameters extracted from NX CAM";
 }
 
+std::string NXCamDataExtractor::extractProcessParameters(ExtractionCache& cache) {
+    std::vector<OperationStamp> stamps;
+    listOperationStamps(stamps);
+    std::uint64_t part = getPartFingerprint();
+    std::uint64_t stamp = getTreeStamp(stamps);
+    if (const std::string* cached = cache.findText(part, processParametersName, stamp)) {
+        return *cached;
+    }
+    std::string parameters = extractProcessParameters();
+    cache.insertText(part, processParametersName, stamp, parameters);
+    return parameters;
+}
+
 double NXCamDataExtractor::getTotalCuttingTime() {
     // In a real implementation, this would calculate total cutting time from all operations
     // For this example, returning a sample value
@@ -1,6 +1,9 @@
 #ifndef NX_CAM_DATA_EXTRACTOR_H
 #define NX_CAM_DATA_EXTRACTOR_H
 
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -18,13 +21,30 @@ private:
 public:
     NXOperation(const std::string& type, double time, double feed, double spindle, double diameter);
     
-    std::string getOperationType() const;
+    const std::string& getOperationType() const;
     double getCuttingTime() const;
     double getFeedRate() const;
     double getSpindleSpeed() const;
     double getToolDiameter() const;
 };
 
+/**
+ * @brief Receives operations one at a time as they are extracted
+ *
+ * Returning false stops the extraction early.
+ */
+typedef std::function<bool(const NXOperation&)> OperationSink;
+
+/**
+ * @brief Identity and modification stamp of an operation in the part
+ */
+struct OperationStamp {
+    std::string id;         // stable operation identifier within the part
+    std::uint64_t stamp;    // changes whenever the operation (or its tool or parameters) is modified
+};
+
+class ExtractionCache;
+
 /**
  * @brief Class to extract data from NX CAM using NX Open API
  * 
@@ -32,27 +52,99 @@ public:
  * including cutting time, operation list, tool information, and process parameters.
  */
 class NXCamDataExtractor {
+private:
+    std::string partPath;
+    std::string partIdentity;
+
+    NXOperation readOperation(std::size_t index);
+    std::uint64_t getTreeStamp(const std::vector<OperationStamp>& stamps) const;
+
 public:
     NXCamDataExtractor();
     ~NXCamDataExtractor();
+
+    /**
+     * @brief Set the part file the operations belong to (identifies its cache entries)
+     * @param path Part file path
+     */
+    void setPartPath(const std::string& path);
+
+    /**
+     * @brief Set the persistent identity of the part, e.g. its UUID in NX
+     *
+     * Stays the same when the part is saved, and differs for another part copied over the
+     * same path, so its cache entries are not served for that part.
+     * @param identity Part identity (the sample part has a fixed one)
+     */
+    void setPartIdentity(const std::string& identity);
+
+    /**
+     * @brief Get the fingerprint identifying the part in an ExtractionCache
+     * @return Fingerprint of the part file and its identity
+     */
+    std::uint64_t getPartFingerprint() const;
+
+    /**
+     * @brief List the operations with their modification stamps, without reading them
+     *
+     * Only walks the operation navigator for ids and stamps, which is much cheaper than
+     * reading every operation's tool and process parameters.
+     * @param stamps Receives one entry per operation, in program order
+     * @return Number of operations
+     */
+    std::size_t listOperationStamps(std::vector<OperationStamp>& stamps);
     
     /**
      * @brief Extract operation list from NX CAM
      * @return Vector of NXOperation objects
      */
     std::vector<NXOperation> extractOperations();
+
+    /**
+     * @brief Extract operations incrementally, handing each one over as soon as it is read
+     *
+     * Lets modelling start before a large assembly is fully extracted (see EstimationPipeline).
+     * @param sink Called once per operation, in program order, on the calling thread
+     * @return Number of operations passed to the sink
+     */
+    std::size_t extractOperations(const OperationSink& sink);
+
+    /**
+     * @brief Extract operations, reading only those that are new or changed since they were cached
+     *
+     * Operations whose part fingerprint, id and stamp match a cache entry are taken from the
+     * cache; the others are read from NX and added to it.
+     * @param sink Called once per operation, in program order, on the calling thread
+     * @param cache Extraction cache
+     * @return Number of operations passed to the sink
+     */
+    std::size_t extractOperations(const OperationSink& sink, ExtractionCache& cache);
     
     /**
      * @brief Extract tool information from NX CAM
      * @return Tool information as string
      */
     std::string extractToolInfo();
+
+    /**
+     * @brief Extract tool information, from the cache while no operation has changed
+     * @param cache Extraction cache
+     * @return Tool information as string
+     */
+    std::string extractToolInfo(ExtractionCache& cache);
     
     /**
      * @brief Extract process parameters from NX CAM
      * @return Process parameters as string
      */
     std::string extractProcessParameters();
+
+    /**
+     * @brief Extract process parameters, from the cache while no operation has changed
+     * @param cache Extraction cache
+     * @return Process parameters as string
+     */
+    std::string extractProcessParameters(ExtractionCache& cache);
     
     /**
      * @brief Get total cutting time from all operations
@@ -0,0 +1,342 @@
+#include "OperationCache.h"
+#include "ModelContainer.h"
+#include "NXCamDataExtractor.h"
+#include "MachineClasses.h"
+#include "TimeModel.h"
+#include "EnergyModel.h"
+#include "CarbonModel.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+namespace {
+
+const char cacheMagic[8] = {'N', 'X', 'O', 'P', 'C', 'A', 'C', 'H'};
+const std::uint32_t cacheFormatVersion = 1;
+
+struct CacheFileHeader {
+    char magic[8];
+    std::uint32_t formatVersion;
+    std::uint32_t recordSize;
+    std::uint64_t configVersion;
+    std::uint64_t count;
+    std::uint64_t checksum;         // over all records
+};
+
+struct CacheRecord {
+    OperationKey key;
+    OperationEstimate estimate;
+};
+
+static_assert(sizeof(CacheRecord) == 16 + 7 * sizeof(double), "CacheRecord is stored as-is in cache files");
+
+// Records read or written at a time when a cache file is merged
+const std::size_t mergeRecords = 4096;
+
+// Open a cache file of the given version and verify its checksum; on success the file is
+// positioned at the first record
+bool openCacheFile(std::ifstream& file, const std::string& path, std::uint64_t version, std::uint64_t& count) {
+    file.open(path, std::ios::binary);
+    CacheFileHeader header;
+    if (!file.is_open() || !file.read(reinterpret_cast<char*>(&header), sizeof(header))
+        || std::memcmp(header.magic, cacheMagic, sizeof(cacheMagic)) != 0
+        || header.formatVersion != cacheFormatVersion || header.recordSize != sizeof(CacheRecord)
+        || header.configVersion != version) {
+        return false;
+    }
+    file.seekg(0, std::ios::end);
+    std::uint64_t recordBytes = static_cast<std::uint64_t>(file.tellg()) - sizeof(header);
+    if (header.count != recordBytes / sizeof(CacheRecord) || recordBytes % sizeof(CacheRecord) != 0) {
+        return false;
+    }
+    file.seekg(sizeof(header), std::ios::beg);
+    std::vector<CacheRecord> chunk(mergeRecords);
+    std::uint64_t checksum = ModelContainer::checksum(nullptr, 0);
+    for (std::uint64_t done = 0; done < header.count; ) {
+        std::size_t n = static_cast<std::size_t>(std::min<std::uint64_t>(mergeRecords, header.count - done));
+        if (!file.read(reinterpret_cast<char*>(chunk.data()), n * sizeof(CacheRecord))) {
+            return false;
+        }
+        checksum = ModelContainer::checksum(chunk.data(), n * sizeof(CacheRecord), checksum);
+        done += n;
+    }
+    if (checksum != header.checksum) {
+        return false;
+    }
+    file.seekg(sizeof(header), std::ios::beg);
+    count = header.count;
+    return true;
+}
+
+} // namespace
+
+OperationKeyBuilder::OperationKeyBuilder() : high(0xcbf29ce484222325ULL), low(0x6a09e667f3bcc909ULL) {
+}
+
+void OperationKeyBuilder::add(std::uint64_t word) {
+    // High half: FNV-1a over the bytes; low half: multiply-xorshift over whole words
+    for (int i = 0; i < 8; ++i) {
+        high ^= (word >> (8 * i)) & 0xff;
+        high *= 0x100000001b3ULL;
+    }
+    low ^= word;
+    low *= 0x9e3779b97f4a7c15ULL;
+    low ^= low >> 29;
+}
+
+void OperationKeyBuilder::add(double value) {
+    if (value == 0.0) {
+        value = 0.0;    // -0 and +0 give the same results
+    }
+    std::uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    add(bits);
+}
+
+void OperationKeyBuilder::add(const std::string& text) {
+    add(static_cast<std::uint64_t>(text.size()));
+    for (std::size_t i = 0; i < text.size(); i += 8) {
+        std::uint64_t word = 0;
+        std::memcpy(&word, text.data() + i, std::min<std::size_t>(8, text.size() - i));
+        add(word);
+    }
+}
+
+OperationKey OperationKeyBuilder::getKey() const {
+    // Final avalanche so that nearby inputs spread over the hash table
+    std::uint64_t mixed = low;
+    mixed ^= mixed >> 33;
+    mixed *= 0xff51afd7ed558ccdULL;
+    mixed ^= mixed >> 33;
+    return OperationKey{high, mixed};
+}
+
+OperationParameters::OperationParameters(const TimeModel& timeModel, const EnergyModel& energyModel, double factor)
+    : rapidTimeFactor(timeModel.getRapidTimeFactor()),
+      idleTimePerOp(timeModel.getIdleTimePerOp()),
+      rapidPower(energyModel.getRapidPower()),
+      idlePower(energyModel.getIdlePower()),
+      emissionFactor(factor) {
+}
+
+OperationKey makeOperationKey(const std::string& material, const std::string& machineType,
+                              const NXOperation& operation, double depthOfCut) {
+    OperationKeyBuilder builder;
+    builder.add(material);
+    builder.add(machineType);
+    builder.add(operation.getOperationType());
+    builder.add(operation.getCuttingTime());
+    builder.add(operation.getFeedRate());
+    builder.add(operation.getSpindleSpeed());
+    builder.add(operation.getToolDiameter());
+    builder.add(depthOfCut);
+    return builder.getKey();
+}
+
+std::uint64_t makeEstimateVersion(std::uint64_t modelVersion, const OperationParameters& parameters,
+                                  bool machineClasses) {
+    OperationKeyBuilder builder;
+    builder.add(modelVersion);
+    builder.add(parameters.rapidTimeFactor);
+    builder.add(parameters.idleTimePerOp);
+    builder.add(parameters.rapidPower);
+    builder.add(parameters.idlePower);
+    builder.add(parameters.emissionFactor);
+    if (machineClasses) {
+        builder.add(static_cast<std::uint64_t>(MachineClass::Count));
+        for (std::size_t c = 0; c < static_cast<std::size_t>(MachineClass::Count); ++c) {
+            builder.add(getMachineKernel(static_cast<MachineClass>(c)).fingerprint);
+        }
+    }
+    return builder.getKey().low;
+}
+
+OperationEstimate evaluateOperation(double cuttingTime, double cuttingPower, const OperationParameters& parameters) {
+    OperationEstimate e;
+    e.cuttingPower = cuttingPower;
+    e.cuttingTime = cuttingTime;
+    e.rapidTime = TimeModel::computeRapidTime(e.cuttingTime, parameters.rapidTimeFactor);
+    e.idleTime = parameters.idleTimePerOp;
+    e.totalTime = TimeModel::computeTotalTime(e.cuttingTime, e.rapidTime, e.idleTime);
+    e.energy = EnergyModel::computeTotalEnergy(EnergyModel::computeEnergy(e.cuttingTime, e.cuttingPower),
+                                               EnergyModel::computeEnergy(e.rapidTime, parameters.rapidPower),
+                                               EnergyModel::computeEnergy(e.idleTime, parameters.idlePower));
+    e.carbon = CarbonModel::computeEmission(e.energy, parameters.emissionFactor);
+    return e;
+}
+
+OperationCache::OperationCache(std::pmr::memory_resource* resource)
+    : entries(resource), version(0), modified(false), shedEntries(false) {
+}
+
+bool OperationCache::setVersion(std::uint64_t configVersion) {
+    if (configVersion == version) {
+        return true;
+    }
+    if (!entries.empty()) {
+        std::cout << "Operation cache invalidated (model or configuration changed, "
+                  << entries.size() << " entries dropped)" << std::endl;
+        modified = true;
+    }
+    entries.clear();
+    shedEntries = false;    // a file of the old version is not merged
+    version = configVersion;
+    return false;
+}
+
+std::uint64_t OperationCache::getVersion() const {
+    return version;
+}
+
+const OperationEstimate* OperationCache::find(const OperationKey& key) const {
+    auto it = entries.find(key);
+    return it != entries.end() ? &it->second : nullptr;
+}
+
+void OperationCache::insert(const OperationKey& key, const OperationEstimate& estimate) {
+    entries[key] = estimate;
+    modified = true;
+}
+
+std::size_t OperationCache::size() const {
+    return entries.size();
+}
+
+void OperationCache::clear() {
+    modified = modified || !entries.empty() || shedEntries;
+    entries.clear();
+    shedEntries = false;
+}
+
+std::size_t OperationCache::shed() {
+    std::size_t dropped = entries.size();
+    // Swap with an empty map so the bucket array is released as well
+    decltype(entries) empty(entries.get_allocator());
+    entries.swap(empty);
+    shedEntries = shedEntries || dropped > 0;
+    return dropped;
+}
+
+bool OperationCache::isModified() const {
+    return modified;
+}
+
+bool OperationCache::load(const std::string& path) {
+    entries.clear();
+    modified = false;
+    shedEntries = false;
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    CacheFileHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))
+        || std::memcmp(header.magic, cacheMagic, sizeof(cacheMagic)) != 0
+        || header.formatVersion != cacheFormatVersion || header.recordSize != sizeof(CacheRecord)) {
+        std::cout << "Warning: " << path << " is not a valid operation cache, ignoring it" << std::endl;
+        return false;
+    }
+    if (header.configVersion != version) {
+        std::cout << "Operation cache " << path << " was written for other models or parameters, ignoring it"
+                  << std::endl;
+        return false;
+    }
+
+    file.seekg(0, std::ios::end);
+    std::uint64_t recordBytes = static_cast<std::uint64_t>(file.tellg()) - sizeof(header);
+    file.seekg(sizeof(header), std::ios::beg);
+    if (header.count != recordBytes / sizeof(CacheRecord) || recordBytes % sizeof(CacheRecord) != 0) {
+        std::cout << "Warning: operation cache " << path << " is truncated or corrupt, ignoring it" << std::endl;
+        return false;
+    }
+
+    std::vector<CacheRecord> records(static_cast<std::size_t>(header.count));
+    if (!file.read(reinterpret_cast<char*>(records.data()), records.size() * sizeof(CacheRecord))
+        || ModelContainer::checksum(records.data(), records.size() * sizeof(CacheRecord)) != header.checksum) {
+        std::cout << "Warning: operation cache " << path << " is truncated or corrupt, ignoring it" << std::endl;
+        return false;
+    }
+    entries.reserve(records.size());
+    for (const CacheRecord& record : records) {
+        entries.emplace(record.key, record.estimate);
+    }
+    std::cout << "Operation cache loaded from " << path << " (" << entries.size() << " entries)" << std::endl;
+    return true;
+}
+
+bool OperationCache::save(const std::string& path) {
+    std::vector<CacheRecord> records;
+    records.reserve(entries.size());
+    for (const auto& entry : entries) {
+        records.push_back(CacheRecord{entry.first, entry.second});
+    }
+
+    // After shed() the file holds entries that are no longer in memory; they are carried over
+    std::ifstream previous;
+    std::uint64_t previousCount = 0;
+    if (shedEntries && !openCacheFile(previous, path, version, previousCount)) {
+        previousCount = 0;
+    }
+
+    CacheFileHeader header;
+    std::memcpy(header.magic, cacheMagic, sizeof(cacheMagic));
+    header.formatVersion = cacheFormatVersion;
+    header.recordSize = sizeof(CacheRecord);
+    header.configVersion = version;
+    header.count = records.size();
+    header.checksum = ModelContainer::checksum(records.data(), records.size() * sizeof(CacheRecord));
+
+    // Write next to the target and rename, so readers never see a partial file
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            std::cout << "Error: cannot write operation cache " << temporary << std::endl;
+            return false;
+        }
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(CacheRecord));
+
+        std::vector<CacheRecord> chunk(previousCount > 0 ? mergeRecords : 0);
+        std::vector<CacheRecord> carried;
+        carried.reserve(chunk.size());
+        for (std::uint64_t done = 0; done < previousCount; ) {
+            std::size_t n = static_cast<std::size_t>(std::min<std::uint64_t>(mergeRecords, previousCount - done));
+            if (!previous.read(reinterpret_cast<char*>(chunk.data()), n * sizeof(CacheRecord))) {
+                std::cout << "Error: failed to read operation cache " << path << std::endl;
+                return false;
+            }
+            done += n;
+            carried.clear();
+            for (std::size_t i = 0; i < n; ++i) {
+                if (entries.find(chunk[i].key) == entries.end()) {
+                    carried.push_back(chunk[i]);
+                }
+            }
+            file.write(reinterpret_cast<const char*>(carried.data()), carried.size() * sizeof(CacheRecord));
+            header.count += carried.size();
+            header.checksum = ModelContainer::checksum(carried.data(), carried.size() * sizeof(CacheRecord),
+                                                       header.checksum);
+        }
+        previous.close();
+        file.seekp(0);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        if (!file) {
+            std::cout << "Error: failed to write operation cache " << temporary << std::endl;
+            return false;
+        }
+    }
+    if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+        std::remove(path.c_str());     // rename does not replace existing files on Windows
+        if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+            std::cout << "Error: cannot replace operation cache " << path << std::endl;
+            return false;
+        }
+    }
+    modified = false;
+    return true;
+}
\ No newline at end of file
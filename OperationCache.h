@@ -0,0 +1,238 @@
+#ifndef OPERATION_CACHE_H
+#define OPERATION_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <unordered_map>
+
+class NXOperation;
+class TimeModel;
+class EnergyModel;
+
+/**
+ * @brief 128-bit content key of an operation's model-relevant inputs
+ */
+struct OperationKey {
+    std::uint64_t high;
+    std::uint64_t low;
+
+    bool operator==(const OperationKey& other) const {
+        return high == other.high && low == other.low;
+    }
+};
+
+struct OperationKeyHash {
+    std::size_t operator()(const OperationKey& key) const {
+        return static_cast<std::size_t>(key.low);
+    }
+};
+
+/**
+ * @brief Builds an OperationKey from a canonical encoding of the inputs
+ *
+ * Numbers are hashed by their bit patterns (with -0 folded into 0), strings with their
+ * length, so equal inputs always give equal keys and field boundaries cannot shift.
+ * The two halves are independent 64-bit hashes, which keeps collisions negligible for a
+ * persistent cache.
+ */
+class OperationKeyBuilder {
+private:
+    std::uint64_t high;
+    std::uint64_t low;
+
+public:
+    OperationKeyBuilder();
+
+    /**
+     * @brief Add an integer, e.g. a version number
+     * @param word Value
+     */
+    void add(std::uint64_t word);
+
+    /**
+     * @brief Add a number
+     * @param value Value
+     */
+    void add(double value);
+
+    /**
+     * @brief Add a string
+     * @param text Text
+     */
+    void add(const std::string& text);
+
+    /**
+     * @brief Get the key of everything added so far
+     * @return Key
+     */
+    OperationKey getKey() const;
+};
+
+/**
+ * @brief Estimate of one operation, the value stored per key
+ */
+struct OperationEstimate {
+    double cuttingPower;    // kW
+    double cuttingTime;     // minutes
+    double rapidTime;       // minutes
+    double idleTime;        // minutes
+    double totalTime;       // minutes
+    double energy;          // kWh
+    double carbon;          // kg CO2
+
+    OperationEstimate()
+        : cuttingPower(0.0), cuttingTime(0.0), rapidTime(0.0), idleTime(0.0), totalTime(0.0), energy(0.0),
+          carbon(0.0) {}
+};
+
+/**
+ * @brief Generic time, energy and emission parameters of operation estimates
+ */
+struct OperationParameters {
+    double rapidTimeFactor;     // rapid time as a fraction of cutting time
+    double idleTimePerOp;       // minutes
+    double rapidPower;          // kW
+    double idlePower;           // kW
+    double emissionFactor;      // kg CO2/kWh
+
+    OperationParameters()
+        : rapidTimeFactor(0.0), idleTimePerOp(0.0), rapidPower(0.0), idlePower(0.0), emissionFactor(0.0) {}
+
+    /**
+     * @brief Parameters of the given models
+     * @param timeModel Rapid time factor and idle time per operation
+     * @param energyModel Rapid and idle power
+     * @param factor Emission factor in kg CO2/kWh
+     */
+    OperationParameters(const TimeModel& timeModel, const EnergyModel& energyModel, double factor);
+};
+
+/**
+ * @brief Key of an operation's estimate: everything about the operation that changes it
+ * @param material Workpiece material
+ * @param machineType Machine type
+ * @param operation Operation
+ * @param depthOfCut Depth of cut in mm
+ * @return Key
+ */
+OperationKey makeOperationKey(const std::string& material, const std::string& machineType,
+                              const NXOperation& operation, double depthOfCut);
+
+/**
+ * @brief Version of estimates: everything besides the operation that changes them
+ * @param modelVersion Version of the power prediction models (AIInterface::getModelVersion)
+ * @param parameters Time, energy and emission parameters
+ * @param machineClasses True if operations on known machine classes use the class kernels
+ * @return Version for OperationCache::setVersion
+ */
+std::uint64_t makeEstimateVersion(std::uint64_t modelVersion, const OperationParameters& parameters,
+                                  bool machineClasses);
+
+/**
+ * @brief Time, energy and emissions of one operation with the generic parameters
+ *
+ * Idle time is the per-operation idle time; setup time belongs to the part.
+ * @param cuttingTime Cutting time in minutes
+ * @param cuttingPower Cutting power in kW
+ * @param parameters Time, energy and emission parameters
+ * @return Estimate
+ */
+OperationEstimate evaluateOperation(double cuttingTime, double cuttingPower, const OperationParameters& parameters);
+
+/**
+ * @brief Persistent map from operation keys to estimates
+ *
+ * Every cache is stamped with the version of the models and parameters its estimates
+ * were computed with; setting a different version drops all entries, and a file written
+ * under another version is ignored on load. The file is a header followed by fixed-size
+ * (key, estimate) records in native endianness, protected by a checksum.
+ */
+class OperationCache {
+private:
+    std::pmr::unordered_map<OperationKey, OperationEstimate, OperationKeyHash> entries;
+    std::uint64_t version;
+    bool modified;
+    bool shedEntries;       // entries were dropped by shed(); the cache file may hold more than the map
+
+public:
+    /**
+     * @brief Empty cache
+     * @param resource Memory resource of the entries (e.g. from a MemoryAccount)
+     */
+    explicit OperationCache(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+    /**
+     * @brief Set the model/configuration version, dropping all entries if it changed
+     * @param configVersion Version of the models and parameters
+     * @return True if the existing entries were kept
+     */
+    bool setVersion(std::uint64_t configVersion);
+
+    /**
+     * @brief Get the model/configuration version of the entries
+     * @return Version
+     */
+    std::uint64_t getVersion() const;
+
+    /**
+     * @brief Look up an estimate
+     * @param key Operation key
+     * @return Estimate, or nullptr if the key is not cached
+     */
+    const OperationEstimate* find(const OperationKey& key) const;
+
+    /**
+     * @brief Add or replace an estimate
+     * @param key Operation key
+     * @param estimate Estimate
+     */
+    void insert(const OperationKey& key, const OperationEstimate& estimate);
+
+    /**
+     * @brief Get the number of cached estimates
+     * @return Number of entries
+     */
+    std::size_t size() const;
+
+    /**
+     * @brief Drop all entries
+     */
+    void clear();
+
+    /**
+     * @brief Give the memory of all entries back without marking the cache modified
+     *
+     * Used to get under a memory budget. Entries already saved stay in the cache file:
+     * later saves merge the entries of the file that are no longer in memory.
+     * @return Number of entries dropped
+     */
+    std::size_t shed();
+
+    /**
+     * @brief Check whether entries were added since the last load or save
+     * @return True if the cache should be saved
+     */
+    bool isModified() const;
+
+    /**
+     * @brief Load a cache file written under the current version
+     * @param path Cache file
+     * @return True if entries were loaded; false if the file is missing, corrupt or from
+     *         another version (the cache is then left empty)
+     */
+    bool load(const std::string& path);
+
+    /**
+     * @brief Write all entries to a cache file
+     *
+     * After shed(), the entries of the existing file that are no longer in memory are
+     * carried over, so the file keeps everything computed under the current version.
+     * @param path Cache file (written to a temporary file and renamed)
+     * @return True on success
+     */
+    bool save(const std::string& path);
+};
+
+#endif // OPERATION_CACHE_H
\ No newline at end of file
@@ -0,0 +1,350 @@
+#include "PlantAggregator.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace {
+
+// Below this many records per thread a rollup runs on the calling thread
+const std::size_t parallelRecords = 65536;
+
+// Groups a thread-local table may hold before the rollup switches to partitioning;
+// beyond this the table no longer fits in cache and every record costs cache misses
+const std::size_t localGroupLimit = 16384;
+
+// Target number of records per partition when partitioning
+const std::size_t partitionRecords = 65536;
+
+struct GroupKey {
+    int machine;
+    int part;
+    int material;
+    int day;
+
+    bool operator==(const GroupKey& other) const {
+        return machine == other.machine && part == other.part && material == other.material && day == other.day;
+    }
+};
+
+std::uint64_t hashKey(const GroupKey& key) {
+    std::uint64_t hash = static_cast<std::uint32_t>(key.machine);
+    hash = hash * 0x9e3779b97f4a7c15ULL + static_cast<std::uint32_t>(key.part);
+    hash = hash * 0x9e3779b97f4a7c15ULL + static_cast<std::uint32_t>(key.material);
+    hash = hash * 0x9e3779b97f4a7c15ULL + static_cast<std::uint32_t>(key.day);
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+GroupKey makeKey(const AggregateRecord& record, unsigned dimensions) {
+    GroupKey key;
+    key.machine = (dimensions & RollupMachine) ? record.machine : -1;
+    key.part = (dimensions & RollupPart) ? record.part : -1;
+    key.material = (dimensions & RollupMaterial) ? record.material : -1;
+    key.day = (dimensions & RollupDay) ? record.day : -1;
+    return key;
+}
+
+struct GroupSums {
+    std::uint64_t count;
+    ReproducibleSum time;
+    ReproducibleSum energy;
+    ReproducibleSum carbon;
+
+    GroupSums() : count(0) {}
+
+    void add(double recordTime, double recordEnergy, double recordCarbon) {
+        ++count;
+        time.add(recordTime);
+        energy.add(recordEnergy);
+        carbon.add(recordCarbon);
+    }
+
+    void merge(const GroupSums& other) {
+        count += other.count;
+        time.merge(other.time);
+        energy.merge(other.energy);
+        carbon.merge(other.carbon);
+    }
+};
+
+// Record with its group key, as scattered into partitions
+struct KeyedRecord {
+    GroupKey key;
+    double time;
+    double energy;
+    double carbon;
+};
+
+// Open-addressing index over groups kept densely in insertion order, so probing touches
+// only small slots and growing never moves the sums
+class GroupTable {
+private:
+    std::vector<GroupKey> keys;
+    std::vector<GroupSums> sums;
+    std::vector<std::uint32_t> slots;   // index into keys and sums plus one, 0 if empty
+
+    std::uint32_t& probe(const GroupKey& key) {
+        std::size_t mask = slots.size() - 1;
+        std::size_t slot = static_cast<std::size_t>(hashKey(key)) & mask;
+        while (slots[slot] != 0 && !(keys[slots[slot] - 1] == key)) {
+            slot = (slot + 1) & mask;
+        }
+        return slots[slot];
+    }
+
+    void grow() {
+        slots.assign(slots.empty() ? 64 : slots.size() * 2, 0);
+        for (std::size_t i = 0; i < keys.size(); ++i) {
+            probe(keys[i]) = static_cast<std::uint32_t>(i + 1);
+        }
+    }
+
+public:
+    GroupSums& find(const GroupKey& key) {
+        if ((keys.size() + 1) * 2 > slots.size()) {
+            grow();
+        }
+        std::uint32_t& slot = probe(key);
+        if (slot == 0) {
+            keys.push_back(key);
+            sums.emplace_back();
+            slot = static_cast<std::uint32_t>(keys.size());
+        }
+        return sums[slot - 1];
+    }
+
+    void merge(const GroupTable& other) {
+        for (std::size_t i = 0; i < other.keys.size(); ++i) {
+            find(other.keys[i]).merge(other.sums[i]);
+        }
+    }
+
+    std::size_t size() const {
+        return keys.size();
+    }
+
+    void appendRows(std::vector<RollupRow>& rows) const {
+        for (std::size_t i = 0; i < keys.size(); ++i) {
+            RollupRow row;
+            row.machine = keys[i].machine;
+            row.part = keys[i].part;
+            row.material = keys[i].material;
+            row.day = keys[i].day;
+            row.count = sums[i].count;
+            row.time = sums[i].time.getValue();
+            row.energy = sums[i].energy.getValue();
+            row.carbon = sums[i].carbon.getValue();
+            rows.push_back(row);
+        }
+    }
+};
+
+// Group a range into a table; false if it outgrew the local limit (the table is then incomplete)
+bool groupRange(const AggregateRecord* first, const AggregateRecord* last, unsigned dimensions, GroupTable& groups) {
+    if (dimensions == 0) {
+        GroupSums& sums = groups.find(makeKey(*first, 0));
+        for (const AggregateRecord* record = first; record != last; ++record) {
+            sums.add(record->time, record->energy, record->carbon);
+        }
+        return true;
+    }
+    for (const AggregateRecord* record = first; record != last; ++record) {
+        groups.find(makeKey(*record, dimensions)).add(record->time, record->energy, record->carbon);
+        if (groups.size() > localGroupLimit) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool rowLess(const RollupRow& a, const RollupRow& b) {
+    if (a.machine != b.machine) return a.machine < b.machine;
+    if (a.part != b.part) return a.part < b.part;
+    if (a.material != b.material) return a.material < b.material;
+    return a.day < b.day;
+}
+
+} // namespace
+
+PlantAggregator::PlantAggregator() {
+}
+
+void PlantAggregator::add(const std::string& machine, const std::string& part, const std::string& material, int day,
+                          double time, double energy, double carbon) {
+    AggregateRecord record;
+    record.machine = machines.intern(machine);
+    record.part = parts.intern(part);
+    record.material = materials.intern(material);
+    record.day = day;
+    record.time = time;
+    record.energy = energy;
+    record.carbon = carbon;
+    records.push_back(record);
+}
+
+bool PlantAggregator::add(const AggregateRecord& record) {
+    if (record.machine < 0 || static_cast<std::size_t>(record.machine) >= machines.size() ||
+        record.part < 0 || static_cast<std::size_t>(record.part) >= parts.size() ||
+        record.material < 0 || static_cast<std::size_t>(record.material) >= materials.size()) {
+        std::cout << "Error: aggregate record with unknown machine, part or material id" << std::endl;
+        return false;
+    }
+    records.push_back(record);
+    return true;
+}
+
+void PlantAggregator::reserve(std::size_t count) {
+    records.reserve(count);
+}
+
+std::size_t PlantAggregator::size() const {
+    return records.size();
+}
+
+void PlantAggregator::clear() {
+    machines = CategoryTable();
+    parts = CategoryTable();
+    materials = CategoryTable();
+    records.clear();
+}
+
+std::vector<RollupRow> PlantAggregator::rollup(unsigned dimensions, std::size_t threads) const {
+    std::vector<RollupRow> rows;
+    if (records.empty()) {
+        return rows;
+    }
+
+    const AggregateRecord* data = records.data();
+    std::size_t count = records.size();
+    if (threads == 0) {
+        threads = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+    }
+    std::size_t chunks = std::min(threads, std::max<std::size_t>(count / parallelRecords, 1));
+    std::unique_ptr<ThreadPool> pool;
+    if (chunks > 1) {
+        pool.reset(new ThreadPool(chunks));
+    }
+    auto forEachChunk = [&pool, chunks](const std::function<void(std::size_t)>& task) {
+        if (!pool) {
+            task(0);
+            return;
+        }
+        std::vector<std::future<void>> done;
+        for (std::size_t c = 0; c < chunks; ++c) {
+            done.push_back(pool->submit([&task, c]() { task(c); }));
+        }
+        for (std::future<void>& chunk : done) {
+            chunk.get();
+        }
+    };
+
+    // Few groups: each thread groups its own range in a cache-resident table, and the
+    // partial tables are merged. Exact partial sums make the merge order irrelevant.
+    std::vector<GroupTable> partials(chunks);
+    std::vector<char> complete(chunks, 0);
+    forEachChunk([&](std::size_t c) {
+        complete[c] = groupRange(data + count * c / chunks, data + count * (c + 1) / chunks, dimensions, partials[c]);
+    });
+    if (std::find(complete.begin(), complete.end(), 0) == complete.end()) {
+        for (std::size_t c = 1; c < chunks; ++c) {
+            partials[0].merge(partials[c]);
+        }
+        partials[0].appendRows(rows);
+        std::sort(rows.begin(), rows.end(), rowLess);
+        return rows;
+    }
+    partials.clear();
+
+    // Many groups: scatter the records by key hash into partitions small enough to group
+    // in cache. Every group lands in exactly one partition, so partitions need no merge.
+    std::size_t partitionBits = 4;
+    while ((std::size_t(1) << partitionBits) * partitionRecords < count && partitionBits < 12) {
+        ++partitionBits;
+    }
+    std::size_t partitions = std::size_t(1) << partitionBits;
+    auto partitionOf = [partitionBits](const GroupKey& key) {
+        return static_cast<std::size_t>(hashKey(key) >> (64 - partitionBits));
+    };
+
+    std::vector<std::vector<std::size_t>> offsets(chunks, std::vector<std::size_t>(partitions, 0));
+    forEachChunk([&](std::size_t c) {
+        std::vector<std::size_t>& histogram = offsets[c];
+        for (std::size_t i = count * c / chunks; i < count * (c + 1) / chunks; ++i) {
+            ++histogram[partitionOf(makeKey(data[i], dimensions))];
+        }
+    });
+    std::vector<std::size_t> partitionStart(partitions + 1, 0);
+    std::size_t position = 0;
+    for (std::size_t p = 0; p < partitions; ++p) {
+        partitionStart[p] = position;
+        for (std::size_t c = 0; c < chunks; ++c) {
+            std::size_t size = offsets[c][p];
+            offsets[c][p] = position;
+            position += size;
+        }
+    }
+    partitionStart[partitions] = position;
+
+    std::vector<KeyedRecord> scattered(count);
+    forEachChunk([&](std::size_t c) {
+        std::vector<std::size_t>& next = offsets[c];
+        for (std::size_t i = count * c / chunks; i < count * (c + 1) / chunks; ++i) {
+            KeyedRecord& keyed = scattered[next[partitionOf(makeKey(data[i], dimensions))]++];
+            keyed.key = makeKey(data[i], dimensions);
+            keyed.time = data[i].time;
+            keyed.energy = data[i].energy;
+            keyed.carbon = data[i].carbon;
+        }
+    });
+
+    std::vector<std::vector<RollupRow>> chunkRows(chunks);
+    forEachChunk([&](std::size_t c) {
+        for (std::size_t p = c; p < partitions; p += chunks) {
+            GroupTable groups;
+            for (std::size_t i = partitionStart[p]; i < partitionStart[p + 1]; ++i) {
+                groups.find(scattered[i].key).add(scattered[i].time, scattered[i].energy, scattered[i].carbon);
+            }
+            groups.appendRows(chunkRows[c]);
+        }
+    });
+    for (const std::vector<RollupRow>& part : chunkRows) {
+        rows.insert(rows.end(), part.begin(), part.end());
+    }
+    std::sort(rows.begin(), rows.end(), rowLess);
+    return rows;
+}
+
+RollupRow PlantAggregator::total(std::size_t threads) const {
+    std::vector<RollupRow> rows = rollup(0, threads);
+    return rows.empty() ? RollupRow() : rows.front();
+}
+
+void PlantAggregator::print(const std::vector<RollupRow>& rows) const {
+    for (const RollupRow& row : rows) {
+        std::cout << "  " << (row.machine >= 0 ? machines.getName(row.machine) : std::string("*")) << " / "
+                  << (row.part >= 0 ? parts.getName(row.part) : std::string("*")) << " / "
+                  << (row.material >= 0 ? materials.getName(row.material) : std::string("*")) << " / day "
+                  << (row.day >= 0 ? std::to_string(row.day) : std::string("*")) << ": " << row.count
+                  << " records, " << row.time << " min, " << row.energy << " kWh, " << row.carbon << " kg CO2"
+                  << std::endl;
+    }
+}
+
+CategoryTable& PlantAggregator::getMachines() {
+    return machines;
+}
+
+CategoryTable& PlantAggregator::getParts() {
+    return parts;
+}
+
+CategoryTable& PlantAggregator::getMaterials() {
+    return materials;
+}
\ No newline at end of file
@@ -0,0 +1,146 @@
+#ifndef PLANT_AGGREGATOR_H
+#define PLANT_AGGREGATOR_H
+
+#include "PowerPredictor.h"
+#include "ReproducibleSum.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief One estimated or measured job (or operation) to aggregate
+ */
+struct AggregateRecord {
+    int machine;        // id in PlantAggregator::getMachines()
+    int part;           // id in PlantAggregator::getParts()
+    int material;       // id in PlantAggregator::getMaterials()
+    int day;            // days from the start of the period, 0-based
+    double time;        // minutes
+    double energy;      // kWh
+    double carbon;      // kg CO2
+};
+
+/**
+ * @brief Dimensions a rollup groups by; combine with |
+ */
+enum RollupDimension : unsigned {
+    RollupMachine = 1,
+    RollupPart = 2,
+    RollupMaterial = 4,
+    RollupDay = 8
+};
+
+/**
+ * @brief Totals of one group; dimensions that were rolled up are -1
+ */
+struct RollupRow {
+    int machine;
+    int part;
+    int material;
+    int day;
+    std::uint64_t count;
+    double time;        // minutes
+    double energy;      // kWh
+    double carbon;      // kg CO2
+
+    RollupRow() : machine(-1), part(-1), material(-1), day(-1), count(0), time(0.0), energy(0.0), carbon(0.0) {}
+};
+
+/**
+ * @brief Plant-level totals and group-by rollups with reproducible results
+ *
+ * Records are stored contiguously. A rollup splits them into one contiguous range per
+ * thread, groups each range into thread-local ReproducibleSum accumulators and merges the
+ * partial groups. Because the sums are exact until the final rounding, every total is
+ * bit-for-bit the same for any insertion order and any thread count, and rows come out
+ * sorted by their group key.
+ */
+class PlantAggregator {
+private:
+    CategoryTable machines;
+    CategoryTable parts;
+    CategoryTable materials;
+    std::vector<AggregateRecord> records;
+
+public:
+    PlantAggregator();
+
+    /**
+     * @brief Add a record by names
+     * @param machine Machine name
+     * @param part Part name
+     * @param material Material name
+     * @param day Days from the start of the period, 0-based
+     * @param time Time in minutes
+     * @param energy Energy in kWh
+     * @param carbon Emissions in kg CO2
+     */
+    void add(const std::string& machine, const std::string& part, const std::string& material, int day,
+             double time, double energy, double carbon);
+
+    /**
+     * @brief Add a record whose ids come from the tables of this aggregator
+     * @param record Record
+     * @return False if an id is not in the tables (the record is skipped)
+     */
+    bool add(const AggregateRecord& record);
+
+    /**
+     * @brief Reserve room for records
+     * @param count Expected number of records
+     */
+    void reserve(std::size_t count);
+
+    /**
+     * @brief Get the number of records
+     * @return Record count
+     */
+    std::size_t size() const;
+
+    /**
+     * @brief Drop all records and names
+     */
+    void clear();
+
+    /**
+     * @brief Group the records and total time, energy and emissions per group
+     * @param dimensions RollupDimension flags to group by (0 gives the plant total)
+     * @param threads Number of threads (0 uses the hardware concurrency)
+     * @return One row per group, sorted by machine, part, material and day id
+     */
+    std::vector<RollupRow> rollup(unsigned dimensions, std::size_t threads = 0) const;
+
+    /**
+     * @brief Get the plant totals
+     * @param threads Number of threads (0 uses the hardware concurrency)
+     * @return Totals over all records
+     */
+    RollupRow total(std::size_t threads = 0) const;
+
+    /**
+     * @brief Print rollup rows with their names, "*" standing for rolled-up dimensions
+     * @param rows Rows returned by rollup()
+     */
+    void print(const std::vector<RollupRow>& rows) const;
+
+    /**
+     * @brief Get the machine names (intern names here to build records by id)
+     * @return Machine table
+     */
+    CategoryTable& getMachines();
+
+    /**
+     * @brief Get the part names
+     * @return Part table
+     */
+    CategoryTable& getParts();
+
+    /**
+     * @brief Get the material names
+     * @return Material table
+     */
+    CategoryTable& getMaterials();
+};
+
+#endif // PLANT_AGGREGATOR_H
\ No newline at end of file
@@ -0,0 +1,156 @@
+#ifndef POWER_PREDICTOR_H
+#define POWER_PREDICTOR_H
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Non-owning view over a contiguous sequence
+ *
+ * Minimal stand-in for std::span while the project builds as C++17.
+ * Converts implicitly from std::vector and other containers exposing data() and size().
+ */
+template <typename T>
+class Span {
+private:
+    T* ptr;
+    std::size_t count;
+
+public:
+    Span() : ptr(nullptr), count(0) {}
+    Span(T* data, std::size_t size) : ptr(data), count(size) {}
+
+    template <typename Container,
+              typename = typename std::enable_if<
+                  std::is_convertible<decltype(std::declval<Container&>().data()), T*>::value>::type>
+    Span(Container& container) : ptr(container.data()), count(container.size()) {}
+
+    T* data() const { return ptr; }
+    std::size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    T& operator[](std::size_t i) const { return ptr[i]; }
+    T* begin() const { return ptr; }
+    T* end() const { return ptr + count; }
+
+    Span subspan(std::size_t offset, std::size_t length) const {
+        return Span(ptr + offset, length);
+    }
+};
+
+/**
+ * @brief Interns category names (materials, operation types, machine types) to dense ids
+ *
+ * Batch prediction works on integer ids so backends can precompute per-category
+ * factors once and index them in their inner loops instead of matching strings per sample.
+ */
+class CategoryTable {
+private:
+    std::map<std::string, int> ids;
+    std::vector<std::string> names;
+
+public:
+    /**
+     * @brief Get the id of a name, adding it if it is not known yet
+     * @param name Category name
+     * @return Dense id starting at 0
+     */
+    int intern(const std::string& name) {
+        auto it = ids.find(name);
+        if (it != ids.end()) {
+            return it->second;
+        }
+        int id = static_cast<int>(names.size());
+        ids.emplace(name, id);
+        names.push_back(name);
+        return id;
+    }
+
+    /**
+     * @brief Get the id of a name without adding it
+     * @param name Category name
+     * @return Id, or -1 if the name is unknown
+     */
+    int find(const std::string& name) const {
+        auto it = ids.find(name);
+        return (it != ids.end()) ? it->second : -1;
+    }
+
+    /**
+     * @brief Get the name of an id
+     * @param id Category id
+     * @return Name, or an empty string for unknown ids
+     */
+    const std::string& getName(int id) const {
+        static const std::string empty;
+        return (id >= 0 && static_cast<std::size_t>(id) < names.size()) ? names[id] : empty;
+    }
+
+    /**
+     * @brief Get the number of interned names
+     * @return Number of names
+     */
+    std::size_t size() const { return names.size(); }
+};
+
+/**
+ * @brief Category tables shared by all predictors of a registry
+ */
+struct FeatureCategories {
+    CategoryTable materials;
+    CategoryTable operationTypes;
+    CategoryTable machineTypes;
+};
+
+/**
+ * @brief Machining parameters of one cut, the input of a power prediction
+ */
+struct CutFeatures {
+    double toolDiameter;    // mm
+    double spindleSpeed;    // RPM
+    double feedRate;        // mm/min
+    double depthOfCut;      // mm
+    int materialId;         // id in FeatureCategories::materials
+    int operationTypeId;    // id in FeatureCategories::operationTypes
+    int machineTypeId;      // id in FeatureCategories::machineTypes
+};
+
+/**
+ * @brief Interface of a cutting power prediction backend
+ *
+ * Backends predict whole batches so they can amortize their setup (category lookups,
+ * model state) and let the compiler vectorize across samples.
+ */
+class PowerPredictor {
+public:
+    virtual ~PowerPredictor() {}
+
+    /**
+     * @brief Get the backend name
+     * @return Name used in the registry and in log output
+     */
+    virtual std::string getName() const = 0;
+
+    /**
+     * @brief Check whether the backend can currently serve predictions
+     * @return False if e.g. no model is loaded or no API key is configured
+     */
+    virtual bool isReady() const { return true; }
+
+    /**
+     * @brief Predict cutting power for a batch of cuts
+     *
+     * Samples the backend cannot answer (e.g. no data for that material) are set to NaN
+     * so the registry can hand them to the next backend of the fallback chain.
+     *
+     * @param features Input cuts
+     * @param out Predicted cutting power in kW, same size as features
+     * @return False if the backend could not serve the batch at all
+     */
+    virtual bool predictBatch(Span<const CutFeatures> features, Span<double> out) = 0;
+};
+
+#endif // POWER_PREDICTOR_H
\ No newline at end of file
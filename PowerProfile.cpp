@@ -0,0 +1,277 @@
+#include "PowerProfile.h"
+#include "NXCamDataExtractor.h"
+#include "TimeModel.h"
+#include "EnergyModel.h"
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+
+PowerProfile::PowerProfile() : cumulativeEnergy(1, 0.0) {
+}
+
+void PowerProfile::clear() {
+    segments.clear();
+    cumulativeEnergy.assign(1, 0.0);
+}
+
+void PowerProfile::addSegment(MoveType type, double duration, double power, int operationIndex) {
+    if (duration <= 0.0) {
+        return;
+    }
+    PowerSegment segment;
+    segment.startTime = getDuration();
+    segment.duration = duration;
+    segment.power = power;
+    segment.operationIndex = operationIndex;
+    segment.moveType = type;
+    segments.push_back(segment);
+    cumulativeEnergy.push_back(cumulativeEnergy.back() + (duration / 60.0) * power);  // kWh
+}
+
+void PowerProfile::buildFromOperations(const std::vector<NXOperation>& operations,
+                                       const TimeModel& timeModel,
+                                       const EnergyModel& energyModel,
+                                       const std::vector<double>& cuttingPowers) {
+    clear();
+    segments.reserve(operations.size() * 3 + 1);
+    cumulativeEnergy.reserve(operations.size() * 3 + 2);
+
+    addSegment(MoveType::Idle, timeModel.getSetupTime(), energyModel.getIdlePower(), -1);
+
+    for (std::size_t i = 0; i < operations.size(); ++i) {
+        const NXOperation& op = operations[i];
+        int index = static_cast<int>(i);
+        double cuttingPower = (i < cuttingPowers.size()) ? cuttingPowers[i] : energyModel.getCuttingPower();
+
+        addSegment(MoveType::Idle, timeModel.getIdleTimePerOp(), energyModel.getIdlePower(), index);
+        addSegment(MoveType::Rapid, op.getCuttingTime() * timeModel.getRapidTimeFactor(),
+                   energyModel.getRapidPower(), index);
+        addSegment(MoveType::Cutting, op.getCuttingTime(), cuttingPower, index);
+    }
+
+    std::cout << "Power profile built: " << segments.size() << " segments, "
+              << getDuration() << " min, " << getTotalEnergy() << " kWh" << std::endl;
+}
+
+const std::vector<PowerSegment>& PowerProfile::getSegments() const {
+    return segments;
+}
+
+double PowerProfile::getDuration() const {
+    if (segments.empty()) {
+        return 0.0;
+    }
+    return segments.back().startTime + segments.back().duration;
+}
+
+double PowerProfile::getTotalEnergy() const {
+    return cumulativeEnergy.back();
+}
+
+double PowerProfile::getEnergyByMoveType(MoveType type) const {
+    double energy = 0.0;
+    for (const auto& segment : segments) {
+        if (segment.moveType == type) {
+            energy += (segment.duration / 60.0) * segment.power;
+        }
+    }
+    return energy;
+}
+
+double PowerProfile::getEnergyForOperation(int operationIndex) const {
+    double energy = 0.0;
+    for (const auto& segment : segments) {
+        if (segment.operationIndex == operationIndex) {
+            energy += (segment.duration / 60.0) * segment.power;
+        }
+    }
+    return energy;
+}
+
+double PowerProfile::energyAt(double time) const {
+    if (segments.empty() || time <= 0.0) {
+        return 0.0;
+    }
+    if (time >= getDuration()) {
+        return getTotalEnergy();
+    }
+    // Last segment starting at or before the requested time
+    auto it = std::upper_bound(segments.begin(), segments.end(), time,
+                               [](double t, const PowerSegment& s) { return t < s.startTime; });
+    std::size_t i = static_cast<std::size_t>(it - segments.begin()) - 1;
+    return cumulativeEnergy[i] + ((time - segments[i].startTime) / 60.0) * segments[i].power;
+}
+
+double PowerProfile::powerAt(double time) const {
+    if (segments.empty() || time < 0.0 || time >= getDuration()) {
+        return 0.0;
+    }
+    auto it = std::upper_bound(segments.begin(), segments.end(), time,
+                               [](double t, const PowerSegment& s) { return t < s.startTime; });
+    return (it - 1)->power;
+}
+
+double PowerProfile::getPeakPower() const {
+    double peak = 0.0;
+    for (const auto& segment : segments) {
+        peak = std::max(peak, segment.power);
+    }
+    return peak;
+}
+
+double PowerProfile::getPeakDemand(double windowMinutes) const {
+    if (segments.empty()) {
+        return 0.0;
+    }
+    if (windowMinutes <= 0.0) {
+        return getPeakPower();
+    }
+
+    // A program shorter than the window is averaged over the whole window: the meter sees
+    // no energy from it outside the program
+    double duration = getDuration();
+    double window = windowMinutes;
+    double latestStart = std::max(duration - window, 0.0);
+
+    // The windowed energy is piecewise linear in the window start, so its maximum is
+    // reached where either window edge sits on a segment boundary.
+    double peakEnergy = 0.0;
+    auto evaluate = [&](double start) {
+        start = std::min(std::max(start, 0.0), latestStart);
+        peakEnergy = std::max(peakEnergy, energyAt(start + window) - energyAt(start));
+    };
+    for (const auto& segment : segments) {
+        evaluate(segment.startTime);
+        evaluate(segment.startTime - window);
+    }
+    evaluate(latestStart);
+
+    return peakEnergy / (window / 60.0);
+}
+
+double PowerProfile::getLoadFactor(double windowMinutes) const {
+    double duration = getDuration();
+    double peak = getPeakDemand(windowMinutes);
+    if (duration <= 0.0 || peak <= 0.0) {
+        return 0.0;
+    }
+    // Averaged over at least one demand window, like the peak demand
+    double averagePower = getTotalEnergy() / (std::max(duration, windowMinutes) / 60.0);
+    return averagePower / peak;
+}
+
+std::vector<PowerSample> PowerProfile::getStepPoints() const {
+    std::vector<PowerSample> points;
+    points.reserve(segments.size() * 2);
+    for (const auto& segment : segments) {
+        points.push_back({segment.startTime, segment.power});
+        points.push_back({segment.startTime + segment.duration, segment.power});
+    }
+    return points;
+}
+
+std::vector<PowerSample> PowerProfile::sample(double sampleRateHz) const {
+    std::vector<PowerSample> samples;
+    double duration = getDuration();
+    if (segments.empty() || sampleRateHz <= 0.0) {
+        return samples;
+    }
+
+    double step = 1.0 / (sampleRateHz * 60.0);  // minutes per sample
+    std::size_t count = static_cast<std::size_t>(std::ceil(duration / step));
+    samples.reserve(count);
+
+    std::size_t seg = 0;
+    for (std::size_t k = 0; k < count; ++k) {
+        double t = static_cast<double>(k) * step;
+        while (seg + 1 < segments.size() && t >= segments[seg + 1].startTime) {
+            ++seg;
+        }
+        samples.push_back({t, segments[seg].power});
+    }
+    return samples;
+}
+
+std::vector<PowerSample> PowerProfile::downsampleLTTB(const std::vector<PowerSample>& samples,
+                                                      std::size_t threshold) {
+    std::size_t n = samples.size();
+    if (threshold >= n || threshold < 3) {
+        return samples;
+    }
+
+    std::vector<PowerSample> result;
+    result.reserve(threshold);
+    result.push_back(samples.front());
+
+    // Bucket size, leaving the first and last point out of the buckets
+    double every = static_cast<double>(n - 2) / static_cast<double>(threshold - 2);
+    std::size_t selected = 0;
+
+    for (std::size_t i = 0; i < threshold - 2; ++i) {
+        // Average of the next bucket is the third vertex of the triangle
+        std::size_t avgStart = static_cast<std::size_t>((i + 1) * every) + 1;
+        std::size_t avgEnd = std::min(static_cast<std::size_t>((i + 2) * every) + 1, n);
+        double avgTime = 0.0;
+        double avgPower = 0.0;
+        for (std::size_t j = avgStart; j < avgEnd; ++j) {
+            avgTime += samples[j].time;
+            avgPower += samples[j].power;
+        }
+        double avgCount = static_cast<double>(avgEnd - avgStart);
+        if (avgCount > 0.0) {
+            avgTime /= avgCount;
+            avgPower /= avgCount;
+        }
+
+        // Pick the point of the current bucket spanning the largest triangle
+        std::size_t rangeStart = static_cast<std::size_t>(i * every) + 1;
+        std::size_t rangeEnd = static_cast<std::size_t>((i + 1) * every) + 1;
+        double aTime = samples[selected].time;
+        double aPower = samples[selected].power;
+        double maxArea = -1.0;
+        std::size_t next = rangeStart;
+        for (std::size_t j = rangeStart; j < rangeEnd; ++j) {
+            double area = std::fabs((aTime - avgTime) * (samples[j].power - aPower) -
+                                    (aTime - samples[j].time) * (avgPower - aPower));
+            if (area > maxArea) {
+                maxArea = area;
+                next = j;
+            }
+        }
+
+        result.push_back(samples[next]);
+        selected = next;
+    }
+
+    result.push_back(samples.back());
+    return result;
+}
+
+std::vector<PowerSample> PowerProfile::downsampleMinMax(const std::vector<PowerSample>& samples,
+                                                        std::size_t threshold) {
+    std::size_t n = samples.size();
+    if (threshold >= n || threshold < 2) {
+        return samples;
+    }
+
+    std::size_t buckets = threshold / 2;
+    std::vector<PowerSample> result;
+    result.reserve(buckets * 2);
+
+    for (std::size_t b = 0; b < buckets; ++b) {
+        std::size_t start = b * n / buckets;
+        std::size_t end = (b + 1) * n / buckets;
+        std::size_t minIndex = start;
+        std::size_t maxIndex = start;
+        for (std::size_t j = start + 1; j < end; ++j) {
+            if (samples[j].power < samples[minIndex].power) minIndex = j;
+            if (samples[j].power > samples[maxIndex].power) maxIndex = j;
+        }
+        // Emit in time order so the polyline does not fold back
+        result.push_back(samples[std::min(minIndex, maxIndex)]);
+        if (minIndex != maxIndex) {
+            result.push_back(samples[std::max(minIndex, maxIndex)]);
+        }
+    }
+    return result;
+}
\ No newline at end of file
@@ -0,0 +1,190 @@
+#ifndef POWER_PROFILE_H
+#define POWER_PROFILE_H
+
+#include <cstddef>
+#include <vector>
+
+class NXOperation;
+class TimeModel;
+class EnergyModel;
+
+/**
+ * @brief Machine state a power segment belongs to
+ */
+enum class MoveType {
+    Idle,
+    Rapid,
+    Cutting
+};
+
+/**
+ * @brief A constant-power interval of the machine power timeline
+ */
+struct PowerSegment {
+    double startTime;       // minutes from program start
+    double duration;        // minutes
+    double power;           // kW
+    int operationIndex;     // index into the operation list, -1 for job setup
+    MoveType moveType;
+};
+
+/**
+ * @brief A single (time, power) point of a sampled or downsampled profile
+ */
+struct PowerSample {
+    double time;            // minutes from program start
+    double power;           // kW
+};
+
+/**
+ * @brief Piecewise-constant power-vs-time profile of a machining program
+ *
+ * This class turns the operation list into a timeline of idle, rapid and cutting
+ * segments so the power curve can be displayed and compared against meter data.
+ * It also computes peak demand and load factor, and provides LTTB and min-max
+ * downsamplers to reduce long, densely sampled profiles to a few thousand points.
+ */
+class PowerProfile {
+private:
+    std::vector<PowerSegment> segments;
+    std::vector<double> cumulativeEnergy;   // kWh at the start of each segment, plus the end
+
+    double energyAt(double time) const;
+
+public:
+    PowerProfile();
+
+    /**
+     * @brief Remove all segments
+     */
+    void clear();
+
+    /**
+     * @brief Append a segment at the end of the timeline
+     * @param type Move type of the segment
+     * @param duration Segment duration in minutes (non-positive durations are ignored)
+     * @param power Power drawn during the segment in kW
+     * @param operationIndex Index of the owning operation, -1 for job setup
+     */
+    void addSegment(MoveType type, double duration, double power, int operationIndex);
+
+    /**
+     * @brief Build the timeline for a program
+     *
+     * The job starts with the setup time at idle power. Each operation then contributes
+     * a tool change (idle), its rapid moves and its cutting time, in that order.
+     *
+     * @param operations Operations in program order
+     * @param timeModel Time model supplying rapid factor, idle time per operation and setup time
+     * @param energyModel Energy model supplying the default cutting, rapid and idle power
+     * @param cuttingPowers Optional per-operation cutting power in kW (e.g. AI predictions);
+     *                      when empty the energy model's cutting power is used
+     */
+    void buildFromOperations(const std::vector<NXOperation>& operations,
+                             const TimeModel& timeModel,
+                             const EnergyModel& energyModel,
+                             const std::vector<double>& cuttingPowers = std::vector<double>());
+
+    /**
+     * @brief Get the segments of the timeline
+     * @return Segments in time order
+     */
+    const std::vector<PowerSegment>& getSegments() const;
+
+    /**
+     * @brief Get the total duration of the profile
+     * @return Duration in minutes
+     */
+    double getDuration() const;
+
+    /**
+     * @brief Get the total energy of the profile
+     * @return Energy in kWh
+     */
+    double getTotalEnergy() const;
+
+    /**
+     * @brief Get the energy spent in one move type
+     * @param type Move type
+     * @return Energy in kWh
+     */
+    double getEnergyByMoveType(MoveType type) const;
+
+    /**
+     * @brief Get the energy spent by one operation
+     * @param operationIndex Operation index, -1 for job setup
+     * @return Energy in kWh
+     */
+    double getEnergyForOperation(int operationIndex) const;
+
+    /**
+     * @brief Get the instantaneous power at a point in time
+     * @param time Time in minutes from program start
+     * @return Power in kW, 0 outside the profile
+     */
+    double powerAt(double time) const;
+
+    /**
+     * @brief Get the highest instantaneous power of the profile
+     * @return Peak power in kW
+     */
+    double getPeakPower() const;
+
+    /**
+     * @brief Get the peak demand, i.e. the highest average power over a sliding window
+     *
+     * Utility meters bill peak demand as the maximum average over a fixed window
+     * (typically 15 minutes). The maximum is computed exactly on the piecewise-constant profile.
+     * A program shorter than the window counts as zero power for the rest of the window.
+     *
+     * @param windowMinutes Demand window in minutes (0 gives the instantaneous peak)
+     * @return Peak demand in kW
+     */
+    double getPeakDemand(double windowMinutes) const;
+
+    /**
+     * @brief Get the load factor (average power divided by peak demand)
+     *
+     * The average is taken over the program, or over one window if the program is shorter.
+     *
+     * @param windowMinutes Demand window in minutes (0 uses the instantaneous peak)
+     * @return Load factor between 0 and 1
+     */
+    double getLoadFactor(double windowMinutes = 0.0) const;
+
+    /**
+     * @brief Get the exact step curve of the profile
+     * @return Two points per segment (start and end), suitable for plotting
+     */
+    std::vector<PowerSample> getStepPoints() const;
+
+    /**
+     * @brief Sample the profile at a fixed rate, e.g. to align with meter data
+     * @param sampleRateHz Samples per second
+     * @return Uniformly spaced samples covering the whole profile
+     */
+    std::vector<PowerSample> sample(double sampleRateHz) const;
+
+    /**
+     * @brief Downsample a series with Largest-Triangle-Three-Buckets
+     * @param samples Input samples in time order
+     * @param threshold Number of output points (series shorter than this are returned as is)
+     * @return Downsampled series keeping the first and last point
+     */
+    static std::vector<PowerSample> downsampleLTTB(const std::vector<PowerSample>& samples,
+                                                   std::size_t threshold);
+
+    /**
+     * @brief Downsample a series keeping the minimum and maximum of each bucket
+     *
+     * Unlike LTTB this never hides short power spikes, which matters for peak inspection.
+     *
+     * @param samples Input samples in time order
+     * @param threshold Maximum number of output points (series shorter than this are returned as is)
+     * @return Downsampled series in time order
+     */
+    static std::vector<PowerSample> downsampleMinMax(const std::vector<PowerSample>& samples,
+                                                     std::size_t threshold);
+};
+
+#endif // POWER_PROFILE_H
\ No newline at end of file
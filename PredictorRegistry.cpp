@@ -0,0 +1,203 @@
+#include "PredictorRegistry.h"
+#include <iostream>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+int internBounded(CategoryTable& table, const std::string& name, std::size_t maxNames) {
+    int id = table.find(name);
+    if (id < 0 && table.size() < maxNames) {
+        id = table.intern(name);
+    }
+    return id;
+}
+
+} // namespace
+
+PredictorRegistry::PredictorRegistry() {
+    std::cout << "PredictorRegistry initialized" << std::endl;
+}
+
+PredictorRegistry::~PredictorRegistry() {
+    std::cout << "PredictorRegistry destroyed" << std::endl;
+}
+
+FeatureCategories& PredictorRegistry::getCategories() {
+    return categories;
+}
+
+const FeatureCategories& PredictorRegistry::getCategories() const {
+    return categories;
+}
+
+void PredictorRegistry::registerPredictor(const std::string& name, std::unique_ptr<PowerPredictor> predictor) {
+    predictors[name] = std::move(predictor);
+    std::cout << "Registered power predictor: " << name << std::endl;
+}
+
+PowerPredictor* PredictorRegistry::getPredictor(const std::string& name) const {
+    auto it = predictors.find(name);
+    return (it != predictors.end()) ? it->second.get() : nullptr;
+}
+
+std::vector<std::string> PredictorRegistry::getPredictorNames() const {
+    std::vector<std::string> names;
+    names.reserve(predictors.size());
+    for (const auto& entry : predictors) {
+        names.push_back(entry.first);
+    }
+    return names;
+}
+
+void PredictorRegistry::setDefaultChain(const std::vector<std::string>& chain) {
+    defaultChain = chain;
+}
+
+void PredictorRegistry::setMachineChain(const std::string& machineType, const std::vector<std::string>& chain) {
+    machineChains[categories.machineTypes.intern(machineType)] = chain;
+}
+
+void PredictorRegistry::setMaterialChain(const std::string& material, const std::vector<std::string>& chain) {
+    materialChains[categories.materials.intern(material)] = chain;
+}
+
+CutFeatures PredictorRegistry::makeFeatures(const std::string& material,
+                                            double toolDiameter,
+                                            double spindleSpeed,
+                                            double feedRate,
+                                            double depthOfCut,
+                                            const std::string& operationType,
+                                            const std::string& machineType) {
+    CutFeatures features;
+    features.toolDiameter = toolDiameter;
+    features.spindleSpeed = spindleSpeed;
+    features.feedRate = feedRate;
+    features.depthOfCut = depthOfCut;
+    features.materialId = categories.materials.intern(material);
+    features.operationTypeId = categories.operationTypes.intern(operationType);
+    features.machineTypeId = categories.machineTypes.intern(machineType);
+    return features;
+}
+
+bool PredictorRegistry::makeBoundedFeatures(const std::string& material,
+                                            double toolDiameter,
+                                            double spindleSpeed,
+                                            double feedRate,
+                                            double depthOfCut,
+                                            const std::string& operationType,
+                                            const std::string& machineType,
+                                            std::size_t maxNames,
+                                            CutFeatures& features) {
+    features.toolDiameter = toolDiameter;
+    features.spindleSpeed = spindleSpeed;
+    features.feedRate = feedRate;
+    features.depthOfCut = depthOfCut;
+    features.materialId = internBounded(categories.materials, material, maxNames);
+    features.operationTypeId = internBounded(categories.operationTypes, operationType, maxNames);
+    features.machineTypeId = internBounded(categories.machineTypes, machineType, maxNames);
+    return features.materialId >= 0 && features.operationTypeId >= 0 && features.machineTypeId >= 0;
+}
+
+const std::vector<std::string>& PredictorRegistry::resolveChain(const CutFeatures& features) const {
+    auto material = materialChains.find(features.materialId);
+    if (material != materialChains.end()) {
+        return material->second;
+    }
+    auto machine = machineChains.find(features.machineTypeId);
+    if (machine != machineChains.end()) {
+        return machine->second;
+    }
+    return defaultChain;
+}
+
+void PredictorRegistry::runChain(const std::vector<std::string>& chain,
+                                 Span<const CutFeatures> features,
+                                 Span<double> out) {
+    const double missing = std::numeric_limits<double>::quiet_NaN();
+    for (double& value : out) {
+        value = missing;
+    }
+
+    // The first backend works on the caller's buffers; later ones only see the samples still missing
+    bool first = true;
+    std::vector<std::size_t> pending;
+    std::vector<CutFeatures> pendingFeatures;
+    std::vector<double> pendingOut;
+
+    for (const std::string& name : chain) {
+        PowerPredictor* predictor = getPredictor(name);
+        if (predictor == nullptr || !predictor->isReady()) {
+            continue;
+        }
+
+        if (first) {
+            if (!predictor->predictBatch(features, out)) {
+                for (double& value : out) {
+                    value = missing;
+                }
+                continue;
+            }
+            first = false;
+            for (std::size_t i = 0; i < out.size(); ++i) {
+                if (std::isnan(out[i])) {
+                    pending.push_back(i);
+                }
+            }
+        } else {
+            pendingFeatures.clear();
+            for (std::size_t index : pending) {
+                pendingFeatures.push_back(features[index]);
+            }
+            pendingOut.assign(pending.size(), missing);
+            if (!predictor->predictBatch(pendingFeatures, pendingOut)) {
+                continue;
+            }
+            std::size_t kept = 0;
+            for (std::size_t i = 0; i < pending.size(); ++i) {
+                if (std::isnan(pendingOut[i])) {
+                    pending[kept++] = pending[i];
+                } else {
+                    out[pending[i]] = pendingOut[i];
+                }
+            }
+            pending.resize(kept);
+        }
+
+        if (pending.empty()) {
+            return;
+        }
+    }
+}
+
+void PredictorRegistry::predictBatch(Span<const CutFeatures> features, Span<double> out) {
+    if (machineChains.empty() && materialChains.empty()) {
+        runChain(defaultChain, features, out);
+        return;
+    }
+
+    // Group samples by chain so every backend still sees one batch
+    std::map<const std::vector<std::string>*, std::vector<std::size_t>> groups;
+    for (std::size_t i = 0; i < features.size(); ++i) {
+        groups[&resolveChain(features[i])].push_back(i);
+    }
+
+    if (groups.size() == 1) {
+        runChain(*groups.begin()->first, features, out);
+        return;
+    }
+
+    std::vector<CutFeatures> groupFeatures;
+    std::vector<double> groupOut;
+    for (const auto& group : groups) {
+        groupFeatures.clear();
+        for (std::size_t index : group.second) {
+            groupFeatures.push_back(features[index]);
+        }
+        groupOut.resize(group.second.size());
+        runChain(*group.first, groupFeatures, groupOut);
+        for (std::size_t i = 0; i < group.second.size(); ++i) {
+            out[group.second[i]] = groupOut[i];
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,132 @@
+#ifndef PREDICTOR_REGISTRY_H
+#define PREDICTOR_REGISTRY_H
+
+#include "PowerPredictor.h"
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Registry of named cutting power backends with per-machine/per-material fallback chains
+ *
+ * Each sample of a batch is routed to a chain of backends: the material chain if one is
+ * set, otherwise the machine chain, otherwise the default chain. Backends are tried in
+ * chain order; samples a backend leaves as NaN (or a whole batch it refuses) go to the next.
+ */
+class PredictorRegistry {
+private:
+    FeatureCategories categories;
+    std::map<std::string, std::unique_ptr<PowerPredictor>> predictors;
+    std::vector<std::string> defaultChain;
+    std::map<int, std::vector<std::string>> machineChains;     // keyed by machine type id
+    std::map<int, std::vector<std::string>> materialChains;    // keyed by material id
+
+    const std::vector<std::string>& resolveChain(const CutFeatures& features) const;
+    void runChain(const std::vector<std::string>& chain, Span<const CutFeatures> features, Span<double> out);
+
+public:
+    PredictorRegistry();
+    ~PredictorRegistry();
+
+    /**
+     * @brief Get the category tables used to build CutFeatures for this registry
+     * @return Category tables
+     */
+    FeatureCategories& getCategories();
+    const FeatureCategories& getCategories() const;
+
+    /**
+     * @brief Register a backend, replacing any backend with the same name
+     * @param name Backend name used in chains
+     * @param predictor Backend instance
+     */
+    void registerPredictor(const std::string& name, std::unique_ptr<PowerPredictor> predictor);
+
+    /**
+     * @brief Get a registered backend
+     * @param name Backend name
+     * @return Backend, or nullptr if not registered
+     */
+    PowerPredictor* getPredictor(const std::string& name) const;
+
+    /**
+     * @brief Get the names of all registered backends
+     * @return Backend names in alphabetical order
+     */
+    std::vector<std::string> getPredictorNames() const;
+
+    /**
+     * @brief Set the chain used when no machine or material chain applies
+     * @param chain Backend names in fallback order
+     */
+    void setDefaultChain(const std::vector<std::string>& chain);
+
+    /**
+     * @brief Set the chain used for one machine type
+     * @param machineType Machine type name
+     * @param chain Backend names in fallback order
+     */
+    void setMachineChain(const std::string& machineType, const std::vector<std::string>& chain);
+
+    /**
+     * @brief Set the chain used for one material (takes precedence over machine chains)
+     * @param material Material name
+     * @param chain Backend names in fallback order
+     */
+    void setMaterialChain(const std::string& material, const std::vector<std::string>& chain);
+
+    /**
+     * @brief Build the features of one cut, interning its category names
+     * @param material Type of material being machined
+     * @param toolDiameter Tool diameter in mm
+     * @param spindleSpeed Spindle speed in RPM
+     * @param feedRate Feed rate in mm/min
+     * @param depthOfCut Depth of cut in mm
+     * @param operationType Type of operation (milling, drilling, etc.)
+     * @param machineType Type of machine
+     * @return Features referring to this registry's category tables
+     */
+    CutFeatures makeFeatures(const std::string& material,
+                             double toolDiameter,
+                             double spindleSpeed,
+                             double feedRate,
+                             double depthOfCut,
+                             const std::string& operationType,
+                             const std::string& machineType);
+
+    /**
+     * @brief Build the features of one cut from untrusted names, bounding the category tables
+     *
+     * Known names resolve to their ids; an unknown name is interned only while its table
+     * holds fewer than maxNames entries, so clients cannot grow the tables without bound.
+     * @param material Type of material being machined
+     * @param toolDiameter Tool diameter in mm
+     * @param spindleSpeed Spindle speed in RPM
+     * @param feedRate Feed rate in mm/min
+     * @param depthOfCut Depth of cut in mm
+     * @param operationType Type of operation (milling, drilling, etc.)
+     * @param machineType Type of machine
+     * @param maxNames Table size at which no more names are added
+     * @param features Receives the features
+     * @return False if a name is unknown and its table is full
+     */
+    bool makeBoundedFeatures(const std::string& material,
+                             double toolDiameter,
+                             double spindleSpeed,
+                             double feedRate,
+                             double depthOfCut,
+                             const std::string& operationType,
+                             const std::string& machineType,
+                             std::size_t maxNames,
+                             CutFeatures& features);
+
+    /**
+     * @brief Predict cutting power for a batch, routing each sample through its fallback chain
+     * @param features Input cuts
+     * @param out Predicted cutting power in kW, same size as features; NaN where no backend answered
+     */
+    void predictBatch(Span<const CutFeatures> features, Span<double> out);
+};
+
+#endif // PREDICTOR_REGISTRY_H
\ No newline at end of file
@@ -0,0 +1,401 @@
+#include "ReportWriter.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+// Largest magnitude printed with fixed decimals; beyond it the digits would only be noise
+const double fixedLimit = 1e15;
+
+// Text report columns
+const std::size_t partWidth = 16;
+const std::size_t indexWidth = 4;
+const std::size_t typeWidth = 18;
+const std::size_t numberWidth = 11;
+
+const char csvHeader[] = "record,part,operation,operation_type,cutting_time_min,feed_mm_min,spindle_rpm,"
+                         "tool_diameter_mm,cutting_power_kw,rapid_time_min,idle_time_min,total_time_min,"
+                         "energy_kwh,carbon_kg,emission_factor\n";
+
+// Appends a string literal without measuring it at run time
+template <std::size_t N>
+void appendLiteral(OutputBuffer& buffer, const char (&text)[N]) {
+    buffer.append(text, N - 1);
+}
+
+} // namespace
+
+OutputBuffer::OutputBuffer(std::size_t capacity)
+    : file(nullptr), data(std::max<std::size_t>(capacity, 4096)), used(0), written(0), failed(false) {
+}
+
+void OutputBuffer::setFile(std::FILE* output) {
+    flush();
+    file = output;
+    failed = false;
+}
+
+char* OutputBuffer::reserve(std::size_t bytes) {
+    if (data.size() - used < bytes) {
+        flush();
+    }
+    return data.data() + used;
+}
+
+void OutputBuffer::append(char c) {
+    *reserve(1) = c;
+    ++used;
+    ++written;
+}
+
+void OutputBuffer::append(const char* text, std::size_t length) {
+    written += length;
+    while (length > 0) {
+        if (used == data.size()) {
+            flush();
+        }
+        std::size_t chunk = std::min(length, data.size() - used);
+        std::memcpy(data.data() + used, text, chunk);
+        used += chunk;
+        text += chunk;
+        length -= chunk;
+    }
+}
+
+void OutputBuffer::append(const std::string& text) {
+    append(text.data(), text.size());
+}
+
+void OutputBuffer::appendInteger(std::int64_t value) {
+    char* first = reserve(24);
+    std::to_chars_result result = std::to_chars(first, first + 24, value);
+    std::size_t length = static_cast<std::size_t>(result.ptr - first);
+    used += length;
+    written += length;
+}
+
+void OutputBuffer::appendNumber(double value) {
+    // Without a format, to_chars gives the shortest digits that parse back to the same double
+    char* first = reserve(32);
+    std::to_chars_result result = std::to_chars(first, first + 32, value);
+    std::size_t length = static_cast<std::size_t>(result.ptr - first);
+    used += length;
+    written += length;
+}
+
+void OutputBuffer::appendFixed(double value, int decimals) {
+    if (!std::isfinite(value) || std::fabs(value) >= fixedLimit) {
+        appendNumber(value);
+        return;
+    }
+    decimals = std::min(std::max(decimals, 0), 17);
+    char* first = reserve(48);
+    std::to_chars_result result = std::to_chars(first, first + 48, value, std::chars_format::fixed, decimals);
+    std::size_t length = static_cast<std::size_t>(result.ptr - first);
+    used += length;
+    written += length;
+}
+
+void OutputBuffer::appendPadded(const std::string& text, std::size_t width, bool alignRight) {
+    std::size_t padding = width > text.size() ? width - text.size() : 0;
+    if (!alignRight) {
+        append(text);
+    }
+    for (std::size_t i = 0; i < padding; ++i) {
+        append(' ');
+    }
+    if (alignRight) {
+        append(text);
+    }
+}
+
+void OutputBuffer::appendFixedPadded(double value, int decimals, std::size_t width) {
+    char digits[48];
+    std::to_chars_result result;
+    if (!std::isfinite(value) || std::fabs(value) >= fixedLimit) {
+        result = std::to_chars(digits, digits + sizeof(digits), value);
+    } else {
+        result = std::to_chars(digits, digits + sizeof(digits), value, std::chars_format::fixed,
+                               std::min(std::max(decimals, 0), 17));
+    }
+    std::size_t length = static_cast<std::size_t>(result.ptr - digits);
+    for (std::size_t i = length; i < width; ++i) {
+        append(' ');
+    }
+    append(digits, length);
+}
+
+void OutputBuffer::appendCsvField(const std::string& text) {
+    if (text.find_first_of(",\"\r\n") == std::string::npos) {
+        append(text);
+        return;
+    }
+    append('"');
+    for (char c : text) {
+        if (c == '"') {
+            append('"');
+        }
+        append(c);
+    }
+    append('"');
+}
+
+void OutputBuffer::appendJsonString(const std::string& text) {
+    static const char hex[] = "0123456789abcdef";
+    append('"');
+    for (char c : text) {
+        unsigned char code = static_cast<unsigned char>(c);
+        if (c == '"' || c == '\\') {
+            append('\\');
+            append(c);
+        } else if (code < 0x20) {
+            char escape[6] = {'\\', 'u', '0', '0', hex[code >> 4], hex[code & 0xf]};
+            append(escape, sizeof(escape));
+        } else {
+            append(c);
+        }
+    }
+    append('"');
+}
+
+void OutputBuffer::appendJsonNumber(double value) {
+    if (std::isfinite(value)) {
+        appendNumber(value);
+    } else {
+        append("null", sizeof("null") - 1);
+    }
+}
+
+bool OutputBuffer::flush() {
+    if (used > 0 && file != nullptr && !failed) {
+        if (std::fwrite(data.data(), 1, used, file) != used) {
+            failed = true;
+        }
+    }
+    used = 0;
+    return !failed;
+}
+
+std::uint64_t OutputBuffer::getBytesWritten() const {
+    return written;
+}
+
+ReportWriter::ReportWriter(std::size_t bufferSize)
+    : buffer(bufferSize), file(nullptr), ownsFile(false), format(ReportFormat::Csv) {
+}
+
+ReportWriter::~ReportWriter() {
+    close();
+}
+
+bool ReportWriter::open(const std::string& outputPath, ReportFormat reportFormat) {
+    close();
+    if (outputPath == "-") {
+        std::cout.flush();      // keep the report after everything printed so far
+        file = stdout;
+        ownsFile = false;
+    } else {
+        file = std::fopen(outputPath.c_str(), "wb");
+        if (file == nullptr) {
+            std::cout << "Error: cannot create report " << outputPath << std::endl;
+            return false;
+        }
+        std::setvbuf(file, nullptr, _IONBF, 0);     // rows are already buffered
+        ownsFile = true;
+    }
+    path = outputPath;
+    format = reportFormat;
+    buffer.setFile(file);
+    writeHeader();
+    return true;
+}
+
+void ReportWriter::writeHeader() {
+    if (format == ReportFormat::Csv) {
+        appendLiteral(buffer, csvHeader);
+    } else if (format == ReportFormat::Text) {
+        buffer.appendPadded("Part", partWidth, false);
+        buffer.appendPadded("#", indexWidth, true);
+        appendLiteral(buffer, "  ");
+        buffer.appendPadded("Operation", typeWidth, false);
+        buffer.appendPadded("Cut min", numberWidth, true);
+        buffer.appendPadded("Power kW", numberWidth, true);
+        buffer.appendPadded("Total min", numberWidth, true);
+        buffer.appendPadded("Energy kWh", numberWidth, true);
+        buffer.appendPadded("CO2 kg", numberWidth, true);
+        buffer.append('\n');
+        std::size_t width = partWidth + indexWidth + 2 + typeWidth + 5 * numberWidth;
+        for (std::size_t i = 0; i < width; ++i) {
+            buffer.append('-');
+        }
+        buffer.append('\n');
+    }
+}
+
+void ReportWriter::writeOperation(const std::string& part, std::size_t index, const NXOperation& operation,
+                                  const OperationEstimate& estimate) {
+    switch (format) {
+    case ReportFormat::Csv:
+        appendLiteral(buffer, "operation,");
+        buffer.appendCsvField(part);
+        buffer.append(',');
+        buffer.appendInteger(static_cast<std::int64_t>(index));
+        buffer.append(',');
+        buffer.appendCsvField(operation.getOperationType());
+        buffer.append(',');
+        buffer.appendNumber(operation.getCuttingTime());
+        buffer.append(',');
+        buffer.appendNumber(operation.getFeedRate());
+        buffer.append(',');
+        buffer.appendNumber(operation.getSpindleSpeed());
+        buffer.append(',');
+        buffer.appendNumber(operation.getToolDiameter());
+        buffer.append(',');
+        buffer.appendNumber(estimate.cuttingPower);
+        buffer.append(',');
+        buffer.appendNumber(estimate.rapidTime);
+        buffer.append(',');
+        buffer.appendNumber(estimate.idleTime);
+        buffer.append(',');
+        buffer.appendNumber(estimate.totalTime);
+        buffer.append(',');
+        buffer.appendNumber(estimate.energy);
+        buffer.append(',');
+        buffer.appendNumber(estimate.carbon);
+        appendLiteral(buffer, ",\n");
+        break;
+    case ReportFormat::JsonLines:
+        appendLiteral(buffer, "{\"record\":\"operation\",\"part\":");
+        buffer.appendJsonString(part);
+        appendLiteral(buffer, ",\"operation\":");
+        buffer.appendInteger(static_cast<std::int64_t>(index));
+        appendLiteral(buffer, ",\"operation_type\":");
+        buffer.appendJsonString(operation.getOperationType());
+        appendLiteral(buffer, ",\"cutting_time_min\":");
+        buffer.appendJsonNumber(operation.getCuttingTime());
+        appendLiteral(buffer, ",\"feed_mm_min\":");
+        buffer.appendJsonNumber(operation.getFeedRate());
+        appendLiteral(buffer, ",\"spindle_rpm\":");
+        buffer.appendJsonNumber(operation.getSpindleSpeed());
+        appendLiteral(buffer, ",\"tool_diameter_mm\":");
+        buffer.appendJsonNumber(operation.getToolDiameter());
+        appendLiteral(buffer, ",\"cutting_power_kw\":");
+        buffer.appendJsonNumber(estimate.cuttingPower);
+        appendLiteral(buffer, ",\"rapid_time_min\":");
+        buffer.appendJsonNumber(estimate.rapidTime);
+        appendLiteral(buffer, ",\"idle_time_min\":");
+        buffer.appendJsonNumber(estimate.idleTime);
+        appendLiteral(buffer, ",\"total_time_min\":");
+        buffer.appendJsonNumber(estimate.totalTime);
+        appendLiteral(buffer, ",\"energy_kwh\":");
+        buffer.appendJsonNumber(estimate.energy);
+        appendLiteral(buffer, ",\"carbon_kg\":");
+        buffer.appendJsonNumber(estimate.carbon);
+        appendLiteral(buffer, "}\n");
+        break;
+    case ReportFormat::Text:
+        buffer.appendPadded(part, partWidth, false);
+        buffer.appendFixedPadded(static_cast<double>(index + 1), 0, indexWidth);
+        appendLiteral(buffer, "  ");
+        buffer.appendPadded(operation.getOperationType(), typeWidth, false);
+        buffer.appendFixedPadded(estimate.cuttingTime, 2, numberWidth);
+        buffer.appendFixedPadded(estimate.cuttingPower, 3, numberWidth);
+        buffer.appendFixedPadded(estimate.totalTime, 2, numberWidth);
+        buffer.appendFixedPadded(estimate.energy, 4, numberWidth);
+        buffer.appendFixedPadded(estimate.carbon, 4, numberWidth);
+        buffer.append('\n');
+        break;
+    }
+}
+
+void ReportWriter::writePart(const PartEstimate& estimate, double emissionFactor) {
+    switch (format) {
+    case ReportFormat::Csv:
+        appendLiteral(buffer, "part,");
+        buffer.appendCsvField(estimate.name);
+        appendLiteral(buffer, ",,,,,,,,,,");
+        buffer.appendNumber(estimate.totalTime);
+        buffer.append(',');
+        buffer.appendNumber(estimate.energy);
+        buffer.append(',');
+        buffer.appendNumber(estimate.carbon);
+        buffer.append(',');
+        buffer.appendNumber(emissionFactor);
+        buffer.append('\n');
+        break;
+    case ReportFormat::JsonLines:
+        appendLiteral(buffer, "{\"record\":\"part\",\"part\":");
+        buffer.appendJsonString(estimate.name);
+        appendLiteral(buffer, ",\"operations\":");
+        buffer.appendInteger(static_cast<std::int64_t>(estimate.operations.size()));
+        appendLiteral(buffer, ",\"total_time_min\":");
+        buffer.appendJsonNumber(estimate.totalTime);
+        appendLiteral(buffer, ",\"energy_kwh\":");
+        buffer.appendJsonNumber(estimate.energy);
+        appendLiteral(buffer, ",\"carbon_kg\":");
+        buffer.appendJsonNumber(estimate.carbon);
+        appendLiteral(buffer, ",\"emission_factor\":");
+        buffer.appendJsonNumber(emissionFactor);
+        appendLiteral(buffer, "}\n");
+        break;
+    case ReportFormat::Text:
+        appendLiteral(buffer, "Carbon label: ");
+        buffer.append(estimate.name);
+        appendLiteral(buffer, " - ");
+        buffer.appendFixed(estimate.carbon, 3);
+        appendLiteral(buffer, " kg CO2, ");
+        buffer.appendFixed(estimate.energy, 3);
+        appendLiteral(buffer, " kWh, ");
+        buffer.appendFixed(estimate.totalTime, 1);
+        appendLiteral(buffer, " min at ");
+        buffer.appendFixed(emissionFactor, 3);
+        appendLiteral(buffer, " kg CO2/kWh\n\n");
+        break;
+    }
+}
+
+void ReportWriter::writeParts(const std::vector<PartProgram>& parts, const std::vector<PartEstimate>& estimates,
+                              double emissionFactor) {
+    std::size_t count = std::min(parts.size(), estimates.size());
+    for (std::size_t p = 0; p < count; ++p) {
+        const PartProgram& part = parts[p];
+        const PartEstimate& estimate = estimates[p];
+        std::size_t operations = std::min(part.operations.size(), estimate.operations.size());
+        for (std::size_t i = 0; i < operations; ++i) {
+            writeOperation(estimate.name, i, part.operations[i], estimate.operations[i]);
+        }
+        writePart(estimate, emissionFactor);
+    }
+}
+
+bool ReportWriter::flush() {
+    bool ok = buffer.flush();
+    if (file != nullptr && !ownsFile) {
+        ok = std::fflush(file) == 0 && ok;
+    }
+    return ok;
+}
+
+bool ReportWriter::close() {
+    if (file == nullptr) {
+        return true;
+    }
+    bool ok = flush();
+    if (ownsFile) {
+        ok = std::fclose(file) == 0 && ok;
+    }
+    if (!ok) {
+        std::cout << "Error: failed to write report " << path << std::endl;
+    }
+    buffer.setFile(nullptr);
+    file = nullptr;
+    ownsFile = false;
+    return ok;
+}
+
+std::uint64_t ReportWriter::getBytesWritten() const {
+    return buffer.getBytesWritten();
+}
\ No newline at end of file
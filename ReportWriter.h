@@ -0,0 +1,227 @@
+#ifndef REPORT_WRITER_H
+#define REPORT_WRITER_H
+
+#include "BatchEstimator.h"
+#include "NXCamDataExtractor.h"
+#include "OperationCache.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Fixed-size output buffer formatting text and numbers without allocating
+ *
+ * Numbers are formatted with std::to_chars straight into the buffer: doubles in their
+ * shortest form that parses back to the same value, or with a fixed number of decimals.
+ * The buffer is written to its file in one call whenever it fills up (the file's own
+ * buffering is switched off), so large exports cost one write per buffer.
+ */
+class OutputBuffer {
+private:
+    std::FILE* file;
+    std::vector<char> data;
+    std::size_t used;
+    std::uint64_t written;
+    bool failed;
+
+    char* reserve(std::size_t bytes);
+
+public:
+    /**
+     * @brief Buffer not yet attached to a file
+     * @param capacity Buffer size in bytes
+     */
+    explicit OutputBuffer(std::size_t capacity = 1 << 20);
+
+    OutputBuffer(const OutputBuffer&) = delete;
+    OutputBuffer& operator=(const OutputBuffer&) = delete;
+
+    /**
+     * @brief Attach to a file, flushing the previous one
+     * @param output Open file (not closed by the buffer), or nullptr
+     */
+    void setFile(std::FILE* output);
+
+    /**
+     * @brief Append a character
+     * @param c Character
+     */
+    void append(char c);
+
+    /**
+     * @brief Append text
+     * @param text Characters
+     * @param length Number of characters
+     */
+    void append(const char* text, std::size_t length);
+
+    /**
+     * @brief Append a string
+     * @param text Text
+     */
+    void append(const std::string& text);
+
+    /**
+     * @brief Append an integer
+     * @param value Value
+     */
+    void appendInteger(std::int64_t value);
+
+    /**
+     * @brief Append a number in the shortest form that round-trips exactly
+     * @param value Value ("nan", "inf" and "-inf" for non-finite values)
+     */
+    void appendNumber(double value);
+
+    /**
+     * @brief Append a number with a fixed number of decimals
+     * @param value Value (very large magnitudes use the shortest form instead)
+     * @param decimals Digits after the decimal point
+     */
+    void appendFixed(double value, int decimals);
+
+    /**
+     * @brief Append text padded with spaces to a column width (longer text is not cut)
+     * @param text Text
+     * @param width Column width
+     * @param alignRight Pad on the left instead of the right
+     */
+    void appendPadded(const std::string& text, std::size_t width, bool alignRight);
+
+    /**
+     * @brief Append a fixed-decimal number right-aligned in a column
+     * @param value Value
+     * @param decimals Digits after the decimal point
+     * @param width Column width
+     */
+    void appendFixedPadded(double value, int decimals, std::size_t width);
+
+    /**
+     * @brief Append a field quoted for CSV if it contains separators, quotes or line breaks
+     * @param text Field
+     */
+    void appendCsvField(const std::string& text);
+
+    /**
+     * @brief Append a JSON string literal, escaping quotes, backslashes and control characters
+     * @param text Text
+     */
+    void appendJsonString(const std::string& text);
+
+    /**
+     * @brief Append a JSON number (null for non-finite values)
+     * @param value Value
+     */
+    void appendJsonNumber(double value);
+
+    /**
+     * @brief Write the buffered bytes to the file
+     * @return False if a write failed (now or earlier)
+     */
+    bool flush();
+
+    /**
+     * @brief Get the number of bytes appended so far, including the ones still buffered
+     * @return Byte count
+     */
+    std::uint64_t getBytesWritten() const;
+};
+
+/**
+ * @brief Export format of a ReportWriter
+ */
+enum class ReportFormat {
+    Csv,            // one row per operation or part, with a header
+    JsonLines,      // one JSON object per line
+    Text            // fixed-width columns for reading
+};
+
+/**
+ * @brief Writes per-operation estimates and per-part carbon labels as CSV, JSON Lines or text
+ *
+ * Rows are formatted into a reusable OutputBuffer, so exporting millions of operations
+ * neither allocates per row nor goes through iostreams. CSV and JSON Lines carry every
+ * number in its shortest exact form; the text report rounds to fixed decimals.
+ * Operation and part rows share one CSV layout, told apart by the record column.
+ */
+class ReportWriter {
+private:
+    OutputBuffer buffer;
+    std::FILE* file;
+    bool ownsFile;
+    ReportFormat format;
+    std::string path;
+
+    void writeHeader();
+
+public:
+    /**
+     * @brief Writer without an output
+     * @param bufferSize Output buffer size in bytes
+     */
+    explicit ReportWriter(std::size_t bufferSize = 1 << 20);
+
+    /**
+     * @brief Flush and close the output
+     */
+    ~ReportWriter();
+
+    ReportWriter(const ReportWriter&) = delete;
+    ReportWriter& operator=(const ReportWriter&) = delete;
+
+    /**
+     * @brief Start a report, writing the header of the format
+     * @param outputPath File to create, or "-" for the standard output
+     * @param reportFormat Format
+     * @return False if the file cannot be created
+     */
+    bool open(const std::string& outputPath, ReportFormat reportFormat);
+
+    /**
+     * @brief Write one operation
+     * @param part Part name
+     * @param index Operation index within the part
+     * @param operation Operation as extracted
+     * @param estimate Its estimate
+     */
+    void writeOperation(const std::string& part, std::size_t index, const NXOperation& operation,
+                        const OperationEstimate& estimate);
+
+    /**
+     * @brief Write the carbon label of a part (totals including setup)
+     * @param estimate Part estimate
+     * @param emissionFactor Emission factor the estimate was made with, in kg CO2/kWh
+     */
+    void writePart(const PartEstimate& estimate, double emissionFactor);
+
+    /**
+     * @brief Write all operations of each part followed by its label
+     * @param parts Parts as estimated
+     * @param estimates Estimates in the same order (see BatchEstimator::estimate)
+     * @param emissionFactor Emission factor in kg CO2/kWh
+     */
+    void writeParts(const std::vector<PartProgram>& parts, const std::vector<PartEstimate>& estimates,
+                    double emissionFactor);
+
+    /**
+     * @brief Write the buffered rows
+     * @return False if a write failed
+     */
+    bool flush();
+
+    /**
+     * @brief Flush and close the output
+     * @return False if a write failed
+     */
+    bool close();
+
+    /**
+     * @brief Get the size of the report so far
+     * @return Byte count
+     */
+    std::uint64_t getBytesWritten() const;
+};
+
+#endif // REPORT_WRITER_H
\ No newline at end of file
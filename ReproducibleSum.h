@@ -0,0 +1,181 @@
+#ifndef REPRODUCIBLE_SUM_H
+#define REPRODUCIBLE_SUM_H
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+/**
+ * @brief Order-independent sum of doubles in 128-bit fixed point
+ *
+ * Every value is rounded once to a multiple of 2^-64 and added to a 128-bit two's
+ * complement integer. Integer addition is associative, so the result is bit-for-bit the
+ * same for any order of the values and any split across threads (partial sums are
+ * combined with merge()), and no precision is lost however many values are summed.
+ * The value is converted back to the nearest double only when it is read.
+ *
+ * Range: magnitudes up to 2^63 (about 9.2e18) per value and for the total, resolution
+ * 2^-64 (about 5.4e-20) per value, which covers minutes, kWh and kg CO2 with a wide margin.
+ * Values outside the range make the sum NaN; infinities and NaN propagate like in
+ * floating-point addition.
+ */
+class ReproducibleSum {
+private:
+    std::uint64_t low;
+    std::uint64_t high;         // two's complement with low
+    bool hasNaN;
+    bool hasPositiveInfinity;
+    bool hasNegativeInfinity;
+    bool outOfRange;
+
+    static int highestBit(std::uint64_t word) {
+        int bit = 0;
+        for (int step = 32; step > 0; step >>= 1) {
+            if (word >> step) {
+                word >>= step;
+                bit += step;
+            }
+        }
+        return bit;
+    }
+
+public:
+    ReproducibleSum()
+        : low(0), high(0), hasNaN(false), hasPositiveInfinity(false), hasNegativeInfinity(false), outOfRange(false) {}
+
+    /**
+     * @brief Add a value
+     * @param value Value
+     */
+    void add(double value) {
+        std::uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        bool negative = (bits >> 63) != 0;
+        int exponent = static_cast<int>((bits >> 52) & 0x7ff);
+        std::uint64_t mantissa = bits & ((std::uint64_t(1) << 52) - 1);
+
+        if (exponent == 0x7ff) {
+            if (mantissa != 0) {
+                hasNaN = true;
+            } else if (negative) {
+                hasNegativeInfinity = true;
+            } else {
+                hasPositiveInfinity = true;
+            }
+            return;
+        }
+        if (exponent == 0) {
+            exponent = 1;       // subnormal: no implicit bit
+        } else {
+            mantissa |= std::uint64_t(1) << 52;
+        }
+
+        // value = mantissa * 2^(exponent - 1075) = mantissa * 2^shift units of 2^-64
+        int shift = exponent - 1011;
+        std::uint64_t addLow;
+        std::uint64_t addHigh;
+        if (shift < 0) {
+            if (shift < -53) {
+                return;         // below half a unit
+            }
+            addLow = (mantissa + (std::uint64_t(1) << (-shift - 1))) >> -shift;
+            addHigh = 0;
+        } else if (shift == 0) {
+            addLow = mantissa;
+            addHigh = 0;
+        } else if (shift < 64) {
+            addLow = mantissa << shift;
+            addHigh = mantissa >> (64 - shift);
+        } else if (shift <= 74) {
+            addLow = 0;
+            addHigh = mantissa << (shift - 64);
+        } else {
+            outOfRange = true;
+            return;
+        }
+
+        if (negative) {
+            std::uint64_t borrow = low < addLow ? 1 : 0;
+            low -= addLow;
+            high -= addHigh + borrow;
+        } else {
+            low += addLow;
+            high += addHigh + (low < addLow ? 1 : 0);
+        }
+    }
+
+    /**
+     * @brief Add a partial sum, e.g. from another thread
+     * @param other Partial sum
+     */
+    void merge(const ReproducibleSum& other) {
+        low += other.low;
+        high += other.high + (low < other.low ? 1 : 0);
+        hasNaN = hasNaN || other.hasNaN;
+        hasPositiveInfinity = hasPositiveInfinity || other.hasPositiveInfinity;
+        hasNegativeInfinity = hasNegativeInfinity || other.hasNegativeInfinity;
+        outOfRange = outOfRange || other.outOfRange;
+    }
+
+    /**
+     * @brief Get the sum rounded to the nearest double (ties to even)
+     * @return Sum
+     */
+    double getValue() const {
+        if (hasNaN || outOfRange || (hasPositiveInfinity && hasNegativeInfinity)) {
+            return std::nan("");
+        }
+        if (hasPositiveInfinity || hasNegativeInfinity) {
+            return hasPositiveInfinity ? HUGE_VAL : -HUGE_VAL;
+        }
+
+        bool negative = (high >> 63) != 0;
+        std::uint64_t magnitudeLow = low;
+        std::uint64_t magnitudeHigh = high;
+        if (negative) {
+            magnitudeLow = ~low + 1;
+            magnitudeHigh = ~high + (magnitudeLow == 0 ? 1 : 0);
+        }
+        if (magnitudeHigh == 0 && magnitudeLow == 0) {
+            return 0.0;
+        }
+
+        // Top 64 significant bits, plus whether anything below them is set
+        int top = magnitudeHigh != 0 ? 64 + highestBit(magnitudeHigh) : highestBit(magnitudeLow);
+        std::uint64_t bits;
+        bool sticky = false;
+        if (top < 64) {
+            bits = magnitudeLow << (63 - top);
+        } else if (top == 64) {
+            bits = (magnitudeHigh << 63) | (magnitudeLow >> 1);
+            sticky = (magnitudeLow & 1) != 0;
+        } else {
+            int drop = top - 63;
+            bits = (magnitudeHigh << (64 - drop)) | (magnitudeLow >> drop);
+            sticky = (magnitudeLow & ((std::uint64_t(1) << drop) - 1)) != 0;
+        }
+
+        // Round the 64 bits to 53, ties to even
+        std::uint64_t mantissa = bits >> 11;
+        std::uint64_t dropped = bits & 0x7ff;
+        if (dropped > 0x400 || (dropped == 0x400 && (sticky || (mantissa & 1) != 0))) {
+            ++mantissa;
+            if (mantissa >> 53) {
+                mantissa >>= 1;
+                ++top;
+            }
+        }
+        double value = std::ldexp(static_cast<double>(mantissa), top - 52 - 64);
+        return negative ? -value : value;
+    }
+
+    /**
+     * @brief Check whether all values were finite and within range
+     * @return True if getValue() is a finite sum
+     */
+    bool isFinite() const {
+        return !hasNaN && !outOfRange && !hasPositiveInfinity && !hasNegativeInfinity;
+    }
+};
+
+#endif // REPRODUCIBLE_SUM_H
\ No newline at end of file
@@ -0,0 +1,289 @@
+#include "ScenarioEngine.h"
+#include "AIInterface.h"
+#include "TimeModel.h"
+#include "EnergyModel.h"
+#include "CarbonModel.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <future>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+
+namespace {
+
+// Below this many per-operation cells the rows are filled on the calling thread
+const std::size_t parallelCells = 1 << 16;
+
+} // namespace
+
+ScenarioDelta::ScenarioDelta()
+    : emissionFactor(-1.0), cuttingPower(-1.0), rapidPower(-1.0), idlePower(-1.0), rapidTimeFactor(-1.0),
+      idleTimePerOp(-1.0), setupTime(-1.0) {
+}
+
+ScenarioDelta::ScenarioDelta(const std::string& scenarioName) : ScenarioDelta() {
+    name = scenarioName;
+}
+
+ScenarioResult::ScenarioResult()
+    : emissionFactor(0.0), totalTime(0.0), cuttingEnergy(0.0), rapidEnergy(0.0), idleEnergy(0.0), energy(0.0),
+      carbon(0.0), carbonChange(0.0), relativeChange(0.0) {
+}
+
+ScenarioEngine::ScenarioEngine(AIInterface& aiInterface, const TimeModel& timeModel, const EnergyModel& energyModel,
+                               double factor)
+    : ai(aiInterface),
+      rapidTimeFactor(timeModel.getRapidTimeFactor()),
+      idleTimePerOp(timeModel.getIdleTimePerOp()),
+      setupTime(timeModel.getSetupTime()),
+      cuttingPower(energyModel.getCuttingPower()),
+      rapidPower(energyModel.getRapidPower()),
+      idlePower(energyModel.getIdlePower()),
+      emissionFactor(factor),
+      depthOfCut(2.0),
+      threads(0),
+      operationDetail(false),
+      modelVersion(0),
+      totalCuttingTime(0.0) {
+}
+
+void ScenarioEngine::setProgram(const std::vector<NXOperation>& programOperations, const std::string& programMaterial,
+                                const std::string& programMachineType) {
+    operations = programOperations;
+    material = programMaterial;
+    machineType = programMachineType;
+
+    // Cutting times are shared by every scenario
+    cuttingTimes.clear();
+    totalCuttingTime = 0.0;
+    for (const NXOperation& operation : operations) {
+        cuttingTimes.push_back(operation.getCuttingTime());
+        totalCuttingTime += operation.getCuttingTime();
+    }
+    featureStages.clear();
+    powerStages.clear();
+}
+
+void ScenarioEngine::setDepthOfCut(double depth) {
+    depthOfCut = depth;     // part of the stage keys, so memoized stages stay valid
+}
+
+void ScenarioEngine::setThreads(std::size_t threadCount) {
+    threads = threadCount;
+}
+
+void ScenarioEngine::setOperationDetail(bool enabled) {
+    operationDetail = enabled;
+}
+
+const std::vector<CutFeatures>& ScenarioEngine::getFeatures(const std::string& scenarioMaterial,
+                                                            const std::string& scenarioMachineType) {
+    OperationKeyBuilder builder;
+    builder.add(scenarioMaterial);
+    builder.add(scenarioMachineType);
+    builder.add(depthOfCut);
+    auto inserted = featureStages.emplace(builder.getKey(), std::vector<CutFeatures>());
+    if (!inserted.second) {
+        ++statistics.reusedStages;
+        return inserted.first->second;
+    }
+
+    ++statistics.featureStages;
+    std::vector<CutFeatures>& features = inserted.first->second;
+    features.reserve(operations.size());
+    for (const NXOperation& operation : operations) {
+        features.push_back(ai.getPredictorRegistry().makeFeatures(
+            scenarioMaterial, operation.getToolDiameter(), operation.getSpindleSpeed(), operation.getFeedRate(),
+            depthOfCut, operation.getOperationType(), scenarioMachineType));
+    }
+    return features;
+}
+
+const ScenarioEngine::PowerStage& ScenarioEngine::getPower(const std::string& scenarioMaterial,
+                                                           const std::string& scenarioMachineType,
+                                                           const std::string& powerSource, double fallbackPower) {
+    OperationKeyBuilder builder;
+    builder.add(modelVersion);
+    builder.add(scenarioMaterial);
+    builder.add(scenarioMachineType);
+    builder.add(depthOfCut);
+    builder.add(powerSource);
+    builder.add(fallbackPower);
+    auto inserted = powerStages.emplace(builder.getKey(), PowerStage());
+    if (!inserted.second) {
+        ++statistics.reusedStages;
+        return inserted.first->second;
+    }
+
+    ++statistics.powerStages;
+    PowerStage& stage = inserted.first->second;
+    const std::vector<CutFeatures>& features = getFeatures(scenarioMaterial, scenarioMachineType);
+    stage.power.assign(features.size(), std::numeric_limits<double>::quiet_NaN());
+    if (powerSource.empty()) {
+        ai.predictCuttingPowerBatch(features, stage.power);
+    } else {
+        PowerPredictor* predictor = ai.getPredictorRegistry().getPredictor(powerSource);
+        if (predictor == nullptr || !predictor->isReady()) {
+            std::cout << "Warning: power source " << powerSource << " is not available, using "
+                      << fallbackPower << " kW" << std::endl;
+        } else if (!predictor->predictBatch(features, stage.power)) {
+            std::fill(stage.power.begin(), stage.power.end(), std::numeric_limits<double>::quiet_NaN());
+        }
+    }
+
+    stage.cuttingEnergy = 0.0;
+    for (std::size_t i = 0; i < stage.power.size(); ++i) {
+        if (!std::isfinite(stage.power[i])) {
+            stage.power[i] = fallbackPower;
+        }
+        stage.cuttingEnergy += EnergyModel::computeEnergy(cuttingTimes[i], stage.power[i]);
+    }
+    return stage;
+}
+
+bool ScenarioEngine::evaluate(const std::vector<ScenarioDelta>& scenarios, ScenarioMatrix& matrix) {
+    if (operations.empty()) {
+        std::cout << "Error: no program set for scenario evaluation" << std::endl;
+        return false;
+    }
+    auto start = std::chrono::steady_clock::now();
+    statistics = ScenarioStatistics();
+    modelVersion = ai.getModelVersion();
+
+    std::vector<ScenarioDelta> rows;
+    rows.reserve(scenarios.size() + 1);
+    rows.push_back(ScenarioDelta("Baseline"));
+    rows.insert(rows.end(), scenarios.begin(), scenarios.end());
+    statistics.scenarios = rows.size();
+
+    // Regional and grid factors are looked up once per distinct name
+    std::unique_ptr<CarbonModel> carbonModel;
+    std::map<std::string, double> regionFactors;
+    std::map<std::string, double> gridFactors;
+
+    // Resolved parameters of one row of the comparison
+    struct ScenarioPlan {
+        const PowerStage* power;
+        double rapidTimeFactor;
+        double idleTimePerOp;
+        double rapidPower;
+        double idlePower;
+        double emissionFactor;
+    };
+
+    const std::size_t n = operations.size();
+    matrix.scenarios.assign(rows.size(), ScenarioResult());
+    matrix.operationCount = n;
+    std::vector<ScenarioPlan> plans(rows.size());
+    for (std::size_t r = 0; r < rows.size(); ++r) {
+        const ScenarioDelta& delta = rows[r];
+        ScenarioPlan& plan = plans[r];
+        plan.rapidTimeFactor = delta.rapidTimeFactor >= 0.0 ? delta.rapidTimeFactor : rapidTimeFactor;
+        plan.idleTimePerOp = delta.idleTimePerOp >= 0.0 ? delta.idleTimePerOp : idleTimePerOp;
+        plan.rapidPower = delta.rapidPower >= 0.0 ? delta.rapidPower : rapidPower;
+        plan.idlePower = delta.idlePower >= 0.0 ? delta.idlePower : idlePower;
+        plan.emissionFactor = emissionFactor;
+        if (delta.emissionFactor >= 0.0) {
+            plan.emissionFactor = delta.emissionFactor;
+        } else if (!delta.region.empty() || !delta.gridType.empty()) {
+            if (!carbonModel) {
+                carbonModel.reset(new CarbonModel());
+            }
+            std::map<std::string, double>& factors = delta.region.empty() ? gridFactors : regionFactors;
+            const std::string& name = delta.region.empty() ? delta.gridType : delta.region;
+            auto found = factors.find(name);
+            if (found == factors.end()) {
+                double factor = delta.region.empty() ? carbonModel->getEmissionFactorForGridType(name)
+                                                     : carbonModel->getEmissionFactorForCountry(name);
+                found = factors.emplace(name, factor).first;
+            }
+            plan.emissionFactor = found->second;
+        }
+        double setup = delta.setupTime >= 0.0 ? delta.setupTime : setupTime;
+        const PowerStage& power = getPower(delta.material.empty() ? material : delta.material,
+                                           delta.machineType.empty() ? machineType : delta.machineType,
+                                           delta.powerSource,
+                                           delta.cuttingPower >= 0.0 ? delta.cuttingPower : cuttingPower);
+        plan.power = &power;
+
+        // Everything past the power stage only needs the shared totals
+        ScenarioResult& result = matrix.scenarios[r];
+        double rapidTime = TimeModel::computeRapidTime(totalCuttingTime, plan.rapidTimeFactor);
+        double idleTime = plan.idleTimePerOp * static_cast<double>(n);
+        result.name = delta.name;
+        result.emissionFactor = plan.emissionFactor;
+        result.totalTime = TimeModel::computeTotalTime(totalCuttingTime, rapidTime, idleTime) + setup;
+        result.cuttingEnergy = power.cuttingEnergy;
+        result.rapidEnergy = EnergyModel::computeEnergy(rapidTime, plan.rapidPower);
+        result.idleEnergy = EnergyModel::computeEnergy(idleTime + setup, plan.idlePower);
+        result.energy = EnergyModel::computeTotalEnergy(result.cuttingEnergy, result.rapidEnergy, result.idleEnergy);
+        result.carbon = CarbonModel::computeEmission(result.energy, plan.emissionFactor);
+    }
+    for (ScenarioResult& result : matrix.scenarios) {
+        result.carbonChange = result.carbon - matrix.scenarios[0].carbon;
+        result.relativeChange = matrix.scenarios[0].carbon != 0.0 ? result.carbonChange / matrix.scenarios[0].carbon
+                                                                   : 0.0;
+    }
+
+    // Per-operation emissions, one row per scenario
+    matrix.operationCarbon.clear();
+    if (!operationDetail) {
+        statistics.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return true;
+    }
+    matrix.operationCarbon.assign(rows.size() * n, 0.0);
+    auto fillRows = [this, &plans, &matrix, n](std::size_t first, std::size_t last) {
+        for (std::size_t r = first; r < last; ++r) {
+            const ScenarioPlan& plan = plans[r];
+            const PowerStage& power = *plan.power;
+            double idleEnergy = EnergyModel::computeEnergy(plan.idleTimePerOp, plan.idlePower);
+            double* row = matrix.operationCarbon.data() + r * n;
+            for (std::size_t i = 0; i < n; ++i) {
+                double energy = EnergyModel::computeTotalEnergy(
+                    EnergyModel::computeEnergy(cuttingTimes[i], power.power[i]),
+                    EnergyModel::computeEnergy(TimeModel::computeRapidTime(cuttingTimes[i], plan.rapidTimeFactor),
+                                               plan.rapidPower),
+                    idleEnergy);
+                row[i] = CarbonModel::computeEmission(energy, plan.emissionFactor);
+            }
+        }
+    };
+    if (rows.size() * n < parallelCells || rows.size() < 2) {
+        fillRows(0, rows.size());
+    } else {
+        ThreadPool pool(threads);
+        std::size_t chunks = std::min(rows.size(), pool.getThreadCount());
+        std::vector<std::future<void>> done;
+        for (std::size_t c = 0; c < chunks; ++c) {
+            done.push_back(pool.submit([&fillRows, &rows, c, chunks]() {
+                fillRows(rows.size() * c / chunks, rows.size() * (c + 1) / chunks);
+            }));
+        }
+        for (std::future<void>& chunk : done) {
+            chunk.get();
+        }
+    }
+
+    statistics.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return true;
+}
+
+const ScenarioStatistics& ScenarioEngine::getStatistics() const {
+    return statistics;
+}
+
+void ScenarioEngine::print(const ScenarioMatrix& matrix) {
+    for (const ScenarioResult& result : matrix.scenarios) {
+        std::cout << "  " << result.name << ": " << result.carbon << " kg CO2, " << result.energy << " kWh, "
+                  << result.totalTime << " min (factor " << result.emissionFactor << " kg CO2/kWh";
+        if (&result != &matrix.scenarios.front()) {
+            std::cout << ", " << (result.carbonChange >= 0.0 ? "+" : "") << result.relativeChange * 100.0
+                      << "% vs baseline";
+        }
+        std::cout << ")" << std::endl;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,205 @@
+#ifndef SCENARIO_ENGINE_H
+#define SCENARIO_ENGINE_H
+
+#include "NXCamDataExtractor.h"
+#include "OperationCache.h"
+#include "PowerPredictor.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class AIInterface;
+class TimeModel;
+class EnergyModel;
+
+/**
+ * @brief Differences of a what-if scenario from the baseline configuration
+ *
+ * Empty strings and negative numbers keep the baseline value.
+ */
+struct ScenarioDelta {
+    std::string name;
+    double emissionFactor;      // kg CO2/kWh, takes precedence over region and grid type
+    std::string region;         // country code for CarbonModel::getEmissionFactorForCountry
+    std::string gridType;       // grid type for CarbonModel::getEmissionFactorForGridType
+    std::string powerSource;    // prediction backend name (empty = the AIInterface fallback chain)
+    std::string material;
+    std::string machineType;
+    double cuttingPower;        // kW used where the power source has no prediction
+    double rapidPower;          // kW
+    double idlePower;           // kW
+    double rapidTimeFactor;
+    double idleTimePerOp;       // minutes
+    double setupTime;           // minutes
+
+    ScenarioDelta();
+
+    /**
+     * @brief Scenario identical to the baseline until fields are set
+     * @param scenarioName Name shown in the comparison
+     */
+    explicit ScenarioDelta(const std::string& scenarioName);
+};
+
+/**
+ * @brief Totals of one scenario
+ */
+struct ScenarioResult {
+    std::string name;
+    double emissionFactor;      // kg CO2/kWh
+    double totalTime;           // minutes, including setup
+    double cuttingEnergy;       // kWh
+    double rapidEnergy;         // kWh
+    double idleEnergy;          // kWh, including setup
+    double energy;              // kWh
+    double carbon;              // kg CO2
+    double carbonChange;        // kg CO2 relative to the baseline
+    double relativeChange;      // carbonChange / baseline carbon
+
+    ScenarioResult();
+};
+
+/**
+ * @brief Comparison of all scenarios; row 0 is the baseline
+ */
+struct ScenarioMatrix {
+    std::vector<ScenarioResult> scenarios;
+    std::size_t operationCount;
+    std::vector<double> operationCarbon;    // kg CO2, one row of operationCount values per scenario (if requested)
+
+    ScenarioMatrix() : operationCount(0) {}
+
+    /**
+     * @brief Get the emissions of one operation in one scenario
+     * @param scenario Row, 0 for the baseline
+     * @param operation Operation index
+     * @return Emissions in kg CO2 (setup excluded)
+     */
+    double getOperationCarbon(std::size_t scenario, std::size_t operation) const {
+        return operationCarbon[scenario * operationCount + operation];
+    }
+};
+
+/**
+ * @brief Work done by the last ScenarioEngine::evaluate call
+ */
+struct ScenarioStatistics {
+    std::size_t scenarios;          // including the baseline
+    std::size_t featureStages;      // distinct material/machine/depth combinations built
+    std::size_t powerStages;        // distinct cutting power predictions run
+    std::size_t reusedStages;       // feature and power stages shared with earlier scenarios or calls
+    double seconds;
+
+    ScenarioStatistics() : scenarios(0), featureStages(0), powerStages(0), reusedStages(0), seconds(0.0) {}
+};
+
+/**
+ * @brief Evaluates one program under many what-if configurations, sharing intermediates
+ *
+ * The estimate splits into stages with narrow dependencies:
+ * - features: material, machine type and depth of cut
+ * - cutting power and cutting energy: features, power source and fallback cutting power
+ * - time components: cutting time totals (computed once per program) and the time parameters
+ * - rapid, idle and setup energy, carbon: totals and the power levels and emission factor
+ *
+ * Each stage is keyed by the inputs it depends on, and only the distinct keys that the
+ * scenarios actually reach are computed, so the predictions (the expensive part) run once
+ * per distinct power configuration, and comparing grids, regions or power levels costs
+ * O(1) per scenario. Feature and power stages are memoized across calls for the same
+ * program and models. Per-operation emission rows are optional and filled in parallel.
+ */
+class ScenarioEngine {
+private:
+    struct PowerStage {
+        std::vector<double> power;  // kW per operation
+        double cuttingEnergy;       // kWh
+    };
+
+    AIInterface& ai;
+    double rapidTimeFactor;
+    double idleTimePerOp;
+    double setupTime;
+    double cuttingPower;
+    double rapidPower;
+    double idlePower;
+    double emissionFactor;
+    double depthOfCut;
+    std::size_t threads;
+    bool operationDetail;
+    std::uint64_t modelVersion;
+    std::vector<NXOperation> operations;
+    std::vector<double> cuttingTimes;
+    double totalCuttingTime;
+    std::string material;
+    std::string machineType;
+    std::unordered_map<OperationKey, std::vector<CutFeatures>, OperationKeyHash> featureStages;
+    std::unordered_map<OperationKey, PowerStage, OperationKeyHash> powerStages;
+    ScenarioStatistics statistics;
+
+    const std::vector<CutFeatures>& getFeatures(const std::string& scenarioMaterial,
+                                                const std::string& scenarioMachineType);
+    const PowerStage& getPower(const std::string& scenarioMaterial, const std::string& scenarioMachineType,
+                               const std::string& powerSource, double fallbackPower);
+
+public:
+    /**
+     * @brief Engine whose baseline uses the parameters of the given models
+     * @param aiInterface Cutting power prediction
+     * @param timeModel Rapid time factor, idle time per operation and setup time
+     * @param energyModel Cutting, rapid and idle power
+     * @param emissionFactor Baseline emission factor in kg CO2/kWh
+     */
+    ScenarioEngine(AIInterface& aiInterface, const TimeModel& timeModel, const EnergyModel& energyModel,
+                   double emissionFactor);
+
+    /**
+     * @brief Set the program to compare, dropping the memoized stages
+     * @param programOperations Operations in program order
+     * @param programMaterial Baseline workpiece material
+     * @param programMachineType Baseline machine type
+     */
+    void setProgram(const std::vector<NXOperation>& programOperations, const std::string& programMaterial,
+                    const std::string& programMachineType);
+
+    /**
+     * @brief Set the depth of cut, which NX operations do not carry
+     * @param depth Depth of cut in mm
+     */
+    void setDepthOfCut(double depth);
+
+    /**
+     * @brief Set the number of threads filling the per-operation rows
+     * @param threadCount Number of threads (0 uses the hardware concurrency)
+     */
+    void setThreads(std::size_t threadCount);
+
+    /**
+     * @brief Also compute the emissions of every operation in every scenario
+     * @param enabled True to fill ScenarioMatrix::operationCarbon
+     */
+    void setOperationDetail(bool enabled);
+
+    /**
+     * @brief Evaluate the baseline and every scenario
+     * @param scenarios Scenario deltas
+     * @param matrix Comparison, baseline first, then the scenarios in order
+     * @return False if no program was set
+     */
+    bool evaluate(const std::vector<ScenarioDelta>& scenarios, ScenarioMatrix& matrix);
+
+    /**
+     * @brief Get the statistics of the last evaluate() call
+     * @return Scenario count and stages computed or reused
+     */
+    const ScenarioStatistics& getStatistics() const;
+
+    /**
+     * @brief Print the comparison, one line per scenario
+     * @param matrix Comparison returned by evaluate()
+     */
+    static void print(const ScenarioMatrix& matrix);
+};
+
+#endif // SCENARIO_ENGINE_H
\ No newline at end of file
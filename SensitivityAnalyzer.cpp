@@ -0,0 +1,197 @@
+#include "SensitivityAnalyzer.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace {
+
+inline std::size_t indexOf(SensitivityParameter parameter) {
+    return static_cast<std::size_t>(parameter);
+}
+
+const std::size_t PartParameterCount = FirstOperationParameter;
+
+} // namespace
+
+SensitivityAnalyzer::SensitivityAnalyzer(const TimeModel& timeModel, const EnergyModel& energyModel, double factor)
+    : powerModel(categories),
+      rapidTimeFactor(timeModel.getRapidTimeFactor()),
+      idleTimePerOp(timeModel.getIdleTimePerOp()),
+      setupTime(timeModel.getSetupTime()),
+      rapidPower(energyModel.getRapidPower()),
+      idlePower(energyModel.getIdlePower()),
+      emissionFactor(factor),
+      depthOfCut(2.0),
+      constantPathLength(true) {
+}
+
+void SensitivityAnalyzer::setPowerModel(const RegressionPredictor& model) {
+    powerModel.setCoefficients(model.getCoefficients());
+    powerModel.setTerms(model.getNormalization(), model.getTerms());
+}
+
+void SensitivityAnalyzer::setDepthOfCut(double depth) {
+    depthOfCut = depth;
+}
+
+void SensitivityAnalyzer::setConstantPathLength(bool enabled) {
+    constantPathLength = enabled;
+}
+
+template <typename T>
+T SensitivityAnalyzer::operationEnergy(const T* p, double nominalFeed, int materialId, int operationTypeId) {
+    T cuttingTime = p[indexOf(SensitivityParameter::CuttingTime)];
+    if (constantPathLength && nominalFeed > 0.0) {
+        // Same toolpath at a different feed: time scales with nominal feed / feed (1 at the nominal point)
+        cuttingTime = cuttingTime * (nominalFeed / p[indexOf(SensitivityParameter::FeedRate)]);
+    }
+    T cuttingPower = powerModel.predict(materialId, operationTypeId,
+                                        p[indexOf(SensitivityParameter::ToolDiameter)],
+                                        p[indexOf(SensitivityParameter::SpindleSpeed)],
+                                        p[indexOf(SensitivityParameter::FeedRate)],
+                                        p[indexOf(SensitivityParameter::DepthOfCut)]);
+    T rapidTime = TimeModel::computeRapidTime(cuttingTime, p[indexOf(SensitivityParameter::RapidTimeFactor)]);
+    T idleTime = TimeModel::computeIdleTime(1, p[indexOf(SensitivityParameter::IdleTimePerOperation)], T(0.0));
+    return EnergyModel::computeTotalEnergy(
+        EnergyModel::computeEnergy(cuttingTime, cuttingPower),
+        EnergyModel::computeEnergy(rapidTime, p[indexOf(SensitivityParameter::RapidPower)]),
+        EnergyModel::computeEnergy(idleTime, p[indexOf(SensitivityParameter::IdlePower)]));
+}
+
+PartSensitivity SensitivityAnalyzer::analyze(const std::vector<NXOperation>& operations, const std::string& material) {
+    PartSensitivity result = PartSensitivity();
+    const int materialId = categories.materials.intern(material);
+    const double partValues[PartParameterCount] = {
+        rapidTimeFactor, idleTimePerOp, setupTime, rapidPower, idlePower, emissionFactor
+    };
+    double weighted[SensitivityParameterCount] = {};    // sum of gradient * value, for the elasticities
+
+    for (const NXOperation& operation : operations) {
+        OperationSensitivity op = OperationSensitivity();
+        op.operationType = operation.getOperationType();
+        std::copy(partValues, partValues + PartParameterCount, op.values);
+        op.values[indexOf(SensitivityParameter::CuttingTime)] = operation.getCuttingTime();
+        op.values[indexOf(SensitivityParameter::FeedRate)] = operation.getFeedRate();
+        op.values[indexOf(SensitivityParameter::SpindleSpeed)] = operation.getSpindleSpeed();
+        op.values[indexOf(SensitivityParameter::ToolDiameter)] = operation.getToolDiameter();
+        op.values[indexOf(SensitivityParameter::DepthOfCut)] = depthOfCut;
+
+        // One pass with every input seeded yields all partial derivatives
+        SensitivityDual p[SensitivityParameterCount];
+        for (std::size_t k = 0; k < SensitivityParameterCount; ++k) {
+            p[k] = SensitivityDual::variable(op.values[k], k);
+        }
+        SensitivityDual energy = operationEnergy(p, op.values[indexOf(SensitivityParameter::FeedRate)], materialId,
+                                                 categories.operationTypes.intern(op.operationType));
+        SensitivityDual carbon = CarbonModel::computeEmission(energy, p[indexOf(SensitivityParameter::EmissionFactor)]);
+
+        op.energy = energy.value;
+        op.carbon = carbon.value;
+        for (std::size_t k = 0; k < SensitivityParameterCount; ++k) {
+            op.gradient[k] = carbon.gradient[k];
+            op.elasticity[k] = op.carbon != 0.0 ? op.gradient[k] * op.values[k] / op.carbon : 0.0;
+            result.gradient[k] += op.gradient[k];
+            weighted[k] += op.gradient[k] * op.values[k];
+        }
+        result.energy += op.energy;
+        result.carbon += op.carbon;
+        result.operations.push_back(op);
+    }
+
+    // Setup idle time belongs to the part, not to an operation
+    SensitivityDual p[SensitivityParameterCount];
+    for (std::size_t k = 0; k < PartParameterCount; ++k) {
+        p[k] = SensitivityDual::variable(partValues[k], k);
+    }
+    SensitivityDual setupIdle = TimeModel::computeIdleTime(0, p[indexOf(SensitivityParameter::IdleTimePerOperation)],
+                                                           p[indexOf(SensitivityParameter::SetupTime)]);
+    SensitivityDual setupEnergy = EnergyModel::computeEnergy(setupIdle, p[indexOf(SensitivityParameter::IdlePower)]);
+    SensitivityDual setupCarbon = CarbonModel::computeEmission(setupEnergy,
+                                                               p[indexOf(SensitivityParameter::EmissionFactor)]);
+    result.energy += setupEnergy.value;
+    result.carbon += setupCarbon.value;
+    for (std::size_t k = 0; k < PartParameterCount; ++k) {
+        result.gradient[k] += setupCarbon.gradient[k];
+        weighted[k] += setupCarbon.gradient[k] * partValues[k];
+    }
+
+    for (std::size_t k = 0; k < SensitivityParameterCount; ++k) {
+        result.elasticity[k] = result.carbon != 0.0 ? weighted[k] / result.carbon : 0.0;
+    }
+    return result;
+}
+
+double SensitivityAnalyzer::evaluate(const std::vector<NXOperation>& operations, const std::string& material) {
+    const int materialId = categories.materials.intern(material);
+    double energy = 0.0;
+    double p[SensitivityParameterCount] = {
+        rapidTimeFactor, idleTimePerOp, setupTime, rapidPower, idlePower, emissionFactor
+    };
+    for (const NXOperation& operation : operations) {
+        p[indexOf(SensitivityParameter::CuttingTime)] = operation.getCuttingTime();
+        p[indexOf(SensitivityParameter::FeedRate)] = operation.getFeedRate();
+        p[indexOf(SensitivityParameter::SpindleSpeed)] = operation.getSpindleSpeed();
+        p[indexOf(SensitivityParameter::ToolDiameter)] = operation.getToolDiameter();
+        p[indexOf(SensitivityParameter::DepthOfCut)] = depthOfCut;
+        energy += operationEnergy(p, operation.getFeedRate(), materialId,
+                                  categories.operationTypes.intern(operation.getOperationType()));
+    }
+    energy += EnergyModel::computeEnergy(TimeModel::computeIdleTime(0, idleTimePerOp, setupTime), idlePower);
+    return CarbonModel::computeEmission(energy, emissionFactor);
+}
+
+std::vector<SensitivityRanking> SensitivityAnalyzer::rank(const PartSensitivity& result) {
+    std::vector<SensitivityRanking> ranking;
+    for (std::size_t k = 0; k < PartParameterCount; ++k) {
+        ranking.push_back({static_cast<SensitivityParameter>(k), -1, result.gradient[k], result.elasticity[k]});
+    }
+    for (std::size_t i = 0; i < result.operations.size(); ++i) {
+        const OperationSensitivity& op = result.operations[i];
+        for (std::size_t k = FirstOperationParameter; k < SensitivityParameterCount; ++k) {
+            // Relative to the part emissions so that operations compare with each other
+            double elasticity = result.carbon != 0.0 ? op.gradient[k] * op.values[k] / result.carbon : 0.0;
+            ranking.push_back({static_cast<SensitivityParameter>(k), static_cast<int>(i), op.gradient[k], elasticity});
+        }
+    }
+    std::stable_sort(ranking.begin(), ranking.end(), [](const SensitivityRanking& a, const SensitivityRanking& b) {
+        return std::fabs(a.elasticity) > std::fabs(b.elasticity);
+    });
+    return ranking;
+}
+
+const char* SensitivityAnalyzer::getParameterName(SensitivityParameter parameter) {
+    switch (parameter) {
+        case SensitivityParameter::RapidTimeFactor: return "Rapid time factor";
+        case SensitivityParameter::IdleTimePerOperation: return "Idle time per operation (min)";
+        case SensitivityParameter::SetupTime: return "Setup time (min)";
+        case SensitivityParameter::RapidPower: return "Rapid power (kW)";
+        case SensitivityParameter::IdlePower: return "Idle power (kW)";
+        case SensitivityParameter::EmissionFactor: return "Emission factor (kg CO2/kWh)";
+        case SensitivityParameter::CuttingTime: return "Cutting time (min)";
+        case SensitivityParameter::FeedRate: return "Feed rate (mm/min)";
+        case SensitivityParameter::SpindleSpeed: return "Spindle speed (RPM)";
+        case SensitivityParameter::ToolDiameter: return "Tool diameter (mm)";
+        case SensitivityParameter::DepthOfCut: return "Depth of cut (mm)";
+    }
+    return "Unknown";
+}
+
+void SensitivityAnalyzer::print(const PartSensitivity& result, std::size_t top) {
+    std::cout << "Part emissions: " << result.carbon << " kg CO2 (" << result.energy << " kWh)" << std::endl;
+    for (std::size_t i = 0; i < result.operations.size(); ++i) {
+        const OperationSensitivity& op = result.operations[i];
+        std::cout << "  Operation " << i + 1 << " (" << op.operationType << "): " << op.carbon << " kg CO2" << std::endl;
+    }
+
+    std::vector<SensitivityRanking> ranking = rank(result);
+    std::cout << "Most influential parameters (elasticity: % CO2 per % change):" << std::endl;
+    for (std::size_t i = 0; i < ranking.size() && i < top; ++i) {
+        const SensitivityRanking& entry = ranking[i];
+        std::cout << "  " << getParameterName(entry.parameter);
+        if (entry.operation >= 0) {
+            std::cout << " [operation " << entry.operation + 1 << "]";
+        }
+        std::cout << ": elasticity " << entry.elasticity << ", " << entry.gradient
+                  << " kg CO2 per unit" << std::endl;
+    }
+}
\ No newline at end of file
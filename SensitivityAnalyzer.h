@@ -0,0 +1,168 @@
+#ifndef SENSITIVITY_ANALYZER_H
+#define SENSITIVITY_ANALYZER_H
+
+#include "Dual.h"
+#include "NXCamDataExtractor.h"
+#include "TimeModel.h"
+#include "EnergyModel.h"
+#include "CarbonModel.h"
+#include "BuiltinPredictors.h"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Inputs of the Time/Energy/Carbon chain that sensitivities are taken with respect to
+ *
+ * The first group applies to the whole part, the second group to each operation.
+ */
+enum class SensitivityParameter {
+    RapidTimeFactor = 0,
+    IdleTimePerOperation,
+    SetupTime,
+    RapidPower,
+    IdlePower,
+    EmissionFactor,
+    CuttingTime,
+    FeedRate,
+    SpindleSpeed,
+    ToolDiameter,
+    DepthOfCut
+};
+
+const std::size_t SensitivityParameterCount = 11;
+const std::size_t FirstOperationParameter = static_cast<std::size_t>(SensitivityParameter::CuttingTime);
+
+typedef Dual<SensitivityParameterCount> SensitivityDual;
+
+/**
+ * @brief Carbon emissions of one operation and their derivatives
+ *
+ * Part-level parameters report this operation's share of the part derivative.
+ */
+struct OperationSensitivity {
+    std::string operationType;
+    double energy;                                  // kWh
+    double carbon;                                  // kg CO2
+    double values[SensitivityParameterCount];       // parameter values used
+    double gradient[SensitivityParameterCount];     // kg CO2 per parameter unit
+    double elasticity[SensitivityParameterCount];   // % change of carbon per % change of the parameter
+};
+
+/**
+ * @brief Carbon emissions of a part and their derivatives
+ *
+ * For per-operation parameters the part gradient and elasticity describe changing the
+ * parameter of every operation at once; the operations hold the individual derivatives.
+ */
+struct PartSensitivity {
+    double energy;                                  // kWh
+    double carbon;                                  // kg CO2
+    double gradient[SensitivityParameterCount];
+    double elasticity[SensitivityParameterCount];
+    std::vector<OperationSensitivity> operations;
+};
+
+/**
+ * @brief Parameter ranked by its influence on the part emissions
+ */
+struct SensitivityRanking {
+    SensitivityParameter parameter;
+    int operation;          // operation index, -1 for part-level parameters
+    double gradient;        // kg CO2 per parameter unit
+    double elasticity;
+};
+
+/**
+ * @brief Sensitivity of part emissions to process parameters by forward-mode differentiation
+ *
+ * Runs the same templated formulas as TimeModel, EnergyModel, CarbonModel and the local
+ * regression power model with SensitivityDual numbers, so one pass per operation yields
+ * the emissions and all partial derivatives, without finite differences.
+ */
+class SensitivityAnalyzer {
+private:
+    FeatureCategories categories;
+    RegressionPredictor powerModel;
+    double rapidTimeFactor;
+    double idleTimePerOp;
+    double setupTime;
+    double rapidPower;
+    double idlePower;
+    double emissionFactor;
+    double depthOfCut;
+    bool constantPathLength;
+
+    template <typename T>
+    T operationEnergy(const T* parameters, double nominalFeed, int materialId, int operationTypeId);
+
+public:
+    /**
+     * @brief Analyzer using the parameters of the given models
+     * @param timeModel Rapid factor, idle time per operation and setup time
+     * @param energyModel Rapid and idle power
+     * @param emissionFactor Emission factor in kg CO2/kWh
+     */
+    SensitivityAnalyzer(const TimeModel& timeModel, const EnergyModel& energyModel, double emissionFactor);
+
+    /**
+     * @brief Use the coefficients and terms of a regression power model for the cutting power
+     * @param model Model to copy (e.g. the "regression" backend of AIInterface)
+     */
+    void setPowerModel(const RegressionPredictor& model);
+
+    /**
+     * @brief Set the depth of cut, which NX operations do not carry
+     * @param depth Depth of cut in mm
+     */
+    void setDepthOfCut(double depth);
+
+    /**
+     * @brief Choose whether a feed change also changes the cutting time
+     *
+     * When enabled (the default) the toolpath length is held constant, so cutting time
+     * scales with 1 / feed rate and the feed sensitivity includes the time effect.
+     *
+     * @param enabled Whether the toolpath length is held constant
+     */
+    void setConstantPathLength(bool enabled);
+
+    /**
+     * @brief Compute the emissions of a part and all partial derivatives
+     * @param operations Operations of the part
+     * @param material Workpiece material
+     * @return Per-part and per-operation sensitivities
+     */
+    PartSensitivity analyze(const std::vector<NXOperation>& operations, const std::string& material);
+
+    /**
+     * @brief Compute the emissions of a part only, with the plain double instantiation
+     * @param operations Operations of the part
+     * @param material Workpiece material
+     * @return Carbon emissions in kg CO2
+     */
+    double evaluate(const std::vector<NXOperation>& operations, const std::string& material);
+
+    /**
+     * @brief Rank all parameters by the magnitude of their elasticity
+     * @param result Result of analyze()
+     * @return Part-level and per-operation parameters, most influential first
+     */
+    static std::vector<SensitivityRanking> rank(const PartSensitivity& result);
+
+    /**
+     * @brief Get the display name of a parameter
+     * @param parameter Parameter
+     * @return Name including the unit
+     */
+    static const char* getParameterName(SensitivityParameter parameter);
+
+    /**
+     * @brief Print the part sensitivities and the most influential parameters
+     * @param result Result of analyze()
+     * @param top Number of ranked parameters to print
+     */
+    static void print(const PartSensitivity& result, std::size_t top = 10);
+};
+
+#endif // SENSITIVITY_ANALYZER_H
\ No newline at end of file
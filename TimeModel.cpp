@@ -16,7 +16,7 @@ TimeModel::~TimeModel() {
 double TimeModel::estimateRapidTime(double cuttingTime) {
     // Rapid time estimation based on cutting time
     // This is a simplified model - in reality, this would be more complex
-    double estimatedRapidTime = cuttingTime * rapidTimeFactor;
+    double estimatedRapidTime = computeRapidTime(cuttingTime, rapidTimeFactor);
     std::cout << "Estimated rapid time: " << estimatedRapidTime << " min (factor: " << rapidTimeFactor << ")" << std::endl;
     return estimatedRapidTime;
 }
@@ -24,14 +24,14 @@ double TimeModel::estimateRapidTime(double cuttingTime) {
 double TimeModel::estimateIdleTime(int numOperations) {
     // Idle time estimation based on number of operations
     // Includes setup time and tool change time
-    double estimatedIdleTime = setupTime + (numOperations * idleTimePerOp);
+    double estimatedIdleTime = computeIdleTime(numOperations, idleTimePerOp, setupTime);
     std::cout << "Estimated idle time: " << estimatedIdleTime << " min (setup: " << setupTime 
               << ", per op: " << idleTimePerOp << ", num ops: " << numOperations << ")" << std::endl;
     return estimatedIdleTime;
 }
 
 double TimeModel::calculateTotalTime(double cuttingTime, double rapidTime, double idleTime) {
-    double totalTime = cuttingTime + rapidTime + idleTime;
+    double totalTime = computeTotalTime(cuttingTime, rapidTime, idleTime);
     std::cout << "Total time calculated: " << totalTime << " min" << std::endl;
     return totalTime;
 }
@@ -49,4 +49,16 @@ void TimeModel::setIdleTimePerOp(double time) {
 void TimeModel::setSetupTime(double time) {
     setupTime = time;
     std::cout << "Setup time updated to: " << time << " min" << std::endl;
+}
+
+double TimeModel::getRapidTimeFactor() const {
+    return rapidTimeFactor;
+}
+
+double TimeModel::getIdleTimePerOp() const {
+    return idleTimePerOp;
+}
+
+double TimeModel::getSetupTime() const {
+    return setupTime;
 }
\ No newline at end of file
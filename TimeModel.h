@@ -57,6 +57,62 @@ public:
      * @param time Setup time in minutes
      */
     void setSetupTime(double time);
+    
+    /**
+     * @brief Get the rapid time factor
+     * @return Factor used to estimate rapid time relative to cutting time
+     */
+    double getRapidTimeFactor() const;
+    
+    /**
+     * @brief Get the idle time per operation
+     * @return Idle time per operation in minutes
+     */
+    double getIdleTimePerOp() const;
+    
+    /**
+     * @brief Get the setup time
+     * @return Setup time in minutes
+     */
+    double getSetupTime() const;
+
+    // Model formulas, templated on the numeric type so that Dual numbers can flow
+    // through them for sensitivity analysis; the methods above use the double versions
+
+    /**
+     * @brief Rapid time formula
+     * @param cuttingTime Cutting time in minutes
+     * @param factor Rapid time factor
+     * @return Rapid time in minutes
+     */
+    template <typename T>
+    static T computeRapidTime(const T& cuttingTime, const T& factor) {
+        return cuttingTime * factor;
+    }
+
+    /**
+     * @brief Idle time formula
+     * @param numOperations Number of machining operations
+     * @param timePerOp Idle time per operation in minutes
+     * @param setup Setup time in minutes
+     * @return Idle time in minutes
+     */
+    template <typename T>
+    static T computeIdleTime(int numOperations, const T& timePerOp, const T& setup) {
+        return setup + (static_cast<double>(numOperations) * timePerOp);
+    }
+
+    /**
+     * @brief Total time formula
+     * @param cuttingTime Cutting time in minutes
+     * @param rapidTime Rapid time in minutes
+     * @param idleTime Idle time in minutes
+     * @return Total time in minutes
+     */
+    template <typename T>
+    static T computeTotalTime(const T& cuttingTime, const T& rapidTime, const T& idleTime) {
+        return cuttingTime + rapidTime + idleTime;
+    }
 };
 
 #endif // TIME_MODEL_H
\ No newline at end of file
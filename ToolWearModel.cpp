@@ -0,0 +1,153 @@
+#include "ToolWearModel.h"
+#include "EnergyModel.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <functional>
+#include <future>
+#include <memory>
+#include <thread>
+
+namespace {
+
+// Operations per scan block; fixed so that the summation order never depends on the threads
+const std::size_t blockOperations = 65536;
+
+// Tool engagement accumulated in a block: since its last tool change, or in total if it has none
+struct BlockTotal {
+    bool toolChange;
+    double engagement;
+};
+
+} // namespace
+
+ToolWearModel::ToolWearModel() : driftPerMinute(0.002), maxDrift(0.25), threads(0) {
+}
+
+void ToolWearModel::setDriftPerMinute(double drift) {
+    driftPerMinute = std::max(drift, 0.0);
+}
+
+double ToolWearModel::getDriftPerMinute() const {
+    return driftPerMinute;
+}
+
+void ToolWearModel::setMaxDrift(double drift) {
+    maxDrift = std::max(drift, 0.0);
+}
+
+double ToolWearModel::getMaxDrift() const {
+    return maxDrift;
+}
+
+void ToolWearModel::setThreads(std::size_t threadCount) {
+    threads = threadCount;
+}
+
+bool ToolWearModel::isToolChange(const NXOperation& previous, const NXOperation& next) {
+    return previous.getToolDiameter() != next.getToolDiameter();
+}
+
+void ToolWearModel::computeEngagement(const std::vector<double>& cuttingTime, const std::vector<char>& newTool,
+                                      std::vector<double>& engagement) const {
+    std::size_t count = std::min(cuttingTime.size(), newTool.size());
+    engagement.resize(count);
+    if (count == 0) {
+        return;
+    }
+    const double* time = cuttingTime.data();
+    const char* change = newTool.data();
+    double* before = engagement.data();
+
+    std::size_t blocks = (count + blockOperations - 1) / blockOperations;
+    std::size_t workers = threads != 0 ? threads : std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+    std::size_t chunks = std::min(workers, blocks);
+    std::unique_ptr<ThreadPool> pool;
+    if (chunks > 1) {
+        pool.reset(new ThreadPool(chunks));
+    }
+    auto forEachBlock = [&pool, chunks, blocks](const std::function<void(std::size_t)>& task) {
+        if (!pool) {
+            for (std::size_t b = 0; b < blocks; ++b) {
+                task(b);
+            }
+            return;
+        }
+        std::vector<std::future<void>> done;
+        for (std::size_t c = 0; c < chunks; ++c) {
+            done.push_back(pool->submit([&task, c, chunks, blocks]() {
+                for (std::size_t b = c; b < blocks; b += chunks) {
+                    task(b);
+                }
+            }));
+        }
+        for (std::future<void>& chunk : done) {
+            chunk.get();
+        }
+    };
+
+    // Local exclusive scan of every block, restarting at its tool changes
+    std::vector<BlockTotal> totals(blocks);
+    forEachBlock([&](std::size_t b) {
+        std::size_t end = std::min(count, (b + 1) * blockOperations);
+        BlockTotal total{false, 0.0};
+        for (std::size_t i = b * blockOperations; i < end; ++i) {
+            if (change[i] || i == 0) {
+                total.toolChange = true;
+                total.engagement = 0.0;
+            }
+            before[i] = total.engagement;
+            total.engagement += time[i];
+        }
+        totals[b] = total;
+    });
+
+    // Engagement carried into each block by the tool loaded before it
+    std::vector<double> carry(blocks, 0.0);
+    for (std::size_t b = 1; b < blocks; ++b) {
+        carry[b] = totals[b - 1].toolChange ? totals[b - 1].engagement : carry[b - 1] + totals[b - 1].engagement;
+    }
+
+    // The carry applies up to the first tool change of the block
+    forEachBlock([&](std::size_t b) {
+        if (carry[b] == 0.0) {
+            return;
+        }
+        std::size_t end = std::min(count, (b + 1) * blockOperations);
+        for (std::size_t i = b * blockOperations; i < end && !change[i]; ++i) {
+            before[i] += carry[b];
+        }
+    });
+}
+
+void ToolWearModel::computePowerFactors(const std::vector<double>& cuttingTime, const std::vector<char>& newTool,
+                                        std::vector<double>& factors) const {
+    computeEngagement(cuttingTime, newTool, factors);
+    for (std::size_t i = 0; i < factors.size(); ++i) {
+        factors[i] = getPowerFactor(factors[i], cuttingTime[i]);
+    }
+}
+
+void ToolWearModel::computePowerFactors(const std::vector<NXOperation>& operations,
+                                        std::vector<double>& factors) const {
+    std::vector<double> cuttingTime(operations.size());
+    std::vector<char> newTool(operations.size(), 0);
+    for (std::size_t i = 0; i < operations.size(); ++i) {
+        cuttingTime[i] = operations[i].getCuttingTime();
+        newTool[i] = i == 0 || isToolChange(operations[i - 1], operations[i]);
+    }
+    computePowerFactors(cuttingTime, newTool, factors);
+}
+
+double ToolWearModel::getPowerFactor(double engagement, double cuttingTime) const {
+    // Wear grows during the operation; its middle stands for the whole operation
+    return 1.0 + std::min(driftPerMinute * (engagement + 0.5 * cuttingTime), maxDrift);
+}
+
+void ToolWearModel::applyPowerFactor(OperationEstimate& estimate, double factor) {
+    double extraEnergy = EnergyModel::computeEnergy(estimate.cuttingTime, estimate.cuttingPower * (factor - 1.0));
+    if (estimate.energy > 0.0) {
+        estimate.carbon *= (estimate.energy + extraEnergy) / estimate.energy;
+    }
+    estimate.energy += extraEnergy;
+    estimate.cuttingPower *= factor;
+}
\ No newline at end of file
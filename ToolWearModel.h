@@ -0,0 +1,114 @@
+#ifndef TOOL_WEAR_MODEL_H
+#define TOOL_WEAR_MODEL_H
+
+#include "NXCamDataExtractor.h"
+#include "OperationCache.h"
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Rise of cutting power with tool wear along the program order
+ *
+ * A tool's engagement is the cutting time it has accumulated since it was loaded. Each
+ * operation's predicted power is scaled by 1 + drift * (engagement at the middle of the
+ * operation), capped at the maximum drift, and the engagement restarts at every tool change.
+ *
+ * Engagement is a segmented prefix sum over the operation sequence, evaluated in fixed
+ * blocks on a thread pool: each block is scanned locally, the block totals are combined
+ * into carries, and the carries are added up to the first tool change of each block. The
+ * block size does not depend on the thread count, so results are identical for any number
+ * of threads.
+ */
+class ToolWearModel {
+private:
+    double driftPerMinute;
+    double maxDrift;
+    std::size_t threads;
+
+public:
+    ToolWearModel();
+
+    /**
+     * @brief Set the power rise per minute of tool engagement
+     * @param drift Fraction of the predicted power per minute (e.g. 0.002 for 0.2 %/min)
+     */
+    void setDriftPerMinute(double drift);
+
+    /**
+     * @brief Get the power rise per minute of tool engagement
+     * @return Fraction of the predicted power per minute
+     */
+    double getDriftPerMinute() const;
+
+    /**
+     * @brief Set the largest power rise of a worn tool
+     * @param drift Fraction of the predicted power (e.g. 0.25)
+     */
+    void setMaxDrift(double drift);
+
+    /**
+     * @brief Get the largest power rise of a worn tool
+     * @return Fraction of the predicted power
+     */
+    double getMaxDrift() const;
+
+    /**
+     * @brief Set the number of threads for large sequences
+     * @param threadCount Threads (0 uses the hardware concurrency)
+     */
+    void setThreads(std::size_t threadCount);
+
+    /**
+     * @brief Check whether the tool changes between two consecutive operations
+     *
+     * NXOperation carries no tool identity, so a change of tool diameter is taken as a tool
+     * change. Callers that know the tool numbers pass their own tool change flags.
+     * @param previous Preceding operation
+     * @param next Following operation
+     * @return True if next runs with another tool
+     */
+    static bool isToolChange(const NXOperation& previous, const NXOperation& next);
+
+    /**
+     * @brief Compute the engagement of the tool at the start of every operation
+     * @param cuttingTime Cutting time of each operation in minutes, in program order
+     * @param newTool Nonzero where an operation starts with a freshly loaded tool (the first
+     *        operation always does)
+     * @param engagement Receives the minutes the tool had cut before each operation
+     */
+    void computeEngagement(const std::vector<double>& cuttingTime, const std::vector<char>& newTool,
+                           std::vector<double>& engagement) const;
+
+    /**
+     * @brief Compute the power factor of every operation
+     * @param cuttingTime Cutting time of each operation in minutes, in program order
+     * @param newTool Nonzero where an operation starts with a freshly loaded tool
+     * @param factors Receives the factor to apply to each operation's predicted power
+     */
+    void computePowerFactors(const std::vector<double>& cuttingTime, const std::vector<char>& newTool,
+                             std::vector<double>& factors) const;
+
+    /**
+     * @brief Compute the power factor of every operation of a program
+     * @param operations Operations in program order; tool changes are detected with isToolChange()
+     * @param factors Receives one factor per operation
+     */
+    void computePowerFactors(const std::vector<NXOperation>& operations, std::vector<double>& factors) const;
+
+    /**
+     * @brief Get the power factor of one operation
+     * @param engagement Minutes the tool had cut before the operation
+     * @param cuttingTime Cutting time of the operation in minutes
+     * @return Factor to apply to the predicted power
+     */
+    double getPowerFactor(double engagement, double cuttingTime) const;
+
+    /**
+     * @brief Scale an operation estimate's cutting power, updating its energy and emissions
+     * @param estimate Estimate computed without wear
+     * @param factor Power factor
+     */
+    static void applyPowerFactor(OperationEstimate& estimate, double factor);
+};
+
+#endif // TOOL_WEAR_MODEL_H
\ No newline at end of file
@@ -0,0 +1,500 @@
+#include "TreeEnsemblePredictor.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+
+namespace {
+
+const char* const featureNames[TreeEnsemblePredictor::FeatureCount] = {
+    "tool_diameter_mm", "spindle_rpm", "feed_mm_min", "depth_of_cut_mm",
+    "material", "operation_type", "machine_type"
+};
+
+// Number of samples walked through a tree together
+const std::size_t blockSize = 64;
+
+int parseFeature(const std::string& name) {
+    for (int i = 0; i < TreeEnsemblePredictor::FeatureCount; ++i) {
+        if (name == featureNames[i]) {
+            return i;
+        }
+    }
+    // XGBoost default naming: f0, f1, ...
+    if (name.size() > 1 && name[0] == 'f') {
+        char* end = nullptr;
+        long index = std::strtol(name.c_str() + 1, &end, 10);
+        if (*end == '\0' && index >= 0 && index < TreeEnsemblePredictor::FeatureCount) {
+            return static_cast<int>(index);
+        }
+    }
+    return -1;
+}
+
+// Reads "key=<int>" from a node line, returns false if the key is missing
+bool parseIntField(const std::string& line, const std::string& key, int& value) {
+    std::size_t pos = line.find(key + "=");
+    if (pos == std::string::npos) {
+        return false;
+    }
+    value = std::atoi(line.c_str() + pos + key.size() + 1);
+    return true;
+}
+
+std::vector<std::string> splitList(const std::string& text) {
+    std::vector<std::string> items;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        items.push_back(item);
+    }
+    return items;
+}
+
+} // namespace
+
+TreeEnsemblePredictor::TreeEnsemblePredictor(const FeatureCategories& cats)
+    : categories(cats), baseScore(0.0), nodes(nullptr), leafValues(nullptr), treeRoots(nullptr),
+      treeDepths(nullptr), treeCount(0), nodeCount(0), info(), categoryCodes(CategoricalFeatureCount) {
+    for (int k = 0; k < CategoricalFeatureCount; ++k) {
+        categoryNameData[k] = nullptr;
+        categoryNameSizes[k] = 0;
+    }
+}
+
+std::string TreeEnsemblePredictor::getName() const {
+    return "tree";
+}
+
+bool TreeEnsemblePredictor::isReady() const {
+    return treeCount > 0;
+}
+
+bool TreeEnsemblePredictor::loadFromDump(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cout << "Error: cannot open tree ensemble dump " << path << std::endl;
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    if (!loadFromDumpText(buffer.str())) {
+        std::cout << "Error: failed to load tree ensemble dump " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool TreeEnsemblePredictor::loadFromDumpText(const std::string& text) {
+    double parsedBaseScore = 0.0;
+    std::vector<std::vector<std::string>> parsedCategories(CategoricalFeatureCount);
+    std::vector<std::vector<DumpNode>> parsedTrees;
+
+    std::stringstream stream(text);
+    std::string rawLine;
+    int lineNumber = 0;
+    while (std::getline(stream, rawLine)) {
+        ++lineNumber;
+        std::size_t first = rawLine.find_first_not_of(" \t\r");
+        if (first == std::string::npos || rawLine[first] == '#') {
+            continue;
+        }
+        std::string line = rawLine.substr(first);
+        while (!line.empty() && (line.back() == '\r' || line.back() == ' ')) {
+            line.pop_back();
+        }
+
+        if (line.compare(0, 11, "base_score=") == 0) {
+            parsedBaseScore = std::strtod(line.c_str() + 11, nullptr);
+            continue;
+        }
+        if (line.compare(0, 9, "category ") == 0) {
+            std::size_t eq = line.find('=');
+            int feature = (eq == std::string::npos) ? -1 : parseFeature(line.substr(9, eq - 9));
+            if (feature < Material) {
+                std::cout << "Error: line " << lineNumber << ": invalid category declaration" << std::endl;
+                return false;
+            }
+            parsedCategories[feature - Material] = splitList(line.substr(eq + 1));
+            continue;
+        }
+        if (line.compare(0, 8, "booster[") == 0) {
+            parsedTrees.emplace_back();
+            continue;
+        }
+
+        // Node line: "<id>:leaf=<value>" or "<id>:[<feature><<threshold>] yes=..,no=..,missing=.."
+        std::size_t colon = line.find(':');
+        if (parsedTrees.empty() || colon == std::string::npos) {
+            std::cout << "Error: line " << lineNumber << ": unexpected content" << std::endl;
+            return false;
+        }
+        int id = std::atoi(line.c_str());
+        if (id < 0) {
+            std::cout << "Error: line " << lineNumber << ": invalid node id" << std::endl;
+            return false;
+        }
+        DumpNode node = {false, 0, 0.0, -1, -1, -1, 0.0};
+        std::string body = line.substr(colon + 1);
+        if (body.compare(0, 5, "leaf=") == 0) {
+            node.isLeaf = true;
+            node.leafValue = std::strtod(body.c_str() + 5, nullptr);
+        } else {
+            std::size_t lt = body.find('<');
+            std::size_t close = body.find(']');
+            if (body.empty() || body[0] != '[' || lt == std::string::npos || close == std::string::npos || lt > close) {
+                std::cout << "Error: line " << lineNumber << ": invalid split" << std::endl;
+                return false;
+            }
+            node.feature = parseFeature(body.substr(1, lt - 1));
+            node.threshold = std::strtod(body.c_str() + lt + 1, nullptr);
+            if (node.feature < 0 ||
+                !parseIntField(body, "yes", node.yes) ||
+                !parseIntField(body, "no", node.no)) {
+                std::cout << "Error: line " << lineNumber << ": invalid split" << std::endl;
+                return false;
+            }
+            if (!parseIntField(body, "missing", node.missing)) {
+                node.missing = node.yes;
+            }
+        }
+
+        std::vector<DumpNode>& tree = parsedTrees.back();
+        if (static_cast<std::size_t>(id) >= tree.size()) {
+            tree.resize(id + 1, DumpNode{true, 0, 0.0, -1, -1, -1, std::numeric_limits<double>::quiet_NaN()});
+        }
+        tree[id] = node;
+    }
+
+    if (parsedTrees.empty()) {
+        std::cout << "Error: tree ensemble dump contains no trees" << std::endl;
+        return false;
+    }
+
+    // compile() only replaces the flat arrays on success, so a broken dump
+    // leaves the current model untouched
+    if (!compile(parsedTrees)) {
+        return false;
+    }
+
+    baseScore = parsedBaseScore;
+    dumpTrees.swap(parsedTrees);
+    for (int k = 0; k < CategoricalFeatureCount; ++k) {
+        ownedCategoryNames[k] = NameTableView::encode(parsedCategories[k]);
+        categoryNameData[k] = ownedCategoryNames[k].data();
+        categoryNameSizes[k] = ownedCategoryNames[k].size() * sizeof(std::uint32_t);
+        categoryNames[k].attach(categoryNameData[k], categoryNameSizes[k]);
+    }
+    container.reset();
+    for (auto& codes : categoryCodes) {
+        codes.clear();
+    }
+    std::cout << "Tree ensemble loaded: " << treeCount << " trees, "
+              << nodeCount << " nodes" << std::endl;
+    return true;
+}
+
+bool TreeEnsemblePredictor::compile(const std::vector<std::vector<DumpNode>>& trees) {
+    std::vector<FlatNode> flat;
+    std::vector<double> leaves;
+    std::vector<std::int32_t> roots;
+    std::vector<std::int32_t> depths;
+
+    for (std::size_t t = 0; t < trees.size(); ++t) {
+        const std::vector<DumpNode>& tree = trees[t];
+        if (tree.empty()) {
+            std::cout << "Error: tree " << t << " is empty" << std::endl;
+            return false;
+        }
+
+        // Breadth-first layout; the yes/no children of a split get adjacent slots
+        std::vector<bool> visited(tree.size(), false);
+        std::vector<int> queue(1, 0);
+        std::vector<int> level(1, 0);
+        std::int32_t root = static_cast<std::int32_t>(flat.size());
+        int depth = 0;
+        flat.emplace_back();
+        leaves.push_back(0.0);
+        visited[0] = true;
+
+        for (std::size_t q = 0; q < queue.size(); ++q) {
+            const DumpNode& node = tree[queue[q]];
+            std::size_t slot = root + q;
+            FlatNode& out = flat[slot];
+            depth = std::max(depth, level[q]);
+
+            if (node.isLeaf) {
+                if (std::isnan(node.leafValue)) {
+                    std::cout << "Error: tree " << t << " references undefined node " << queue[q] << std::endl;
+                    return false;
+                }
+                out.threshold = std::numeric_limits<double>::infinity();
+                out.left = static_cast<std::int32_t>(slot);
+                out.feature = 0;
+                out.defaultRight = 0;
+                out.isLeaf = 1;
+                leaves[slot] = node.leafValue;
+                continue;
+            }
+
+            bool validChildren = node.yes >= 0 && node.no >= 0 &&
+                                 static_cast<std::size_t>(node.yes) < tree.size() &&
+                                 static_cast<std::size_t>(node.no) < tree.size() &&
+                                 (node.missing == node.yes || node.missing == node.no);
+            if (!validChildren || visited[node.yes] || visited[node.no] || node.yes == node.no) {
+                std::cout << "Error: tree " << t << " node " << queue[q] << " has invalid children" << std::endl;
+                return false;
+            }
+            visited[node.yes] = true;
+            visited[node.no] = true;
+
+            // Children are appended in queue order, so their slots follow the queue positions
+            out.threshold = node.threshold;
+            out.left = root + static_cast<std::int32_t>(queue.size());
+            out.feature = static_cast<std::int16_t>(node.feature);
+            out.defaultRight = (node.missing == node.no) ? 1 : 0;
+            out.isLeaf = 0;
+            queue.push_back(node.yes);
+            queue.push_back(node.no);
+            level.push_back(level[q] + 1);
+            level.push_back(level[q] + 1);
+            flat.emplace_back();
+            flat.emplace_back();
+            leaves.push_back(0.0);
+            leaves.push_back(0.0);
+        }
+
+        roots.push_back(root);
+        depths.push_back(depth);
+    }
+
+    ownedNodes.swap(flat);
+    ownedLeafValues.swap(leaves);
+    ownedRoots.swap(roots);
+    ownedDepths.swap(depths);
+    nodes = ownedNodes.data();
+    leafValues = ownedLeafValues.data();
+    treeRoots = ownedRoots.data();
+    treeDepths = ownedDepths.data();
+    treeCount = ownedRoots.size();
+    nodeCount = ownedNodes.size();
+    return true;
+}
+
+void TreeEnsemblePredictor::refreshCategoryCodes() {
+    const CategoryTable* tables[CategoricalFeatureCount] = {
+        &categories.materials, &categories.operationTypes, &categories.machineTypes
+    };
+    for (int k = 0; k < CategoricalFeatureCount; ++k) {
+        std::vector<double>& codes = categoryCodes[k];
+        for (std::size_t id = codes.size(); id < tables[k]->size(); ++id) {
+            int code = categoryNames[k].find(tables[k]->getName(static_cast<int>(id)));
+            codes.push_back(code >= 0 ? static_cast<double>(code) : std::numeric_limits<double>::quiet_NaN());
+        }
+    }
+}
+
+void TreeEnsemblePredictor::encode(const CutFeatures& f, double* row, std::size_t stride) const {
+    const double missing = std::numeric_limits<double>::quiet_NaN();
+    const int ids[CategoricalFeatureCount] = {f.materialId, f.operationTypeId, f.machineTypeId};
+    row[ToolDiameter * stride] = f.toolDiameter;
+    row[SpindleSpeed * stride] = f.spindleSpeed;
+    row[FeedRate * stride] = f.feedRate;
+    row[DepthOfCut * stride] = f.depthOfCut;
+    for (int k = 0; k < CategoricalFeatureCount; ++k) {
+        const std::vector<double>& codes = categoryCodes[k];
+        bool known = ids[k] >= 0 && static_cast<std::size_t>(ids[k]) < codes.size();
+        row[(Material + k) * stride] = known ? codes[ids[k]] : missing;
+    }
+}
+
+bool TreeEnsemblePredictor::predictBatch(Span<const CutFeatures> features, Span<double> out) {
+    if (!isReady()) {
+        return false;
+    }
+    refreshCategoryCodes();
+
+    // Column-major block: x[feature * blockSize + sample]
+    double x[FeatureCount * blockSize];
+    std::int32_t node[blockSize];
+    double sum[blockSize];
+    const FlatNode* flat = nodes;
+    const double* leaves = leafValues;
+
+    for (std::size_t base = 0; base < features.size(); base += blockSize) {
+        std::size_t count = std::min(blockSize, features.size() - base);
+        for (std::size_t s = 0; s < count; ++s) {
+            encode(features[base + s], x + s, blockSize);
+            sum[s] = baseScore;
+        }
+
+        for (std::size_t t = 0; t < treeCount; ++t) {
+            std::int32_t root = treeRoots[t];
+            for (std::size_t s = 0; s < count; ++s) {
+                node[s] = root;
+            }
+            // Every sample takes exactly depth steps; finished samples spin on their leaf, whatever
+            // the feature value (+inf would pass even the infinite leaf threshold)
+            for (std::int32_t d = 0; d < treeDepths[t]; ++d) {
+                for (std::size_t s = 0; s < count; ++s) {
+                    const FlatNode& n = flat[node[s]];
+                    double v = x[n.feature * blockSize + s];
+                    int right = (v >= n.threshold) | ((v != v) & n.defaultRight);
+                    node[s] = n.left + (right & (n.isLeaf ^ 1));
+                }
+            }
+            for (std::size_t s = 0; s < count; ++s) {
+                sum[s] += leaves[node[s]];
+            }
+        }
+
+        for (std::size_t s = 0; s < count; ++s) {
+            out[base + s] = sum[s];
+        }
+    }
+    return true;
+}
+
+double TreeEnsemblePredictor::predictReference(const CutFeatures& features) {
+    if (dumpTrees.empty()) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    refreshCategoryCodes();
+    double x[FeatureCount];
+    encode(features, x, 1);
+
+    double sum = baseScore;
+    for (const std::vector<DumpNode>& tree : dumpTrees) {
+        int id = 0;
+        while (!tree[id].isLeaf) {
+            const DumpNode& n = tree[id];
+            double v = x[n.feature];
+            if (std::isnan(v)) {
+                id = n.missing;
+            } else {
+                id = (v < n.threshold) ? n.yes : n.no;
+            }
+        }
+        sum += tree[id].leafValue;
+    }
+    return sum;
+}
+
+bool TreeEnsemblePredictor::attachContainer(const std::shared_ptr<const ModelContainer>& modelContainer) {
+    std::size_t infoSize = 0;
+    std::size_t nodesSize = 0;
+    std::size_t leavesSize = 0;
+    std::size_t rootsSize = 0;
+    std::size_t depthsSize = 0;
+    const void* infoData = modelContainer->getSection(ModelSectionType::TreeInfo, 0, infoSize);
+    const void* nodesData = modelContainer->getSection(ModelSectionType::TreeNodes, 0, nodesSize);
+    const void* leavesData = modelContainer->getSection(ModelSectionType::TreeLeafValues, 0, leavesSize);
+    const void* rootsData = modelContainer->getSection(ModelSectionType::TreeRoots, 0, rootsSize);
+    const void* depthsData = modelContainer->getSection(ModelSectionType::TreeDepths, 0, depthsSize);
+    if (infoData == nullptr || infoSize != sizeof(TreeEnsembleInfo)) {
+        return false;
+    }
+
+    TreeEnsembleInfo stored = *static_cast<const TreeEnsembleInfo*>(infoData);
+    if (stored.treeCount == 0 ||
+        nodesData == nullptr || nodesSize != stored.nodeCount * sizeof(FlatNode) ||
+        leavesData == nullptr || leavesSize != stored.nodeCount * sizeof(double) ||
+        rootsData == nullptr || rootsSize != stored.treeCount * sizeof(std::int32_t) ||
+        depthsData == nullptr || depthsSize != stored.treeCount * sizeof(std::int32_t)) {
+        std::cout << "Error: model container holds an inconsistent tree ensemble" << std::endl;
+        return false;
+    }
+
+    // Predictions follow these indices without checks, so a corrupt container must not get through
+    const FlatNode* storedNodes = static_cast<const FlatNode*>(nodesData);
+    const std::int32_t* storedRoots = static_cast<const std::int32_t*>(rootsData);
+    const std::int32_t* storedDepths = static_cast<const std::int32_t*>(depthsData);
+    std::int64_t storedNodeCount = stored.nodeCount;
+    for (std::int64_t i = 0; i < storedNodeCount; ++i) {
+        const FlatNode& n = storedNodes[i];
+        bool valid = n.isLeaf ? (n.left == i && n.feature == 0)
+                              : (n.isLeaf == 0 && n.left > i && n.left < storedNodeCount - 1 &&
+                                 n.feature >= 0 && n.feature < FeatureCount);
+        if (!valid || n.isLeaf > 1) {
+            std::cout << "Error: model container holds an invalid tree node " << i << std::endl;
+            return false;
+        }
+    }
+    for (std::size_t t = 0; t < stored.treeCount; ++t) {
+        if (storedRoots[t] < 0 || storedRoots[t] >= storedNodeCount ||
+            storedDepths[t] < 0 || storedDepths[t] > storedNodeCount) {
+            std::cout << "Error: model container holds an invalid root or depth of tree " << t << std::endl;
+            return false;
+        }
+    }
+
+    NameTableView names[CategoricalFeatureCount];
+    const void* nameData[CategoricalFeatureCount];
+    std::size_t nameSizes[CategoricalFeatureCount];
+    for (int k = 0; k < CategoricalFeatureCount; ++k) {
+        nameData[k] = modelContainer->getSection(ModelSectionType::CategoryNames, Material + k, nameSizes[k]);
+        if (nameData[k] != nullptr && !names[k].attach(nameData[k], nameSizes[k])) {
+            std::cout << "Error: model container holds an invalid category table" << std::endl;
+            return false;
+        }
+    }
+
+    // Everything is used in place; nothing is parsed or copied
+    baseScore = stored.baseScore;
+    nodes = storedNodes;
+    leafValues = static_cast<const double*>(leavesData);
+    treeRoots = storedRoots;
+    treeDepths = storedDepths;
+    treeCount = stored.treeCount;
+    nodeCount = stored.nodeCount;
+    for (int k = 0; k < CategoricalFeatureCount; ++k) {
+        categoryNames[k] = names[k];
+        categoryNameData[k] = nameData[k];
+        categoryNameSizes[k] = nameSizes[k];
+        ownedCategoryNames[k].clear();
+    }
+    container = modelContainer;
+    dumpTrees.clear();
+    ownedNodes.clear();
+    ownedLeafValues.clear();
+    ownedRoots.clear();
+    ownedDepths.clear();
+    for (auto& codes : categoryCodes) {
+        codes.clear();
+    }
+
+    std::cout << "Tree ensemble mapped: " << treeCount << " trees, " << nodeCount << " nodes" << std::endl;
+    return true;
+}
+
+void TreeEnsemblePredictor::getSections(std::vector<ModelSectionData>& sections) {
+    if (!isReady()) {
+        return;
+    }
+    info.baseScore = baseScore;
+    info.treeCount = static_cast<std::uint32_t>(treeCount);
+    info.nodeCount = static_cast<std::uint32_t>(nodeCount);
+
+    sections.push_back({ModelSectionType::TreeInfo, 0, &info, sizeof(info)});
+    sections.push_back({ModelSectionType::TreeNodes, 0, nodes, nodeCount * sizeof(FlatNode)});
+    sections.push_back({ModelSectionType::TreeLeafValues, 0, leafValues, nodeCount * sizeof(double)});
+    sections.push_back({ModelSectionType::TreeRoots, 0, treeRoots, treeCount * sizeof(std::int32_t)});
+    sections.push_back({ModelSectionType::TreeDepths, 0, treeDepths, treeCount * sizeof(std::int32_t)});
+    for (int k = 0; k < CategoricalFeatureCount; ++k) {
+        if (categoryNameData[k] != nullptr) {
+            sections.push_back({ModelSectionType::CategoryNames, static_cast<std::uint32_t>(Material + k),
+                                categoryNameData[k], categoryNameSizes[k]});
+        }
+    }
+}
+
+std::size_t TreeEnsemblePredictor::getTreeCount() const {
+    return treeCount;
+}
+
+std::size_t TreeEnsemblePredictor::getNodeCount() const {
+    return nodeCount;
+}
\ No newline at end of file
@@ -0,0 +1,158 @@
+#ifndef TREE_ENSEMBLE_PREDICTOR_H
+#define TREE_ENSEMBLE_PREDICTOR_H
+
+#include "PowerPredictor.h"
+#include "ModelContainer.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Gradient-boosted tree ensemble backend for cutting power prediction
+ *
+ * Loads a trained GBDT from the text dump format described in docs/MODEL_FORMATS.md
+ * (XGBoost-style "booster[i]:" blocks with named features and category tables) and
+ * compiles it into flattened node arrays. Batch inference walks a block of samples
+ * through each tree level by level with a branch-free child computation, so the
+ * independent traversals overlap and the node arrays stay hot in cache.
+ *
+ * The compiled arrays can also be stored in a binary ModelContainer and used in
+ * place from its memory mapping, skipping parsing and compilation entirely.
+ */
+class TreeEnsemblePredictor : public PowerPredictor {
+public:
+    // Feature order used by the model, named after the columns of datasets/machining_power.csv
+    enum Feature {
+        ToolDiameter = 0,
+        SpindleSpeed,
+        FeedRate,
+        DepthOfCut,
+        Material,
+        OperationType,
+        MachineType,
+        FeatureCount
+    };
+
+    /**
+     * @brief Node of a parsed (uncompiled) tree, as read from the dump
+     */
+    struct DumpNode {
+        bool isLeaf;
+        int feature;
+        double threshold;       // samples with value < threshold go to yes
+        int yes;
+        int no;
+        int missing;
+        double leafValue;
+    };
+
+    /**
+     * @brief Flattened node: children are adjacent, so next = left + goRight
+     *
+     * Leaves point to themselves and never step right, which lets every sample run the
+     * same number of steps per tree without branching on leaves.
+     */
+    struct FlatNode {
+        double threshold;
+        std::int32_t left;
+        std::int16_t feature;
+        std::uint8_t defaultRight;  // direction for missing values
+        std::uint8_t isLeaf;
+    };
+    static_assert(sizeof(FlatNode) == 16, "FlatNode is stored as-is in model containers");
+
+    static const int CategoricalFeatureCount = FeatureCount - Material;
+
+private:
+    const FeatureCategories& categories;
+    double baseScore;
+    std::vector<std::vector<DumpNode>> dumpTrees;               // only for models loaded from a dump
+
+    // Compiled model, pointing either at the owned vectors or into a mapped container
+    const FlatNode* nodes;
+    const double* leafValues;                                   // parallel to nodes
+    const std::int32_t* treeRoots;
+    const std::int32_t* treeDepths;
+    std::size_t treeCount;
+    std::size_t nodeCount;
+    NameTableView categoryNames[CategoricalFeatureCount];       // per categorical feature, code -> name
+    const void* categoryNameData[CategoricalFeatureCount];      // encoded tables behind the views
+    std::size_t categoryNameSizes[CategoricalFeatureCount];
+
+    std::vector<FlatNode> ownedNodes;
+    std::vector<double> ownedLeafValues;
+    std::vector<std::int32_t> ownedRoots;
+    std::vector<std::int32_t> ownedDepths;
+    std::vector<std::uint32_t> ownedCategoryNames[CategoricalFeatureCount];
+    std::shared_ptr<const ModelContainer> container;
+    TreeEnsembleInfo info;                                      // written by getSections()
+
+    std::vector<std::vector<double>> categoryCodes;             // registry id -> model code (NaN if unknown)
+
+    bool compile(const std::vector<std::vector<DumpNode>>& trees);
+    void refreshCategoryCodes();
+    void encode(const CutFeatures& features, double* row, std::size_t stride) const;
+
+public:
+    explicit TreeEnsemblePredictor(const FeatureCategories& categories);
+
+    std::string getName() const override;
+    bool isReady() const override;
+    bool predictBatch(Span<const CutFeatures> features, Span<double> out) override;
+
+    /**
+     * @brief Load and compile a model from a text dump
+     * @param path Path to the dump file
+     * @return True on success; on failure the previous model is kept
+     */
+    bool loadFromDump(const std::string& path);
+
+    /**
+     * @brief Load and compile a model from dump text
+     * @param text Dump contents
+     * @return True on success; on failure the previous model is kept
+     */
+    bool loadFromDumpText(const std::string& text);
+
+    /**
+     * @brief Use the compiled model stored in a container, in place
+     * @param modelContainer Opened container; kept alive as long as the model is used
+     * @return True if the container holds a valid tree ensemble; otherwise the current model is kept
+     */
+    bool attachContainer(const std::shared_ptr<const ModelContainer>& modelContainer);
+
+    /**
+     * @brief Describe the compiled model as container sections
+     *
+     * The sections point into this predictor and stay valid until the model changes.
+     *
+     * @param sections Sections are appended here
+     */
+    void getSections(std::vector<ModelSectionData>& sections);
+
+    /**
+     * @brief Evaluate one cut by walking the parsed dump trees directly
+     *
+     * Reference implementation used to validate the compiled arrays.
+     * Only available for models loaded from a dump.
+     *
+     * @param features Input cut
+     * @return Predicted cutting power in kW, NaN if no dump trees are loaded
+     */
+    double predictReference(const CutFeatures& features);
+
+    /**
+     * @brief Get the number of trees
+     * @return Number of trees in the loaded model
+     */
+    std::size_t getTreeCount() const;
+
+    /**
+     * @brief Get the number of flattened nodes
+     * @return Total node count over all trees
+     */
+    std::size_t getNodeCount() const;
+};
+
+#endif // TREE_ENSEMBLE_PREDICTOR_H
\ No newline at end of file
@@ -3,12 +3,126 @@
 #include "EnergyModel.h"
 #include "CarbonModel.h"
 #include "AIInterface.h"
+#include "PowerProfile.h"
+#include "CarbonScheduler.h"
+#include "SensitivityAnalyzer.h"
+#include "BatchEstimator.h"
+#include "EstimationPipeline.h"
+#include "MachineSimulator.h"
+#include "CalendarQueue.h"
+#include "ScenarioEngine.h"
+#include "ReportWriter.h"
+#include "PlantAggregator.h"
+#include "AsyncEstimator.h"
+#include "ExtractionCache.h"
+#include "ToolWearModel.h"
+#include "MachineClasses.h"
 
+#include <chrono>
 #include <iostream>
 #include <fstream>
 #include <string>
 #include <vector>
 #include <sstream>
+#include <thread>
+#include <utility>
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <random>
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+
+// Row i of the report benchmark: a few operation types, numbers that need all their digits
+NXOperation benchmarkOperation(std::size_t i) {
+    static const char* types[] = {"Milling", "Drilling", "Face Milling", "Contour, finish"};
+    double k = static_cast<double>(i % 1000);
+    return NXOperation(types[i % 4], 1.0 + k / 7.0, 400.0 + k * 1.3, 4000.0 + k * 11.0, 6.0 + (i % 10));
+}
+
+OperationEstimate benchmarkEstimate(std::size_t i) {
+    OperationEstimate e;
+    double k = static_cast<double>(i % 997);
+    e.cuttingPower = 2.0 + k / 311.0;
+    e.cuttingTime = 1.0 + k / 7.0;
+    e.rapidTime = 0.1 * e.cuttingTime;
+    e.idleTime = 0.5;
+    e.totalTime = e.cuttingTime + e.rapidTime + e.idleTime;
+    e.energy = e.cuttingPower * e.totalTime / 60.0;
+    e.carbon = 0.475 * e.energy;
+    return e;
+}
+
+// The CSV rows of ReportWriter written through an ofstream, as the exports did before it
+void writeIostreamRows(std::ofstream& out, std::size_t rows, bool flushEachRow) {
+    out << "record,part,operation,operation_type,cutting_time_min,feed_mm_min,spindle_rpm,"
+        << "tool_diameter_mm,cutting_power_kw,rapid_time_min,idle_time_min,total_time_min,"
+        << "energy_kwh,carbon_kg,emission_factor\n";
+    for (std::size_t i = 0; i < rows; ++i) {
+        NXOperation op = benchmarkOperation(i);
+        OperationEstimate e = benchmarkEstimate(i);
+        out << "operation,Part-" << i / 100 << ',' << i % 100 << ',' << op.getOperationType() << ','
+            << op.getCuttingTime() << ',' << op.getFeedRate() << ',' << op.getSpindleSpeed() << ','
+            << op.getToolDiameter() << ',' << e.cuttingPower << ',' << e.rapidTime << ',' << e.idleTime << ','
+            << e.totalTime << ',' << e.energy << ',' << e.carbon << ',';
+        if (flushEachRow) {
+            out << std::endl;
+        } else {
+            out << '\n';
+        }
+    }
+}
+
+void printRate(const std::string& label, std::size_t rows, std::uint64_t bytes, double seconds) {
+    std::cout << label << ": " << seconds << " s, " << rows / seconds << " rows/s, "
+              << bytes / seconds / 1e6 << " MB/s" << std::endl;
+}
+
+// Report export benchmark: the same operation rows through iostreams and through ReportWriter
+int benchmarkReports(std::size_t rows) {
+    typedef std::chrono::steady_clock Clock;
+    const std::string path = "report_bench.out";
+    std::cout << "Writing " << rows << " operation rows to " << path << std::endl;
+
+    for (int variant = 0; variant < 2; ++variant) {
+        Clock::time_point start = Clock::now();
+        std::ofstream out(path);
+        if (variant == 1) {
+            out.precision(17);  // round-trip exact, as ReportWriter's shortest form
+        }
+        writeIostreamRows(out, rows, variant == 0);
+        std::uint64_t bytes = static_cast<std::uint64_t>(out.tellp());
+        out.close();
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        printRate(variant == 0 ? "iostream, std::endl" : "iostream, '\\n', precision 17", rows, bytes, seconds);
+    }
+
+    const ReportFormat formats[] = {ReportFormat::Csv, ReportFormat::JsonLines, ReportFormat::Text};
+    const char* labels[] = {"ReportWriter CSV", "ReportWriter JSON Lines", "ReportWriter text"};
+    for (int f = 0; f < 3; ++f) {
+        Clock::time_point start = Clock::now();
+        ReportWriter writer;
+        if (!writer.open(path, formats[f])) {
+            return 1;
+        }
+        for (std::size_t i = 0; i < rows; ++i) {
+            writer.writeOperation("Part-" + std::to_string(i / 100), i % 100, benchmarkOperation(i),
+                                  benchmarkEstimate(i));
+        }
+        std::uint64_t bytes = writer.getBytesWritten();
+        if (!writer.close()) {
+            return 1;
+        }
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        printRate(labels[f], rows, bytes, seconds);
+    }
+    std::remove(path.c_str());
+    return 0;
+}
+
+} // namespace
 
 /**
  * @brief NX CNC Carbon Emission Add-on
@@ -18,7 +132,12 @@
  *
  * Based on the project specification in project.md
  */
-int main() {
+int main(int argc, char* argv[]) {
+    // Report export throughput instead of the examples: --bench-report [ROWS]
+    if (argc >= 2 && std::string(argv[1]) == "--bench-report") {
+        return benchmarkReports(argc >= 3 ? static_cast<std::size_t>(std::atol(argv[2])) : 1000000);
+    }
+
     std::cout << "NX CNC Carbon Emission Add-on" << std::endl;
     std::cout << "===============================" << std::endl;
 
@@ -90,6 +209,281 @@ int main() {
 
     std::cout << "Carbon Emission: " << carbonEmission << " kg CO2" << std::endl;
 
+    // Example usage: Power-vs-time profile
+    std::cout << "\nBuilding power profile..." << std::endl;
+    PowerProfile powerProfile;
+    powerProfile.buildFromOperations(operations, timeModel, energyModel);
+    std::vector<PowerSample> displayPoints = PowerProfile::downsampleLTTB(powerProfile.sample(1.0), 500);
+
+    std::cout << "Peak Power: " << powerProfile.getPeakPower() << " kW" << std::endl;
+    std::cout << "Peak Demand (15 min): " << powerProfile.getPeakDemand(15.0) << " kW" << std::endl;
+    std::cout << "Load Factor (15 min): " << powerProfile.getLoadFactor(15.0) << std::endl;
+    std::cout << "Display points: " << displayPoints.size() << std::endl;
+
+    // Example usage: Carbon-aware scheduling of queued jobs
+    std::cout << "\nScheduling queued jobs..." << std::endl;
+    std::vector<double> hourlyIntensity = {0.30, 0.28, 0.27, 0.27, 0.29, 0.35, 0.45, 0.52,
+                                           0.50, 0.44, 0.38, 0.33, 0.31, 0.32, 0.36, 0.42,
+                                           0.50, 0.55, 0.54, 0.49, 0.43, 0.38, 0.34, 0.31};
+    CarbonScheduler scheduler;
+    scheduler.setGridIntensity(GridIntensity(0.0, 60.0, hourlyIntensity));
+    scheduler.addMachine(ScheduleMachine("VMC-1", energyModel));
+    scheduler.addMachine(ScheduleMachine("VMC-2", energyModel));
+    for (int i = 0; i < 6; ++i) {
+        scheduler.addJob(ScheduleJob("Part-" + std::to_string(i + 1), totalTime, totalEnergy, 1440.0));
+    }
+    if (scheduler.schedule()) {
+        scheduler.printSummary();
+    }
+
+    // Example usage: Discrete-event simulation of a cell, including transients and auxiliary loads
+    std::cout << "\nSimulating a machining cell..." << std::endl;
+    MachineSimulator cellSimulator(timeModel);
+    for (int m = 0; m < 2; ++m) {
+        std::size_t machine = cellSimulator.addMachine(MachineProfile("VMC-" + std::to_string(m + 1), energyModel));
+        for (int i = 0; i < 3; ++i) {
+            SimulationJob job("Part-" + std::to_string(3 * m + i + 1), operations);
+            job.releaseTime = 60.0 * i;
+            cellSimulator.addJob(machine, job);
+        }
+    }
+    if (cellSimulator.run(480.0)) {
+        cellSimulator.printSummary();
+    }
+
+    // Example usage: Event queue checked against std::priority_queue, with pushes that fall
+    // before the pending events after the calendar grows and shrinks
+    std::cout << "\nChecking the event queue..." << std::endl;
+    typedef std::pair<double, std::uint32_t> ReferenceEvent;  // time, push index
+    CalendarQueue calendar;
+    std::priority_queue<ReferenceEvent, std::vector<ReferenceEvent>, std::greater<ReferenceEvent>> reference;
+    std::mt19937 queueRandom(1);
+    std::uint32_t pushed = 0;
+    std::size_t mismatches = 0;
+    double queueNow = 0.0;
+    auto pushEvent = [&](double time) {
+        calendar.push(SimulationEvent(time, pushed, 0));
+        reference.push(ReferenceEvent(time, pushed++));
+    };
+    auto popEvent = [&]() {
+        SimulationEvent event;
+        if (!calendar.pop(event) || event.time != reference.top().first || event.target != reference.top().second) {
+            ++mismatches;
+        }
+        queueNow = reference.top().first;
+        reference.pop();
+    };
+    for (double time : {10.0, 11.0, 12.0, 13.0, 14.0, 1.0}) {
+        pushEvent(time);
+    }
+    while (!reference.empty()) {
+        popEvent();
+    }
+    for (int round = 0; round < 200; ++round) {
+        // Grow with events spread ahead, shrink by popping most of them, then push between
+        // the last popped time and the earliest pending one (and ties with the last popped)
+        std::uniform_real_distribution<double> ahead(0.0, 1.0 + round % 7 * 50.0);
+        for (int i = 0; i < 1 + round % 11 * 40; ++i) {
+            pushEvent(queueNow + ahead(queueRandom));
+        }
+        for (std::size_t i = reference.size() * 3 / 4; i > 0; --i) {
+            popEvent();
+        }
+        double gap = reference.empty() ? 1.0 : reference.top().first - queueNow;
+        std::uniform_real_distribution<double> between(0.0, gap);
+        for (int i = 0; i < 1 + round % 5; ++i) {
+            pushEvent(i == 0 ? queueNow : queueNow + between(queueRandom));
+            popEvent();
+        }
+    }
+    while (!reference.empty()) {
+        popEvent();
+    }
+    if (mismatches == 0 && calendar.empty()) {
+        std::cout << "Event queue matched std::priority_queue over " << pushed << " events" << std::endl;
+    } else {
+        std::cout << "Error: event queue out of order in " << mismatches << " of " << pushed << " pops" << std::endl;
+    }
+
+    // Example usage: Sensitivity of the part emissions to the process parameters
+    std::cout << "\nAnalyzing sensitivities..." << std::endl;
+    SensitivityAnalyzer sensitivityAnalyzer(timeModel, energyModel, emissionFactor);
+    sensitivityAnalyzer.setPowerModel(aiInterface.getRegressionPredictor());
+    SensitivityAnalyzer::print(sensitivityAnalyzer.analyze(operations, "Al6061"), 5);
+
+    // Example usage: What-if comparison across grids and power sources, sharing the common stages
+    std::cout << "\nComparing scenarios..." << std::endl;
+    ScenarioEngine scenarioEngine(aiInterface, timeModel, energyModel, emissionFactor);
+    scenarioEngine.setProgram(operations, "Al6061", "3axis_VMC");
+    std::vector<ScenarioDelta> scenarios;
+    scenarios.push_back(ScenarioDelta("DE grid"));
+    scenarios.back().region = "DE";
+    scenarios.push_back(ScenarioDelta("FR grid"));
+    scenarios.back().region = "FR";
+    scenarios.push_back(ScenarioDelta("Heuristic power"));
+    scenarios.back().powerSource = "heuristic";
+    ScenarioMatrix scenarioMatrix;
+    if (scenarioEngine.evaluate(scenarios, scenarioMatrix)) {
+        ScenarioEngine::print(scenarioMatrix);
+    }
+
+    // Example usage: Family of parts sharing operations, each distinct operation evaluated once
+    std::cout << "\nEstimating a family of parts..." << std::endl;
+    std::vector<PartProgram> family;
+    for (int i = 0; i < 4; ++i) {
+        std::vector<NXOperation> variantOperations = operations;
+        variantOperations.push_back(NXOperation("Face Milling", 2.0 + i, 900, 6000, 16.0));
+        family.push_back(PartProgram("Bracket-" + std::string(1, static_cast<char>('A' + i)), "Al6061",
+                                     "3axis_VMC", variantOperations));
+    }
+    BatchEstimator batchEstimator(aiInterface, timeModel, energyModel, emissionFactor);
+    std::vector<PartEstimate> familyEstimates;
+    batchEstimator.estimate(family, familyEstimates);
+    for (const PartEstimate& estimate : familyEstimates) {
+        std::cout << estimate.name << ": " << estimate.carbon << " kg CO2" << std::endl;
+    }
+    const BatchStatistics& batchStatistics = batchEstimator.getStatistics();
+    std::cout << "Operations: " << batchStatistics.operations << ", distinct: "
+              << batchStatistics.uniqueOperations << std::endl;
+    ReportWriter familyReport;
+    if (familyReport.open("-", ReportFormat::Text)) {
+        familyReport.writeParts(family, familyEstimates, emissionFactor);
+        familyReport.close();
+    }
+
+    // Example usage: The same batch under a memory budget, shedding the cache and spilling results
+    std::cout << "\nEstimating under a memory budget..." << std::endl;
+    BatchEstimator budgetEstimator(aiInterface, timeModel, energyModel, emissionFactor);
+    budgetEstimator.setMemoryBudget(2048);
+    budgetEstimator.setSpillPath("batch_spill.csv");
+    std::vector<PartEstimate> budgetEstimates;
+    budgetEstimator.estimate(family, budgetEstimates);
+    const BatchStatistics& budgetStatistics = budgetEstimator.getStatistics();
+    std::cout << "Parts spilled: " << budgetStatistics.spilledParts << ", cached estimates dropped: "
+              << budgetStatistics.shedEntries << std::endl;
+    MemoryAccount::print(budgetStatistics.memory);
+
+    // Example usage: Entries shed from memory stay in the cache file across later saves
+    std::cout << "\nShedding a saved operation cache..." << std::endl;
+    const PartProgram& shedPart = family[0];
+    OperationKey savedKey = makeOperationKey(shedPart.material, shedPart.machineType, shedPart.operations[0], 2.0);
+    OperationKey laterKey = makeOperationKey(shedPart.material, shedPart.machineType, shedPart.operations[1], 2.0);
+    OperationCache sheddingCache;
+    sheddingCache.insert(savedKey, familyEstimates[0].operations[0]);
+    sheddingCache.save("shed_cache.bin");
+    sheddingCache.shed();
+    sheddingCache.insert(laterKey, familyEstimates[0].operations[1]);
+    sheddingCache.save("shed_cache.bin");
+    OperationCache reloadedCache;
+    reloadedCache.load("shed_cache.bin");
+    if (reloadedCache.find(savedKey) != nullptr && reloadedCache.find(laterKey) != nullptr) {
+        std::cout << "Cache file kept the shed entry and the later one" << std::endl;
+    } else {
+        std::cout << "Error: cache file lost entries after shedding (" << reloadedCache.size() << " left)"
+                  << std::endl;
+    }
+
+    // Example usage: Cutting power drifting up as the tools wear along the program
+    std::cout << "\nEstimating with tool wear..." << std::endl;
+    ToolWearModel toolWear;
+    batchEstimator.setToolWearModel(&toolWear);
+    std::vector<PartEstimate> wornEstimates;
+    batchEstimator.estimate(family, wornEstimates);
+    batchEstimator.setToolWearModel(nullptr);
+    for (std::size_t i = 0; i < wornEstimates.size(); ++i) {
+        std::cout << wornEstimates[i].name << ": " << wornEstimates[i].carbon << " kg CO2 (+"
+                  << 100.0 * (wornEstimates[i].carbon / familyEstimates[i].carbon - 1.0) << " % from tool wear)"
+                  << std::endl;
+    }
+
+    // Example usage: The same part on every machine class, through the per-class kernels
+    std::cout << "\nEstimating per machine class..." << std::endl;
+    BatchEstimator classEstimator(aiInterface, timeModel, energyModel, emissionFactor);
+    classEstimator.setMachineClasses(true);
+    std::vector<PartProgram> classParts;
+    for (std::size_t c = 0; c < static_cast<std::size_t>(MachineClass::Count); ++c) {
+        classParts.push_back(family[0]);
+        classParts.back().machineType = getMachineKernel(static_cast<MachineClass>(c)).name;
+    }
+    std::vector<PartEstimate> classEstimates;
+    classEstimator.estimate(classParts, classEstimates);
+    for (std::size_t i = 0; i < classEstimates.size(); ++i) {
+        std::cout << classParts[i].machineType << ": " << classEstimates[i].totalTime << " min, "
+                  << classEstimates[i].energy << " kWh, " << classEstimates[i].carbon << " kg CO2" << std::endl;
+    }
+
+    // Example usage: Plant rollups of a week of the family on two machines
+    std::cout << "\nRolling up plant totals..." << std::endl;
+    PlantAggregator plant;
+    for (int day = 0; day < 5; ++day) {
+        for (std::size_t i = 0; i < family.size(); ++i) {
+            const PartEstimate& estimate = familyEstimates[i];
+            plant.add(i % 2 == 0 ? "VMC-1" : "VMC-2", estimate.name, family[i].material, day,
+                      estimate.totalTime, estimate.energy, estimate.carbon);
+        }
+    }
+    plant.print(plant.rollup(RollupMachine));
+    plant.print(plant.rollup(RollupDay));
+    RollupRow plantTotal = plant.total();
+    std::cout << "Plant total: " << plantTotal.carbon << " kg CO2 over " << plantTotal.count << " jobs" << std::endl;
+
+    // Example usage: Background estimation polled once per UI frame, restarted after an edit
+    std::cout << "\nEstimating in the background..." << std::endl;
+    AsyncEstimator asyncEstimator(aiInterface, timeModel, energyModel, emissionFactor);
+    std::shared_ptr<EstimationJob> job = asyncEstimator.start(family[0]);
+    PartProgram editedPart = family[0];
+    editedPart.operations.back() = NXOperation("Face Milling", 3.5, 900, 6000, 16.0);
+    job->cancel();
+    job = asyncEstimator.start(std::move(editedPart));
+    std::vector<OperationEstimate> streamed;
+    streamed.reserve(job->getTotal());
+    int frames = 0;
+    while (!job->isDone()) {
+        job->poll(streamed);
+        ++frames;
+        std::this_thread::sleep_for(std::chrono::milliseconds(16));
+    }
+    job->poll(streamed);
+    PartEstimate editedEstimate = job->getResult().get();
+    std::cout << editedEstimate.name << " (edited): " << streamed.size() << " operations streamed over " << frames
+              << " frames, " << editedEstimate.carbon << " kg CO2" << std::endl;
+
+    // Example usage: Estimation overlapped with the extraction of the operations
+    std::cout << "\nEstimating while extracting..." << std::endl;
+    EstimationPipeline pipeline(aiInterface, timeModel, energyModel, emissionFactor);
+    std::vector<OperationEstimate> pipelineEstimates;
+    pipeline.run(extractor, pipelineEstimates);
+    double pipelineCarbon = 0.0;
+    for (const OperationEstimate& estimate : pipelineEstimates) {
+        pipelineCarbon += estimate.carbon;
+    }
+    std::cout << "Operations: " << pipeline.getStatistics().operations << ", carbon: " << pipelineCarbon
+              << " kg CO2" << std::endl;
+
+    // Example usage: Re-extraction served from the persistent extraction cache
+    std::cout << "\nExtracting through the extraction cache..." << std::endl;
+    ExtractionCache extractionCache;
+    extractionCache.load("extraction_cache.bin");
+    for (int pass = 1; pass <= 2; ++pass) {
+        std::size_t hits = extractionCache.getHits();
+        std::size_t misses = extractionCache.getMisses();
+        std::size_t extracted = extractor.extractOperations([](const NXOperation&) { return true; }, extractionCache);
+        extractor.extractToolInfo(extractionCache);
+        extractor.extractProcessParameters(extractionCache);
+        std::cout << "Pass " << pass << ": " << extracted << " operations, "
+                  << extractionCache.getHits() - hits << " cache hits, "
+                  << extractionCache.getMisses() - misses << " re-extracted" << std::endl;
+    }
+    if (extractionCache.isModified()) {
+        extractionCache.save("extraction_cache.bin");
+    }
+    // Another part copied over the same file has another identity, so nothing is served from the cache
+    extractor.setPartIdentity("5d0c7e42-18a3-4f6b-b2e9-07a1c3d4e5f6");
+    std::size_t replacedHits = extractionCache.getHits();
+    extractor.extractOperations([](const NXOperation&) { return true; }, extractionCache);
+    std::cout << "Replaced part: " << extractionCache.getHits() - replacedHits << " cache hits" << std::endl;
+    extractor.setPartIdentity("");
+
     // Example usage: AI integration (optional) - Local model
     std::cout << "\nTesting local AI interface..." << std::endl;
     aiInterface.setEnabled(true);
@@ -0,0 +1,205 @@
+// nxcarbond.cpp
+// Estimation daemon: loads the models once and serves operation estimates to NX sessions,
+// the MES and dashboards over a Unix domain socket (protocol in EstimateProtocol.h).
+//
+//   nxcarbond [--socket PATH] [--model FILE] [--train CSV] [--emission-factor F]
+//             [--max-batch N] [--batch-delay-us N] [--max-connections N]
+//   nxcarbond --metrics [--socket PATH]
+//   nxcarbond --bench REQUESTS [--clients N] [--pipeline N] [--socket PATH]
+
+#include "EstimationServer.h"
+#include "EstimationClient.h"
+#include "TimeModel.h"
+#include "EnergyModel.h"
+#include "AIInterface.h"
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+EstimationServer* runningServer = nullptr;
+
+void handleSignal(int) {
+    if (runningServer != nullptr) {
+        runningServer->stop();
+    }
+}
+
+void printUsage() {
+    std::cout << "Usage: nxcarbond [--socket PATH] [--model FILE] [--train CSV] [--emission-factor F]\n"
+              << "                 [--max-batch N] [--batch-delay-us N] [--max-connections N]\n"
+              << "       nxcarbond --metrics [--socket PATH]\n"
+              << "       nxcarbond --bench REQUESTS [--clients N] [--pipeline N] [--socket PATH]" << std::endl;
+}
+
+int printMetrics(const std::string& socketPath) {
+    EstimationClient client;
+    std::string text;
+    if (!client.connect(socketPath) || !client.fetchMetrics(text)) {
+        return 1;
+    }
+    std::cout << text;
+    return 0;
+}
+
+// Load generator: each client sends `pipeline` requests per round trip and records the round-trip time
+int runBenchmark(const std::string& socketPath, std::size_t requests, std::size_t clients, std::size_t pipeline) {
+    clients = std::max<std::size_t>(1, clients);
+    pipeline = std::max<std::size_t>(1, pipeline);
+    const char* materials[] = {"Al6061", "Steel_S45C", "Ti6Al4V"};
+    const char* operations[] = {"Milling", "Drilling", "Face Milling"};
+
+    std::vector<LatencyHistogram> histograms(clients);
+    std::vector<std::size_t> answered(clients, 0);
+    std::vector<std::size_t> failures(clients, 0);
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t t = 0; t < clients; ++t) {
+        threads.emplace_back([&, t]() {
+            EstimationClient client;
+            if (!client.connect(socketPath)) {
+                failures[t] = requests / clients;
+                return;
+            }
+            const std::size_t perClient = requests / clients;
+            std::vector<EstimateQuery> queries;
+            std::vector<EstimateResult> results;
+            std::vector<EstimateStatus> statuses;
+            for (std::size_t sent = 0; sent < perClient; sent += queries.size()) {
+                queries.resize(std::min(pipeline, perClient - sent));
+                for (std::size_t i = 0; i < queries.size(); ++i) {
+                    std::size_t k = sent + i + t;
+                    EstimateQuery& q = queries[i];
+                    q.material = materials[k % 3];
+                    q.operationType = operations[(k / 3) % 3];
+                    q.machineType = "3axis_VMC";
+                    q.fields.toolDiameter = 6.0 + static_cast<double>(k % 10);
+                    q.fields.spindleSpeed = 4000.0 + static_cast<double>(k % 50) * 100.0;
+                    q.fields.feedRate = 400.0 + static_cast<double>(k % 40) * 20.0;
+                    q.fields.depthOfCut = 1.0 + static_cast<double>(k % 4) * 0.5;
+                    q.fields.cuttingTime = 5.0;
+                    q.fields.emissionFactor = 0.0;
+                }
+                auto sendTime = std::chrono::steady_clock::now();
+                if (!client.estimateBatch(queries, results, statuses)) {
+                    failures[t] += perClient - sent;
+                    return;
+                }
+                auto elapsed = std::chrono::steady_clock::now() - sendTime;
+                histograms[t].record(static_cast<std::uint64_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+                answered[t] += queries.size();
+                for (EstimateStatus status : statuses) {
+                    if (status != EstimateStatus::Ok) {
+                        ++failures[t];
+                    }
+                }
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    LatencyHistogram total;
+    std::size_t totalAnswered = 0;
+    std::size_t failed = 0;
+    for (std::size_t t = 0; t < clients; ++t) {
+        total.merge(histograms[t]);
+        totalAnswered += answered[t];
+        failed += failures[t];
+    }
+    std::cout << "Requests: " << totalAnswered << " in " << seconds << " s (" << totalAnswered / seconds << " req/s), "
+              << failed << " failed" << std::endl;
+    std::cout << "Round trip (up to " << pipeline << " requests): p50 " << total.quantile(0.50) / 1000.0
+              << " us, p99 " << total.quantile(0.99) / 1000.0 << " us, max " << total.getMaximum() / 1000.0
+              << " us" << std::endl;
+    printMetrics(socketPath);
+    return failed == 0 ? 0 : 1;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    ServerOptions options;
+    std::string modelPath;
+    std::string trainingPath;
+    double emissionFactor = 0.475;  // kg CO2/kWh (US average)
+    bool metricsOnly = false;
+    std::size_t benchRequests = 0;
+    std::size_t benchClients = 4;
+    std::size_t benchPipeline = 1;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--socket" && hasValue) {
+            options.socketPath = argv[++i];
+        } else if (arg == "--model" && hasValue) {
+            modelPath = argv[++i];
+        } else if (arg == "--train" && hasValue) {
+            trainingPath = argv[++i];
+        } else if (arg == "--emission-factor" && hasValue) {
+            emissionFactor = std::atof(argv[++i]);
+        } else if (arg == "--max-batch" && hasValue) {
+            options.maxBatchSize = static_cast<std::size_t>(std::atol(argv[++i]));
+        } else if (arg == "--batch-delay-us" && hasValue) {
+            options.batchDelayMicros = std::atoi(argv[++i]);
+        } else if (arg == "--max-connections" && hasValue) {
+            options.maxConnections = static_cast<std::size_t>(std::atol(argv[++i]));
+        } else if (arg == "--metrics") {
+            metricsOnly = true;
+        } else if (arg == "--bench" && hasValue) {
+            benchRequests = static_cast<std::size_t>(std::atol(argv[++i]));
+        } else if (arg == "--clients" && hasValue) {
+            benchClients = static_cast<std::size_t>(std::atol(argv[++i]));
+        } else if (arg == "--pipeline" && hasValue) {
+            benchPipeline = static_cast<std::size_t>(std::atol(argv[++i]));
+        } else {
+            printUsage();
+            return 2;
+        }
+    }
+
+    std::signal(SIGPIPE, SIG_IGN);
+    if (metricsOnly) {
+        return printMetrics(options.socketPath);
+    }
+    if (benchRequests > 0) {
+        return runBenchmark(options.socketPath, benchRequests, benchClients, benchPipeline);
+    }
+
+    TimeModel timeModel;
+    EnergyModel energyModel;
+    AIInterface aiInterface;
+    aiInterface.setEnabled(true);
+    if (!modelPath.empty()) {
+        aiInterface.loadModel(modelPath);
+    }
+    if (!trainingPath.empty()) {
+        aiInterface.trainModel(trainingPath);
+    }
+
+    EstimationServer server(aiInterface, timeModel, energyModel, emissionFactor);
+    server.setOptions(options);
+    if (!server.start()) {
+        return 1;
+    }
+    runningServer = &server;
+    std::signal(SIGINT, handleSignal);
+    std::signal(SIGTERM, handleSignal);
+    server.run();
+    runningServer = nullptr;
+
+    std::cout << "nxcarbond stopped" << std::endl;
+    std::cout << EstimationServer::formatMetrics(server.getMetrics());
+    return 0;
+}
\ No newline at end of file